@@ -0,0 +1,295 @@
+/*****************************************************************************
+ * FrameIndex.cpp: Keyframes and presentation timestamps of a video file
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "FrameIndex.h"
+
+extern "C"
+{
+#include <libavformat/avformat.h>
+}
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+using namespace Backend;
+
+namespace
+{
+
+// Bumped whenever the serialized layout changes
+const uint32_t  SerializationVersion = 1;
+
+struct Header
+{
+    uint32_t    version;
+    int32_t     timeBaseNum;
+    int32_t     timeBaseDen;
+    uint32_t    frameCount;
+    uint32_t    keyframeCount;
+};
+
+std::mutex&
+registryMutex()
+{
+    static std::mutex   mutex;
+    return mutex;
+}
+
+std::map<std::string, std::shared_ptr<const FrameIndex>>&
+registry()
+{
+    static std::map<std::string, std::shared_ptr<const FrameIndex>>     indexes;
+    return indexes;
+}
+
+// The media library hands out file:// URLs, while MLT may hold plain paths: both are
+// turned into the same local path
+std::string
+registryKey( const std::string& path )
+{
+    const std::string scheme = "file://";
+    if ( path.compare( 0, scheme.size(), scheme ) != 0 )
+        return path;
+    auto location = path.substr( scheme.size() );
+    // "file:///C:/video.mp4"
+    if ( location.size() > 2 && location[0] == '/' && location[2] == ':' )
+        location.erase( 0, 1 );
+    std::string key;
+    for ( size_t i = 0; i < location.size(); ++i )
+    {
+        if ( location[i] == '%' && i + 2 < location.size() &&
+             isxdigit( static_cast<unsigned char>( location[i + 1] ) ) != 0 &&
+             isxdigit( static_cast<unsigned char>( location[i + 2] ) ) != 0 )
+        {
+            key += static_cast<char>( std::stoi( location.substr( i + 1, 2 ), nullptr, 16 ) );
+            i += 2;
+        }
+        else
+            key += location[i];
+    }
+    return key;
+}
+
+}
+
+FrameIndex::FrameIndex()
+    : m_timeBaseNum( 1 )
+    , m_timeBaseDen( 1 )
+    , m_variableFrameRate( false )
+{
+}
+
+std::shared_ptr<FrameIndex>
+FrameIndex::build( const char* path, const std::function<bool( double )>& progress )
+{
+    AVFormatContext* context = nullptr;
+    if ( avformat_open_input( &context, path, nullptr, nullptr ) < 0 )
+        return nullptr;
+    std::unique_ptr<AVFormatContext*, void(*)( AVFormatContext** )>  guard( &context, &avformat_close_input );
+    if ( avformat_find_stream_info( context, nullptr ) < 0 )
+        return nullptr;
+    auto stream = av_find_best_stream( context, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0 );
+    if ( stream < 0 )
+        return nullptr;
+    // The other streams' packets are dropped by the demuxer, and nothing is decoded
+    for ( unsigned int i = 0; i < context->nb_streams; ++i )
+        context->streams[i]->discard = static_cast<int>( i ) == stream ? AVDISCARD_DEFAULT : AVDISCARD_ALL;
+    auto timeBase = context->streams[stream]->time_base;
+    auto duration = context->duration != AV_NOPTS_VALUE ? context->duration / static_cast<double>( AV_TIME_BASE ) : .0;
+
+    std::shared_ptr<FrameIndex> index( new FrameIndex );
+    index->m_timeBaseNum = timeBase.num;
+    index->m_timeBaseDen = timeBase.den;
+    // Packets come in decoding order, along with whether they start a GOP
+    std::vector<std::pair<int64_t, bool>>   packets;
+    auto packet = av_packet_alloc();
+    std::unique_ptr<AVPacket*, void(*)( AVPacket** )>  packetGuard( &packet, &av_packet_free );
+    while ( av_read_frame( context, packet ) >= 0 )
+    {
+        if ( packet->stream_index == stream )
+        {
+            auto pts = packet->pts != AV_NOPTS_VALUE ? packet->pts : packet->dts;
+            if ( pts != AV_NOPTS_VALUE )
+            {
+                packets.emplace_back( pts, ( packet->flags & AV_PKT_FLAG_KEY ) != 0 );
+                if ( packets.size() % 1000 == 0 && duration > .0 &&
+                     progress( std::min( 1.0, pts * av_q2d( timeBase ) / duration ) ) == false )
+                {
+                    av_packet_unref( packet );
+                    return nullptr;
+                }
+            }
+        }
+        av_packet_unref( packet );
+    }
+    if ( packets.empty() == true )
+        return nullptr;
+
+    std::sort( packets.begin(), packets.end() );
+    auto first = packets.front().first;
+    index->m_pts.reserve( packets.size() );
+    for ( const auto& p : packets )
+    {
+        if ( p.second == true )
+            index->m_keyframes.push_back( static_cast<uint32_t>( index->m_pts.size() ) );
+        index->m_pts.push_back( p.first - first );
+    }
+    // Frames decoded before the first keyframe can't be shown anyway
+    if ( index->m_keyframes.empty() == true || index->m_keyframes.front() != 0 )
+        index->m_keyframes.insert( index->m_keyframes.begin(), 0 );
+    index->m_variableFrameRate = index->detectVariableFrameRate();
+    progress( 1.0 );
+    return index;
+}
+
+std::shared_ptr<FrameIndex>
+FrameIndex::deserialize( const std::string& data )
+{
+    Header header;
+    if ( data.size() < sizeof( header ) )
+        return nullptr;
+    memcpy( &header, data.data(), sizeof( header ) );
+    auto expected = sizeof( header ) + header.frameCount * sizeof( int64_t ) +
+            header.keyframeCount * sizeof( uint32_t );
+    if ( header.version != SerializationVersion || data.size() != expected ||
+         header.timeBaseNum <= 0 || header.timeBaseDen <= 0 )
+        return nullptr;
+    std::shared_ptr<FrameIndex> index( new FrameIndex );
+    index->m_timeBaseNum = header.timeBaseNum;
+    index->m_timeBaseDen = header.timeBaseDen;
+    index->m_pts.resize( header.frameCount );
+    index->m_keyframes.resize( header.keyframeCount );
+    auto p = data.data() + sizeof( header );
+    memcpy( index->m_pts.data(), p, header.frameCount * sizeof( int64_t ) );
+    p += header.frameCount * sizeof( int64_t );
+    memcpy( index->m_keyframes.data(), p, header.keyframeCount * sizeof( uint32_t ) );
+    index->m_variableFrameRate = index->detectVariableFrameRate();
+    return index;
+}
+
+std::string
+FrameIndex::serialize() const
+{
+    // In the host byte order: this is only meant for the local cache
+    Header header;
+    header.version = SerializationVersion;
+    header.timeBaseNum = m_timeBaseNum;
+    header.timeBaseDen = m_timeBaseDen;
+    header.frameCount = static_cast<uint32_t>( m_pts.size() );
+    header.keyframeCount = static_cast<uint32_t>( m_keyframes.size() );
+    std::string data( reinterpret_cast<const char*>( &header ), sizeof( header ) );
+    data.append( reinterpret_cast<const char*>( m_pts.data() ), m_pts.size() * sizeof( int64_t ) );
+    data.append( reinterpret_cast<const char*>( m_keyframes.data() ), m_keyframes.size() * sizeof( uint32_t ) );
+    return data;
+}
+
+void
+FrameIndex::publish( const std::string& path, std::shared_ptr<const FrameIndex> index )
+{
+    std::lock_guard<std::mutex> lock( registryMutex() );
+    if ( index == nullptr )
+        registry().erase( registryKey( path ) );
+    else
+        registry()[registryKey( path )] = std::move( index );
+}
+
+std::shared_ptr<const FrameIndex>
+FrameIndex::find( const std::string& path )
+{
+    std::lock_guard<std::mutex> lock( registryMutex() );
+    auto it = registry().find( registryKey( path ) );
+    if ( it == registry().end() )
+        return nullptr;
+    return it->second;
+}
+
+size_t
+FrameIndex::frameCount() const
+{
+    return m_pts.size();
+}
+
+size_t
+FrameIndex::keyframeCount() const
+{
+    return m_keyframes.size();
+}
+
+bool
+FrameIndex::isVariableFrameRate() const
+{
+    return m_variableFrameRate;
+}
+
+bool
+FrameIndex::detectVariableFrameRate() const
+{
+    if ( m_pts.size() < 3 )
+        return false;
+    auto shortest = m_pts[1] - m_pts[0];
+    auto longest = shortest;
+    for ( size_t i = 2; i < m_pts.size(); ++i )
+    {
+        auto d = m_pts[i] - m_pts[i - 1];
+        shortest = std::min( shortest, d );
+        longest = std::max( longest, d );
+    }
+    // Allow for the rounding of the timestamps to the time base
+    return longest - shortest > std::max<int64_t>( 1, longest / 100 );
+}
+
+double
+FrameIndex::time( size_t frame ) const
+{
+    if ( m_pts.empty() == true )
+        return .0;
+    frame = std::min( frame, m_pts.size() - 1 );
+    return static_cast<double>( m_pts[frame] ) * m_timeBaseNum / m_timeBaseDen;
+}
+
+size_t
+FrameIndex::frameAt( double time ) const
+{
+    // Half a tick of tolerance, the time usually comes from a frame number
+    auto pts = static_cast<int64_t>( std::floor( time * m_timeBaseDen / m_timeBaseNum + 0.5 ) );
+    auto it = std::upper_bound( m_pts.begin(), m_pts.end(), pts );
+    if ( it == m_pts.begin() )
+        return 0;
+    return static_cast<size_t>( it - m_pts.begin() ) - 1;
+}
+
+size_t
+FrameIndex::keyframe( size_t frame ) const
+{
+    auto it = std::upper_bound( m_keyframes.begin(), m_keyframes.end(), static_cast<uint32_t>( frame ) );
+    return it == m_keyframes.begin() ? 0 : *( it - 1 );
+}
@@ -0,0 +1,89 @@
+/*****************************************************************************
+ * FrameIndex.h: Keyframes and presentation timestamps of a video file
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef FRAMEINDEX_H
+#define FRAMEINDEX_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Backend
+{
+    /**
+     *  Lists the frames of the main video stream of a file, in presentation order,
+     *  along with their exact timestamps and which ones are keyframes.
+     *
+     *  Timestamps are relative to the first frame, as the inputs' positions are.
+     *  This doesn't assume a constant frame rate, so it also describes variable
+     *  frame rate footage, ie. from phones.
+     */
+    class FrameIndex
+    {
+    public:
+        /**
+         *  Reads every packet of the file, without decoding them.
+         *  progress is given the ratio of the file which was read, and returns false
+         *  to interrupt the scan.
+         *  Returns nullptr if the file has no video, or if it was interrupted.
+         */
+        static std::shared_ptr<FrameIndex>  build( const char* path,
+                                                   const std::function<bool( double )>& progress );
+        static std::shared_ptr<FrameIndex>  deserialize( const std::string& data );
+        std::string             serialize() const;
+
+        /**
+         *  Makes an index available to every input reading this file.
+         *  The indexes are shared between threads, and are never modified once published.
+         *  A file:// URL and the local path it designates refer to the same index.
+         */
+        static void             publish( const std::string& path, std::shared_ptr<const FrameIndex> index );
+        static std::shared_ptr<const FrameIndex>    find( const std::string& path );
+
+        size_t                  frameCount() const;
+        size_t                  keyframeCount() const;
+        bool                    isVariableFrameRate() const;
+
+        // The presentation time of a frame, in seconds
+        double                  time( size_t frame ) const;
+        // The frame shown at a given time
+        size_t                  frameAt( double time ) const;
+        // The last keyframe at or before a frame
+        size_t                  keyframe( size_t frame ) const;
+
+    private:
+        FrameIndex();
+        bool                    detectVariableFrameRate() const;
+
+        int32_t                 m_timeBaseNum;
+        int32_t                 m_timeBaseDen;
+        // Presentation timestamps in the stream time base, sorted
+        std::vector<int64_t>    m_pts;
+        // Indexes in m_pts of the keyframes, sorted
+        std::vector<uint32_t>   m_keyframes;
+        bool                    m_variableFrameRate;
+    };
+}
+
+#endif // FRAMEINDEX_H
@@ -25,6 +25,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <string>
 
 namespace Backend
 {
@@ -64,6 +65,15 @@ namespace Backend
         // Absolute position in frames
         virtual std::unique_ptr<IInput>      cut( int64_t begin  = 0, int64_t end  = EndOfMedia ) = 0;
         virtual bool            isCut( ) const = 0 ;
+        // Opens an independent decoder of the same media, with the same boundaries,
+        // which can be read from another thread while this input keeps playing.
+        // Without withFilters, the filters applied to this input are left out, while the
+        // clips of tracks and sequences keep their own.
+        virtual std::unique_ptr<IInput>      reader( bool withFilters = false ) const = 0;
+        // Describes this input, its boundaries, filters, tracks and transitions included,
+        // without opening anything. This must be called from the thread editing the input,
+        // the whole input being locked meanwhile so that it can keep playing.
+        virtual std::string     serialize() const = 0;
 
         virtual bool            sameClip( IInput& that ) const = 0;
         virtual bool            runsInto( IInput& that ) const = 0;
@@ -78,6 +88,13 @@ namespace Backend
         // The position in frame relative to its beginning
         virtual int64_t         position() const = 0;
         virtual void            setPosition( int64_t position ) = 0;
+        // The position of the last keyframe shown at or before a position. Seeking there
+        // only decodes a single frame. Without a FrameIndex, this is the position itself.
+        virtual int64_t         keyframe( int64_t position ) const = 0;
+        // Reads the first frames, so that their data is in the system caches. This is meant
+        // for readers: the input they were opened from isn't prepared in any other way.
+        // This may run on any thread, as long as nothing else reads from this input meanwhile.
+        virtual void            warmCache( int64_t nbFrames ) = 0;
 
         // The absolete position in frame
         virtual int64_t         frame() const = 0;
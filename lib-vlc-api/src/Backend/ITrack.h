@@ -25,6 +25,8 @@
 
 #include "IInput.h"
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace Backend
 {
@@ -52,6 +54,10 @@ namespace Backend
         virtual int         clipIndexAt( int64_t position ) = 0;
         virtual int         count() const = 0;
         virtual void        clear() = 0;
+        // Replaces the whole track content in a single pass. Clips are given with their
+        // start frame, sorted and without overlapping. Overlapping clips are rejected as a
+        // whole, leaving the track content as it was.
+        virtual bool        setClips( const std::vector<std::pair<IInput*, int64_t>>& clips ) = 0;
 
         virtual void        hide( HideType hideType ) = 0;
     };
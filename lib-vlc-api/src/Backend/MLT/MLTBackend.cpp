@@ -35,6 +35,9 @@
 #include <mlt/framework/mlt_log.h>
 
 #include "MLTFilter.h"
+#include "MLTStillImage.h"
+#include "MLTImageSequence.h"
+#include "MLTFrameBuffer.h"
 
 #include <mutex>
 #include <sstream>
@@ -85,6 +88,10 @@ MLTBackend::MLTBackend()
         }
         m_availableTransitions[ transitionInfo->identifier() ] = transitionInfo;
     }
+
+    StillImageCache::registerServices( *m_mltRepo );
+    ImageSequenceProducer::registerService( *m_mltRepo );
+    FrameBuffer::registerService( *m_mltRepo );
 }
 
 MLTBackend::~MLTBackend()
@@ -0,0 +1,350 @@
+/*****************************************************************************
+ * MLTFrameBuffer.cpp: Rendered frames of the previewed input, around the playhead
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "MLTFrameBuffer.h"
+#include "MLTInput.h"
+
+#include <mlt++/MltFilter.h>
+#include <mlt++/MltFrame.h>
+#include <mlt++/MltProducer.h>
+#include <mlt++/MltRepository.h>
+
+#include <cstring>
+#include <iterator>
+
+using namespace Backend::MLT;
+
+const char* const FrameBuffer::FilterService = "vlmc_prefetch";
+
+namespace
+{
+
+typedef FrameBuffer::Image  Image;
+
+// About sixty 1080p frames
+const size_t DefaultBudget = 256 * 1024 * 1024;
+
+std::shared_ptr<FrameBuffer>
+bufferOf( mlt_filter filter )
+{
+    auto buffer = static_cast<std::weak_ptr<FrameBuffer>*>(
+                mlt_properties_get_data( MLT_FILTER_PROPERTIES( filter ), "_vlmc_buffer", nullptr ) );
+    return buffer != nullptr ? buffer->lock() : nullptr;
+}
+
+void
+deleteBuffer( void* buffer )
+{
+    delete static_cast<std::weak_ptr<FrameBuffer>*>( buffer );
+}
+
+std::shared_ptr<const Image>
+copyImage( mlt_frame frame, const uint8_t* data, mlt_image_format format, int width, int height )
+{
+    std::shared_ptr<Image> image( new Image );
+    if ( image->copy( frame, data, format, width, height ) == false )
+        return nullptr;
+    return image;
+}
+
+int
+filterGetImage( mlt_frame frame, uint8_t** buffer, mlt_image_format* format, int* width, int* height, int writable )
+{
+    auto filter = static_cast<mlt_filter>( mlt_frame_pop_service( frame ) );
+    auto frameBuffer = bufferOf( filter );
+    if ( frameBuffer == nullptr )
+        return mlt_frame_get_image( frame, buffer, format, width, height, writable );
+    auto position = mlt_frame_get_position( frame );
+    auto image = frameBuffer->take( filter, position, *format, *width, *height );
+    // The services below, down to the decoders, are skipped altogether
+    if ( image != nullptr )
+        return image->serve( frame, buffer, format, width, height );
+
+    auto res = mlt_frame_get_image( frame, buffer, format, width, height, writable );
+    if ( res == 0 && frameBuffer->wants( filter, position ) == true )
+        frameBuffer->rendered( filter, position, copyImage( frame, *buffer, *format, *width, *height ) );
+    return res;
+}
+
+mlt_frame
+filterProcess( mlt_filter filter, mlt_frame frame )
+{
+    mlt_frame_push_service( frame, filter );
+    mlt_frame_push_get_image( frame, filterGetImage );
+    return frame;
+}
+
+void*
+createFilter( mlt_profile, mlt_service_type, const char*, const void* )
+{
+    auto filter = mlt_filter_new();
+    if ( filter != nullptr )
+        filter->process = filterProcess;
+    return filter;
+}
+
+}
+
+FrameBuffer::FrameBuffer()
+    : m_size( 0 )
+    , m_budget( DefaultBudget )
+    , m_generation( 0 )
+    , m_filter( nullptr )
+    , m_expected( -1 )
+    , m_recording( false )
+    , m_format( mlt_image_yuv422 )
+    , m_width( 0 )
+    , m_height( 0 )
+{
+}
+
+void
+FrameBuffer::attach( MLTInput& input )
+{
+    auto producer = input.producer();
+    // An XML copy of the input may come with its filter already
+    mlt_filter filter = nullptr;
+    for ( int i = 0; i < producer->filter_count() && filter == nullptr; ++i )
+    {
+        std::unique_ptr<Mlt::Filter> f( producer->filter( i ) );
+        if ( isFilter( *f ) == true )
+            filter = f->get_filter();
+    }
+    auto profile = mlt_service_profile( producer->get_service() );
+    if ( filter == nullptr )
+    {
+        filter = mlt_factory_filter( profile, FilterService, nullptr );
+        if ( filter == nullptr )
+            return;
+        // Not an effect: it isn't saved along with the input
+        mlt_properties_set_int( MLT_FILTER_PROPERTIES( filter ), "_loader", 1 );
+        mlt_service_attach( producer->get_service(), filter );
+        // The producer holds a reference
+        mlt_filter_close( filter );
+    }
+    mlt_properties_set_data( MLT_FILTER_PROPERTIES( filter ), "_vlmc_buffer",
+                             new std::weak_ptr<FrameBuffer>( shared_from_this() ), 0, deleteBuffer, nullptr );
+
+    std::lock_guard<std::mutex> lock( m_mutex );
+    m_frames.clear();
+    m_size = 0;
+    ++m_generation;
+    m_filter = filter;
+    m_expected = -1;
+    if ( profile != nullptr )
+    {
+        m_width = profile->width;
+        m_height = profile->height;
+    }
+}
+
+bool
+FrameBuffer::render( IInput& reader, int64_t position, uint64_t generation )
+{
+    auto input = dynamic_cast<MLTInput*>( &reader );
+    if ( input == nullptr )
+        return false;
+    mlt_image_format format;
+    int width;
+    int height;
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        if ( generation != m_generation )
+            return false;
+        if ( m_frames.count( position ) != 0 )
+            return true;
+        format = static_cast<mlt_image_format>( m_format );
+        width = m_width;
+        height = m_height;
+    }
+    input->setPosition( position );
+    std::unique_ptr<Mlt::Frame> frame( input->producer()->get_frame() );
+    if ( frame == nullptr || frame->is_valid() == false )
+        return false;
+    auto data = frame->get_image( format, width, height );
+    auto image = copyImage( frame->get_frame(), data, format, width, height );
+    if ( image == nullptr )
+        return false;
+
+    std::lock_guard<std::mutex> lock( m_mutex );
+    if ( generation != m_generation )
+        return false;
+    insert( position, std::move( image ) );
+    return true;
+}
+
+uint64_t
+FrameBuffer::generation() const
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+    return m_generation;
+}
+
+bool
+FrameBuffer::contains( int64_t position ) const
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+    return m_frames.count( position ) != 0;
+}
+
+void
+FrameBuffer::expect( int64_t position )
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+    m_expected = position;
+}
+
+void
+FrameBuffer::setRecording( bool recording )
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+    m_recording = recording;
+}
+
+void
+FrameBuffer::invalidate()
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+    m_frames.clear();
+    m_size = 0;
+    ++m_generation;
+    m_expected = -1;
+}
+
+void
+FrameBuffer::trim( int64_t position )
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+    while ( m_size > m_budget && m_frames.empty() == false )
+    {
+        auto first = m_frames.begin();
+        auto last = std::prev( m_frames.end() );
+        auto it = position - first->first > last->first - position ? first : last;
+        m_size -= it->second->size();
+        m_frames.erase( it );
+    }
+}
+
+void
+FrameBuffer::setBudget( size_t budget )
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+    m_budget = budget;
+}
+
+size_t
+FrameBuffer::size() const
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+    return m_size;
+}
+
+void
+FrameBuffer::registerService( Mlt::Repository& repository )
+{
+    repository.register_service( filter_type, FilterService, createFilter );
+}
+
+bool
+FrameBuffer::isFilter( Mlt::Filter& filter )
+{
+    auto service = filter.get( "mlt_service" );
+    return service != nullptr && strcmp( service, FilterService ) == 0;
+}
+
+std::shared_ptr<const FrameBuffer::Image>
+FrameBuffer::take( const void* filter, int64_t position, int format, int width, int height )
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+    if ( filter != m_filter )
+        return nullptr;
+    if ( format != mlt_image_none && width > 0 && height > 0 )
+    {
+        m_format = format;
+        m_width = width;
+        m_height = height;
+    }
+    if ( position != m_expected )
+        return nullptr;
+    // Only once: the same position asked again is a refresh, which has to be rendered
+    m_expected = -1;
+    auto it = m_frames.find( position );
+    if ( it == m_frames.end() || matches( *it->second ) == false )
+        return nullptr;
+    return it->second;
+}
+
+bool
+FrameBuffer::wants( const void* filter, int64_t position ) const
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+    return filter == m_filter && ( m_recording == true || m_frames.count( position ) != 0 );
+}
+
+void
+FrameBuffer::rendered( const void* filter, int64_t position, std::shared_ptr<const Image> image )
+{
+    if ( image == nullptr )
+        return;
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        if ( filter != m_filter )
+            return;
+        auto it = m_frames.find( position );
+        if ( it != m_frames.end() && matches( *it->second ) == true )
+        {
+            if ( it->second->pixels == image->pixels )
+                return;
+            // The input changed behind our back, none of the frames can be trusted anymore
+            m_frames.clear();
+            m_size = 0;
+            ++m_generation;
+        }
+        if ( m_recording == false )
+            return;
+        insert( position, std::move( image ) );
+    }
+    trim( position );
+}
+
+bool
+FrameBuffer::matches( const Image& image ) const
+{
+    return image.format == m_format && image.width == m_width && image.height == m_height;
+}
+
+void
+FrameBuffer::insert( int64_t position, std::shared_ptr<const Image> image )
+{
+    auto it = m_frames.find( position );
+    if ( it != m_frames.end() )
+    {
+        m_size -= it->second->size();
+        m_frames.erase( it );
+    }
+    m_size += image->size();
+    m_frames.emplace( position, std::move( image ) );
+}
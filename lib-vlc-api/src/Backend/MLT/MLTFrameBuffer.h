@@ -0,0 +1,133 @@
+/*****************************************************************************
+ * MLTFrameBuffer.h: Rendered frames of the previewed input, around the playhead
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef MLTFRAMEBUFFER_H
+#define MLTFRAMEBUFFER_H
+
+#include "MLTFrameImage.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace Mlt
+{
+class Filter;
+class Repository;
+}
+
+namespace Backend
+{
+class IInput;
+namespace MLT
+{
+    class MLTInput;
+
+    /**
+     *  Keeps rendered frames of the previewed input, ie. the sequence, by position.
+     *
+     *  Frames are rendered into the buffer from independent readers of the input, on
+     *  any thread. The "vlmc_prefetch" filter, which ends the filter chain of the input,
+     *  then hands out the buffered frame of a position instead of rendering it, as long
+     *  as it was told to expect that position. A refresh of the current frame, ie. after
+     *  an effect was tweaked, is always rendered.
+     *
+     *  The filter also checks the frames it renders against their buffered copy, and
+     *  drops the whole buffer if they differ. It can record them as well, so that stepping
+     *  back after the playback doesn't decode them again.
+     */
+    class FrameBuffer : public std::enable_shared_from_this<FrameBuffer>
+    {
+    public:
+        typedef FrameImage  Image;
+
+        static const char* const    FilterService;
+
+        FrameBuffer();
+
+        /**
+         *  Appends the filter to an input, replacing its previous one if any.
+         *  Only the last input this was attached to is served, the filters of the
+         *  previous ones let every frame through.
+         */
+        void                attach( MLTInput& input );
+        /**
+         *  Renders a frame of a reader of the input into the buffer. Readers can't be shared
+         *  between threads, but each thread can render with its own.
+         *  \param generation  The buffer generation when the reader was copied from the input
+         *  \return false if the frame couldn't be rendered, or the buffer was invalidated since
+         */
+        bool                render( IInput& reader, int64_t position, uint64_t generation );
+        /**
+         *  Bumped whenever the frames are dropped, be it by invalidate() or because the filter
+         *  found that the input changed. Readers copied before are outdated.
+         */
+        uint64_t            generation() const;
+        bool                contains( int64_t position ) const;
+        // The next request for this position is served from the buffer, if it has it
+        void                expect( int64_t position );
+        // Keeps a copy of the frames the filter renders
+        void                setRecording( bool recording );
+        // Drops every frame, including the ones being rendered
+        void                invalidate();
+        // Drops the frames the furthest away from a position, until the buffer fits its budget
+        void                trim( int64_t position );
+        // In bytes
+        void                setBudget( size_t budget );
+        size_t              size() const;
+
+        static void         registerService( Mlt::Repository& repository );
+        static bool         isFilter( Mlt::Filter& filter );
+
+        // Called by the filter, with the image format & size it is asked for
+        std::shared_ptr<const Image>    take( const void* filter, int64_t position,
+                                              int format, int width, int height );
+        // Whether a frame the filter rendered is worth a copy, see rendered()
+        bool                wants( const void* filter, int64_t position ) const;
+        void                rendered( const void* filter, int64_t position,
+                                      std::shared_ptr<const Image> image );
+
+    private:
+        bool                matches( const Image& image ) const;
+        void                insert( int64_t position, std::shared_ptr<const Image> image );
+
+    private:
+        mutable std::mutex                                  m_mutex;
+        std::map<int64_t, std::shared_ptr<const Image>>     m_frames;
+        size_t                      m_size;
+        size_t                      m_budget;
+        // Bumped on invalidation, frames rendered from an older one are dropped
+        uint64_t                    m_generation;
+        // The filter being served
+        const void*                 m_filter;
+        int64_t                     m_expected;
+        bool                        m_recording;
+        // What the consumer asks for, the readers render the same
+        int                         m_format;
+        int                         m_width;
+        int                         m_height;
+    };
+}
+}
+
+#endif // MLTFRAMEBUFFER_H
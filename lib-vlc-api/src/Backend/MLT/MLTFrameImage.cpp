@@ -0,0 +1,133 @@
+/*****************************************************************************
+ * MLTFrameImage.cpp: Images kept out of MLT frames, and the producers serving them
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "MLTFrameImage.h"
+
+#include <mlt/framework/mlt_pool.h>
+#include <mlt/framework/mlt_producer.h>
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace Backend::MLT;
+
+FrameImage::FrameImage()
+    : width( 0 )
+    , height( 0 )
+    , format( mlt_image_none )
+    , aspectRatio( .0 )
+{
+}
+
+size_t
+FrameImage::size() const
+{
+    return sizeof( *this ) + pixels.size() + alpha.size();
+}
+
+bool
+FrameImage::copy( mlt_frame frame, const uint8_t* data, mlt_image_format format, int width, int height )
+{
+    auto size = mlt_image_format_size( format, width, height, nullptr );
+    if ( data == nullptr || size <= 0 )
+        return false;
+    auto properties = MLT_FRAME_PROPERTIES( frame );
+    this->width = width;
+    this->height = height;
+    this->format = format;
+    aspectRatio = mlt_properties_get_double( properties, "aspect_ratio" );
+    pixels.assign( data, data + size );
+    int alphaSize = 0;
+    auto mask = static_cast<uint8_t*>( mlt_properties_get_data( properties, "alpha", &alphaSize ) );
+    if ( mask != nullptr && alphaSize > 0 )
+        alpha.assign( mask, mask + alphaSize );
+    else
+        alpha.clear();
+    return true;
+}
+
+int
+FrameImage::serve( mlt_frame frame, uint8_t** buffer, mlt_image_format* format, int* width, int* height ) const
+{
+    auto size = pixels.size();
+    auto data = static_cast<uint8_t*>( mlt_pool_alloc( static_cast<int>( size ) ) );
+    if ( data == nullptr )
+        return 1;
+    memcpy( data, pixels.data(), size );
+    mlt_frame_set_image( frame, data, static_cast<int>( size ), mlt_pool_release );
+    if ( alpha.empty() == false )
+    {
+        auto mask = static_cast<uint8_t*>( mlt_pool_alloc( static_cast<int>( alpha.size() ) ) );
+        if ( mask != nullptr )
+        {
+            memcpy( mask, alpha.data(), alpha.size() );
+            mlt_frame_set_alpha( frame, mask, static_cast<int>( alpha.size() ), mlt_pool_release );
+        }
+    }
+    auto properties = MLT_FRAME_PROPERTIES( frame );
+    mlt_properties_set_int( properties, "format", this->format );
+    mlt_properties_set_int( properties, "width", this->width );
+    mlt_properties_set_int( properties, "height", this->height );
+    if ( aspectRatio > .0 )
+        mlt_properties_set_double( properties, "aspect_ratio", aspectRatio );
+    *buffer = data;
+    *format = static_cast<mlt_image_format>( this->format );
+    *width = this->width;
+    *height = this->height;
+    return 0;
+}
+
+int
+ImageProducer::getFrame( mlt_producer producer, mlt_frame_ptr frame, mlt_get_image getImage )
+{
+    *frame = mlt_frame_init( MLT_PRODUCER_SERVICE( producer ) );
+    if ( *frame == nullptr )
+        return 1;
+    auto properties = MLT_FRAME_PROPERTIES( *frame );
+    auto producerProperties = MLT_PRODUCER_PROPERTIES( producer );
+    mlt_frame_set_position( *frame, mlt_producer_position( producer ) );
+    mlt_properties_set_int( properties, "progressive", 1 );
+    mlt_properties_set_double( properties, "aspect_ratio", 1.0 );
+    mlt_properties_set_int( properties, "meta.media.width",
+                            mlt_properties_get_int( producerProperties, "meta.media.width" ) );
+    mlt_properties_set_int( properties, "meta.media.height",
+                            mlt_properties_get_int( producerProperties, "meta.media.height" ) );
+    // No audio: MLT fills the frame with silence
+    mlt_properties_set_int( properties, "test_audio", 1 );
+    mlt_frame_push_service( *frame, producer );
+    mlt_frame_push_get_image( *frame, getImage );
+    mlt_producer_prepare_next( producer );
+    return 0;
+}
+
+void
+ImageProducer::close( mlt_producer producer )
+{
+    // mlt_producer_close would call this again otherwise
+    producer->close = nullptr;
+    mlt_producer_close( producer );
+    free( producer );
+}
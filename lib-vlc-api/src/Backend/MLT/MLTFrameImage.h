@@ -0,0 +1,82 @@
+/*****************************************************************************
+ * MLTFrameImage.h: Images kept out of MLT frames, and the producers serving them
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef MLTFRAMEIMAGE_H
+#define MLTFRAMEIMAGE_H
+
+#include <mlt/framework/mlt_frame.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace Backend
+{
+namespace MLT
+{
+    /**
+     *  A copy of a frame's image, which outlives the frame.
+     *
+     *  The still image cache, the image sequences and the frame buffer keep their
+     *  images this way, and hand a copy of them to each frame they serve.
+     */
+    struct FrameImage
+    {
+        int                     width;
+        int                     height;
+        // A mlt_image_format
+        int                     format;
+        // The sample aspect ratio, 0 if unknown
+        double                  aspectRatio;
+        std::vector<uint8_t>    pixels;
+        // The alpha mask of YUV images, if any
+        std::vector<uint8_t>    alpha;
+
+        FrameImage();
+
+        // In bytes
+        size_t                  size() const;
+        // Copies the image a frame was rendered to, and its alpha mask. false if there's none.
+        bool                    copy( mlt_frame frame, const uint8_t* data, mlt_image_format format,
+                                      int width, int height );
+        /**
+         *  Hands a copy of the image to a frame, as a get_image callback would: the
+         *  services down the chain may write to it. Returns 0 on success.
+         */
+        int                     serve( mlt_frame frame, uint8_t** buffer, mlt_image_format* format,
+                                       int* width, int* height ) const;
+    };
+
+    /**
+     *  The get_frame & close callbacks of the producers which only have a video stream,
+     *  the size of which is in their "meta.media.width" and "meta.media.height".
+     */
+    class ImageProducer
+    {
+    public:
+        // Creates a frame at the producer's position, rendered by getImage
+        static int      getFrame( mlt_producer producer, mlt_frame_ptr frame, mlt_get_image getImage );
+        static void     close( mlt_producer producer );
+    };
+}
+}
+
+#endif // MLTFRAMEIMAGE_H
@@ -0,0 +1,630 @@
+/*****************************************************************************
+ * MLTImageSequence.cpp: Plays numbered images as a video
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "MLTImageSequence.h"
+#include "MLTFrameImage.h"
+
+#include <mlt++/MltRepository.h>
+
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+#include <libswscale/swscale.h>
+}
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <locale>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+using namespace Backend::MLT;
+
+const char* const ImageSequenceProducer::ServiceName = "vlmc_sequence";
+const int ImageSequenceProducer::MaxGap = 100;
+
+namespace
+{
+
+const int   DefaultReadAhead = 8;
+
+struct Resource
+{
+    std::string     prefix;
+    // 0 when the numbers aren't padded
+    int             digits;
+    std::string     suffix;
+    int             first;
+    int             last;
+    double          fps;
+    int             readAhead;
+};
+
+bool
+parse( const char* resource, Resource& r )
+{
+    std::string s( resource );
+    auto query = s.rfind( '?' );
+    if ( query == std::string::npos )
+        return false;
+    r.first = -1;
+    r.last = -1;
+    r.fps = .0;
+    r.readAhead = DefaultReadAhead;
+    std::istringstream params( s.substr( query + 1 ) );
+    std::string param;
+    while ( std::getline( params, param, '&' ) )
+    {
+        auto equal = param.find( '=' );
+        if ( equal == std::string::npos )
+            continue;
+        auto key = param.substr( 0, equal );
+        // Whatever the application locale is
+        std::istringstream value( param.substr( equal + 1 ) );
+        value.imbue( std::locale::classic() );
+        if ( key == "first" )
+            value >> r.first;
+        else if ( key == "last" )
+            value >> r.last;
+        else if ( key == "fps" )
+            value >> r.fps;
+        else if ( key == "readahead" )
+            value >> r.readAhead;
+    }
+
+    // A single %d or %0Nd, and %% for %. The pattern is never given to printf.
+    auto pattern = s.substr( 0, query );
+    r.prefix.clear();
+    r.suffix.clear();
+    r.digits = -1;
+    for ( size_t i = 0; i < pattern.size(); ++i )
+    {
+        auto& part = r.digits < 0 ? r.prefix : r.suffix;
+        if ( pattern[i] != '%' )
+            part += pattern[i];
+        else if ( i + 1 < pattern.size() && pattern[i + 1] == '%' )
+        {
+            part += '%';
+            ++i;
+        }
+        else
+        {
+            if ( r.digits >= 0 )
+                return false;
+            size_t j = i + 1;
+            int digits = 0;
+            while ( j < pattern.size() && std::isdigit( static_cast<unsigned char>( pattern[j] ) ) != 0 )
+                digits = digits * 10 + ( pattern[j++] - '0' );
+            if ( j >= pattern.size() || pattern[j] != 'd' || digits > 16 )
+                return false;
+            r.digits = digits;
+            i = j;
+        }
+    }
+    return r.digits >= 0 && r.first >= 0 && r.last >= r.first && r.fps > .0 && r.readAhead >= 0;
+}
+
+/*
+ * Reading & decoding
+ */
+
+// Maps a file, or reads it when the mapping wouldn't leave room for the decoders' padding
+class MappedFile
+{
+public:
+    explicit MappedFile( const std::string& path );
+    ~MappedFile();
+
+    const uint8_t*          data() const;
+    size_t                  size() const;
+
+private:
+    MappedFile( const MappedFile& ) = delete;
+    MappedFile& operator=( const MappedFile& ) = delete;
+
+    const uint8_t*          m_data;
+    size_t                  m_size;
+    void*                   m_mapping;
+    std::vector<uint8_t>    m_buffer;
+};
+
+MappedFile::MappedFile( const std::string& path )
+    : m_data( nullptr )
+    , m_size( 0 )
+    , m_mapping( nullptr )
+{
+#ifndef _WIN32
+    int fd = open( path.c_str(), O_RDONLY );
+    if ( fd < 0 )
+        return;
+    struct stat info;
+    if ( fstat( fd, &info ) == 0 && info.st_size > 0 )
+    {
+        m_size = static_cast<size_t>( info.st_size );
+        auto page = static_cast<size_t>( sysconf( _SC_PAGESIZE ) );
+        auto tail = m_size % page;
+        // The decoders may read up to AV_INPUT_BUFFER_PADDING_SIZE bytes past the end.
+        // They're mapped, and zeroed, as long as they fit in the last page.
+        if ( tail != 0 && page - tail >= AV_INPUT_BUFFER_PADDING_SIZE )
+        {
+            auto mapping = mmap( nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+            if ( mapping != MAP_FAILED )
+            {
+                madvise( mapping, m_size, MADV_WILLNEED );
+                m_mapping = mapping;
+                m_data = static_cast<const uint8_t*>( mapping );
+            }
+        }
+    }
+    close( fd );
+    if ( m_data != nullptr || m_size == 0 )
+        return;
+#endif
+    std::ifstream file( path.c_str(), std::ios::binary | std::ios::ate );
+    if ( file.is_open() == false )
+        return;
+    m_size = static_cast<size_t>( file.tellg() );
+    m_buffer.assign( m_size + AV_INPUT_BUFFER_PADDING_SIZE, 0 );
+    file.seekg( 0 );
+    if ( file.read( reinterpret_cast<char*>( m_buffer.data() ), m_size ) )
+        m_data = m_buffer.data();
+    else
+        m_size = 0;
+}
+
+MappedFile::~MappedFile()
+{
+#ifndef _WIN32
+    if ( m_mapping != nullptr )
+        munmap( m_mapping, m_size );
+#endif
+}
+
+const uint8_t*
+MappedFile::data() const
+{
+    return m_data;
+}
+
+size_t
+MappedFile::size() const
+{
+    return m_size;
+}
+
+typedef FrameImage  Image;
+
+AVCodecID
+codecId( const std::string& path )
+{
+    auto dot = path.rfind( '.' );
+    if ( dot == std::string::npos )
+        return AV_CODEC_ID_NONE;
+    auto extension = path.substr( dot + 1 );
+    std::transform( extension.begin(), extension.end(), extension.begin(), []( char c ) {
+        return static_cast<char>( std::tolower( static_cast<unsigned char>( c ) ) );
+    });
+    if ( extension == "png" )
+        return AV_CODEC_ID_PNG;
+    if ( extension == "jpg" || extension == "jpeg" )
+        return AV_CODEC_ID_MJPEG;
+    return AV_CODEC_ID_NONE;
+}
+
+// Decodes an image, scaled to the given size. A size of 0 keeps its native size.
+std::shared_ptr<const Image>
+decode( const std::string& path, int width, int height )
+{
+    auto codec = avcodec_find_decoder( codecId( path ) );
+    if ( codec == nullptr )
+        return nullptr;
+    MappedFile file( path );
+    if ( file.data() == nullptr )
+        return nullptr;
+
+    AVCodecContext* context = avcodec_alloc_context3( codec );
+    std::unique_ptr<AVCodecContext*, void(*)( AVCodecContext** )>  contextGuard( &context, &avcodec_free_context );
+    if ( context == nullptr )
+        return nullptr;
+    // The images are decoded in parallel, one thread each
+    context->thread_count = 1;
+    if ( avcodec_open2( context, codec, nullptr ) < 0 )
+        return nullptr;
+    AVPacket* packet = av_packet_alloc();
+    std::unique_ptr<AVPacket*, void(*)( AVPacket** )>  packetGuard( &packet, &av_packet_free );
+    AVFrame* frame = av_frame_alloc();
+    std::unique_ptr<AVFrame*, void(*)( AVFrame** )>  frameGuard( &frame, &av_frame_free );
+    if ( packet == nullptr || frame == nullptr )
+        return nullptr;
+    packet->data = const_cast<uint8_t*>( file.data() );
+    packet->size = static_cast<int>( file.size() );
+    if ( avcodec_send_packet( context, packet ) < 0 )
+        return nullptr;
+    auto res = avcodec_receive_frame( context, frame );
+    if ( res == AVERROR( EAGAIN ) )
+    {
+        avcodec_send_packet( context, nullptr );
+        res = avcodec_receive_frame( context, frame );
+    }
+    if ( res < 0 || frame->width <= 0 || frame->height <= 0 )
+        return nullptr;
+
+    if ( width <= 0 || height <= 0 )
+    {
+        width = frame->width;
+        height = frame->height;
+    }
+    std::unique_ptr<SwsContext, void(*)( SwsContext* )> scaler(
+                sws_getContext( frame->width, frame->height, static_cast<AVPixelFormat>( frame->format ),
+                                width, height, AV_PIX_FMT_RGBA, SWS_BICUBIC, nullptr, nullptr, nullptr ),
+                &sws_freeContext );
+    if ( scaler == nullptr )
+        return nullptr;
+    std::shared_ptr<Image> image( new Image );
+    image->width = width;
+    image->height = height;
+    image->format = mlt_image_rgb24a;
+    image->pixels.resize( static_cast<size_t>( width ) * height * 4 );
+    uint8_t* planes[4] = { image->pixels.data(), nullptr, nullptr, nullptr };
+    int strides[4] = { width * 4, 0, 0, 0 };
+    sws_scale( scaler.get(), frame->data, frame->linesize, 0, frame->height, planes, strides );
+    return image;
+}
+
+/*
+ * The worker pool, shared by all the sequences
+ */
+
+class WorkerPool
+{
+public:
+    static WorkerPool&      instance();
+    ~WorkerPool();
+
+    // Urgent tasks, ie. the image the output waits for, skip the read-ahead queue
+    void                    post( std::function<void()> task, bool urgent );
+
+private:
+    WorkerPool();
+    void                    run();
+
+    std::mutex                          m_mutex;
+    std::condition_variable             m_cond;
+    std::deque<std::function<void()>>   m_tasks;
+    std::vector<std::thread>            m_threads;
+    bool                                m_stop;
+};
+
+WorkerPool&
+WorkerPool::instance()
+{
+    static WorkerPool   pool;
+    return pool;
+}
+
+WorkerPool::WorkerPool()
+    : m_stop( false )
+{
+    auto count = std::max( 2u, std::thread::hardware_concurrency() );
+    for ( unsigned i = 0; i < count; ++i )
+        m_threads.emplace_back( &WorkerPool::run, this );
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_stop = true;
+    }
+    m_cond.notify_all();
+    for ( auto& t : m_threads )
+        t.join();
+}
+
+void
+WorkerPool::post( std::function<void()> task, bool urgent )
+{
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        if ( urgent == true )
+            m_tasks.push_front( std::move( task ) );
+        else
+            m_tasks.push_back( std::move( task ) );
+    }
+    m_cond.notify_one();
+}
+
+void
+WorkerPool::run()
+{
+    while ( true )
+    {
+        std::function<void()>   task;
+        {
+            std::unique_lock<std::mutex> lock( m_mutex );
+            m_cond.wait( lock, [this]() { return m_stop == true || m_tasks.empty() == false; } );
+            if ( m_stop == true )
+                return;
+            task = std::move( m_tasks.front() );
+            m_tasks.pop_front();
+        }
+        task();
+    }
+}
+
+/*
+ * The images of a producer
+ */
+
+class Reader : public std::enable_shared_from_this<Reader>
+{
+public:
+    explicit Reader( const Resource& resource );
+
+    std::string             path( int index ) const;
+    // The image shown at a position of a profile running at profileFps
+    int                     indexAt( mlt_position position, double profileFps ) const;
+    // Waits for an image, and schedules the decoding of the next ones
+    std::shared_ptr<const Image>    image( int index, int width, int height );
+
+private:
+    struct Slot
+    {
+        Slot() : pending( true ) {}
+
+        std::shared_ptr<const Image>    image;
+        bool                            pending;
+    };
+
+    // Called with m_mutex held
+    void                    schedule( int index, bool urgent );
+    void                    decodeSlot( int index, int width, int height, unsigned generation );
+
+    const Resource          m_resource;
+    std::mutex              m_mutex;
+    std::condition_variable m_cond;
+    std::map<int, Slot>     m_slots;
+    // The size the slots are decoded at
+    int                     m_width;
+    int                     m_height;
+    // Bumped when the size changes, to drop the decodings in flight
+    unsigned                m_generation;
+    int                     m_position;
+    int                     m_direction;
+};
+
+Reader::Reader( const Resource& resource )
+    : m_resource( resource )
+    , m_width( 0 )
+    , m_height( 0 )
+    , m_generation( 0 )
+    , m_position( resource.first )
+    , m_direction( 1 )
+{
+}
+
+std::string
+Reader::path( int index ) const
+{
+    auto number = std::to_string( index );
+    if ( static_cast<int>( number.size() ) < m_resource.digits )
+        number.insert( 0, m_resource.digits - number.size(), '0' );
+    return m_resource.prefix + number + m_resource.suffix;
+}
+
+int
+Reader::indexAt( mlt_position position, double profileFps ) const
+{
+    auto index = m_resource.first + static_cast<int>( std::floor( position * m_resource.fps / profileFps + 1e-6 ) );
+    return std::max( m_resource.first, std::min( index, m_resource.last ) );
+}
+
+std::shared_ptr<const Image>
+Reader::image( int index, int width, int height )
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    if ( width != m_width || height != m_height )
+    {
+        // ie. the preview was resized
+        m_slots.clear();
+        m_width = width;
+        m_height = height;
+        ++m_generation;
+    }
+    if ( index != m_position )
+        m_direction = index > m_position ? 1 : -1;
+    m_position = index;
+
+    // Only keep the images around the position, on the side it's heading to
+    auto low = m_direction > 0 ? index - 1 : index - m_resource.readAhead;
+    auto high = m_direction > 0 ? index + m_resource.readAhead : index + 1;
+    for ( auto it = m_slots.begin(); it != m_slots.end(); )
+    {
+        if ( it->first < low || it->first > high )
+            it = m_slots.erase( it );
+        else
+            ++it;
+    }
+    schedule( index, true );
+    for ( int i = 1; i <= m_resource.readAhead; ++i )
+        schedule( index + i * m_direction, false );
+
+    m_cond.wait( lock, [this, index]() {
+        auto it = m_slots.find( index );
+        return it == m_slots.end() || it->second.pending == false;
+    });
+    auto it = m_slots.find( index );
+    if ( it != m_slots.end() )
+        return it->second.image;
+    // Dropped by a concurrent request, ie. from another rendering thread
+    lock.unlock();
+    return decode( path( index ), width, height );
+}
+
+void
+Reader::schedule( int index, bool urgent )
+{
+    if ( index < m_resource.first || index > m_resource.last || m_slots.count( index ) != 0 )
+        return;
+    m_slots[index] = Slot();
+    // The tasks may outlive the producer
+    std::weak_ptr<Reader> self( shared_from_this() );
+    auto width = m_width;
+    auto height = m_height;
+    auto generation = m_generation;
+    WorkerPool::instance().post( [self, index, width, height, generation]() {
+        auto reader = self.lock();
+        if ( reader != nullptr )
+            reader->decodeSlot( index, width, height, generation );
+    }, urgent );
+}
+
+void
+Reader::decodeSlot( int index, int width, int height, unsigned generation )
+{
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        // Skipped by a seek, or outdated by a new size
+        auto it = m_slots.find( index );
+        if ( generation != m_generation || it == m_slots.end() || it->second.pending == false )
+            return;
+    }
+    std::shared_ptr<const Image> image;
+    for ( int i = index; i >= std::max( m_resource.first, index - ImageSequenceProducer::MaxGap ) && image == nullptr; --i )
+        image = decode( path( i ), width, height );
+
+    std::lock_guard<std::mutex> lock( m_mutex );
+    auto it = m_slots.find( index );
+    if ( generation != m_generation || it == m_slots.end() )
+        return;
+    it->second.image = image;
+    it->second.pending = false;
+    m_cond.notify_all();
+}
+
+/*
+ * The producer
+ */
+
+int
+producerGetImage( mlt_frame frame, uint8_t** buffer, mlt_image_format* format, int* width, int* height, int )
+{
+    auto producer = static_cast<mlt_producer>( mlt_frame_pop_service( frame ) );
+    auto reader = static_cast<std::shared_ptr<Reader>*>(
+                mlt_properties_get_data( MLT_PRODUCER_PROPERTIES( producer ), "_reader", nullptr ) );
+    if ( reader == nullptr )
+        return 1;
+    auto profile = mlt_service_profile( MLT_PRODUCER_SERVICE( producer ) );
+    auto index = (*reader)->indexAt( mlt_frame_get_position( frame ), mlt_profile_fps( profile ) );
+    auto image = (*reader)->image( index, *width, *height );
+    if ( image == nullptr )
+        return 1;
+    return image->serve( frame, buffer, format, width, height );
+}
+
+int
+producerGetFrame( mlt_producer producer, mlt_frame_ptr frame, int )
+{
+    return ImageProducer::getFrame( producer, frame, producerGetImage );
+}
+
+void
+deleteReader( void* reader )
+{
+    delete static_cast<std::shared_ptr<Reader>*>( reader );
+}
+
+void*
+createProducer( mlt_profile profile, mlt_service_type, const char*, const void* arg )
+{
+    Resource resource;
+    if ( arg == nullptr || parse( static_cast<const char*>( arg ), resource ) == false )
+        return nullptr;
+    auto reader = std::make_shared<Reader>( resource );
+    // Probes the size, and checks that the pattern matches an image
+    auto first = decode( reader->path( resource.first ), 0, 0 );
+    if ( first == nullptr )
+        return nullptr;
+    auto producer = mlt_producer_new( profile );
+    if ( producer == nullptr )
+        return nullptr;
+    auto properties = MLT_PRODUCER_PROPERTIES( producer );
+    mlt_properties_set( properties, "resource", static_cast<const char*>( arg ) );
+    mlt_properties_set_int( properties, "seekable", 1 );
+    mlt_properties_set_int( properties, "meta.media.nb_streams", 1 );
+    mlt_properties_set( properties, "meta.media.0.stream.type", "video" );
+    mlt_properties_set_int( properties, "meta.media.width", first->width );
+    mlt_properties_set_int( properties, "meta.media.height", first->height );
+    mlt_properties_set_int( properties, "meta.media.sample_aspect_num", 1 );
+    mlt_properties_set_int( properties, "meta.media.sample_aspect_den", 1 );
+    mlt_properties_set_int( properties, "meta.media.progressive", 1 );
+    mlt_properties_set_int( properties, "meta.media.frame_rate_num", static_cast<int>( std::lround( resource.fps * 1000 ) ) );
+    mlt_properties_set_int( properties, "meta.media.frame_rate_den", 1000 );
+    mlt_properties_set_int( properties, "width", first->width );
+    mlt_properties_set_int( properties, "height", first->height );
+    mlt_properties_set_double( properties, "aspect_ratio", 1.0 );
+    // In frames of the profile
+    auto count = resource.last - resource.first + 1;
+    auto length = std::max( 1, static_cast<int>( std::ceil( count * mlt_profile_fps( profile ) / resource.fps - 1e-6 ) ) );
+    mlt_properties_set_position( properties, "length", length );
+    mlt_properties_set_position( properties, "out", length - 1 );
+    mlt_properties_set_data( properties, "_reader", new std::shared_ptr<Reader>( reader ), 0, deleteReader, nullptr );
+    producer->get_frame = producerGetFrame;
+    producer->close = reinterpret_cast<mlt_destructor>( &ImageProducer::close );
+    return producer;
+}
+
+}
+
+void
+ImageSequenceProducer::registerService( Mlt::Repository& repository )
+{
+    repository.register_service( producer_type, ServiceName, createProducer );
+}
+
+bool
+ImageSequenceProducer::isSequence( const char* resource )
+{
+    Resource r;
+    return resource != nullptr && parse( resource, r ) == true;
+}
@@ -0,0 +1,60 @@
+/*****************************************************************************
+ * MLTImageSequence.h: Plays numbered images as a video
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef MLTIMAGESEQUENCE_H
+#define MLTIMAGESEQUENCE_H
+
+namespace Mlt
+{
+class Repository;
+}
+
+namespace Backend
+{
+namespace MLT
+{
+    /**
+     *  The "vlmc_sequence" producer, which plays a numbered series of images.
+     *
+     *  Its resource is a pattern followed by the range of images and their frame rate,
+     *  ie. "/renders/shot_%04d.png?first=1&last=250&fps=24&readahead=8". Only a single
+     *  "%d" or "%0Nd" is expanded, and "%%" stands for "%".
+     *
+     *  The images are read through memory mappings, and decoded by a pool of worker
+     *  threads shared by all the sequences. Each producer keeps decoding the next
+     *  "readahead" images in the direction it's played, so that playback doesn't wait
+     *  for the decoder. A missing image shows the last one found before it.
+     */
+    class ImageSequenceProducer
+    {
+    public:
+        static const char* const    ServiceName;
+        // How far back a missing image gets replaced by the last one found
+        static const int            MaxGap;
+
+        static void     registerService( Mlt::Repository& repository );
+        static bool     isSequence( const char* resource );
+    };
+}
+}
+
+#endif // MLTIMAGESEQUENCE_H
@@ -28,15 +28,68 @@
 #include "MLTProfile.h"
 #include "MLTBackend.h"
 #include "MLTFilter.h"
+#include "MLTStillImage.h"
+#include "MLTImageSequence.h"
+#include "MLTFrameBuffer.h"
+#include "Backend/FrameIndex.h"
 
+#include <mlt++/MltConsumer.h>
 #include <mlt++/MltFrame.h>
 #include <mlt++/MltFilter.h>
 #include <mlt++/MltProducer.h>
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <cassert>
+#include <vector>
 
 using namespace Backend::MLT;
 
+namespace
+{
+
+// Lists the services an input is made of, each one before the services it reads
+// from, which is the order the rendering threads lock them in
+void
+graph( mlt_service service, std::vector<mlt_service>& services )
+{
+    if ( service == nullptr || std::find( services.begin(), services.end(), service ) != services.end() )
+        return;
+    services.push_back( service );
+    for ( auto i = 0; mlt_service_filter( service, i ) != nullptr; ++i )
+        graph( MLT_FILTER_SERVICE( mlt_service_filter( service, i ) ), services );
+    switch ( mlt_service_identify( service ) )
+    {
+        case playlist_type:
+        {
+            auto playlist = reinterpret_cast<mlt_playlist>( service );
+            for ( auto i = 0; i < mlt_playlist_count( playlist ); ++i )
+                graph( MLT_PRODUCER_SERVICE( mlt_playlist_get_clip( playlist, i ) ), services );
+            break;
+        }
+        case multitrack_type:
+        {
+            auto multitrack = reinterpret_cast<mlt_multitrack>( service );
+            for ( auto i = 0; i < mlt_multitrack_count( multitrack ); ++i )
+                graph( MLT_PRODUCER_SERVICE( mlt_multitrack_track( multitrack, i ) ), services );
+            break;
+        }
+        case producer_type:
+        {
+            auto producer = reinterpret_cast<mlt_producer>( service );
+            if ( mlt_producer_is_cut( producer ) != 0 )
+                graph( MLT_PRODUCER_SERVICE( mlt_producer_cut_parent( producer ) ), services );
+            break;
+        }
+        default:
+            break;
+    }
+    // Tractors, fields, and transitions read from the service connected to them
+    graph( mlt_service_producer( service ), services );
+}
+
+}
+
 MLTInput::MLTInput()
     : m_producer( nullptr )
     , m_callback( nullptr )
@@ -75,18 +128,29 @@ MLTInput::MLTInput( Mlt::Producer* producer, IInputEventCb* callback )
     calcTracks();
     if ( isValid() == false )
         throw InvalidServiceException();
+    if ( StillImageCache::isStillProducer( *m_producer ) == true )
+        StillImageCache::attachMemo( *m_producer );
 }
 
 MLTInput::MLTInput( IProfile& profile, const char* path, IInputEventCb* callback )
     : MLTInput()
 {
-    std::string temp = std::string( "avformat:" ) + path;
+    // Still images are decoded once, instead of once per frame, and image sequences
+    // are decoded ahead of the playback
+    const char* service = "avformat";
+    if ( ImageSequenceProducer::isSequence( path ) == true )
+        service = ImageSequenceProducer::ServiceName;
+    else if ( StillImageCache::isStillImage( path ) == true )
+        service = StillImageCache::ProducerService;
+    std::string temp = std::string( service ) + ":" + path;
     MLTProfile& mltProfile = static_cast<MLTProfile&>( profile );
     m_producer = new Mlt::Producer( *mltProfile.m_profile, "loader", temp.c_str() );
     setCallback( callback );
     calcTracks();
     if ( isValid() == false )
         throw InvalidServiceException();
+    if ( StillImageCache::isStillProducer( *m_producer ) == true )
+        StillImageCache::attachMemo( *m_producer );
 }
 
 MLTInput::MLTInput( const char* path, IInputEventCb* callback )
@@ -202,6 +266,78 @@ MLTInput::isCut() const
     return producer()->is_cut();
 }
 
+std::unique_ptr<IInput>
+MLTInput::reader( bool withFilters ) const
+{
+    auto& profile = *static_cast<MLTProfile&>( Backend::instance()->profile() ).m_profile;
+    auto& source = producer()->is_cut() == true ? producer()->parent() : *producer();
+    const char* service = source.get( "mlt_service" );
+    // A plain media file is simply opened again
+    if ( withFilters == false && service != nullptr && ( strncmp( service, "avformat", 8 ) == 0 ||
+                                                         strcmp( service, StillImageCache::ProducerService ) == 0 ||
+                                                         strcmp( service, ImageSequenceProducer::ServiceName ) == 0 ) )
+    {
+        auto p = new Mlt::Producer( profile, service, source.get( "resource" ) );
+        if ( p->is_valid() == false )
+        {
+            delete p;
+            throw InvalidServiceException();
+        }
+        p->set_in_and_out( begin(), end() );
+        return std::unique_ptr<IInput>( new MLTInput( p ) );
+    }
+
+    // Anything else is copied through its XML description, which includes its
+    // boundaries, filters, tracks and transitions.
+    auto copy = deserialize( serialize() );
+    if ( withFilters == false )
+    {
+        auto p = copy->producer();
+        while ( p->filter_count() > 0 )
+        {
+            std::unique_ptr<Mlt::Filter> f( p->filter( 0 ) );
+            p->detach( *f );
+        }
+    }
+    return std::move( copy );
+}
+
+std::string
+MLTInput::serialize() const
+{
+    auto& profile = *static_cast<MLTProfile&>( Backend::instance()->profile() ).m_profile;
+    Mlt::Consumer   consumer( profile, "xml", "string" );
+    consumer.set( "no_meta", 1 );
+    consumer.set( "store", "vlmc" );
+    // The playback keeps rendering meanwhile: locking the input alone would leave its
+    // tracks, clips, and filters to be modified while they are written
+    std::vector<mlt_service>    services;
+    graph( producer()->get_service(), services );
+    for ( auto s : services )
+        mlt_service_lock( s );
+    consumer.connect( *producer() );
+    consumer.start();
+    for ( auto it = services.rbegin(); it != services.rend(); ++it )
+        mlt_service_unlock( *it );
+    const char* xml = consumer.get( "string" );
+    if ( xml == nullptr )
+        throw InvalidServiceException();
+    return xml;
+}
+
+std::unique_ptr<MLTInput>
+MLTInput::deserialize( const std::string& description )
+{
+    auto& profile = *static_cast<MLTProfile&>( Backend::instance()->profile() ).m_profile;
+    auto p = new Mlt::Producer( profile, "xml-string", description.c_str() );
+    if ( p->is_valid() == false )
+    {
+        delete p;
+        throw InvalidServiceException();
+    }
+    return std::unique_ptr<MLTInput>( new MLTInput( p ) );
+}
+
 bool
 MLTInput::sameClip( Backend::IInput& that ) const
 {
@@ -247,9 +383,82 @@ MLTInput::position() const
 void
 MLTInput::setPosition( int64_t position )
 {
+    // Several positions may show the same frame of variable frame rate footage. Seeking
+    // to the first one lands on the frame's own timestamp, rather than between two
+    // timestamps, which the decoder may round to the next frame.
+    auto index = frameIndex();
+    if ( index != nullptr && index->isVariableFrameRate() == true )
+    {
+        auto frame = index->frameAt( ( begin() + position ) / fps() );
+        position = std::max<int64_t>( 0, std::min( framePosition( *index, frame ), position ) );
+    }
     producer()->seek( position );
 }
 
+int64_t
+MLTInput::keyframe( int64_t position ) const
+{
+    auto index = frameIndex();
+    if ( index == nullptr )
+        return position;
+    auto frame = index->frameAt( ( begin() + position ) / fps() );
+    auto keyframe = framePosition( *index, index->keyframe( frame ) );
+    return std::max<int64_t>( 0, std::min( keyframe, position ) );
+}
+
+std::shared_ptr<const FrameIndex>
+MLTInput::frameIndex() const
+{
+    auto& source = producer()->is_cut() == true ? producer()->parent() : *producer();
+    const char* resource = source.get( "resource" );
+    if ( resource == nullptr )
+        return nullptr;
+    auto index = FrameIndex::find( resource );
+    if ( index == nullptr || index->frameCount() == 0 )
+        return nullptr;
+    return index;
+}
+
+int64_t
+MLTInput::framePosition( const FrameIndex& index, size_t frame ) const
+{
+    // Positions follow the frame rate of the profile and are relative to the in point,
+    // whatever the timestamps of the source. This is the first one showing the frame.
+    return static_cast<int64_t>( std::ceil( index.time( frame ) * fps() - 1e-6 ) ) - begin();
+}
+
+void
+MLTInput::warmCache( int64_t nbFrames )
+{
+    // The frames are pulled as the playback would, so that the data it needs at the
+    // in point gets read.
+    auto& profile = *static_cast<MLTProfile&>( Backend::instance()->profile() ).m_profile;
+    auto count = std::min( nbFrames, playableLength() );
+    for ( int64_t i = 0; i < count; ++i )
+    {
+        producer()->seek( static_cast<int>( i ) );
+        std::unique_ptr<Mlt::Frame> frame( producer()->get_frame() );
+        if ( frame == nullptr || frame->is_valid() == false )
+            break;
+        if ( hasVideo() == true )
+        {
+            mlt_image_format format = mlt_image_yuv422;
+            auto width = profile.width();
+            auto height = profile.height();
+            frame->get_image( format, width, height );
+        }
+        if ( hasAudio() == true )
+        {
+            mlt_audio_format format = mlt_audio_s16;
+            auto frequency = 48000;
+            auto channels = 2;
+            auto samples = mlt_sample_calculator( static_cast<float>( fps() ), frequency, i );
+            frame->get_audio( format, frequency, channels, samples );
+        }
+    }
+    producer()->seek( 0 );
+}
+
 int64_t
 MLTInput::frame() const
 {
@@ -387,8 +596,12 @@ MLTInput::attach( Backend::IFilter& filter )
 {
     MLTFilter* mltFilter = dynamic_cast<MLTFilter*>( &filter );
     assert( mltFilter );
+    auto internal = internalFilterIndex();
     auto ret = producer()->attach( *mltFilter->filter() );
     mltFilter->connect( *this );
+    // The memo of still images & the prefetch buffer have to see the output of every effect
+    if ( ret == 0 && internal >= 0 )
+        producer()->move_filter( internal, producer()->filter_count() - 1 );
     return !ret;
 }
 
@@ -412,7 +625,18 @@ MLTInput::detach( int index )
 int
 MLTInput::filterCount() const
 {
-    return producer()->filter_count();
+    // The internal filter is an implementation detail, and always comes last
+    return producer()->filter_count() - ( internalFilterIndex() >= 0 ? 1 : 0 );
+}
+
+int
+MLTInput::internalFilterIndex() const
+{
+    auto count = producer()->filter_count();
+    if ( count == 0 )
+        return -1;
+    std::unique_ptr<Mlt::Filter> last( producer()->filter( count - 1 ) );
+    return StillImageCache::isMemo( *last ) == true || FrameBuffer::isFilter( *last ) == true ? count - 1 : -1;
 }
 
 bool
@@ -34,6 +34,8 @@ class Producer;
 
 namespace Backend
 {
+class FrameIndex;
+
 namespace MLT
 {
 
@@ -65,6 +67,13 @@ class MLTInput : virtual public IInput, public MLTService
 
         virtual std::unique_ptr<IInput>      cut( int64_t begin = 0, int64_t end = EndOfMedia ) override;
         virtual bool            isCut() const override;
+        virtual std::unique_ptr<IInput>      reader( bool withFilters = false ) const override;
+        virtual std::string     serialize() const override;
+        /**
+         *  Opens a copy of an input from its serialize() description. This opens every
+         *  media it reads from, and can be called from any thread.
+         */
+        static std::unique_ptr<MLTInput>    deserialize( const std::string& description );
 
         virtual bool            sameClip( IInput& that ) const override;
         virtual bool            runsInto( IInput& that ) const override;
@@ -79,6 +88,8 @@ class MLTInput : virtual public IInput, public MLTService
         // The position in frame relative to its beginning
         virtual int64_t         position() const override;
         virtual void            setPosition( int64_t position ) override;
+        virtual int64_t         keyframe( int64_t position ) const override;
+        virtual void            warmCache( int64_t nbFrames ) override;
 
         // The absolete position in frame
         virtual int64_t         frame() const override;
@@ -116,6 +127,12 @@ class MLTInput : virtual public IInput, public MLTService
         MLTInput();
 
         void                    calcTracks();
+        // The index of the filter VLMC keeps at the end of the chain, ie. the memo of a
+        // still image or the prefetch buffer of the preview, or -1
+        int                     internalFilterIndex() const;
+        // The index of the file this input reads, once published, see FrameIndex::publish()
+        std::shared_ptr<const FrameIndex>   frameIndex() const;
+        int64_t                 framePosition( const FrameIndex& index, size_t frame ) const;
 
     private:
         Mlt::Producer*          m_producer;
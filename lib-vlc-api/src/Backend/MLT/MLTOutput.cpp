@@ -34,6 +34,7 @@
 #include <mlt++/MltProfile.h>
 
 #include <cassert>
+#include <cstring>
 
 using namespace Backend::MLT;
 
@@ -99,6 +100,14 @@ MLTOutput::onOutputStopped( void*, MLTOutput* self )
     self->m_callback->onStopped();
 }
 
+void
+MLTOutput::onOutputError( void*, MLTOutput* self )
+{
+    if ( self->m_callback == nullptr )
+        return;
+    self->m_callback->onErrorEncountered();
+}
+
 void
 MLTOutput::setName( const char* name )
 {
@@ -113,6 +122,7 @@ MLTOutput::setCallback(Backend::IOutputEventCb *callback)
     m_callback = callback;
     consumer()->listen( "consumer-thread-started", this, (mlt_listener)MLTOutput::onOutputStarted );
     consumer()->listen( "consumer-stopped", this, (mlt_listener)MLTOutput::onOutputStopped );
+    consumer()->listen( "consumer-fatal-error", this, (mlt_listener)MLTOutput::onOutputError );
 }
 
 void
@@ -223,3 +233,64 @@ MLTFFmpegOutput::setAudioSampleRate( int rate )
 {
     consumer()->set( "frequency", rate );
 }
+
+void
+MLTFFmpegOutput::setVideoCodec( const char* codec )
+{
+    consumer()->set( "vcodec", codec );
+}
+
+void
+MLTFFmpegOutput::setAudioCodec( const char* codec )
+{
+    consumer()->set( "acodec", codec );
+}
+
+void
+MLTFFmpegOutput::setFormat( const char* format )
+{
+    consumer()->set( "f", format );
+}
+
+void
+MLTFFmpegOutput::setOption( const char* name, const char* value )
+{
+    // Unknown properties are forwarded to libavformat & libavcodec as AVOptions
+    consumer()->set( name, value );
+}
+
+MLTMultiOutput::MLTMultiOutput()
+    : MLTOutput( Backend::instance()->profile(), "multi" )
+    , m_renditionCount( 0 )
+{
+    consumer()->set( "terminate_on_pause", 1 );
+}
+
+int
+MLTMultiOutput::addRendition( const MLTFFmpegOutput& rendition )
+{
+    // The multi consumer instanciates its nested consumers upon start, from
+    // the "N" property holding the service name and the "N.*" properties.
+    const auto  index = m_renditionCount++;
+    const auto  prefix = std::to_string( index );
+    auto        properties = rendition.consumer();
+
+    consumer()->set( prefix.c_str(), "avformat" );
+    for ( int i = 0; i < properties->count(); ++i )
+    {
+        const char* name = properties->get_name( i );
+        const char* value = properties->get( i );
+        // Skip data properties & the service description
+        if ( name == nullptr || value == nullptr || name[0] == '_' ||
+             strncmp( name, "mlt_", 4 ) == 0 )
+            continue;
+        consumer()->set( ( prefix + '.' + name ).c_str(), value );
+    }
+    return index;
+}
+
+int
+MLTMultiOutput::renditionCount() const
+{
+    return m_renditionCount;
+}
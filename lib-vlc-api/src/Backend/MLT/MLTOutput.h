@@ -56,6 +56,8 @@ class MLTOutput : public IOutput, public MLTService
 
         static void     onOutputStarted( void* owner, MLTOutput* self );
         static void     onOutputStopped( void* owner, MLTOutput* self );
+        // ie. the encoder or the muxer failed, the output stops right after
+        static void     onOutputError( void* owner, MLTOutput* self );
 
         virtual void    setName( const char* name ) override;
         virtual void    setCallback( IOutputEventCb* callback ) override;
@@ -101,7 +103,39 @@ class MLTFFmpegOutput : public MLTOutput
         void    setAudioBitrate( int kbps );
         void    setChannels( int channels );
         void    setAudioSampleRate( int rate );
+        void    setVideoCodec( const char* codec );
+        void    setAudioCodec( const char* codec );
+        /**
+         * @brief setFormat Forces the muxer instead of guessing it from the target
+         */
+        void    setFormat( const char* format );
+        /**
+         * @brief setOption Passes an option as is to the muxer or the encoders
+         */
+        void    setOption( const char* name, const char* value );
+};
+
+/**
+ * @brief The MLTMultiOutput class feeds several avformat encoders from a single
+ *        producer, so that the timeline is decoded and composited only once
+ *        per frame. Each rendition scales the composite to its own size.
+ */
+class MLTMultiOutput : public MLTOutput
+{
+    public:
+        MLTMultiOutput();
+
+        /**
+         * @brief addRendition  Registers a new encoder sink.
+         * @param rendition     An avformat output holding the rendition settings.
+         *                      Its properties are copied, it is never started.
+         * @return The index of the rendition
+         */
+        int     addRendition( const MLTFFmpegOutput& rendition );
+        int     renditionCount() const;
 
+    private:
+        int     m_renditionCount;
 };
 
 }
@@ -0,0 +1,511 @@
+/*****************************************************************************
+ * MLTStillImage.cpp: Decode once & memory cache for still image clips
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "MLTStillImage.h"
+
+#include <mlt++/MltFilter.h>
+#include <mlt++/MltProducer.h>
+#include <mlt++/MltRepository.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <iterator>
+#include <sstream>
+
+#include <sys/stat.h>
+
+using namespace Backend::MLT;
+
+const char* const StillImageCache::ProducerService = "vlmc_still";
+const char* const StillImageCache::MemoService = "vlmc_still_memo";
+
+namespace
+{
+
+typedef StillImageCache::Image  Image;
+
+// About sixty 1080p images
+const size_t DefaultBudget = 512 * 1024 * 1024;
+
+// The filters whose output only depends on their input image and their parameters.
+// Any other filter may change from a frame to another, ie. film grain or a timecode.
+const char* const StaticFilters[] = {
+    "affine", "box_blur", "brightness", "charcoal", "chroma", "chroma_hold", "crop", "gamma",
+    "greyscale", "invert", "mirror", "obscure", "resize", "rescale", "sepia", "threshold",
+    "avfilter.hflip", "avfilter.negate", "avfilter.vflip",
+    "frei0r.brightness", "frei0r.colorize", "frei0r.contrast0r", "frei0r.curves", "frei0r.edgeglow",
+    "frei0r.emboss", "frei0r.flippo", "frei0r.glow", "frei0r.hueshift0r", "frei0r.IIRblur",
+    "frei0r.levels", "frei0r.pixeliz0r", "frei0r.saturat0r", "frei0r.sharpness", "frei0r.sobel",
+    "frei0r.squareblur", "frei0r.threelay0r", "frei0r.tint0r", "frei0r.twolay0r", "frei0r.vignette",
+};
+
+struct ProducerCloser
+{
+    void operator()( mlt_producer producer ) const { mlt_producer_close( producer ); }
+};
+
+struct FrameCloser
+{
+    void operator()( mlt_frame frame ) const { mlt_frame_close( frame ); }
+};
+
+std::shared_ptr<const Image>
+decode( mlt_profile profile, const char* path )
+{
+    std::unique_ptr<mlt_producer_s, ProducerCloser> producer( mlt_factory_producer( profile, "avformat", path ) );
+    if ( producer == nullptr )
+        return nullptr;
+    auto properties = MLT_PRODUCER_PROPERTIES( producer.get() );
+    int width = mlt_properties_get_int( properties, "meta.media.width" );
+    int height = mlt_properties_get_int( properties, "meta.media.height" );
+    mlt_frame f = nullptr;
+    if ( width <= 0 || height <= 0 ||
+         mlt_service_get_frame( MLT_PRODUCER_SERVICE( producer.get() ), &f, 0 ) != 0 || f == nullptr )
+        return nullptr;
+    std::unique_ptr<mlt_frame_s, FrameCloser> frame( f );
+    // Requesting the native size, so that avformat doesn't scale it
+    mlt_image_format format = mlt_image_rgb24a;
+    uint8_t* data = nullptr;
+    if ( mlt_frame_get_image( frame.get(), &data, &format, &width, &height, 0 ) != 0 ||
+         data == nullptr || format != mlt_image_rgb24a )
+        return nullptr;
+    std::shared_ptr<Image> image( new Image );
+    image->width = width;
+    image->height = height;
+    image->format = mlt_image_rgb24a;
+    image->aspectRatio = 1.0;
+    image->pixels.assign( data, data + static_cast<size_t>( width ) * height * 4 );
+    return image;
+}
+
+// Averages the source pixels each destination pixel covers, or repeats them when upscaling
+std::shared_ptr<const Image>
+scale( const Image& source, int width, int height )
+{
+    std::shared_ptr<Image> image( new Image );
+    image->width = width;
+    image->height = height;
+    image->format = mlt_image_rgb24a;
+    image->aspectRatio = source.aspectRatio;
+    image->pixels.resize( static_cast<size_t>( width ) * height * 4 );
+    std::vector<int> columns( width + 1 );
+    for ( int x = 0; x <= width; ++x )
+        columns[x] = static_cast<int>( static_cast<int64_t>( x ) * source.width / width );
+    auto out = image->pixels.data();
+    for ( int y = 0; y < height; ++y )
+    {
+        int y0 = static_cast<int>( static_cast<int64_t>( y ) * source.height / height );
+        int y1 = std::max( y0 + 1, static_cast<int>( static_cast<int64_t>( y + 1 ) * source.height / height ) );
+        for ( int x = 0; x < width; ++x )
+        {
+            int x0 = columns[x];
+            int x1 = std::max( x0 + 1, columns[x + 1] );
+            uint64_t sum[4] = { 0, 0, 0, 0 };
+            for ( int sy = y0; sy < y1; ++sy )
+            {
+                auto in = &source.pixels[( static_cast<size_t>( sy ) * source.width + x0 ) * 4];
+                for ( int sx = x0; sx < x1; ++sx, in += 4 )
+                {
+                    for ( int c = 0; c < 4; ++c )
+                        sum[c] += in[c];
+                }
+            }
+            uint64_t count = static_cast<uint64_t>( y1 - y0 ) * ( x1 - x0 );
+            for ( int c = 0; c < 4; ++c )
+                *out++ = static_cast<uint8_t>( ( sum[c] + count / 2 ) / count );
+        }
+    }
+    return image;
+}
+
+// A size of 0 returns the image at its native size
+std::shared_ptr<const Image>
+scaledImage( mlt_profile profile, const char* path, int width, int height )
+{
+    auto& cache = StillImageCache::instance();
+    // An image edited in place gets new keys, its stale entries are simply never read again
+    struct stat info;
+    if ( stat( path, &info ) != 0 )
+        return nullptr;
+    std::ostringstream file;
+    file << path << '|' << info.st_size << '|' << info.st_mtime;
+    std::ostringstream key;
+    key << "scaled|" << file.str() << '|' << width << 'x' << height;
+    auto image = cache.find( key.str() );
+    if ( image != nullptr )
+        return image;
+    auto sourceKey = "source|" + file.str();
+    auto source = cache.find( sourceKey );
+    if ( source == nullptr )
+    {
+        source = decode( profile, path );
+        if ( source == nullptr )
+            return nullptr;
+        cache.insert( sourceKey, source );
+    }
+    if ( width <= 0 || height <= 0 || ( width == source->width && height == source->height ) )
+        return source;
+    image = scale( *source, width, height );
+    cache.insert( key.str(), image );
+    return image;
+}
+
+/*
+ * The producer
+ */
+
+int
+producerGetImage( mlt_frame frame, uint8_t** buffer, mlt_image_format* format, int* width, int* height, int )
+{
+    auto producer = static_cast<mlt_producer>( mlt_frame_pop_service( frame ) );
+    auto path = mlt_properties_get( MLT_PRODUCER_PROPERTIES( producer ), "resource" );
+    if ( path == nullptr )
+        return 1;
+    auto image = scaledImage( mlt_service_profile( MLT_PRODUCER_SERVICE( producer ) ), path, *width, *height );
+    if ( image == nullptr )
+        return 1;
+    return image->serve( frame, buffer, format, width, height );
+}
+
+int
+producerGetFrame( mlt_producer producer, mlt_frame_ptr frame, int )
+{
+    return ImageProducer::getFrame( producer, frame, producerGetImage );
+}
+
+void*
+createProducer( mlt_profile profile, mlt_service_type, const char*, const void* arg )
+{
+    auto path = static_cast<const char*>( arg );
+    if ( path == nullptr )
+        return nullptr;
+    // Decoding the image checks the file, and it's about to be shown anyway
+    auto source = scaledImage( profile, path, 0, 0 );
+    if ( source == nullptr )
+        return nullptr;
+    auto producer = mlt_producer_new( profile );
+    if ( producer == nullptr )
+        return nullptr;
+    auto properties = MLT_PRODUCER_PROPERTIES( producer );
+    mlt_properties_set( properties, "resource", path );
+    mlt_properties_set_int( properties, "seekable", 1 );
+    mlt_properties_set_int( properties, "meta.media.nb_streams", 1 );
+    mlt_properties_set( properties, "meta.media.0.stream.type", "video" );
+    mlt_properties_set_int( properties, "meta.media.width", source->width );
+    mlt_properties_set_int( properties, "meta.media.height", source->height );
+    mlt_properties_set_int( properties, "meta.media.sample_aspect_num", 1 );
+    mlt_properties_set_int( properties, "meta.media.sample_aspect_den", 1 );
+    mlt_properties_set_int( properties, "meta.media.progressive", 1 );
+    mlt_properties_set_int( properties, "width", source->width );
+    mlt_properties_set_int( properties, "height", source->height );
+    mlt_properties_set_double( properties, "aspect_ratio", 1.0 );
+    producer->get_frame = producerGetFrame;
+    producer->close = reinterpret_cast<mlt_destructor>( &ImageProducer::close );
+    return producer;
+}
+
+/*
+ * The memo filter
+ */
+
+bool
+isTimeDependent( mlt_filter filter, mlt_producer producer )
+{
+    auto properties = MLT_FILTER_PROPERTIES( filter );
+    auto service = mlt_properties_get( properties, "mlt_service" );
+    if ( service == nullptr )
+        return true;
+    auto isStatic = std::any_of( std::begin( StaticFilters ), std::end( StaticFilters ), [service]( const char* name ) {
+        return strcmp( service, name ) == 0;
+    } );
+    if ( isStatic == false )
+        return true;
+    // Starts or stops within the clip
+    auto out = mlt_filter_get_out( filter );
+    if ( mlt_filter_get_in( filter ) > 0 || ( out > 0 && out < mlt_producer_get_playtime( producer ) - 1 ) )
+        return true;
+    // Keyframed parameters, ie. "0=0;50=1"
+    for ( int i = 0; i < mlt_properties_count( properties ); ++i )
+    {
+        auto value = mlt_properties_get_value( properties, i );
+        if ( value != nullptr && strchr( value, '=' ) != nullptr && strchr( value, ';' ) != nullptr )
+            return true;
+    }
+    return false;
+}
+
+/*
+ * Describes what the memo's output depends on: the image and the parameters of the effects
+ * applied before it. Returns an empty string if the output changes from a frame to another,
+ * or if there's nothing to memoize.
+ */
+std::string
+memoSource( mlt_filter memo )
+{
+    auto producer = static_cast<mlt_producer>(
+                mlt_properties_get_data( MLT_FILTER_PROPERTIES( memo ), "_vlmc_producer", nullptr ) );
+    if ( producer == nullptr )
+        return std::string();
+    auto parent = mlt_producer_cut_parent( producer );
+    auto path = mlt_properties_get( MLT_PRODUCER_PROPERTIES( parent ), "resource" );
+    if ( path == nullptr )
+        return std::string();
+    std::ostringstream source;
+    source << path;
+    int effects = 0;
+    // The filters of the source producer run before the ones of its cuts
+    mlt_producer producers[] = { parent, producer };
+    for ( int p = parent == producer ? 1 : 0; p < 2; ++p )
+    {
+        mlt_filter filter;
+        for ( int i = 0; ( filter = mlt_service_filter( MLT_PRODUCER_SERVICE( producers[p] ), i ) ) != nullptr; ++i )
+        {
+            if ( filter == memo )
+                break;
+            auto properties = MLT_FILTER_PROPERTIES( filter );
+            auto service = mlt_properties_get( properties, "mlt_service" );
+            // The loader's normalizers only depend on the requested size & format
+            if ( ( service != nullptr && strcmp( service, StillImageCache::MemoService ) == 0 ) ||
+                 mlt_properties_get_int( properties, "_loader" ) != 0 )
+                continue;
+            if ( isTimeDependent( filter, producer ) == true )
+                return std::string();
+            ++effects;
+            source << '|';
+            for ( int j = 0; j < mlt_properties_count( properties ); ++j )
+            {
+                auto name = mlt_properties_get_name( properties, j );
+                auto value = mlt_properties_get_value( properties, j );
+                if ( name != nullptr && name[0] != '_' && value != nullptr )
+                    source << name << '=' << value << ';';
+            }
+        }
+    }
+    if ( effects == 0 )
+        return std::string();
+    return source.str();
+}
+
+// The frame property through which a memo passes its source to its get_image
+std::string
+memoProperty( mlt_filter memo )
+{
+    std::ostringstream name;
+    name << "_vlmc_memo." << static_cast<const void*>( memo );
+    return name.str();
+}
+
+int
+memoGetImage( mlt_frame frame, uint8_t** buffer, mlt_image_format* format, int* width, int* height, int writable )
+{
+    auto memo = static_cast<mlt_filter>( mlt_frame_pop_service( frame ) );
+    auto properties = MLT_FRAME_PROPERTIES( frame );
+    auto value = mlt_properties_get( properties, memoProperty( memo ).c_str() );
+    if ( value == nullptr )
+        return mlt_frame_get_image( frame, buffer, format, width, height, writable );
+    std::string source( value );
+    // A single image per memo & size: an effect being tweaked doesn't fill the cache
+    std::ostringstream key;
+    key << "memo|" << static_cast<const void*>( memo ) << '|' << *width << 'x' << *height << '|' << *format;
+    auto& cache = StillImageCache::instance();
+    auto image = cache.find( key.str() );
+    if ( image != nullptr && image->source == source )
+        return image->serve( frame, buffer, format, width, height );
+
+    auto res = mlt_frame_get_image( frame, buffer, format, width, height, writable );
+    if ( res != 0 || *buffer == nullptr )
+        return res;
+    std::shared_ptr<Image> copy( new Image );
+    if ( copy->copy( frame, *buffer, *format, *width, *height ) == false )
+        return res;
+    copy->source = source;
+    cache.insert( key.str(), copy );
+    return res;
+}
+
+mlt_frame
+memoProcess( mlt_filter memo, mlt_frame frame )
+{
+    auto source = memoSource( memo );
+    if ( source.empty() == true )
+        return frame;
+    mlt_properties_set( MLT_FRAME_PROPERTIES( frame ), memoProperty( memo ).c_str(), source.c_str() );
+    mlt_frame_push_service( frame, memo );
+    mlt_frame_push_get_image( frame, memoGetImage );
+    return frame;
+}
+
+void*
+createMemo( mlt_profile, mlt_service_type, const char*, const void* )
+{
+    auto memo = mlt_filter_new();
+    if ( memo != nullptr )
+        memo->process = memoProcess;
+    return memo;
+}
+
+}
+
+size_t
+StillImageCache::Image::size() const
+{
+    return FrameImage::size() + sizeof( source ) + source.size();
+}
+
+StillImageCache::StillImageCache()
+    : m_size( 0 )
+    , m_budget( DefaultBudget )
+{
+}
+
+StillImageCache&
+StillImageCache::instance()
+{
+    static StillImageCache cache;
+    return cache;
+}
+
+std::shared_ptr<const StillImageCache::Image>
+StillImageCache::find( const std::string& key )
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+    auto it = m_index.find( key );
+    if ( it == m_index.end() )
+        return nullptr;
+    m_entries.splice( m_entries.begin(), m_entries, it->second );
+    return it->second->second;
+}
+
+void
+StillImageCache::insert( const std::string& key, std::shared_ptr<const Image> image )
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+    auto it = m_index.find( key );
+    if ( it != m_index.end() )
+    {
+        m_size -= it->second->second->size();
+        m_entries.erase( it->second );
+        m_index.erase( it );
+    }
+    m_size += image->size();
+    m_entries.emplace_front( key, std::move( image ) );
+    m_index[key] = m_entries.begin();
+    // The frames being rendered hold their own copy, evicting is always safe
+    while ( m_size > m_budget && m_entries.size() > 1 )
+    {
+        m_size -= m_entries.back().second->size();
+        m_index.erase( m_entries.back().first );
+        m_entries.pop_back();
+    }
+}
+
+void
+StillImageCache::setBudget( size_t budget )
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+    m_budget = budget;
+    while ( m_size > m_budget && m_entries.empty() == false )
+    {
+        m_size -= m_entries.back().second->size();
+        m_index.erase( m_entries.back().first );
+        m_entries.pop_back();
+    }
+}
+
+size_t
+StillImageCache::size() const
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+    return m_size;
+}
+
+void
+StillImageCache::clear()
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+    m_entries.clear();
+    m_index.clear();
+    m_size = 0;
+}
+
+void
+StillImageCache::registerServices( Mlt::Repository& repository )
+{
+    repository.register_service( producer_type, ProducerService, createProducer );
+    repository.register_service( filter_type, MemoService, createMemo );
+}
+
+bool
+StillImageCache::isStillImage( const char* path )
+{
+    auto extension = strrchr( path, '.' );
+    if ( extension == nullptr )
+        return false;
+    std::string e( extension + 1 );
+    std::transform( e.begin(), e.end(), e.begin(), []( char c ) {
+        return static_cast<char>( std::tolower( static_cast<unsigned char>( c ) ) );
+    } );
+    return e == "png" || e == "jpg" || e == "jpeg";
+}
+
+bool
+StillImageCache::isStillProducer( Mlt::Producer& producer )
+{
+    auto& source = producer.is_cut() == true ? producer.parent() : producer;
+    auto service = source.get( "mlt_service" );
+    return service != nullptr && strcmp( service, ProducerService ) == 0;
+}
+
+bool
+StillImageCache::isMemo( Mlt::Filter& filter )
+{
+    auto service = filter.get( "mlt_service" );
+    return service != nullptr && strcmp( service, MemoService ) == 0;
+}
+
+void
+StillImageCache::attachMemo( Mlt::Producer& producer )
+{
+    // XML copies come with their memo, which doesn't know about its new producer
+    for ( int i = 0; i < producer.filter_count(); ++i )
+    {
+        std::unique_ptr<Mlt::Filter> filter( producer.filter( i ) );
+        if ( isMemo( *filter ) == true )
+        {
+            filter->set( "_vlmc_producer", producer.get_producer(), 0 );
+            return;
+        }
+    }
+    auto memo = mlt_factory_filter( mlt_service_profile( producer.get_service() ), MemoService, nullptr );
+    if ( memo == nullptr )
+        return;
+    mlt_properties_set_data( MLT_FILTER_PROPERTIES( memo ), "_vlmc_producer", producer.get_producer(),
+                             0, nullptr, nullptr );
+    mlt_service_attach( producer.get_service(), memo );
+    // The producer holds a reference
+    mlt_filter_close( memo );
+}
@@ -0,0 +1,113 @@
+/*****************************************************************************
+ * MLTStillImage.h: Decode once & memory cache for still image clips
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef MLTSTILLIMAGE_H
+#define MLTSTILLIMAGE_H
+
+#include "MLTFrameImage.h"
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Mlt
+{
+class Filter;
+class Producer;
+class Repository;
+}
+
+namespace Backend
+{
+namespace MLT
+{
+    /**
+     *  Keeps the decoded still images (png, jpeg) in memory.
+     *
+     *  A still clip is otherwise decoded and scaled again for each of its frames.
+     *  The "vlmc_still" producer decodes each file once, and keeps a copy scaled to
+     *  every size it's requested at, ie. the project and the preview sizes.
+     *
+     *  Its frames all come from the same cached buffer. The "vlmc_still_memo" filter,
+     *  which ends the filter chain of still clips, also keeps the output of the clip's
+     *  effects as long as none of them is animated, so that they run only once.
+     *
+     *  The least recently used images are dropped once the cache is over budget.
+     */
+    class StillImageCache
+    {
+    public:
+        struct Image : public FrameImage
+        {
+            // What a memoized image was computed from, see the memo filter
+            std::string             source;
+
+            size_t                  size() const;
+        };
+
+        static const char* const    ProducerService;
+        static const char* const    MemoService;
+
+        static StillImageCache&     instance();
+
+        std::shared_ptr<const Image>    find( const std::string& key );
+        void                    insert( const std::string& key, std::shared_ptr<const Image> image );
+        // In bytes
+        void                    setBudget( size_t budget );
+        size_t                  size() const;
+        void                    clear();
+
+        /**
+         *  Registers the producer & the filter, so that the loader and XML copies
+         *  can create them.
+         */
+        static void             registerServices( Mlt::Repository& repository );
+        // true for the file types VLMC imports as still images, see Media::ImageExtensions
+        static bool             isStillImage( const char* path );
+        static bool             isStillProducer( Mlt::Producer& producer );
+        static bool             isMemo( Mlt::Filter& filter );
+        /**
+         *  Appends a memo filter to a still image producer, or a cut of it.
+         *  A memo which came along with an XML copy is bound to its new producer.
+         */
+        static void             attachMemo( Mlt::Producer& producer );
+
+    private:
+        StillImageCache();
+
+        typedef std::pair<std::string, std::shared_ptr<const Image>>    Entry;
+
+        mutable std::mutex      m_mutex;
+        // Most recently used first
+        std::list<Entry>        m_entries;
+        std::unordered_map<std::string, std::list<Entry>::iterator>     m_index;
+        size_t                  m_size;
+        size_t                  m_budget;
+    };
+}
+}
+
+#endif // MLTSTILLIMAGE_H
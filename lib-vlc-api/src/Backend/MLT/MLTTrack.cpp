@@ -152,6 +152,37 @@ MLTTrack::clear()
     playlist()->clear();
 }
 
+bool
+MLTTrack::setClips( const std::vector<std::pair<IInput*, int64_t>>& clips )
+{
+    // Check the whole layout first, a rejected one leaves the playlist as it was
+    int64_t next = 0;
+    for ( const auto& c : clips )
+    {
+        if ( c.second < next )
+            return false;
+        next = c.second + c.first->playableLength();
+    }
+
+    bool ret = true;
+    next = 0;
+    // Don't let a consumer see the playlist while it is being rebuilt
+    playlist()->lock();
+    playlist()->clear();
+    for ( const auto& c : clips )
+    {
+        auto mltInput = dynamic_cast<MLTInput*>( c.first );
+        assert( mltInput );
+        if ( c.second > next )
+            playlist()->blank( (int)( c.second - next - 1 ) );
+        if ( playlist()->append( *mltInput->producer() ) != 0 )
+            ret = false;
+        next = c.second + mltInput->playableLength();
+    }
+    playlist()->unlock();
+    return ret;
+}
+
 void
 MLTTrack::hide( Backend::HideType hydeType )
 {
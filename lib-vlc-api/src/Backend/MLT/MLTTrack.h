@@ -61,6 +61,7 @@ class MLTTrack : public ITrack, public MLTInput
         virtual int         clipIndexAt( int64_t position ) override;
         virtual int         count() const override;
         virtual void        clear() override;
+        virtual bool        setClips( const std::vector<std::pair<IInput*, int64_t>>& clips ) override;
         virtual void        hide( HideType hideType ) override;
 
     private:
@@ -26,16 +26,97 @@
 
 #include "AbstractUndoStack.h"
 #include "Commands.h"
+#include "Tools/VlmcDebug.h"
+#include "Workflow/SequenceWorkflow.h"
 
 using namespace Commands;
 
 AbstractUndoStack::AbstractUndoStack( QObject* parent )
     : QObject( parent )
-    , m_index( -1 )
+    , m_isClean( true )
+    , m_index( 0 )
+    , m_undoLimit( 0 )
+    , m_memoryLimit( 0 )
 {
 
 }
 
+AbstractUndoStack::~AbstractUndoStack()
+{
+    qDeleteAll( m_stack );
+}
+
+int
+AbstractUndoStack::count() const
+{
+    return m_stack.size();
+}
+
+int
+AbstractUndoStack::index() const
+{
+    return m_index;
+}
+
+QString
+AbstractUndoStack::text( int idx ) const
+{
+    if ( idx < 0 || idx >= m_stack.size() )
+        return QString();
+    return m_stack[idx]->text();
+}
+
+void
+AbstractUndoStack::setSequence( std::shared_ptr<SequenceWorkflow> sequence )
+{
+    // Previous states belong to another sequence, they can't be checkpointed anymore
+    clear();
+    m_sequence = std::move( sequence );
+}
+
+void
+AbstractUndoStack::setUndoLimit( int limit )
+{
+    m_undoLimit = limit;
+    compact();
+}
+
+int
+AbstractUndoStack::undoLimit() const
+{
+    return m_undoLimit;
+}
+
+void
+AbstractUndoStack::setMemoryLimit( qint64 bytes )
+{
+    m_memoryLimit = bytes;
+    compact();
+}
+
+qint64
+AbstractUndoStack::memoryLimit() const
+{
+    return m_memoryLimit;
+}
+
+qint64
+AbstractUndoStack::estimatedSize( int idx ) const
+{
+    if ( idx < 0 || idx >= m_stack.size() )
+        return 0;
+    return m_stack[idx]->estimatedSize();
+}
+
+qint64
+AbstractUndoStack::estimatedSize() const
+{
+    qint64 size = 0;
+    for ( const auto cmd : m_stack )
+        size += cmd->estimatedSize();
+    return size;
+}
+
 void
 AbstractUndoStack::redo()
 {
@@ -44,28 +125,43 @@ AbstractUndoStack::redo()
     m_stack[m_index]->redo();
     m_index++;
     _setClean( false );
+    emit indexChanged( m_index );
 }
 
 void
 AbstractUndoStack::undo()
 {
-    if ( m_index < 0 )
+    if ( m_index <= 0 )
         return;
-    m_stack[m_index]->undo();
     m_index--;
+    m_stack[m_index]->undo();
     _setClean( false );
+    emit indexChanged( m_index );
 }
 
 void
 AbstractUndoStack::push( Generic* command )
 {
-    if ( m_index == -1 )
-        m_index = 0;
-    while ( m_index < m_stack.size() )
-        m_stack.pop();
-    m_stack.push( command );
+    // The undone commands can't be reached anymore
+    removeCommands( m_index );
+    auto state = m_sequence != nullptr ? m_sequence->state() : SequenceState();
     command->redo();
+
+    // Merging into the clean command would prevent undoing back to the clean state
+    auto top = m_index > 0 ? m_stack[m_index - 1] : nullptr;
+    if ( top != nullptr && m_isClean == false && command->id() != -1 &&
+         top->id() == command->id() && top->isValid() == true && command->isValid() == true &&
+         top->mergeWith( command ) == true )
+        delete command;
+    else
+    {
+        m_stack.append( command );
+        m_states.append( state );
+        m_index++;
+    }
     _setClean( false );
+    compact();
+    emit indexChanged( m_index );
 }
 
 void
@@ -74,6 +170,17 @@ AbstractUndoStack::setClean()
     _setClean( true );
 }
 
+void
+AbstractUndoStack::clear()
+{
+    if ( m_stack.isEmpty() == true )
+        return;
+    removeCommands( 0 );
+    m_index = 0;
+    _setClean( true );
+    emit indexChanged( m_index );
+}
+
 void
 AbstractUndoStack::_setClean( bool val )
 {
@@ -81,3 +188,62 @@ AbstractUndoStack::_setClean( bool val )
         emit cleanChanged( val );
     m_isClean = val;
 }
+
+void
+AbstractUndoStack::removeCommands( int from )
+{
+    for ( int i = from; i < m_stack.size(); ++i )
+        delete m_stack[i];
+    m_stack.resize( from );
+    m_states.resize( from );
+}
+
+void
+AbstractUndoStack::compact()
+{
+    if ( m_sequence == nullptr )
+        return;
+    auto size = estimatedSize();
+    auto isOverBudget = [this, &size]
+    {
+        return ( m_undoLimit > 0 && m_stack.size() > m_undoLimit ) ||
+                ( m_memoryLimit > 0 && size > m_memoryLimit );
+    };
+    int folded = 0;
+    // Only applied commands are folded, oldest first, into the checkpoint right before them.
+    // A command the sequence state doesn't cover stays, and the next ones start a new checkpoint.
+    int i = 0;
+    while ( isOverBudget() == true && i < m_index )
+    {
+        if ( m_stack[i]->isSequenceEdit() == false )
+        {
+            ++i;
+            continue;
+        }
+        auto after = i + 1 < m_states.size() ? m_states[i + 1] : m_sequence->state();
+        size -= m_stack[i]->estimatedSize();
+        auto checkpoint = i > 0 ? dynamic_cast<Checkpoint*>( m_stack[i - 1] ) : nullptr;
+        if ( checkpoint == nullptr )
+        {
+            checkpoint = new Checkpoint( m_sequence, m_states[i], after );
+            size += checkpoint->estimatedSize();
+            delete m_stack[i];
+            m_stack[i] = checkpoint;
+            ++i;
+        }
+        else
+        {
+            size -= checkpoint->estimatedSize();
+            checkpoint->append( after );
+            size += checkpoint->estimatedSize();
+            delete m_stack[i];
+            m_stack.remove( i );
+            m_states.remove( i );
+            m_index--;
+        }
+        ++folded;
+    }
+    if ( folded > 0 )
+        vlmcDebug() << "Compacted" << folded << "undo command(s), the history now holds about"
+                    << size / 1024 << "KiB in" << m_stack.size() << "entries";
+}
@@ -29,39 +29,110 @@
 #include <QUndoStack>
 #include "Commands.h"
 #else
-#include <QStack>
+#include <QVector>
+#include "Workflow/SequenceState.h"
 #endif
 
+#include <memory>
+
+class   SequenceWorkflow;
+
 namespace Commands
 {
 #ifdef HAVE_GUI
     class AbstractUndoStack : public QUndoStack
     {
+        public:
+            /**
+             *  \brief  The estimated memory kept alive by a command, see Generic::estimatedSize()
+             */
+            qint64  estimatedSize( int idx ) const
+            {
+                auto cmd = dynamic_cast<const Generic*>( command( idx ) );
+                return cmd != nullptr ? cmd->estimatedSize() : 0;
+            }
+            qint64  estimatedSize() const
+            {
+                qint64 size = 0;
+                for ( int i = 0; i < count(); ++i )
+                    size += estimatedSize( i );
+                return size;
+            }
 #else
     class Generic;
+
+    /**
+     *  \brief  Mirrors QUndoStack for the headless builds, within a memory budget.
+     *
+     *  When the history exceeds its entry or memory limit, the oldest applied sequence
+     *  edits are folded into a Checkpoint, which only keeps the sequence states around
+     *  them. The commands are then deleted, releasing the instances, producers and filters
+     *  they were the last to hold. Commands the sequence state doesn't cover, ie. library
+     *  changes, are kept: the edits after them go to another checkpoint. Unlike
+     *  QUndoStack::setUndoLimit(), this doesn't lose the ability to undo up to the
+     *  beginning of the session, but the limits can't be met while such commands remain.
+     *  \sa    Generic::isSequenceEdit()
+     */
     class AbstractUndoStack : public QObject
     {
         Q_OBJECT
 
         public:
             explicit AbstractUndoStack( QObject* parent = 0 );
+            ~AbstractUndoStack();
+
+            int         count() const;
+            // The number of applied commands, as QUndoStack::index()
+            int         index() const;
+            QString     text( int idx ) const;
+            /**
+             *  \brief  The sequence whose states checkpoints are made of.
+             *
+             *  Without a sequence, the history is never compacted.
+             */
+            void        setSequence( std::shared_ptr<SequenceWorkflow> sequence );
+            /**
+             *  \brief  The number of entries above which the history gets compacted. 0 for no limit.
+             */
+            void        setUndoLimit( int limit );
+            int         undoLimit() const;
+            /**
+             *  \brief  The estimated size above which the history gets compacted, in bytes. 0 for no limit.
+             */
+            void        setMemoryLimit( qint64 bytes );
+            qint64      memoryLimit() const;
+            /**
+             *  \brief  The estimated memory kept alive by a command, see Generic::estimatedSize()
+             */
+            qint64      estimatedSize( int idx ) const;
+            qint64      estimatedSize() const;
 
         signals:
             void cleanChanged( bool val );
+            // Mirrors QUndoStack::indexChanged
+            void indexChanged( int idx );
 
         public slots:
             void redo();
             void undo();
             void push( Generic* command );
             void setClean();
+            void clear();
 
         private:
             // Avoid overloading setClean
             void _setClean( bool val );
+            void removeCommands( int from );
+            void compact();
 
-            bool         m_isClean;
-            QStack<Generic*>       m_stack;
-            int          m_index;
+            bool                            m_isClean;
+            QVector<Generic*>               m_stack;
+            // The sequence state before each command of m_stack was first applied
+            QVector<SequenceState>          m_states;
+            int                             m_index;
+            int                             m_undoLimit;
+            qint64                          m_memoryLimit;
+            std::shared_ptr<SequenceWorkflow>   m_sequence;
 #endif
     };
 }
@@ -42,6 +42,11 @@
 # include "Gui/timeline/MarkerManager.h"
 #endif
 
+// Rough memory kept alive by the backend objects a command may hold: a producer
+// along with its properties, and a filter.
+static const qint64 ProducerCost = 16 * 1024;
+static const qint64 FilterCost = 4 * 1024;
+
 Commands::Generic::Generic() :
         m_valid( true )
 {
@@ -68,6 +73,18 @@ Commands::Generic::isValid() const
     return m_valid;
 }
 
+qint64
+Commands::Generic::estimatedSize() const
+{
+    return sizeof( Generic ) + text().size() * sizeof( QChar );
+}
+
+bool
+Commands::Generic::isSequenceEdit() const
+{
+    return false;
+}
+
 #ifndef HAVE_GUI
 void
 Commands::Generic::setText( const QString& text )
@@ -80,6 +97,18 @@ Commands::Generic::text() const
 {
     return m_text;
 }
+
+int
+Commands::Generic::id() const
+{
+    return -1;
+}
+
+bool
+Commands::Generic::mergeWith( const Generic* )
+{
+    return false;
+}
 #endif
 
 void
@@ -96,6 +125,66 @@ Commands::Generic::undo()
         internalUndo();
 }
 
+bool
+Commands::SequenceEdit::isSequenceEdit() const
+{
+    return true;
+}
+
+Commands::Checkpoint::Checkpoint( std::shared_ptr<SequenceWorkflow> const& workflow,
+                                  const SequenceState& before, const SequenceState& after ) :
+        m_workflow( workflow ),
+        m_before( before ),
+        m_after( after ),
+        m_count( 1 )
+{
+    retranslate();
+}
+
+void
+Commands::Checkpoint::append( const SequenceState& after )
+{
+    m_after = after;
+    ++m_count;
+    retranslate();
+}
+
+int
+Commands::Checkpoint::count() const
+{
+    return m_count;
+}
+
+void
+Commands::Checkpoint::retranslate()
+{
+    setText( tr( "%n earlier action(s)", "", m_count ) );
+}
+
+qint64
+Commands::Checkpoint::estimatedSize() const
+{
+    // The records are mostly shared with the live sequence, count them anyway
+    auto records = m_before.clips().size() + m_after.clips().size();
+    auto transitions = m_before.transitions().size() + m_after.transitions().size();
+    return Generic::estimatedSize() + records * sizeof( SequenceState::Clip ) +
+            transitions * sizeof( SequenceState::Transition );
+}
+
+void
+Commands::Checkpoint::internalRedo()
+{
+    if ( m_workflow->restore( m_after ) == false )
+        invalidate();
+}
+
+void
+Commands::Checkpoint::internalUndo()
+{
+    if ( m_workflow->restore( m_before ) == false )
+        invalidate();
+}
+
 Commands::Clip::Add::Add( std::shared_ptr<SequenceWorkflow> const& workflow,
                           const QUuid& uuid, quint32 trackId, qint32 pos ) :
         m_workflow( workflow ),
@@ -219,6 +308,12 @@ Commands::Clip::Remove::retranslate()
     setText( tr( "Removing clip " ) );
 }
 
+qint64
+Commands::Clip::Remove::estimatedSize() const
+{
+    return Generic::estimatedSize() + m_clips.size() * ProducerCost;
+}
+
 int
 Commands::Clip::Remove::id() const
 {
@@ -284,6 +379,12 @@ Commands::Clip::Resize::retranslate()
     setText( tr( "Resizing clip" ) );
 }
 
+qint64
+Commands::Clip::Resize::estimatedSize() const
+{
+    return Generic::estimatedSize() + m_infos.size() * ( sizeof( Info ) + ProducerCost );
+}
+
 bool
 Commands::Clip::Resize::mergeWith( const Generic* command )
 {
@@ -323,6 +424,220 @@ Commands::Clip::Resize::internalUndo()
     }
 }
 
+Commands::Clip::GroupEdit::GroupEdit( std::shared_ptr<SequenceWorkflow> const& workflow, const QString& text,
+                                      const QVector<SequenceWorkflow::ClipEdit>& edits,
+                                      const QVector<QUuid>& removed ) :
+    m_workflow( workflow ),
+    m_text( text ),
+    m_edits( edits ),
+    m_removedUuids( removed )
+{
+    for ( const auto& e : edits )
+        m_oldEdits << workflow->placement( e.uuid );
+    for ( const auto& uuid : removed )
+    {
+        auto clip = workflow->clip( uuid );
+        if ( clip == nullptr )
+        {
+            invalidate();
+            return;
+        }
+        m_removed << clip;
+    }
+    retranslate();
+}
+
+void
+Commands::Clip::GroupEdit::retranslate()
+{
+    setText( m_text );
+}
+
+qint64
+Commands::Clip::GroupEdit::estimatedSize() const
+{
+    return Generic::estimatedSize() + ( m_edits.size() + m_oldEdits.size() ) * sizeof( SequenceWorkflow::ClipEdit ) +
+            m_removed.size() * ProducerCost;
+}
+
+void
+Commands::Clip::GroupEdit::internalRedo()
+{
+    if ( m_workflow->applyEdits( m_edits, m_removedUuids ) == false )
+        invalidate();
+}
+
+void
+Commands::Clip::GroupEdit::internalUndo()
+{
+    if ( m_workflow->applyEdits( m_oldEdits, {}, m_removed ) == false )
+        invalidate();
+}
+
+Commands::Clip::Gesture::Gesture( std::shared_ptr<SequenceWorkflow> const& workflow, bool allowOverlaps ) :
+    m_workflow( workflow ),
+    m_allowOverlaps( allowOverlaps )
+{
+    retranslate();
+}
+
+void
+Commands::Clip::Gesture::retranslate()
+{
+    setText( tr( "Editing clip(s)", "", m_infos.count() ) );
+}
+
+Commands::Clip::Gesture::Info*
+Commands::Clip::Gesture::info( const QUuid& uuid )
+{
+    for ( auto& info : m_infos )
+    {
+        if ( info.uuid == uuid )
+            return &info;
+    }
+    auto clip = m_workflow->clip( uuid );
+    if ( clip == nullptr )
+        return nullptr;
+    m_infos.append( Info{
+        uuid,
+        clip->trackId,
+        clip->trackId,
+        clip->pos,
+        clip->pos,
+        clip->clip->begin(),
+        clip->clip->begin(),
+        clip->clip->end(),
+        clip->clip->end()
+    });
+    retranslate();
+    return &m_infos.last();
+}
+
+bool
+Commands::Clip::Gesture::add( const QUuid& uuid )
+{
+    return info( uuid ) != nullptr;
+}
+
+bool
+Commands::Clip::Gesture::contains( const QUuid& uuid ) const
+{
+    for ( const auto& info : m_infos )
+    {
+        if ( info.uuid == uuid )
+            return true;
+    }
+    return false;
+}
+
+bool
+Commands::Clip::Gesture::allowsOverlaps() const
+{
+    return m_allowOverlaps;
+}
+
+bool
+Commands::Clip::Gesture::move( const QUuid& uuid, quint32 trackId, qint64 pos )
+{
+    auto i = info( uuid );
+    if ( i == nullptr )
+        return false;
+    i->newTrackId = trackId;
+    i->newPos = pos;
+    return true;
+}
+
+bool
+Commands::Clip::Gesture::resize( const QUuid& uuid, qint64 newBegin, qint64 newEnd, qint64 newPos )
+{
+    auto i = info( uuid );
+    if ( i == nullptr )
+        return false;
+    i->newBegin = newBegin;
+    i->newEnd = newEnd;
+    i->newPos = newPos;
+    return true;
+}
+
+bool
+Commands::Clip::Gesture::moveTransition( const QUuid& uuid, qint64 begin, qint64 end )
+{
+    for ( auto& info : m_transitionInfos )
+    {
+        if ( info.uuid == uuid )
+        {
+            info.newBegin = begin;
+            info.newEnd = end;
+            return true;
+        }
+    }
+    auto t = m_workflow->transition( uuid );
+    if ( t == nullptr )
+        return false;
+    m_transitionInfos.append( TransitionInfo{
+        uuid,
+        begin,
+        t->transition->begin(),
+        end,
+        t->transition->end()
+    });
+    return true;
+}
+
+bool
+Commands::Clip::Gesture::isEmpty() const
+{
+    for ( const auto& info : m_infos )
+    {
+        if ( info.newTrackId != info.oldTrackId || info.newPos != info.oldPos ||
+             info.newBegin != info.oldBegin || info.newEnd != info.oldEnd )
+            return false;
+    }
+    for ( const auto& info : m_transitionInfos )
+    {
+        if ( info.newBegin != info.oldBegin || info.newEnd != info.oldEnd )
+            return false;
+    }
+    return true;
+}
+
+void
+Commands::Clip::Gesture::apply( bool forward )
+{
+    QVector<SequenceWorkflow::ClipEdit> edits;
+    for ( const auto& info : m_infos )
+    {
+        if ( forward == true )
+            edits << SequenceWorkflow::ClipEdit{ info.uuid, info.newTrackId, info.newPos, info.newBegin, info.newEnd };
+        else
+            edits << SequenceWorkflow::ClipEdit{ info.uuid, info.oldTrackId, info.oldPos, info.oldBegin, info.oldEnd };
+    }
+    if ( m_workflow->applyEdits( edits ) == false )
+    {
+        invalidate();
+        return;
+    }
+    for ( const auto& info : m_transitionInfos )
+    {
+        if ( forward == true )
+            m_workflow->moveTransition( info.uuid, info.newBegin, info.newEnd );
+        else
+            m_workflow->moveTransition( info.uuid, info.oldBegin, info.oldEnd );
+    }
+}
+
+void
+Commands::Clip::Gesture::internalRedo()
+{
+    apply( true );
+}
+
+void
+Commands::Clip::Gesture::internalUndo()
+{
+    apply( false );
+}
+
 Commands::Clip::Split::Split( std::shared_ptr<SequenceWorkflow> const& workflow,
                               const QUuid& uuid, qint64 newClipPos, qint64 newClipBegin ) :
     m_workflow( workflow ),
@@ -349,6 +664,13 @@ Commands::Clip::Split::retranslate()
     setText( tr("Splitting clip") );
 }
 
+qint64
+Commands::Clip::Split::estimatedSize() const
+{
+    // The instance being split, and the new clip
+    return Generic::estimatedSize() + 2 * ProducerCost;
+}
+
 void
 Commands::Clip::Split::internalRedo()
 {
@@ -447,8 +769,10 @@ Commands::Clip::Unlink::internalUndo()
         invalidate();
 }
 
-Commands::Effect::Add::Add( std::shared_ptr<EffectHelper> const& helper, Backend::IInput* target )
-    : m_helper( helper )
+Commands::Effect::Add::Add( std::shared_ptr<SequenceWorkflow> const& workflow,
+                            std::shared_ptr<EffectHelper> const& helper, Backend::IInput* target )
+    : m_workflow( workflow )
+    , m_helper( helper )
     , m_target( target )
 {
     retranslate();
@@ -460,21 +784,31 @@ Commands::Effect::Add::retranslate()
     setText( tr( "Adding effect %1" ).arg( m_helper->name() ) );
 }
 
+qint64
+Commands::Effect::Add::estimatedSize() const
+{
+    return Generic::estimatedSize() + FilterCost;
+}
+
 void
 Commands::Effect::Add::internalRedo()
 {
     m_target->attach( *m_helper->filter() );
+    m_workflow->updateFilters( m_target );
 }
 
 void
 Commands::Effect::Add::internalUndo()
 {
     m_target->detach( *m_helper->filter() );
+    m_workflow->updateFilters( m_target );
 }
 
-Commands::Effect::Move::Move( std::shared_ptr<EffectHelper> const& helper, std::shared_ptr<Backend::IInput> const& from, Backend::IInput* to,
+Commands::Effect::Move::Move( std::shared_ptr<SequenceWorkflow> const& workflow,
+                              std::shared_ptr<EffectHelper> const& helper, std::shared_ptr<Backend::IInput> const& from, Backend::IInput* to,
                               qint64 pos)
-    : m_helper( helper )
+    : m_workflow( workflow )
+    , m_helper( helper )
     , m_from( from )
     , m_to( to )
     , m_newPos( pos )
@@ -491,6 +825,12 @@ Commands::Effect::Move::retranslate()
     setText( tr( "Moving effect %1" ).arg( m_helper->name() ) );
 }
 
+qint64
+Commands::Effect::Move::estimatedSize() const
+{
+    return Generic::estimatedSize() + FilterCost;
+}
+
 void
 Commands::Effect::Move::internalRedo()
 {
@@ -503,6 +843,8 @@ Commands::Effect::Move::internalRedo()
     }
     else
         m_helper->setBoundaries( m_newPos, m_newEnd );
+    m_workflow->updateFilters( m_from.get() );
+    m_workflow->updateFilters( m_to );
 }
 
 void
@@ -516,10 +858,14 @@ Commands::Effect::Move::internalUndo()
     }
     else
         m_helper->setBoundaries( m_oldPos, m_oldEnd );
+    m_workflow->updateFilters( m_from.get() );
+    m_workflow->updateFilters( m_to );
 }
 
-Commands::Effect::Resize::Resize( std::shared_ptr<EffectHelper> const& helper, qint64 newBegin, qint64 newEnd )
-    : m_helper( helper )
+Commands::Effect::Resize::Resize( std::shared_ptr<SequenceWorkflow> const& workflow,
+                                  std::shared_ptr<EffectHelper> const& helper, qint64 newBegin, qint64 newEnd )
+    : m_workflow( workflow )
+    , m_helper( helper )
     , m_newBegin( newBegin )
     , m_newEnd( newEnd )
 {
@@ -534,20 +880,30 @@ Commands::Effect::Resize::retranslate()
     setText( tr( "Resizing effect %1" ).arg( m_helper->name() ) );
 }
 
+qint64
+Commands::Effect::Resize::estimatedSize() const
+{
+    return Generic::estimatedSize() + FilterCost;
+}
+
 void
 Commands::Effect::Resize::internalRedo()
 {
     m_helper->setBoundaries( m_newBegin, m_newEnd );
+    m_workflow->updateFilters( m_helper->filter()->input().get() );
 }
 
 void
 Commands::Effect::Resize::internalUndo()
 {
     m_helper->setBoundaries( m_oldBegin, m_oldEnd );
+    m_workflow->updateFilters( m_helper->filter()->input().get() );
 }
 
-Commands::Effect::Remove::Remove( std::shared_ptr<EffectHelper> const& helper )
-    : m_helper( helper )
+Commands::Effect::Remove::Remove( std::shared_ptr<SequenceWorkflow> const& workflow,
+                                  std::shared_ptr<EffectHelper> const& helper )
+    : m_workflow( workflow )
+    , m_helper( helper )
     , m_target( helper->filter()->input() )
 {
 
@@ -559,16 +915,24 @@ Commands::Effect::Remove::retranslate()
     setText( tr( "Deleting effect %1" ).arg( m_helper->name() ) );
 }
 
+qint64
+Commands::Effect::Remove::estimatedSize() const
+{
+    return Generic::estimatedSize() + FilterCost;
+}
+
 void
 Commands::Effect::Remove::internalRedo()
 {
     m_target->detach( *m_helper->filter() );
+    m_workflow->updateFilters( m_target.get() );
 }
 
 void
 Commands::Effect::Remove::internalUndo()
 {
     m_helper->setTarget( m_target.get() );
+    m_workflow->updateFilters( m_target.get() );
 }
 
 Commands::Transition::Add::Add( std::shared_ptr<SequenceWorkflow> const& workflow,
@@ -627,6 +991,12 @@ Commands::Transition::Add::retranslate()
     setText( tr( "Adding transition" ) );
 }
 
+qint64
+Commands::Transition::Add::estimatedSize() const
+{
+    return Generic::estimatedSize() + ( m_transitionInstance != nullptr ? ProducerCost : 0 );
+}
+
 const QUuid&
 Commands::Transition::Add::uuid()
 {
@@ -737,6 +1107,66 @@ void Commands::Transition::Remove::retranslate()
     setText( tr( "Removing transition" ) );
 }
 
+qint64
+Commands::Transition::Remove::estimatedSize() const
+{
+    return Generic::estimatedSize() + ( m_transitionInstance != nullptr ? ProducerCost : 0 );
+}
+
+Commands::Media::SplitAtCuts::SplitAtCuts( QSharedPointer<::Media> media, const QVector<qint64>& cuts )
+    : m_media( media )
+{
+    qint64 begin = 0;
+    for ( auto cut : cuts )
+    {
+        if ( cut <= begin )
+            continue;
+        m_shots << qMakePair( begin, cut - 1 );
+        begin = cut;
+    }
+    m_shots << qMakePair( begin, static_cast<qint64>( media->input()->length() - 1 ) );
+    for ( auto i = 0; i < m_shots.size(); ++i )
+        m_uuids << QUuid::createUuid();
+    retranslate();
+}
+
+void
+Commands::Media::SplitAtCuts::internalRedo()
+{
+    for ( auto i = 0; i < m_shots.size(); ++i )
+    {
+        QVariantMap m{
+            { "libraryUuid", m_uuids[i] },
+            { "begin", m_shots[i].first },
+            { "end", m_shots[i].second },
+        };
+        if ( m_media->loadSubclip( m ) == nullptr )
+        {
+            invalidate();
+            return;
+        }
+    }
+}
+
+void
+Commands::Media::SplitAtCuts::internalUndo()
+{
+    for ( const auto& uuid : m_uuids )
+        m_media->removeSubclip( uuid );
+}
+
+void
+Commands::Media::SplitAtCuts::retranslate()
+{
+    setText( tr( "Splitting %1 into %n shot(s)", "", m_shots.size() ).arg( m_media->title() ) );
+}
+
+qint64
+Commands::Media::SplitAtCuts::estimatedSize() const
+{
+    return Generic::estimatedSize() + m_shots.size() * ProducerCost;
+}
+
 #ifdef HAVE_GUI
 Commands::Marker::Add::Add( QSharedPointer<MarkerManager> markerManager, quint64 pos )
     : m_markerManager( markerManager )
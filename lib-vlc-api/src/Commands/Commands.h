@@ -38,6 +38,7 @@
 
 class   Clip;
 class   EffectHelper;
+class   Media;
 class   Transition;
 class   MarkerManager;
 
@@ -71,9 +72,23 @@ namespace Commands
             void            redo();
             void            undo();
             bool            isValid() const;
+            /**
+             *  \brief  A rough estimate of the memory kept alive by this command, in bytes.
+             *
+             *  Producers, filters and instances only referenced by the history count the
+             *  most. The undo stack memory budget is checked against those estimates.
+             */
+            virtual qint64  estimatedSize() const;
+            /**
+             *  \brief  Returns true if the sequence state records everything this command changes
+             */
+            virtual bool    isSequenceEdit() const;
 #ifndef HAVE_GUI
             void            setText( const QString& text ) ;
             QString         text() const;
+            // Mirrors QUndoCommand: commands sharing an id() other than -1 can be merged
+            virtual int     id() const;
+            virtual bool    mergeWith( const Generic* command );
 #endif
         private:
             bool            m_valid;
@@ -85,9 +100,51 @@ namespace Commands
             void            invalidated();
     };
 
+    /**
+     *  \brief  A command which only changes the clips & transitions of the sequence.
+     *
+     *  The undo stack can fold those into a Checkpoint. The others, ie. library changes,
+     *  stay in the history as they are.
+     */
+    class   SequenceEdit : public Generic
+    {
+        public:
+            virtual bool    isSequenceEdit() const;
+    };
+
+    /**
+     *  \brief  Stands for a run of commands compacted by the undo stack.
+     *
+     *  Only the sequence states around those commands are kept. They share their
+     *  records with the live sequence, so the instances, producers and filters the
+     *  commands were holding get released. Undoing and redoing go through
+     *  SequenceWorkflow::restore().
+     */
+    class   Checkpoint : public Generic
+    {
+        public:
+            Checkpoint( std::shared_ptr<SequenceWorkflow> const& workflow,
+                        const SequenceState& before, const SequenceState& after );
+            /**
+             *  \brief  Absorbs the next command, which led to the given state
+             */
+            void            append( const SequenceState& after );
+            int             count() const;
+            virtual void    internalRedo();
+            virtual void    internalUndo();
+            virtual void    retranslate();
+            virtual qint64  estimatedSize() const;
+
+        private:
+            std::shared_ptr<SequenceWorkflow> m_workflow;
+            SequenceState               m_before;
+            SequenceState               m_after;
+            int                         m_count;
+    };
+
     namespace   Clip
     {
-        class   Add : public Generic
+        class   Add : public SequenceEdit
         {
             public:
                 Add( std::shared_ptr<SequenceWorkflow> const& workflow, const QUuid& uuid, quint32 trackId, qint32 pos );
@@ -104,7 +161,7 @@ namespace Commands
                 qint64                      m_pos;
         };
 
-        class   Move : public Generic
+        class   Move : public SequenceEdit
         {
             public:
                 Move( std::shared_ptr<SequenceWorkflow> const& workflow, const QString& uuid, quint32 trackId, qint64 pos );
@@ -127,13 +184,14 @@ namespace Commands
                 QVector<Info>       m_infos;
         };
 
-        class   Remove : public Generic
+        class   Remove : public SequenceEdit
         {
             public:
                 Remove( std::shared_ptr<SequenceWorkflow> const& workflow, const QUuid& uuid );
                 virtual void internalRedo();
                 virtual void internalUndo();
                 virtual void    retranslate();
+                virtual qint64  estimatedSize() const;
                 virtual int     id() const;
                 virtual bool    mergeWith( const Generic* command );
 
@@ -149,7 +207,7 @@ namespace Commands
          *  \param  newPos: if the clip was resized from the beginning, it is moved
          *                  so we have to know its new position
         */
-        class   Resize : public Generic
+        class   Resize : public SequenceEdit
         {
             public:
                 Resize( std::shared_ptr<SequenceWorkflow> const& workflow,
@@ -157,6 +215,7 @@ namespace Commands
                 virtual void    internalRedo();
                 virtual void    internalUndo();
                 virtual void    retranslate();
+                virtual qint64  estimatedSize() const;
                 virtual bool    mergeWith( const Generic* cmd );
                 virtual int     id() const;
 
@@ -175,7 +234,99 @@ namespace Commands
                 QVector<Info>                   m_infos;
         };
 
-        class   Split : public Generic
+        /**
+         *  \brief  Applies a group edit planned by SequenceWorkflow, ie. a ripple delete.
+         *
+         *  Every clip goes from its previous placement to its new one in a single
+         *  SequenceWorkflow::applyEdits() pass, and back when undoing.
+         */
+        class   GroupEdit : public SequenceEdit
+        {
+            public:
+                GroupEdit( std::shared_ptr<SequenceWorkflow> const& workflow, const QString& text,
+                           const QVector<SequenceWorkflow::ClipEdit>& edits,
+                           const QVector<QUuid>& removed = {} );
+                virtual void    internalRedo();
+                virtual void    internalUndo();
+                virtual void    retranslate();
+                virtual qint64  estimatedSize() const;
+
+            private:
+                std::shared_ptr<SequenceWorkflow>       m_workflow;
+                QString                                 m_text;
+                QVector<SequenceWorkflow::ClipEdit>     m_edits;
+                QVector<SequenceWorkflow::ClipEdit>     m_oldEdits;
+                QVector<QUuid>                          m_removedUuids;
+                QVector<QSharedPointer<SequenceWorkflow::ClipInstance>>     m_removed;
+        };
+
+        /**
+         *  \brief  Moves and resizes recorded during an interactive edit.
+         *
+         *  The edits are only recorded while the gesture goes on, the sequence is left
+         *  untouched until the command is pushed. Each clip then goes directly from its
+         *  original state to its final one in a single SequenceWorkflow::applyEdits() pass,
+         *  the transitions following, and the whole gesture is a single undo entry.
+         *  \sa     MainWorkflow::beginGesture()
+         */
+        class   Gesture : public SequenceEdit
+        {
+            public:
+                /**
+                 *  \param  allowOverlaps   Lets clips overlap, to create cross-dissolves
+                 */
+                Gesture( std::shared_ptr<SequenceWorkflow> const& workflow, bool allowOverlaps = false );
+                /**
+                 *  \brief  Makes a clip part of the gesture, without changing it yet
+                 *  \return false if the clip doesn't exist
+                 */
+                bool            add( const QUuid& uuid );
+                bool            contains( const QUuid& uuid ) const;
+                bool            allowsOverlaps() const;
+                /**
+                 *  \brief  Records the latest target of a clip, replacing any previous one
+                 *  \return false if the clip doesn't exist
+                 */
+                bool            move( const QUuid& uuid, quint32 trackId, qint64 pos );
+                bool            resize( const QUuid& uuid, qint64 newBegin, qint64 newEnd, qint64 newPos );
+                bool            moveTransition( const QUuid& uuid, qint64 begin, qint64 end );
+                bool            isEmpty() const;
+
+                virtual void    internalRedo();
+                virtual void    internalUndo();
+                virtual void    retranslate();
+
+            private:
+                struct Info
+                {
+                    QUuid           uuid;
+                    quint32         newTrackId;
+                    quint32         oldTrackId;
+                    qint64          newPos;
+                    qint64          oldPos;
+                    qint64          newBegin;
+                    qint64          oldBegin;
+                    qint64          newEnd;
+                    qint64          oldEnd;
+                };
+                struct TransitionInfo
+                {
+                    QUuid           uuid;
+                    qint64          newBegin;
+                    qint64          oldBegin;
+                    qint64          newEnd;
+                    qint64          oldEnd;
+                };
+                Info*           info( const QUuid& uuid );
+                void            apply( bool forward );
+
+                std::shared_ptr<SequenceWorkflow> m_workflow;
+                const bool          m_allowOverlaps;
+                QVector<Info>       m_infos;
+                QVector<TransitionInfo>     m_transitionInfos;
+        };
+
+        class   Split : public SequenceEdit
         {
             public:
                 Split( std::shared_ptr<SequenceWorkflow> const& workflow,
@@ -183,6 +334,7 @@ namespace Commands
                 virtual void    internalRedo();
                 virtual void    internalUndo();
                 virtual void    retranslate();
+                virtual qint64  estimatedSize() const;
             private:
                 std::shared_ptr<SequenceWorkflow> m_workflow;
                 QSharedPointer<SequenceWorkflow::ClipInstance>  m_toSplit;
@@ -194,7 +346,7 @@ namespace Commands
                 qint64                      m_oldEnd;
         };
 
-        class   Link : public Generic
+        class   Link : public SequenceEdit
         {
             public:
                 Link( std::shared_ptr<SequenceWorkflow> const& workflow,
@@ -208,7 +360,7 @@ namespace Commands
                 QUuid     m_clipB;
         };
 
-        class   Unlink : public Generic
+        class   Unlink : public SequenceEdit
         {
             public:
                 Unlink( std::shared_ptr<SequenceWorkflow> const& workflow,
@@ -223,16 +375,23 @@ namespace Commands
         };
     }
 
+    /**
+     *  Effect commands act on the backend inputs directly, and record the outcome in the
+     *  state of the element they touched, see SequenceWorkflow::updateFilters
+     */
     namespace   Effect
     {
         class   Add : public Generic
         {
             public:
-                Add( std::shared_ptr<EffectHelper> const& helper, Backend::IInput* target );
+                Add( std::shared_ptr<SequenceWorkflow> const& workflow,
+                     std::shared_ptr<EffectHelper> const& helper, Backend::IInput* target );
                 virtual void    internalRedo();
                 virtual void    internalUndo();
                 virtual void    retranslate();
+                virtual qint64  estimatedSize() const;
             private:
+                std::shared_ptr<SequenceWorkflow> m_workflow;
                 std::shared_ptr<EffectHelper>   m_helper;
                 Backend::IInput*      m_target;
         };
@@ -240,11 +399,14 @@ namespace Commands
         class   Move : public Generic
         {
             public:
-                Move( std::shared_ptr<EffectHelper> const& helper, std::shared_ptr<Backend::IInput> const& from, Backend::IInput* to, qint64 pos );
+                Move( std::shared_ptr<SequenceWorkflow> const& workflow,
+                      std::shared_ptr<EffectHelper> const& helper, std::shared_ptr<Backend::IInput> const& from, Backend::IInput* to, qint64 pos );
                 virtual void    internalRedo();
                 virtual void    internalUndo();
                 virtual void    retranslate();
+                virtual qint64  estimatedSize() const;
             private:
+                std::shared_ptr<SequenceWorkflow>   m_workflow;
                 std::shared_ptr<EffectHelper>       m_helper;
                 std::shared_ptr<Backend::IInput>    m_from;
                 Backend::IInput      *m_to;
@@ -257,11 +419,14 @@ namespace Commands
         class   Resize : public Generic
         {
             public:
-                Resize( std::shared_ptr<EffectHelper> const& helper, qint64 newBegin, qint64 newEnd );
+                Resize( std::shared_ptr<SequenceWorkflow> const& workflow,
+                        std::shared_ptr<EffectHelper> const& helper, qint64 newBegin, qint64 newEnd );
                 virtual void        internalRedo();
                 virtual void        internalUndo();
                 virtual void        retranslate();
+                virtual qint64      estimatedSize() const;
             private:
+                std::shared_ptr<SequenceWorkflow>   m_workflow;
                 std::shared_ptr<EffectHelper>       m_helper;
                 qint64              m_newBegin;
                 qint64              m_newEnd;
@@ -272,11 +437,14 @@ namespace Commands
         class   Remove : public Generic
         {
             public:
-                Remove( std::shared_ptr<EffectHelper> const& helper );
+                Remove( std::shared_ptr<SequenceWorkflow> const& workflow,
+                        std::shared_ptr<EffectHelper> const& helper );
                 virtual void    internalRedo();
                 virtual void    internalUndo();
                 virtual void    retranslate();
+                virtual qint64  estimatedSize() const;
             private:
+                std::shared_ptr<SequenceWorkflow>   m_workflow;
                 std::shared_ptr<EffectHelper>       m_helper;
                 std::shared_ptr<Backend::IInput>    m_target;
         };
@@ -284,7 +452,7 @@ namespace Commands
 
     namespace Transition
     {
-        class   Add : public Generic
+        class   Add : public SequenceEdit
         {
             public:
                 Add( std::shared_ptr<SequenceWorkflow> const& workflow,
@@ -296,6 +464,7 @@ namespace Commands
                 virtual void    internalRedo();
                 virtual void    internalUndo();
                 virtual void    retranslate();
+                virtual qint64  estimatedSize() const;
 
                 const QUuid&    uuid();
             private:
@@ -311,7 +480,7 @@ namespace Commands
                 std::shared_ptr<SequenceWorkflow>           m_workflow;
         };
 
-        class   Move : public Generic
+        class   Move : public SequenceEdit
         {
             public:
                 Move( std::shared_ptr<SequenceWorkflow> const& workflow,
@@ -328,7 +497,7 @@ namespace Commands
                 std::shared_ptr<SequenceWorkflow>           m_workflow;
         };
 
-        class   MoveBetweenTracks : public Generic
+        class   MoveBetweenTracks : public SequenceEdit
         {
             public:
                 MoveBetweenTracks( std::shared_ptr<SequenceWorkflow> const& workflow,
@@ -345,7 +514,7 @@ namespace Commands
                 std::shared_ptr<SequenceWorkflow>           m_workflow;
         };
 
-        class   Remove : public Generic
+        class   Remove : public SequenceEdit
         {
             public:
                 Remove( std::shared_ptr<SequenceWorkflow> const& workflow,
@@ -353,6 +522,7 @@ namespace Commands
                 virtual void    internalRedo();
                 virtual void    internalUndo();
                 virtual void    retranslate();
+                virtual qint64  estimatedSize() const;
             private:
                 QUuid                                       m_uuid;
                 QSharedPointer<SequenceWorkflow::TransitionInstance>                m_transitionInstance;
@@ -360,6 +530,31 @@ namespace Commands
         };
     }
 
+    namespace   Media
+    {
+        /**
+         *  \brief  Creates a subclip for each shot of a media.
+         */
+        class   SplitAtCuts : public Generic
+        {
+            public:
+                /**
+                 *  \param cuts    The first frame of each shot but the first one, in order
+                 */
+                SplitAtCuts( QSharedPointer<::Media> media, const QVector<qint64>& cuts );
+                virtual void    internalRedo();
+                virtual void    internalUndo();
+                virtual void    retranslate();
+                virtual qint64  estimatedSize() const;
+            private:
+                QSharedPointer<::Media>         m_media;
+                // First and last frames of each shot
+                QVector<QPair<qint64, qint64>>  m_shots;
+                // The subclips are recreated with the same uuids when redoing
+                QVector<QUuid>                  m_uuids;
+        };
+    }
+
 #ifdef HAVE_GUI
     // Gui commands
     namespace   Marker
@@ -20,41 +20,90 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
  *****************************************************************************/
 
-#include "controlserver.h"
-#include "QtWebSockets/qwebsocketserver.h"
-#include "QtWebSockets/qwebsocket.h"
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "ControlServer.h"
+#include "Library/AnalysisScheduler.h"
+#include "Library/Library.h"
+#include "Main/Core.h"
+#include "Media/Media.h"
+#include "Project/Project.h"
+#include "Tools/VlmcDebug.h"
+#include "Workflow/MainWorkflow.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QHostAddress>
+#include <QMetaEnum>
 
 ControlServer::ControlServer(quint16 port,
                              QString expectedId) :
-    m_wsServer(new QWebSocketServer("",
-                                    QWebSocketServer::SecureMode, this)),
     m_expectedId(expectedId),
+    // No certificate is configured, and the client is expected to run on this host
+    m_wsServer(new QWebSocketServer("VLMC",
+                                    QWebSocketServer::NonSecureMode, this)),
     m_client(nullptr),
     m_authDone(false)
 {
-    if (m_wsServer->listen(QHostAddress::Any, port)) {
+    if (m_wsServer->listen(QHostAddress::LocalHost, port)) {
         connect(m_wsServer, &QWebSocketServer::newConnection,
                 this, &ControlServer::onNewConnection);
+    } else {
+        vlmcWarning() << "Can't listen for a control client on port" << port
+                      << ":" << m_wsServer->errorString();
     }
+
+    // Analysis notifications are pushed to the client as they happen
+    auto scheduler = Core::instance()->analysisScheduler();
+    connect(scheduler, &AnalysisScheduler::progress, this,
+            [this](qint64 mediaId, AnalysisScheduler::Kind kind, double ratio) {
+      sendEvent(QJsonObject{ { "event", "analysisProgress" }, { "mediaId", mediaId },
+                             { "kind", AnalysisScheduler::kindName(kind) }, { "progress", ratio } });
+    });
+    connect(scheduler, &AnalysisScheduler::finished, this,
+            [this](qint64 mediaId, AnalysisScheduler::Kind kind) {
+      sendEvent(QJsonObject{ { "event", "analysisFinished" }, { "mediaId", mediaId },
+                             { "kind", AnalysisScheduler::kindName(kind) } });
+    });
+    connect(scheduler, &AnalysisScheduler::failed, this,
+            [this](qint64 mediaId, AnalysisScheduler::Kind kind) {
+      sendEvent(QJsonObject{ { "event", "analysisFailed" }, { "mediaId", mediaId },
+                             { "kind", AnalysisScheduler::kindName(kind) } });
+    });
 }
 
 ControlServer::~ControlServer() { }
 
+void ControlServer::sendEvent(const QJsonObject &event)
+{
+  if (m_client == nullptr || m_authDone == false) {
+    return;
+  }
+  m_client->sendTextMessage(QString::fromUtf8(QJsonDocument(event).toJson(QJsonDocument::Compact)));
+}
+
 void ControlServer::onNewConnection()
 {
   if (m_client) {
     return;
   }
 
-  m_client = m_pWebSocketServer->nextPendingConnection();
+  m_client = m_wsServer->nextPendingConnection();
+  // The socket is a child of the server, which goes away below
+  m_client->setParent(this);
 
   connect(m_client, &QWebSocket::textMessageReceived,
           this, &ControlServer::onTextMsgReceived);
   connect(m_client, &QWebSocket::disconnected,
           this, &ControlServer::onSocketDisconnected);
 
+  // Only one client is served. The server is still emitting this signal.
   m_wsServer->close();
-  delete m_wsServer;
+  m_wsServer->deleteLater();
+  m_wsServer = nullptr;
 }
 
 void ControlServer::onTextMsgReceived(QString msg)
@@ -68,6 +117,87 @@ void ControlServer::onTextMsgReceived(QString msg)
 
 void ControlServer::onSocketDisconnected()
 {
-  delete m_client;
+  m_client->deleteLater();
+  m_client = nullptr;
+  m_authDone = false;
   emit closed();
 }
+
+void ControlServer::tryAuth(QString msg)
+{
+  m_authDone = (msg == m_expectedId);
+  m_client->sendTextMessage(m_authDone ? "auth ok" : "auth failed");
+}
+
+/*
+ * Requests are JSON objects naming a "method", ie.
+ * {"method": "clipUsage", "uuid": "{...}"} or {"method": "mediaUsage", "mediaId": 42}
+ * {"method": "timelineRange", "startFrame": 0, "endFrame": 250, "trackIds": [0, 1]} lists
+ * what a viewport shows, "trackIds" being optional.
+ * {"method": "undoStats"} describes the undo history and its estimated memory use.
+ * {"method": "preloadProject", "path": "..."} opens the media of the next project in the
+ * background, {"method": "loadProject", "path": "..."} then switches to it.
+ * {"method": "analyze", "mediaId": 42, "kind": "Peaks"} schedules a media analysis, and
+ * {"method": "analysisResult", ...} returns it once done. {"method": "cancelAnalysis",
+ * "mediaId": 42} and {"method": "analysisStats"} handle the queue. The progress of the
+ * analyses is pushed as {"event": "analysisProgress" / "analysisFinished" / "analysisFailed"}.
+ * {"method": "splitAtSceneCuts", "mediaId": 42} creates a subclip per detected shot.
+ * {"method": "optimizeMedia", "mediaId": 42} transcodes a video to an all-intra copy, reported
+ * as the "OptimizedMedia" analysis, and {"method": "optimizedMediaUsage"} returns their disk use.
+ * The reply is the method result, as a JSON object.
+ */
+void ControlServer::processMsg(QString msg)
+{
+  auto request = QJsonDocument::fromJson(msg.toUtf8()).object();
+  auto method = request["method"].toString();
+  auto workflow = Core::instance()->workflow();
+  QJsonObject reply;
+
+  if (method == "clipUsage") {
+    reply = workflow->clipUsage(request["uuid"].toString());
+  } else if (method == "mediaUsage") {
+    reply = workflow->mediaUsage(static_cast<qint64>(request["mediaId"].toDouble()));
+  } else if (method == "timelineRange") {
+    reply = workflow->timelineRange(static_cast<qint64>(request["startFrame"].toDouble()),
+                                    static_cast<qint64>(request["endFrame"].toDouble()),
+                                    request["trackIds"].toArray().toVariantList());
+  } else if (method == "undoStats") {
+    reply = workflow->undoStats();
+  } else if (method == "preloadProject") {
+    Core::instance()->project()->preload(request["path"].toString());
+    reply = QJsonObject{ { "preloading", true } };
+  } else if (method == "loadProject") {
+    reply = QJsonObject{ { "loaded", Core::instance()->project()->load(request["path"].toString()) } };
+  } else if (method == "analyze" || method == "analysisResult") {
+    auto mediaId = static_cast<qint64>(request["mediaId"].toDouble());
+    auto media = Core::instance()->library()->media(mediaId);
+    bool ok = false;
+    auto kind = static_cast<AnalysisScheduler::Kind>(QMetaEnum::fromType<AnalysisScheduler::Kind>()
+        .keyToValue(qPrintable(request["kind"].toString()), &ok));
+    auto scheduler = Core::instance()->analysisScheduler();
+    if (media == nullptr || ok == false) {
+      reply = QJsonObject{ { "error", "unknown media or analysis" } };
+    } else if (method == "analyze") {
+      scheduler->enqueue(mediaId, media->mrl(), kind, AnalysisScheduler::Visible);
+      reply = QJsonObject{ { "scheduled", true } };
+    } else {
+      reply = QJsonObject{ { "result", QJsonValue::fromVariant(scheduler->result(media->mrl(), kind)) } };
+    }
+  } else if (method == "cancelAnalysis") {
+    Core::instance()->analysisScheduler()->cancel(static_cast<qint64>(request["mediaId"].toDouble()));
+    reply = QJsonObject{ { "cancelled", true } };
+  } else if (method == "splitAtSceneCuts") {
+    auto mediaId = static_cast<qint64>(request["mediaId"].toDouble());
+    reply = QJsonObject{ { "split", Core::instance()->library()->splitAtSceneCuts(mediaId) } };
+  } else if (method == "optimizeMedia") {
+    auto mediaId = static_cast<qint64>(request["mediaId"].toDouble());
+    reply = QJsonObject{ { "scheduled", Core::instance()->library()->optimizeMedia(mediaId) } };
+  } else if (method == "optimizedMediaUsage") {
+    reply = QJsonObject::fromVariantMap(Core::instance()->library()->optimizedMediaUsage());
+  } else if (method == "analysisStats") {
+    reply = Core::instance()->analysisScheduler()->stats();
+  } else {
+    reply = QJsonObject{ { "error", "unknown method: " + method } };
+  }
+  m_client->sendTextMessage(QString::fromUtf8(QJsonDocument(reply).toJson(QJsonDocument::Compact)));
+}
@@ -23,10 +23,11 @@
 #ifndef CONTROLSERVER_H
 #define CONTROLSERVER_H
 
+#include <QJsonObject>
 #include <QObject>
 #include <QQueue>
-#include "QtWebSockets/qwebsocketserver.h"
-#include "QtWebSockets/qwebsocket.h"
+#include <QWebSocketServer>
+#include <QWebSocket>
 
 class ControlServer : public QObject
 {
@@ -46,7 +47,8 @@ private slots:
 
 private:
     void tryAuth(QString);
-    void processMsg(QString)
+    void processMsg(QString);
+    void sendEvent(const QJsonObject &event);
 
     const QString m_expectedId;
 
@@ -104,4 +104,5 @@ EffectInstanceWidget::save()
 {
     for ( ISettingsCategoryWidget* val : m_settings )
         val->save();
+    emit saved();
 }
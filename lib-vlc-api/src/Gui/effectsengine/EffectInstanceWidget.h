@@ -54,6 +54,10 @@ class EffectInstanceWidget : public QWidget
 
     public slots:
         void                                save();
+
+    signals:
+        // The parameters were applied to the filter
+        void                                saved();
 };
 
 #endif // EFFECTINSTANCEWIDGET_H
@@ -77,6 +77,7 @@ EffectStack::addEffectHelper( EffectHelper* helper )
 {
     EffectInstanceWidget    *w = new EffectInstanceWidget( this );
     w->setEffectHelper( std::unique_ptr<EffectHelper>( helper ) );
+    connect( w, SIGNAL( saved() ), this, SIGNAL( edited() ) );
     m_stackedLayout->addWidget( w );
     m_instanceWidgets[helper->identifier()] = w;
 }
@@ -92,6 +93,7 @@ void
 EffectStack::moveUp()
 {
     m_model->moveUp( m_ui->list->currentIndex() );
+    emit edited();
     if ( m_ui->list->currentIndex().row() > 0 )
         m_ui->list->setCurrentIndex( m_ui->list->currentIndex().sibling( m_ui->list->currentIndex().row() - 1, 0 ) );
 }
@@ -100,6 +102,7 @@ void
 EffectStack::moveDown()
 {
     m_model->moveDown( m_ui->list->currentIndex() );
+    emit edited();
     if ( m_ui->list->currentIndex().row() < m_model->rowCount( QModelIndex() ) - 1 )
         m_ui->list->setCurrentIndex( m_ui->list->currentIndex().sibling( m_ui->list->currentIndex().row() + 1, 0 ) );
 }
@@ -108,6 +111,7 @@ void
 EffectStack::remove()
 {
     m_model->removeRow( m_ui->list->currentIndex().row() );
+    emit edited();
     if ( m_ui->list->currentIndex().isValid() == true )
         selectedChanged( m_ui->list->currentIndex() );
     else
@@ -122,5 +126,8 @@ EffectStack::add()
         QMessageBox::warning( this, tr( "An unexpected error has occurred" ),
                               tr( "We couldn't create an instance of '%1'.").arg( m_ui->addComboBox->currentText() ) );
     else
+    {
         addEffectHelper( helper );
+        emit edited();
+    }
 }
@@ -51,6 +51,10 @@ class EffectStack : public QDialog
         explicit EffectStack( Backend::IInput* input, QWidget *parent = 0 );
         ~EffectStack();
 
+    signals:
+        // A filter was added, removed, moved or its parameters were applied
+        void        edited();
+
     private:
         void        addEffectHelper( EffectHelper* helper );
 
@@ -53,6 +53,10 @@ ClipLibraryView::ClipLibraryView( QWidget* parent )
 
     connect( Core::instance()->library(), &Library::clipAdded, this, &ClipLibraryView::onClipAdded );
     connect( Core::instance()->library(), &Library::clipRemoved, this, &ClipLibraryView::clipRemoved );
+    connect( Core::instance()->library(), &Library::sceneCutsChanged, this, [this]( qint64 mediaId )
+    {
+        emit sceneCutsChanged( mediaId, Core::instance()->library()->sceneCuts( mediaId ).size() );
+    } );
 }
 
 QWidget*
@@ -73,9 +77,19 @@ ClipLibraryView::clip( const QString& uuid )
         { "mediaId", clip->media()->id() },
         { "duration", clip->length() },
         { "onTimeline", clip->onTimeline() },
+        { "sceneCuts", Core::instance()->library()->sceneCuts( clip->media()->id() ).size() },
     };
 }
 
+bool
+ClipLibraryView::splitAtSceneCuts( const QString& uuid )
+{
+    auto clip = Core::instance()->library()->clip( uuid );
+    if ( clip == nullptr )
+        return false;
+    return Core::instance()->library()->splitAtSceneCuts( clip->media()->id() );
+}
+
 void
 ClipLibraryView::onClipAdded( const QString& uuid )
 {
@@ -39,6 +39,12 @@ class ClipLibraryView : public QObject
         Q_INVOKABLE
         QJsonObject clip( const QString& uuid );
 
+        /**
+         * @brief splitAtSceneCuts  Creates a subclip for each shot of a clip media
+         */
+        Q_INVOKABLE
+        bool        splitAtSceneCuts( const QString& uuid );
+
     public slots:
         void    onClipAdded( const QString& uuid );
         void    onClipSelected( const QString& uuid );
@@ -53,6 +59,7 @@ class ClipLibraryView : public QObject
 
         void    clipSelected( const QString& uuid );
         void    clipOnTimelineChanged( const QString& uuid, bool onTimeline );
+        void    sceneCutsChanged( int mediaId, int count );
 };
 
 #endif // CLIPLIBRARYVIEW_H
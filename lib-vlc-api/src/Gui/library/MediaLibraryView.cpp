@@ -90,7 +90,7 @@ MediaLibraryView::onMediaSelected( qint64 mediaId )
 {
     QSharedPointer<Media> media = Core::instance()->library()->media( mediaId );
     if ( media == nullptr ) {
-        media.reset( new Media( Core::instance()->library()->model()->findMedia( mediaId ) ) );
+        media = Media::fromMediaLibrary( Core::instance()->library()->model()->findMedia( mediaId ) );
         Core::instance()->library()->addMedia( media );
     }
 
@@ -15,6 +15,7 @@ Rectangle {
     property string title
     property int duration
     property bool onTimeline
+    property int sceneCuts
     property var subClips: []
     property int subClipsCount: 0
 
@@ -70,13 +71,28 @@ Rectangle {
 
     MouseArea {
         anchors.fill: parent
+        acceptedButtons: Qt.LeftButton | Qt.RightButton
         onPressed: {
             clipListView.currentIndex = index;
+            if ( mouse.button === Qt.RightButton ) {
+                shotMenu.popup();
+                return;
+            }
             view.onClipSelected( uuid );
             view.startDrag( uuid );
         }
     }
 
+    Menu {
+        id: shotMenu
+
+        MenuItem {
+            text: "Split at scene cuts"
+            enabled: isBaseClip && sceneCuts > 0
+            onTriggered: view.splitAtSceneCuts( uuid )
+        }
+    }
+
     Row {
         anchors.fill: parent
         Image {
@@ -120,7 +136,8 @@ Rectangle {
                 font.pointSize: 8
                 maximumLineCount: 1
                 color: "#EEEEEE"
-                text: "Duration: " + toDuration( duration )
+                text: "Duration: " + toDuration( duration ) +
+                      ( isBaseClip && sceneCuts > 0 ? " - " + ( sceneCuts + 1 ) + " shots" : "" )
                 elide: Text.ElideRight
                 wrapMode: Text.Wrap
             }
@@ -34,6 +34,7 @@ Rectangle {
                 thumbnailPath: model.thumbnailPath
                 mediaId: model.mediaId
                 onTimeline: model.onTimeline
+                sceneCuts: model.sceneCuts
                 title: model.title
                 width: parent.width
             }
@@ -57,6 +58,13 @@ Rectangle {
             }
         }
 
+        onSceneCutsChanged: {
+            for ( var i = 0; i < clips.count; ++i ) {
+                if ( clips.get( i )["mediaId"] === mediaId )
+                    clips.setProperty( i, "sceneCuts", count );
+            }
+        }
+
         onClipRemoved: {
             var clip = view.clip( uuid );
             if ( clip.isBaseClip === false ) {
@@ -20,10 +20,10 @@ Rectangle {
     radius: 2
     border.color: "#1f546f"
     border.width: 1
+    visible: inView === true || selected === true
     opacity: page.dragging === true && selectedClips.indexOf( uuid ) !== -1 ? 0.5 : 1.0
 
     property alias name: text.text
-    property alias thumbnailSource: thumbnailImage.source
     property int trackId
     // Usualy it is trackId, the clip will be moved to the new track immediately.
     property int newTrackId
@@ -34,12 +34,19 @@ Rectangle {
     property int length
     property string libraryUuid // Library UUID: For thumbnails
     property string uuid // Instance UUID
-    property var linkedClips: linkedClipsDict[uuid] ? linkedClipsDict[uuid] : [] // Uuid
+    property var linkedClips: [] // Uuid
     property string type
     property bool selected: false
+    // Offscreen clips are neither drawn nor given a thumbnail
+    property bool inView: timelineModel.visibleEnd < 0 ||
+                          ( position <= timelineModel.visibleEnd &&
+                            position + end - begin >= timelineModel.visibleBegin )
     property alias mouseX: dragArea.mouseX
 
-    property var clipInfo
+    property var clipInfo // Its row in the timeline model
+    // Shot boundaries, in frames from the clip start
+    property var shots: timelineModel.shotsRevision >= 0 && inView ?
+                            timelineModel.shots( libraryUuid, begin, end ) : []
 
     function forcePosition()
     {
@@ -48,14 +55,14 @@ Rectangle {
     }
 
     function resize() {
-        // This function updates Backend
+        // This function updates Backend, within the gesture opened on press
         workflow.resizeClip( uuid, begin, end, position );
         for ( var i = 0; i < linkedClips.length; ++i )
         {
             var linkedClip = linkedClips[i];
             var lc = findClipItem( linkedClip );
-            if ( lc === null )
-                return;
+            if ( !lc )
+                break;
             workflow.resizeClip( lc.uuid, lc.begin, lc.end, lc.position );
         }
     }
@@ -64,10 +71,7 @@ Rectangle {
         if ( selected === false )
             return;
         for ( var i = 0; i < linkedClips.length; ++i )
-        {
-            var linkedClip = linkedClips[i];
-            findClipItem( linkedClip ).selected = true;
-        }
+            selectClip( linkedClips[i] );
     }
 
     function linked() {
@@ -101,7 +105,7 @@ Rectangle {
         {
             var linkedClip = linkedClips[i];
             var lc = findClipItem( linkedClip );
-            if ( lc === null )
+            if ( !lc )
                 return;
             // Don't resize from the begining if the clips didn't shared the same begin position
             if ( lc.position === oldPos ) {
@@ -151,42 +155,17 @@ Rectangle {
             y -= yToMoveUp - container.height + height;
     }
 
-    onClipInfoChanged: {
-        if ( !clipInfo )
-            return;
-
-        position = clipInfo["position"];
-        begin = clipInfo["begin"];
-        end = clipInfo["end"];
-        length = clipInfo["length"];
-    }
-
-    onPositionChanged: {
-        clipInfo["position"] = position;
-    }
-
-    onBeginChanged: {
-        clipInfo["begin"] = begin;
-    }
-
-    onEndChanged: {
-        clipInfo["end"] = end;
-    }
-
-    onLengthChanged: {
-        clipInfo["length"] = length;
-    }
-
     onSelectedChanged: {
+        // Keeps the delegate of a selected clip alive while it is offscreen
+        timelineModel.setSelected( uuid, selected );
         if ( selected === true ) {
-            selectedClips.push( uuid );
+            // A clip shown on another track while dragged is already listed
+            if ( selectedClips.indexOf( uuid ) === -1 )
+                selectedClips.push( uuid );
 
             var group = findGroup( uuid );
-            for ( var i = 0; i < ( group ? group.length : 0 ); ++i ) {
-                var clipItem = findClipItem( group[i] );
-                if ( clipItem )
-                    clipItem.selected = true;
-            }
+            for ( var i = 0; i < ( group ? group.length : 0 ); ++i )
+                selectClip( group[i] );
             selectLinkedClip();
         }
         else
@@ -199,24 +178,16 @@ Rectangle {
     }
 
     Component.onCompleted: {
-        for ( var i = 0; i < allClips.length; ++i ) {
-            if ( allClips[i].linkedClips.indexOf( uuid ) !== -1 )
-                linkedClips.push( allClips[i].uuid );
-        }
-        if ( clipInfo["selected"] === false )
-            selected = false;
-        else
-            selected = true;
         newTrackId = trackId;
         lastPosition = position;
         allClips.push( clip );
         allClipsDict[uuid] = clip;
+        selected = clipInfo["selected"] === true;
 
         updateEffects( workflow.clipInfo( uuid ) );
 
         if ( uuid === "videoUuid" || uuid === "audioUuid" )
             return;
-        thumbnailSource = "image://thumbnail/" + libraryUuid + "/0";
 
         for ( var i = 0; i < allTransitions.length; ++i ) {
             if ( allTransitions[i].begin === position || allTransitions[i].end === position + length - 1 )
@@ -224,26 +195,15 @@ Rectangle {
         }
     }
 
+    // The selection outlives the delegate: it stays in the model, and removed
+    // clips are unselected by the workflow handlers
     Component.onDestruction: {
         Drag.drop();
-        selected = false;
+        // The clip may already have a delegate on another track
+        if ( allClipsDict[uuid] === clip )
+            delete allClipsDict[uuid];
 
-        for ( var i = 0; i < linkedClips.length; ++i )
-        {
-            var linkedClip = linkedClips[i];
-            var linkedClipItem = findClipItem( linkedClip );
-            if ( linkedClipItem )
-                for ( var j = 0; j < linkedClipItem.linkedClips.length; ++j )
-                {
-                    if ( linkedClipItem.linkedClips[j] === uuid )
-                    {
-                        linkedClipItem.linkedClips.splice( j, 1 );
-                        break;
-                    }
-                }
-        }
-
-        for ( i = 0; i < allClips.length; ++i ) {
+        for ( var i = 0; i < allClips.length; ++i ) {
             if ( allClips[i] === clip ) {
                 allClips.splice( i, 1 );
                 return;
@@ -258,6 +218,40 @@ Rectangle {
         id: effects
     }
 
+    // Audio peaks of the media, computed in the background
+    Canvas {
+        id: waveform
+        anchors.fill: parent
+        visible: type === "Audio" && inView === true
+        property var peaks: visible === true && timelineModel.peaksRevision >= 0 ?
+                                timelineModel.peaks( libraryUuid, begin, end,
+                                                     Math.min( 1024, Math.max( 1, Math.floor( width / 2 ) ) ) ) : []
+
+        onPeaksChanged: requestPaint()
+        onPaint: {
+            var ctx = getContext( "2d" );
+            ctx.clearRect( 0, 0, width, height );
+            ctx.fillStyle = "#80c0e0";
+            var step = width / Math.max( 1, peaks.length );
+            for ( var i = 0; i < peaks.length; ++i ) {
+                var h = peaks[i] * height;
+                ctx.fillRect( i * step, ( height - h ) / 2, Math.max( 1, step - 1 ), h );
+            }
+        }
+    }
+
+    // Shot boundaries detected in the media
+    Repeater {
+        model: shots
+        delegate: Rectangle {
+            x: ftop( modelData )
+            width: 1
+            height: clip.height
+            color: "#f0c040"
+            opacity: 0.7
+        }
+    }
+
     Text {
         id: text
         color: "white"
@@ -279,7 +273,10 @@ Rectangle {
         anchors.bottomMargin: 4
         fillMode: Image.PreserveAspectFit
         visible: width < clip.width
-        asynchronous: true
+        // The thumbnails are decoded once the media is analyzed, the provider only
+        // looks them up, from the GUI thread
+        source: type !== "Video" || inView === false || uuid === "videoUuid" ? "" :
+                "image://thumbnail/" + libraryUuid + "/" + begin + "/" + timelineModel.thumbnailsRevision
     }
 
     MouseArea {
@@ -312,14 +309,16 @@ Rectangle {
                     if ( mouseX < width / 2 ) {
                         var newPos = position + ptof( mouseX );
                         var newBegin = begin + ptof( mouseX );
-                        if ( newBegin < 0 || newPos < 0 || newBegin >= end )
+                        if ( newBegin < 0 || newPos < 0 || newBegin >= end ||
+                             workflow.canResizeClip( uuid, newBegin, end, newPos ) === false )
                             return;
                         begin = newBegin;
                         position = newPos;
                     }
                     else {
                         var newEnd = begin + ptof( mouseX );
-                        if ( newEnd <= begin || newEnd + 1 > clipInfo["length"] )
+                        if ( newEnd <= begin || newEnd + 1 > length ||
+                             workflow.canResizeClip( uuid, begin, newEnd, position ) === false )
                             return;
                         end = newEnd;
                     }
@@ -344,6 +343,9 @@ Rectangle {
                     selected = true;
                 }
                 page.dragging = true;
+                // Everything until the release is a single edit
+                if ( isCutMode === false )
+                    workflow.beginGesture( selectedClips, isTransitionMode );
             }
         }
 
@@ -367,6 +369,15 @@ Rectangle {
                 resize();
             else if ( dragArea.drag.active )
                 dragFinished( newTrackId - trackId, position - lastPosition );
+            workflow.endGesture();
+            timelineModel.resetShownTracks();
+        }
+
+        onCanceled: {
+            workflow.cancelGesture();
+            timelineModel.resetShownTracks();
+            page.dragging = false;
+            forcePosition();
         }
 
         states: [
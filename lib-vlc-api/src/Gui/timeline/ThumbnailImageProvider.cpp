@@ -27,6 +27,7 @@
 
 #include "ThumbnailImageProvider.h"
 
+#include "Library/AnalysisScheduler.h"
 #include "Library/Library.h"
 #include "Media/Clip.h"
 #include "Media/Media.h"
@@ -46,12 +47,22 @@ ThumbnailImageProvider::requestImage( const QString& id, QSize* size, const QSiz
     tmp.replace( "%7B", "{" );
     tmp.replace( "%7D", "}" );
 
+    // "<library uuid>/<frame>", followed by a revision which only defeats the cache
     auto infos = tmp.split( '/' );
     auto libraryUuid = infos[0];
+    auto frame = infos.size() > 1 ? infos[1].toLongLong() : 0;
     auto clip = Core::instance()->library()->clip( libraryUuid );
-    QImage snapshot( clip->media()->snapshot() );
-    *size = snapshot.size();
+    if ( clip == nullptr )
+        return QImage();
+    // This only looks the analysis results up, the media is never decoded here
+    auto thumbnail = Core::instance()->library()->thumbnail( clip->media()->id(), frame );
+    if ( thumbnail.isNull() == true )
+    {
+        Core::instance()->analysisScheduler()->raisePriority( clip->media()->id(), AnalysisScheduler::Visible );
+        return thumbnail;
+    }
+    *size = thumbnail.size();
     auto width = requestedSize.width() > 0 ? requestedSize.width() : size->width();
     auto height = requestedSize.height() > 0 ? requestedSize.height() : size->height();
-    return snapshot.scaled( width, height );
+    return thumbnail.scaled( width, height );
 }
@@ -26,6 +26,10 @@
 
 #include <QQuickImageProvider>
 
+/**
+ *  Serves the thumbnails computed by the media analysis. It reads the library,
+ *  so the images must be loaded synchronously, from the GUI thread.
+ */
 class ThumbnailImageProvider : public QObject, public QQuickImageProvider
 {
     Q_OBJECT
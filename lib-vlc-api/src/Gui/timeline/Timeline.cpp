@@ -36,6 +36,7 @@
 #include "Settings/Settings.h"
 #include "Tools/VlmcDebug.h"
 #include "MarkerManager.h"
+#include "TimelineModel.h"
 
 #include <QtQuick/QQuickView>
 #include <QtQml/QQmlContext>
@@ -46,6 +47,7 @@ Timeline::Timeline( Settings* projectSettings, MainWindow* parent )
     , m_view( new QQuickView )
     , m_container( QWidget::createWindowContainer( m_view, parent ) )
     , m_markerManager( new MarkerManager )
+    , m_model( new TimelineModel( Core::instance()->workflow(), this ) )
     , m_settings( new Settings )
 {
     m_container->setSizePolicy( QSizePolicy::Expanding, QSizePolicy::Expanding );
@@ -55,6 +57,7 @@ Timeline::Timeline( Settings* projectSettings, MainWindow* parent )
     m_view->rootContext()->setContextProperty( QStringLiteral( "timeline" ), this );
     m_view->rootContext()->setContextProperty( QStringLiteral( "mainwindow" ), parent );
     m_view->rootContext()->setContextProperty( QStringLiteral( "workflow" ), Core::instance()->workflow() );
+    m_view->rootContext()->setContextProperty( QStringLiteral( "timelineModel" ), m_model );
     m_view->setSource( QUrl( QStringLiteral( "qrc:/QML/main.qml" ) ) );
 
     connect( Core::instance()->workflow(), &MainWorkflow::cleared, this, [this]()
@@ -66,6 +69,9 @@ Timeline::Timeline( Settings* projectSettings, MainWindow* parent )
     connect( m_markerManager.data(), &MarkerManager::markerAdded, this, &Timeline::markerAdded );
     connect( m_markerManager.data(), &MarkerManager::markerMoved, this, &Timeline::markerMoved );
     connect( m_markerManager.data(), &MarkerManager::markerRemoved, this, &Timeline::markerRemoved );
+    connect( m_markerManager.data(), &MarkerManager::markerAdded, m_model, &TimelineModel::addMarker );
+    connect( m_markerManager.data(), &MarkerManager::markerMoved, m_model, &TimelineModel::moveMarker );
+    connect( m_markerManager.data(), &MarkerManager::markerRemoved, m_model, &TimelineModel::removeMarker );
 
     m_settings->createVar( SettingValue::List, QStringLiteral( "markers" ), QVariantList(),
                            "Markers", "List of markers that the timeline uses",
@@ -34,6 +34,7 @@ class MainWindow;
 class QQuickView;
 class Settings;
 class MarkerManager;
+class TimelineModel;
 
 /**
  * \brief Entry point of the timeline widget.
@@ -70,6 +71,7 @@ private:
     QWidget*            m_container;
 
     QSharedPointer<MarkerManager> m_markerManager;
+    TimelineModel*      m_model;
     std::unique_ptr<Settings> m_settings;
 };
 
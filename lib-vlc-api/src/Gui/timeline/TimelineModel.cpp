@@ -0,0 +1,819 @@
+/*****************************************************************************
+ * TimelineModel.cpp: Item model of the timeline clips and transitions
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "TimelineModel.h"
+
+#include "Library/Library.h"
+#include "Main/Core.h"
+#include "Media/Clip.h"
+#include "Media/Media.h"
+#include "Workflow/MainWorkflow.h"
+#include "Workflow/SequenceState.h"
+
+#include <QSortFilterProxyModel>
+#include <QtQml/QQmlEngine>
+
+#include <algorithm>
+
+namespace
+{
+
+// Each step of freePosition sticks to or moves past one clip
+const int   MaxPlacementSteps = 16;
+
+qint64
+edgeFrame( qint64 frame )
+{
+    return frame;
+}
+
+qint64
+edgeFrame( const std::pair<const qint64, QString>& edge )
+{
+    return edge.first;
+}
+
+// Both edges of [pos, pos + length - 1] are tried, the closest candidate wins
+template <typename C, typename Accept>
+qint64
+snap( const C& edges, qint64 pos, qint64 length, qint64 margin, Accept accept )
+{
+    auto distance = margin;
+    auto newPos = pos;
+    auto visit = [&]( qint64 frame, qint64 offset )
+    {
+        for ( auto it = edges.lower_bound( frame - margin + 1 );
+              it != edges.end() && edgeFrame( *it ) < frame + margin; ++it )
+        {
+            if ( accept( *it ) == false )
+                continue;
+            auto d = qAbs( edgeFrame( *it ) - frame );
+            if ( d < distance )
+            {
+                distance = d;
+                newPos = edgeFrame( *it ) - offset;
+            }
+        }
+    };
+    if ( margin <= 0 )
+        return pos;
+    visit( pos, 0 );
+    visit( pos + length - 1, length - 1 );
+    return newPos;
+}
+
+template <typename C>
+void
+eraseEdge( C& edges, qint64 frame, const QString& uuid )
+{
+    auto range = edges.equal_range( frame );
+    for ( auto it = range.first; it != range.second; ++it )
+    {
+        if ( it->second == uuid )
+        {
+            edges.erase( it );
+            return;
+        }
+    }
+}
+
+// The elements of one kind shown on a track, offscreen ones excluded
+class TrackFilter : public QSortFilterProxyModel
+{
+public:
+    TrackFilter( TimelineModel* model, const QString& kind, const QString& type, quint32 trackId )
+        : QSortFilterProxyModel( model )
+        , m_kind( kind )
+        , m_type( type )
+        , m_trackId( trackId )
+    {
+        setDynamicSortFilter( true );
+        setSourceModel( model );
+    }
+
+protected:
+    virtual bool    filterAcceptsRow( int sourceRow, const QModelIndex& sourceParent ) const override
+    {
+        auto idx = sourceModel()->index( sourceRow, 0, sourceParent );
+        if ( idx.data( TimelineModel::KindRole ).toString() != m_kind ||
+             idx.data( TimelineModel::TypeRole ).toString() != m_type ||
+             idx.data( TimelineModel::TrackIdRole ).toUInt() != m_trackId )
+            return false;
+        return idx.data( TimelineModel::InRangeRole ).toBool() == true ||
+                idx.data( TimelineModel::SelectedRole ).toBool() == true ||
+                idx.data( TimelineModel::PreviewRole ).toBool() == true;
+    }
+
+private:
+    QString     m_kind;
+    QString     m_type;
+    quint32     m_trackId;
+};
+
+}
+
+TimelineModel::TimelineModel( MainWorkflow* workflow, QObject* parent )
+    : QAbstractListModel( parent )
+    , m_workflow( workflow )
+    , m_visibleBegin( 0 )
+    , m_visibleEnd( -1 )
+    , m_shotsRevision( 0 )
+    , m_thumbnailsRevision( 0 )
+    , m_peaksRevision( 0 )
+{
+    connect( workflow, &MainWorkflow::clipAdded, this, &TimelineModel::clipAdded );
+    connect( workflow, &MainWorkflow::clipMoved, this, &TimelineModel::clipChanged );
+    connect( workflow, &MainWorkflow::clipResized, this, &TimelineModel::clipChanged );
+    connect( workflow, &MainWorkflow::clipRemoved, this, &TimelineModel::clipRemoved );
+    connect( workflow, &MainWorkflow::clipLinked, this, &TimelineModel::clipLinkChanged );
+    connect( workflow, &MainWorkflow::clipUnlinked, this, &TimelineModel::clipLinkChanged );
+    connect( workflow, &MainWorkflow::transitionAdded, this, &TimelineModel::transitionAdded );
+    connect( workflow, &MainWorkflow::transitionMoved, this, &TimelineModel::transitionChanged );
+    connect( workflow, &MainWorkflow::transitionRemoved, this, &TimelineModel::transitionRemoved );
+    connect( workflow, &MainWorkflow::cleared, this, &TimelineModel::reset );
+    connect( Core::instance()->library(), &Library::sceneCutsChanged, this, [this]()
+    {
+        ++m_shotsRevision;
+        emit shotsChanged();
+    } );
+    connect( Core::instance()->library(), &Library::thumbnailsChanged, this, [this]()
+    {
+        ++m_thumbnailsRevision;
+        emit thumbnailsChanged();
+    } );
+    connect( Core::instance()->library(), &Library::peaksChanged, this, [this]()
+    {
+        ++m_peaksRevision;
+        emit peaksChanged();
+    } );
+    reset();
+}
+
+int
+TimelineModel::rowCount( const QModelIndex& parent ) const
+{
+    if ( parent.isValid() == true )
+        return 0;
+    return m_items.size();
+}
+
+QVariant
+TimelineModel::data( const QModelIndex& index, int role ) const
+{
+    if ( index.isValid() == false || index.row() >= m_items.size() )
+        return QVariant();
+    const auto& item = m_items[index.row()];
+    switch ( role )
+    {
+    case UuidRole:
+        return item.uuid;
+    case LibraryUuidRole:
+        return item.libraryUuid.isNull() == true ? QString() : item.libraryUuid.toString();
+    case KindRole:
+        return item.isTransition == true ? QStringLiteral( "transition" ) : QStringLiteral( "clip" );
+    case TypeRole:
+        return item.isAudio == true ? QStringLiteral( "Audio" ) : QStringLiteral( "Video" );
+    case TrackIdRole:
+        return item.shownTrackId;
+    case PositionRole:
+        return item.shownPosition;
+    case BeginRole:
+        return item.begin;
+    case EndRole:
+        return item.end;
+    case LengthRole:
+        return item.last - item.position + 1;
+    case Qt::DisplayRole:
+    case NameRole:
+        return item.name;
+    case IdentifierRole:
+        return item.isTransition == true ? item.name : QString();
+    case LinkedClipsRole:
+        return item.linkedClips;
+    case InRangeRole:
+        return inRange( item );
+    case SelectedRole:
+        return item.selected;
+    case PreviewRole:
+        return item.isPreview;
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray>
+TimelineModel::roleNames() const
+{
+    return {
+        { UuidRole, "uuid" },
+        { LibraryUuidRole, "libraryUuid" },
+        { KindRole, "kind" },
+        { TypeRole, "type" },
+        { TrackIdRole, "trackId" },
+        { PositionRole, "position" },
+        { BeginRole, "begin" },
+        { EndRole, "end" },
+        { LengthRole, "length" },
+        { NameRole, "name" },
+        { IdentifierRole, "identifier" },
+        { LinkedClipsRole, "linkedClips" },
+        { InRangeRole, "inRange" },
+        { SelectedRole, "selected" },
+        { PreviewRole, "preview" },
+    };
+}
+
+qint64
+TimelineModel::visibleBegin() const
+{
+    return m_visibleBegin;
+}
+
+qint64
+TimelineModel::visibleEnd() const
+{
+    return m_visibleEnd;
+}
+
+void
+TimelineModel::setVisibleRange( qint64 begin, qint64 end )
+{
+    if ( begin == m_visibleBegin && end == m_visibleEnd )
+        return;
+    QVector<bool> before( m_items.size() );
+    for ( auto i = 0; i < m_items.size(); ++i )
+        before[i] = inRange( m_items[i] );
+    m_visibleBegin = begin;
+    m_visibleEnd = end;
+    // Only notify the rows which entered or left the range, so that their track
+    // models create or destroy their delegates
+    for ( auto i = 0; i < m_items.size(); ++i )
+    {
+        if ( inRange( m_items[i] ) != before[i] )
+            rowChanged( i );
+    }
+    emit visibleRangeChanged();
+}
+
+QObject*
+TimelineModel::trackModel( const QString& kind, const QString& type, quint32 trackId )
+{
+    auto key = kind + QLatin1Char( '/' ) + type + QLatin1Char( '/' ) + QString::number( trackId );
+    auto model = m_trackModels.value( key );
+    if ( model == nullptr )
+    {
+        model = new TrackFilter( this, kind, type, trackId );
+        QQmlEngine::setObjectOwnership( model, QQmlEngine::CppOwnership );
+        m_trackModels.insert( key, model );
+    }
+    return model;
+}
+
+int
+TimelineModel::trackCount( const QString& type ) const
+{
+    auto isAudio = type == QStringLiteral( "Audio" );
+    int count = 0;
+    for ( auto it = m_clips.cbegin(); it != m_clips.cend(); ++it )
+    {
+        if ( it->empty() == true || ( it.key() >> 32 ) != static_cast<quint64>( isAudio ) )
+            continue;
+        count = qMax( count, static_cast<int>( it.key() & 0xFFFFFFFF ) + 1 );
+    }
+    return count;
+}
+
+QVariantMap
+TimelineModel::get( const QString& uuid ) const
+{
+    auto row = m_rows.value( uuid, -1 );
+    if ( row < 0 )
+        return QVariantMap();
+    QVariantMap map;
+    auto idx = QAbstractListModel::index( row );
+    const auto names = roleNames();
+    for ( auto it = names.cbegin(); it != names.cend(); ++it )
+        map[QString::fromLatin1( it.value() )] = data( idx, it.key() );
+    return map;
+}
+
+QStringList
+TimelineModel::clipsAt( const QString& type, quint32 trackId, qint64 begin, qint64 end,
+                        const QStringList& excluded ) const
+{
+    QStringList uuids;
+    auto skipped = toSet( excluded );
+    visitClips( trackKey( type, trackId ), begin, end, [&uuids, &skipped]( const Item& item )
+    {
+        if ( skipped.contains( item.uuid ) == false )
+            uuids.prepend( item.uuid );
+    } );
+    return uuids;
+}
+
+qint64
+TimelineModel::freePosition( const QString& type, quint32 trackId, qint64 pos, qint64 length,
+                             qint64 margin, qint64 fallback, const QStringList& excluded ) const
+{
+    auto track = trackKey( type, trackId );
+    auto skipped = toSet( excluded );
+    for ( auto step = 0; step < MaxPlacementSteps; ++step )
+    {
+        auto moved = false;
+        visitClips( track, pos - margin, pos + length - 1 + margin, [&]( const Item& item )
+        {
+            if ( moved == true || skipped.contains( item.uuid ) == true )
+                return;
+            // Before the clip if it starts after pos, after it otherwise
+            auto newPos = item.position - margin >= pos ? item.position - length : item.last + 1;
+            if ( newPos == pos )
+                return;
+            pos = newPos;
+            moved = true;
+        } );
+        if ( moved == false )
+            return pos;
+        if ( pos < 0 )
+            return fallback;
+    }
+    if ( collides( track, pos, pos + length - 1, skipped ) == false )
+        return pos;
+    // No gap is wide enough around pos, use the end of the track
+    auto clips = m_clips.constFind( track );
+    if ( clips == m_clips.cend() )
+        return pos;
+    for ( auto it = clips->crbegin(); it != clips->crend(); ++it )
+    {
+        if ( skipped.contains( it->second ) == false )
+            return m_items[m_rows.value( it->second )].last + 1;
+    }
+    return pos;
+}
+
+int
+TimelineModel::shotsRevision() const
+{
+    return m_shotsRevision;
+}
+
+QVariantList
+TimelineModel::shots( const QString& libraryUuid, qint64 begin, qint64 end ) const
+{
+    QVariantList list;
+    auto clip = Core::instance()->library()->clip( QUuid( libraryUuid ) );
+    if ( clip == nullptr )
+        return list;
+    const auto cuts = Core::instance()->library()->sceneCuts( clip->media()->id() );
+    for ( auto it = std::upper_bound( cuts.cbegin(), cuts.cend(), begin );
+          it != cuts.cend() && *it <= end; ++it )
+        list << *it - begin;
+    return list;
+}
+
+int
+TimelineModel::thumbnailsRevision() const
+{
+    return m_thumbnailsRevision;
+}
+
+int
+TimelineModel::peaksRevision() const
+{
+    return m_peaksRevision;
+}
+
+QVariantList
+TimelineModel::peaks( const QString& libraryUuid, qint64 begin, qint64 end, int count ) const
+{
+    QVariantList list;
+    auto clip = Core::instance()->library()->clip( QUuid( libraryUuid ) );
+    if ( clip == nullptr || count <= 0 || end < begin )
+        return list;
+    const auto peaks = Core::instance()->library()->peaks( clip->media()->id() );
+    if ( peaks.isEmpty() == true )
+        return list;
+    auto length = end - begin + 1;
+    for ( auto i = 0; i < count; ++i )
+    {
+        auto first = qBound<qint64>( 0, begin + length * i / count, peaks.size() - 1 );
+        auto last = qBound<qint64>( first, begin + length * ( i + 1 ) / count, peaks.size() );
+        int peak = 0;
+        for ( auto f = first; f < qMax( first + 1, last ); ++f )
+            peak = qMax( peak, static_cast<int>( static_cast<quint8>( peaks[static_cast<int>( f )] ) ) );
+        list << peak / 255.0;
+    }
+    return list;
+}
+
+qint64
+TimelineModel::snapToMarkers( qint64 pos, qint64 length, qint64 margin ) const
+{
+    return snap( m_markers, pos, length, margin, []( qint64 ) { return true; } );
+}
+
+qint64
+TimelineModel::snapToClips( qint64 pos, qint64 length, qint64 margin, const QString& type,
+                            quint32 trackId, const QStringList& excluded ) const
+{
+    auto it = m_edges.constFind( trackKey( type, trackId ) );
+    if ( it == m_edges.cend() )
+        return pos;
+    auto skipped = toSet( excluded );
+    return snap( *it, pos, length, margin, [&skipped]( const std::pair<const qint64, QString>& edge )
+    {
+        return skipped.contains( edge.second ) == false;
+    } );
+}
+
+void
+TimelineModel::setSelected( const QString& uuid, bool selected )
+{
+    auto it = m_rows.constFind( uuid );
+    if ( it == m_rows.cend() || m_items[*it].selected == selected )
+        return;
+    m_items[*it].selected = selected;
+    rowChanged( *it );
+}
+
+void
+TimelineModel::addPreview( const QVariantMap& info )
+{
+    Item item;
+    item.uuid = info.value( QStringLiteral( "uuid" ) ).toString();
+    item.libraryUuid = QUuid( info.value( QStringLiteral( "libraryUuid" ) ).toString() );
+    item.isTransition = info.value( QStringLiteral( "kind" ) ).toString() == QStringLiteral( "transition" );
+    item.isAudio = info.value( QStringLiteral( "type" ) ).toString() == QStringLiteral( "Audio" );
+    item.isPreview = true;
+    item.selected = info.value( QStringLiteral( "selected" ), true ).toBool();
+    item.trackId = info.value( QStringLiteral( "trackId" ) ).toUInt();
+    item.begin = info.value( QStringLiteral( "begin" ) ).toLongLong();
+    item.end = info.value( QStringLiteral( "end" ) ).toLongLong();
+    if ( item.isTransition == true )
+    {
+        item.position = item.begin;
+        item.last = item.end;
+        item.name = info.value( QStringLiteral( "identifier" ) ).toString();
+    }
+    else
+    {
+        item.position = info.value( QStringLiteral( "position" ) ).toLongLong();
+        item.last = item.position + item.end - item.begin;
+        item.name = info.value( QStringLiteral( "name" ) ).toString();
+    }
+    item.shownTrackId = item.trackId;
+    item.shownPosition = item.position;
+
+    auto row = m_items.size();
+    beginInsertRows( QModelIndex(), row, row );
+    m_items.append( item );
+    endInsertRows();
+}
+
+void
+TimelineModel::removePreview( const QString& uuid )
+{
+    for ( auto row = m_items.size() - 1; row >= 0; --row )
+    {
+        if ( m_items[row].isPreview == true && m_items[row].uuid == uuid )
+            remove( row );
+    }
+}
+
+void
+TimelineModel::setShownTrack( const QString& uuid, quint32 trackId, qint64 position )
+{
+    auto it = m_rows.constFind( uuid );
+    if ( it == m_rows.cend() )
+        return;
+    auto& item = m_items[*it];
+    if ( item.shownTrackId == trackId && item.shownPosition == position )
+        return;
+    item.shownTrackId = trackId;
+    item.shownPosition = position;
+    rowChanged( *it );
+}
+
+void
+TimelineModel::resetShownTracks()
+{
+    for ( auto row = 0; row < m_items.size(); ++row )
+    {
+        auto& item = m_items[row];
+        if ( item.shownTrackId == item.trackId && item.shownPosition == item.position )
+            continue;
+        item.shownTrackId = item.trackId;
+        item.shownPosition = item.position;
+        rowChanged( row );
+    }
+}
+
+void
+TimelineModel::addMarker( quint64 pos )
+{
+    m_markers.insert( pos );
+}
+
+void
+TimelineModel::moveMarker( quint64 from, quint64 to )
+{
+    removeMarker( from );
+    addMarker( to );
+}
+
+void
+TimelineModel::removeMarker( quint64 pos )
+{
+    auto it = m_markers.find( pos );
+    if ( it != m_markers.end() )
+        m_markers.erase( it );
+}
+
+quint64
+TimelineModel::trackKey( bool isAudio, quint32 trackId )
+{
+    return ( static_cast<quint64>( isAudio ) << 32 ) | trackId;
+}
+
+quint64
+TimelineModel::trackKey( const QString& type, quint32 trackId )
+{
+    return trackKey( type == QStringLiteral( "Audio" ), trackId );
+}
+
+QSet<QString>
+TimelineModel::toSet( const QStringList& uuids )
+{
+    QSet<QString> set;
+    for ( const auto& uuid : uuids )
+        set.insert( uuid );
+    return set;
+}
+
+bool
+TimelineModel::inRange( const TimelineModel::Item& item ) const
+{
+    if ( m_visibleEnd < 0 )
+        return true;
+    return item.shownPosition <= m_visibleEnd &&
+            item.shownPosition + item.last - item.position >= m_visibleBegin;
+}
+
+void
+TimelineModel::index( const TimelineModel::Item& item )
+{
+    if ( item.isTransition == true || item.isPreview == true )
+        return;
+    auto key = trackKey( item.isAudio, item.trackId );
+    m_clips[key].emplace( item.position, item.uuid );
+    auto& edges = m_edges[key];
+    edges.emplace( item.position, item.uuid );
+    edges.emplace( item.last, item.uuid );
+}
+
+void
+TimelineModel::unindex( const TimelineModel::Item& item )
+{
+    if ( item.isTransition == true || item.isPreview == true )
+        return;
+    auto key = trackKey( item.isAudio, item.trackId );
+    eraseEdge( m_clips[key], item.position, item.uuid );
+    auto& edges = m_edges[key];
+    eraseEdge( edges, item.position, item.uuid );
+    eraseEdge( edges, item.last, item.uuid );
+}
+
+template <typename F>
+void
+TimelineModel::visitClips( quint64 track, qint64 begin, qint64 end, F f ) const
+{
+    auto clips = m_clips.constFind( track );
+    if ( clips == m_clips.cend() )
+        return;
+    auto it = clips->upper_bound( end );
+    while ( it != clips->begin() )
+    {
+        --it;
+        const auto& item = m_items[m_rows.value( it->second )];
+        if ( item.last >= begin )
+            f( item );
+        // Clips of a track don't overlap, so no earlier clip can reach begin
+        else if ( item.position < begin )
+            break;
+    }
+}
+
+bool
+TimelineModel::collides( quint64 track, qint64 begin, qint64 end, const QSet<QString>& excluded ) const
+{
+    auto found = false;
+    visitClips( track, begin, end, [&found, &excluded]( const Item& item )
+    {
+        if ( excluded.contains( item.uuid ) == false )
+            found = true;
+    } );
+    return found;
+}
+
+void
+TimelineModel::rowChanged( int row )
+{
+    // No role list, the track models filter on several roles
+    emit dataChanged( QAbstractListModel::index( row ), QAbstractListModel::index( row ) );
+}
+
+TimelineModel::Item
+TimelineModel::clipItem( const QUuid& uuid ) const
+{
+    Item item;
+    auto record = m_workflow->sequenceState().clip( uuid );
+    if ( record == nullptr )
+        return item;
+    item.uuid = uuid.toString();
+    item.libraryUuid = record->clipUuid;
+    item.isTransition = false;
+    item.isAudio = record->isAudio;
+    item.isPreview = false;
+    item.selected = false;
+    item.trackId = record->trackId;
+    item.position = record->pos;
+    item.last = record->pos + record->end - record->begin;
+    item.begin = record->begin;
+    item.end = record->end;
+    item.shownTrackId = item.trackId;
+    item.shownPosition = item.position;
+    auto clip = Core::instance()->library()->clip( record->clipUuid );
+    if ( clip != nullptr )
+        item.name = clip->media()->title();
+    for ( const auto& linkedClip : record->linkedClips )
+        item.linkedClips << linkedClip.toString();
+    return item;
+}
+
+TimelineModel::Item
+TimelineModel::transitionItem( const QUuid& uuid ) const
+{
+    Item item;
+    auto record = m_workflow->sequenceState().transition( uuid );
+    if ( record == nullptr )
+        return item;
+    item.uuid = uuid.toString();
+    item.isTransition = true;
+    item.isAudio = record->isAudio;
+    item.isPreview = false;
+    item.selected = false;
+    // The timeline shows a transition between two tracks on the second one
+    item.trackId = record->isInTrack == true ? record->trackAId : record->trackBId;
+    item.position = record->begin;
+    item.last = record->end;
+    item.begin = record->begin;
+    item.end = record->end;
+    item.shownTrackId = item.trackId;
+    item.shownPosition = item.position;
+    item.name = record->identifier;
+    return item;
+}
+
+void
+TimelineModel::insert( const TimelineModel::Item& item )
+{
+    if ( item.uuid.isEmpty() == true )
+        return;
+    if ( m_rows.contains( item.uuid ) == true )
+    {
+        update( item );
+        return;
+    }
+    auto row = m_items.size();
+    beginInsertRows( QModelIndex(), row, row );
+    m_items.append( item );
+    m_rows[item.uuid] = row;
+    index( item );
+    endInsertRows();
+}
+
+void
+TimelineModel::update( const TimelineModel::Item& item )
+{
+    auto it = m_rows.constFind( item.uuid );
+    if ( it == m_rows.cend() )
+        return;
+    auto row = *it;
+    auto& current = m_items[row];
+    unindex( current );
+    auto selected = current.selected;
+    current = item;
+    current.selected = selected;
+    index( current );
+    rowChanged( row );
+}
+
+void
+TimelineModel::remove( int row )
+{
+    beginRemoveRows( QModelIndex(), row, row );
+    unindex( m_items[row] );
+    if ( m_items[row].isPreview == false )
+        m_rows.remove( m_items[row].uuid );
+    m_items.remove( row );
+    for ( auto i = row; i < m_items.size(); ++i )
+    {
+        if ( m_items[i].isPreview == false )
+            m_rows[m_items[i].uuid] = i;
+    }
+    endRemoveRows();
+}
+
+void
+TimelineModel::reset()
+{
+    beginResetModel();
+    m_items.clear();
+    m_rows.clear();
+    m_clips.clear();
+    m_edges.clear();
+    auto state = m_workflow->sequenceState();
+    for ( auto it = state.clips().cbegin(); it != state.clips().cend(); ++it )
+    {
+        auto item = clipItem( it.key() );
+        m_rows[item.uuid] = m_items.size();
+        m_items.append( item );
+        index( item );
+    }
+    for ( auto it = state.transitions().cbegin(); it != state.transitions().cend(); ++it )
+    {
+        auto item = transitionItem( it.key() );
+        m_rows[item.uuid] = m_items.size();
+        m_items.append( item );
+    }
+    endResetModel();
+}
+
+void
+TimelineModel::clipAdded( const QString& uuid )
+{
+    insert( clipItem( QUuid( uuid ) ) );
+}
+
+void
+TimelineModel::clipChanged( const QString& uuid )
+{
+    update( clipItem( QUuid( uuid ) ) );
+}
+
+void
+TimelineModel::clipRemoved( const QString& uuid )
+{
+    auto row = m_rows.value( QUuid( uuid ).toString(), -1 );
+    if ( row >= 0 )
+        remove( row );
+}
+
+void
+TimelineModel::clipLinkChanged( const QString& uuidA, const QString& uuidB )
+{
+    update( clipItem( QUuid( uuidA ) ) );
+    update( clipItem( QUuid( uuidB ) ) );
+}
+
+void
+TimelineModel::transitionAdded( const QString& uuid )
+{
+    insert( transitionItem( QUuid( uuid ) ) );
+}
+
+void
+TimelineModel::transitionChanged( const QString& uuid )
+{
+    update( transitionItem( QUuid( uuid ) ) );
+}
+
+void
+TimelineModel::transitionRemoved( const QString& uuid )
+{
+    auto row = m_rows.value( QUuid( uuid ).toString(), -1 );
+    if ( row >= 0 )
+        remove( row );
+}
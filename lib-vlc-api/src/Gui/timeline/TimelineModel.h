@@ -0,0 +1,265 @@
+/*****************************************************************************
+ * TimelineModel.h: Item model of the timeline clips and transitions
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef TIMELINEMODEL_H
+#define TIMELINEMODEL_H
+
+#include <QAbstractListModel>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QUuid>
+#include <QVector>
+
+#include <map>
+#include <set>
+
+class MainWorkflow;
+class QSortFilterProxyModel;
+
+/**
+ *  @brief  Mirrors the sequence clips and transitions for the QML timeline.
+ *
+ *  The model is fed incrementally from the workflow signals: each signal only
+ *  touches the row of the modified element, which is found through a hash of
+ *  the uuids instead of walking every track. It also keeps per track indexes
+ *  of the clips and of their edges, so that collisions and magnetic snapping
+ *  cost O(log n) while dragging.
+ *
+ *  Each track of the view shows a filtered model of its own, which drops the
+ *  elements lying outside of the visible range: their delegates are only
+ *  created once they get close to the view. Selected elements and the previews
+ *  of the elements being dropped are always kept, since a drag handles them.
+ */
+class TimelineModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_DISABLE_COPY( TimelineModel )
+
+    Q_PROPERTY( qint64 visibleBegin READ visibleBegin NOTIFY visibleRangeChanged )
+    Q_PROPERTY( qint64 visibleEnd READ visibleEnd NOTIFY visibleRangeChanged )
+    // Changes whenever scene cuts are detected, for bindings calling shots()
+    Q_PROPERTY( int shotsRevision READ shotsRevision NOTIFY shotsChanged )
+    // Changes whenever thumbnails are computed, to reload the thumbnail images
+    Q_PROPERTY( int thumbnailsRevision READ thumbnailsRevision NOTIFY thumbnailsChanged )
+    // Changes whenever audio peaks are computed, for bindings calling peaks()
+    Q_PROPERTY( int peaksRevision READ peaksRevision NOTIFY peaksChanged )
+
+public:
+    enum Roles
+    {
+        UuidRole = Qt::UserRole + 1,
+        LibraryUuidRole,
+        KindRole,
+        TypeRole,
+        TrackIdRole,
+        PositionRole,
+        BeginRole,
+        EndRole,
+        LengthRole,
+        NameRole,
+        IdentifierRole,
+        LinkedClipsRole,
+        InRangeRole,
+        SelectedRole,
+        PreviewRole,
+    };
+
+    explicit TimelineModel( MainWorkflow* workflow, QObject* parent = nullptr );
+
+    virtual int                     rowCount( const QModelIndex& parent = QModelIndex() ) const override;
+    virtual QVariant                data( const QModelIndex& index, int role = Qt::DisplayRole ) const override;
+    virtual QHash<int, QByteArray>  roleNames() const override;
+
+    qint64                  visibleBegin() const;
+    qint64                  visibleEnd() const;
+
+    /**
+     *  @brief  Sets the frames shown by the view. A negative end means everything.
+     */
+    Q_INVOKABLE void        setVisibleRange( qint64 begin, qint64 end );
+    /**
+     *  @brief  Returns the elements of a kind ("clip" or "transition") shown on a track.
+     *
+     *  The model is owned by this one, and shared by every caller.
+     */
+    Q_INVOKABLE QObject*    trackModel( const QString& kind, const QString& type, quint32 trackId );
+    /**
+     *  @brief  Returns the number of tracks of a type holding clips.
+     */
+    Q_INVOKABLE int         trackCount( const QString& type ) const;
+
+    /**
+     *  @brief  Returns every role of an element, or an empty map if it is unknown.
+     */
+    Q_INVOKABLE QVariantMap get( const QString& uuid ) const;
+    /**
+     *  @brief  Lists the clips of a track overlapping [begin, end], ordered by position.
+     */
+    Q_INVOKABLE QStringList clipsAt( const QString& type, quint32 trackId, qint64 begin,
+                                     qint64 end, const QStringList& excluded = QStringList() ) const;
+    /**
+     *  @brief  Finds where [pos, pos + length - 1] fits between the clips of a track.
+     *
+     *  The range sticks to the clips less than margin frames away, and is moved
+     *  past the ones it overlaps.
+     *  @return The new position, fallback if it would become negative, or the
+     *          end of the track if the gaps around pos are too narrow.
+     */
+    Q_INVOKABLE qint64      freePosition( const QString& type, quint32 trackId, qint64 pos, qint64 length,
+                                          qint64 margin, qint64 fallback,
+                                          const QStringList& excluded = QStringList() ) const;
+
+    /**
+     *  @brief  Moves [pos, pos + length - 1] so that one of its edges sticks to
+     *          the closest marker less than margin frames away.
+     *  @return The new position, or pos if no marker is close enough.
+     */
+    Q_INVOKABLE qint64      snapToMarkers( qint64 pos, qint64 length, qint64 margin ) const;
+    /**
+     *  @brief  Same as snapToMarkers, using the clip edges of a track.
+     */
+    Q_INVOKABLE qint64      snapToClips( qint64 pos, qint64 length, qint64 margin, const QString& type,
+                                         quint32 trackId, const QStringList& excluded = QStringList() ) const;
+
+    Q_INVOKABLE void        setSelected( const QString& uuid, bool selected );
+    /**
+     *  @brief  Shows an element which isn't part of the sequence yet, ie. while it is dropped.
+     *
+     *  The info map holds the roles of the element. Previews are never indexed,
+     *  and several of them may share the same uuid.
+     */
+    Q_INVOKABLE void        addPreview( const QVariantMap& info );
+    /**
+     *  @brief  Removes every preview using this uuid.
+     */
+    Q_INVOKABLE void        removePreview( const QString& uuid );
+    /**
+     *  @brief  Shows a clip on another track while it is dragged, without moving it.
+     */
+    Q_INVOKABLE void        setShownTrack( const QString& uuid, quint32 trackId, qint64 position );
+    /**
+     *  @brief  Shows the clips where the sequence has them again, once a drag is over.
+     */
+    Q_INVOKABLE void        resetShownTracks();
+
+    int                     shotsRevision() const;
+    /**
+     *  @brief  Lists the shot boundaries inside a part of a library clip.
+     *  @return The first frame of each shot starting in ]begin, end], relative to begin
+     */
+    Q_INVOKABLE QVariantList    shots( const QString& libraryUuid, qint64 begin, qint64 end ) const;
+
+    int                     thumbnailsRevision() const;
+    int                     peaksRevision() const;
+    /**
+     *  @brief  Summarizes the audio peaks of a part of a library clip, for a waveform.
+     *  @return count values from 0 to 1, the loudest peak of each slice of [begin, end],
+     *          or an empty list until the media has been analyzed
+     */
+    Q_INVOKABLE QVariantList    peaks( const QString& libraryUuid, qint64 begin, qint64 end, int count ) const;
+
+public slots:
+    void                    addMarker( quint64 pos );
+    void                    moveMarker( quint64 from, quint64 to );
+    void                    removeMarker( quint64 pos );
+
+signals:
+    void                    visibleRangeChanged();
+    void                    shotsChanged();
+    void                    thumbnailsChanged();
+    void                    peaksChanged();
+
+private:
+    struct Item
+    {
+        QString             uuid;
+        QUuid               libraryUuid;
+        bool                isTransition;
+        bool                isAudio;
+        bool                isPreview;
+        bool                selected;
+        quint32             trackId;
+        // First and last frames on the timeline
+        qint64              position;
+        qint64              last;
+        // The clip bounds in its media, or the transition bounds
+        qint64              begin;
+        qint64              end;
+        // Where the view shows the element, which differs while it is dragged
+        quint32             shownTrackId;
+        qint64              shownPosition;
+        QString             name;
+        QStringList         linkedClips;
+    };
+
+    static quint64          trackKey( bool isAudio, quint32 trackId );
+    static quint64          trackKey( const QString& type, quint32 trackId );
+    static QSet<QString>    toSet( const QStringList& uuids );
+
+    bool                    inRange( const Item& item ) const;
+    void                    index( const Item& item );
+    void                    unindex( const Item& item );
+    /**
+     *  @brief  Calls f for each clip of the track overlapping [begin, end], from the last one.
+     */
+    template <typename F>
+    void                    visitClips( quint64 track, qint64 begin, qint64 end, F f ) const;
+    bool                    collides( quint64 track, qint64 begin, qint64 end,
+                                      const QSet<QString>& excluded ) const;
+    void                    rowChanged( int row );
+
+    Item                    clipItem( const QUuid& uuid ) const;
+    Item                    transitionItem( const QUuid& uuid ) const;
+    void                    insert( const Item& item );
+    void                    update( const Item& item );
+    void                    remove( int row );
+    void                    reset();
+
+private slots:
+    void                    clipAdded( const QString& uuid );
+    void                    clipChanged( const QString& uuid );
+    void                    clipRemoved( const QString& uuid );
+    void                    clipLinkChanged( const QString& uuidA, const QString& uuidB );
+    void                    transitionAdded( const QString& uuid );
+    void                    transitionChanged( const QString& uuid );
+    void                    transitionRemoved( const QString& uuid );
+
+private:
+    MainWorkflow*           m_workflow;
+    QVector<Item>           m_items;
+    // Rows of the elements of the sequence, previews excluded
+    QHash<QString, int>     m_rows;
+    // Clips by first frame, for each track. Clips of a track never overlap.
+    QHash<quint64, std::multimap<qint64, QString>> m_clips;
+    // Clip first and last frames, for each track
+    QHash<quint64, std::multimap<qint64, QString>> m_edges;
+    std::multiset<qint64>   m_markers;
+    QHash<QString, QSortFilterProxyModel*>  m_trackModels;
+    qint64                  m_visibleBegin;
+    qint64                  m_visibleEnd;
+    int                     m_shotsRevision;
+    int                     m_thumbnailsRevision;
+    int                     m_peaksRevision;
+};
+
+#endif // TIMELINEMODEL_H
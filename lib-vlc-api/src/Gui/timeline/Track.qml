@@ -8,8 +8,6 @@ Item {
 
     property int trackId
     property string type
-    property ListModel clips
-    property ListModel transitionModel
 
     Item {
         id: clipArea
@@ -54,17 +52,15 @@ Item {
 
             onDropped: {
                 if ( mode === dropMode.New ) {
-                    aClipInfo = findClipFromTrack( "Audio", trackId, "audioUuid" );
-                    vClipInfo = findClipFromTrack( "Video", trackId, "videoUuid" );
+                    var aClip = findClipItem( "audioUuid" );
+                    var vClip = findClipItem( "videoUuid" );
                     var pos = 0;
-                    if ( aClipInfo ) {
-                        pos = aClipInfo["position"];
-                        removeClipFromTrack( "Audio", trackId, "audioUuid" );
-                    }
-                    if ( vClipInfo ) {
-                        pos = vClipInfo["position"];
-                        removeClipFromTrack( "Video", trackId, "videoUuid" );
-                    }
+                    if ( aClipInfo && aClip )
+                        pos = aClip.position;
+                    if ( vClipInfo && vClip )
+                        pos = vClip.position;
+                    timelineModel.removePreview( "audioUuid" );
+                    timelineModel.removePreview( "videoUuid" );
                     workflow.addClip( drop.getDataAsString("vlmc/uuid"), trackId, pos, false );
                     currentUuid = "";
                     aClipInfo = null;
@@ -78,7 +74,7 @@ Item {
                     workflow.addTransitionBetweenTracks(
                         transition.identifier, transition.begin, transition.end,
                         transition.trackId - 1, transition.trackId, transition.type );
-                    removeTransitionFromTrack( type, trackId, "transitionUuid" );
+                    timelineModel.removePreview( "transitionUuid" );
                     currentUuid = "";
 
                 }
@@ -86,11 +82,11 @@ Item {
 
             onExited: {
                 if ( currentUuid === "transitionUuid" ) {
-                    removeTransitionFromTrack( type, trackId, "transitionUuid" );
+                    timelineModel.removePreview( "transitionUuid" );
                 }
                 else if ( currentUuid !== "" ) {
-                    removeClipFromTrack( "Audio", trackId, "audioUuid" );
-                    removeClipFromTrack( "Video", trackId, "videoUuid" );
+                    timelineModel.removePreview( "audioUuid" );
+                    timelineModel.removePreview( "videoUuid" );
                 }
             }
 
@@ -206,10 +202,8 @@ Item {
                              newTrackId = trackId - oldTrackId + target.trackId;
                             target.newTrackId = Math.max( 0, newTrackId );
                             if ( target.newTrackId !== target.trackId ) {
-                                // Let's move to the new tracks
-                                target.clipInfo["selected"] = true;
-                                addClip( target.type, target.newTrackId, target.clipInfo );
-                                removeClipFromTrack( target.type, target.trackId, target.uuid );
+                                // Let's move to the new tracks, the sequence is only updated on drop
+                                timelineModel.setShownTrack( target.uuid, target.newTrackId, target.position );
                             }
                         }
                     }
@@ -286,50 +280,57 @@ Item {
                         return;
                     }
 
+                    // The sequence has the final say, the drag stops where it refuses a clip
+                    if ( mode === dropMode.Move ) {
+                        for ( i = 0; i < selectedClips.length; ++i ) {
+                            target = findClipItem( selectedClips[i] );
+                            if ( workflow.canMoveClip( target.uuid, target.newTrackId,
+                                                       target.position + deltaPos ) === false ) {
+                                drag.source.forcePosition();
+                                return;
+                            }
+                        }
+                    }
+
                     for ( i = 0; i < selectedClips.length; ++i ) {
                         target = findClipItem( selectedClips[i] );
                         newPos = target.position + deltaPos;
 
-                        var currentTrack = trackContainer( target.type )["tracks"].get( target.newTrackId );
-                        if ( currentTrack )
-                        {
-                            var clips = currentTrack["clips"];
-                            for ( var j = 0; j < clips.count; ++j )  {
-                                var clip = clips.get( j );
-                                if ( clip.uuid === target.uuid ||
-                                     ( clip.uuid === drag.source.uuid && target.newTrackId !== drag.source.newTrackId )
-                                   )
-                                    continue;
-                                var cPos = clip.uuid === drag.source.uuid ? ptof( drag.source.x ) : clip["position"];
-                                var cEndPos = clip["position"] + clip["length"] - 1;
-                                // If they overlap, create a cross-dissolve transition
-                                if ( cEndPos >= newPos && newPos + target.length - 1 >= cPos )
-                                {
-                                    var toCreate = true;
-                                    for ( var k = 0; k < allTransitions.length; ++k ) {
-                                        var transitionItem = allTransitions[k];
-                                        if ( transitionItem.trackId === clip.trackId &&
-                                             transitionItem.type === clip.type &&
-                                             transitionItem.isCrossDissolve === true &&
-                                             transitionItem.clips.indexOf( clip.uuid ) !== -1 &&
-                                             transitionItem.clips.indexOf( target.uuid ) !== -1
-                                            ) {
-                                            transitionItem.begin = Math.max( newPos, cPos );
-                                            transitionItem.end = Math.min( newPos + target.length - 1, cEndPos );
-                                            toCreate = false;
-                                        }
-                                    }
-                                    if ( toCreate === true ) {
-                                        addTransition( target.type, target.newTrackId,
-                                                        { "begin": Math.max( newPos, cPos ),
-                                                          "end": Math.min( newPos + target.length - 1, cEndPos ),
-                                                          "identifier": "dissolve",
-                                                          "uuid": "transitionUuid" } );
-                                        transitionItem = allTransitions[allTransitions.length - 1];
-                                        transitionItem.clips.push( clip.uuid );
-                                        transitionItem.clips.push( target.uuid );
+                        var overlapping = timelineModel.clipsAt( target.type, target.newTrackId, newPos,
+                                                                 newPos + target.length - 1, [target.uuid] );
+                        for ( var j = 0; j < overlapping.length; ++j )  {
+                            var clip = timelineModel.get( overlapping[j] );
+                            if ( clip.uuid === drag.source.uuid && target.newTrackId !== drag.source.newTrackId )
+                                continue;
+                            var cPos = clip.uuid === drag.source.uuid ? ptof( drag.source.x ) : clip["position"];
+                            var cEndPos = clip["position"] + clip["length"] - 1;
+                            // If they overlap, create a cross-dissolve transition
+                            if ( cEndPos >= newPos && newPos + target.length - 1 >= cPos )
+                            {
+                                var toCreate = true;
+                                for ( var k = 0; k < allTransitions.length; ++k ) {
+                                    var transitionItem = allTransitions[k];
+                                    if ( transitionItem.trackId === clip.trackId &&
+                                         transitionItem.type === clip.type &&
+                                         transitionItem.isCrossDissolve === true &&
+                                         transitionItem.clips.indexOf( clip.uuid ) !== -1 &&
+                                         transitionItem.clips.indexOf( target.uuid ) !== -1
+                                        ) {
+                                        transitionItem.begin = Math.max( newPos, cPos );
+                                        transitionItem.end = Math.min( newPos + target.length - 1, cEndPos );
+                                        toCreate = false;
                                     }
                                 }
+                                if ( toCreate === true ) {
+                                    addTransition( target.type, target.newTrackId,
+                                                    { "begin": Math.max( newPos, cPos ),
+                                                      "end": Math.min( newPos + target.length - 1, cEndPos ),
+                                                      "identifier": "dissolve",
+                                                      "uuid": "transitionUuid" } );
+                                    transitionItem = allTransitions[allTransitions.length - 1];
+                                    transitionItem.clips.push( clip.uuid );
+                                    transitionItem.clips.push( target.uuid );
+                                }
                             }
                         }
 
@@ -359,7 +360,8 @@ Item {
 
         Repeater {
             id: clipRepeater
-            model: clips
+            // Only the clips close to the view get a delegate
+            model: timelineModel.trackModel( "clip", track.type, track.trackId )
             delegate: Clip {
                 height: track.height - 3
                 name: model.name
@@ -371,13 +373,14 @@ Item {
                 begin: model.begin
                 end: model.end
                 length: model.length
+                linkedClips: model.linkedClips
                 clipInfo: model
             }
         }
 
         Repeater {
             id: transitionRepeater
-            model: transitionModel
+            model: timelineModel.trackModel( "transition", track.type, track.trackId )
             delegate: TransitionItem {
                 identifier: model.identifier
                 uuid: model.uuid
@@ -19,8 +19,6 @@ Rectangle {
         delegate: Track {
             trackId: index
             type: container.type
-            clips: model["clips"]
-            transitionModel: model["transitions"]
         }
     }
 }
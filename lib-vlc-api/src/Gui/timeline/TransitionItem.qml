@@ -28,16 +28,11 @@ Rectangle {
     property int trackId
     property string type
     property var clips: [] // clips overlapping
-    property var transitionInfo
+    property var transitionInfo // Its row in the timeline model
 
     Drag.keys: ["Transition"]
     Drag.active: mouseArea.drag.active
 
-    onUuidChanged: {
-        transitionInfo["uuid"] = uuid;
-        allTransitionsDict[uuid] = transition;
-    }
-
     Component.onCompleted: {
         allTransitions.push( transition );
         if ( uuid )
@@ -46,6 +41,8 @@ Rectangle {
 
     Component.onDestruction: {
         Drag.drop();
+        if ( allTransitionsDict[uuid] === transition )
+            delete allTransitionsDict[uuid];
         for ( var i = 0; i < allTransitions.length; ++i ) {
             if ( allTransitions[i] === transition ) {
                 allTransitions.splice( i, 1 );
@@ -151,7 +148,7 @@ Rectangle {
         onReleased: {
             if ( transitionInfo["begin"] !== begin || transitionInfo["end"] !== end )
                 workflow.moveTransition( uuid, begin, end );
-            if ( transitionInfo["trackBId"] !== trackId )
+            if ( inTrack === false && transitionInfo["trackId"] !== trackId )
                 workflow.moveTransitionBetweenTracks( uuid, trackId - 1, trackId );
         }
 
@@ -23,7 +23,6 @@ Rectangle {
     property var allTransitions: [] // Actual transition item objects
     property var allTransitionsDict: ({}) // Actual transition item objects
     property var groups: [] // list of lists of clip uuids
-    property var linkedClipsDict: ({}) // Uuid
     property alias isMagneticMode: magneticModeButton.selected
     property bool isCutMode: false
     property bool isTransitionMode: transitionModeButton.selected
@@ -34,116 +33,50 @@ Rectangle {
 
     function findNewPosition( newPos, target, dragSource, useMagneticMode ) {
         if ( useMagneticMode === true ) {
-            var leastDistance = ptof( magneticMargin );
-            // Check two times
-            for ( var k = 0; k < 2; ++k ) {
-                for ( var j = 0; j < markers.count; ++j ) {
-                    var mPos = markers.get( j ).position;
-                    if ( Math.abs( newPos - mPos ) < leastDistance ) {
-                        leastDistance = Math.abs( newPos - mPos );
-                        newPos = mPos;
-                    }
-                    else if ( Math.abs( newPos + target.length - 1 - mPos ) < leastDistance ) {
-                        leastDistance = Math.abs( newPos + target.length - 1 - mPos );
-                        newPos = mPos - target.length + 1;
-                    }
-                }
-            }
+            newPos = timelineModel.snapToMarkers( newPos, target.length, ptof( magneticMargin ) );
             // Magnet for the left edge of the timeline
             if ( newPos < ptof( magneticMargin ) )
                 newPos = 0;
         }
 
-        // Collision detection
-        var isCollided = true;
-        var currentTrack = trackContainer( target.type )["tracks"].get( target.newTrackId );
-        if ( currentTrack )
-            var clips = currentTrack["clips"];
-        else
-            return target.position;
-        for ( j = 0; j < clips.count + 2 && isCollided; ++j ) {
-            isCollided = false;
-            for ( k = 0; k < clips.count; ++k ) {
-                var clip = clips.get( k );
-                if ( clip.uuid === target.uuid ||
-                     ( clip.uuid === dragSource.uuid && target.newTrackId !== dragSource.newTrackId )
-                   )
-                    continue;
-                var cPos = clip.uuid === dragSource.uuid ? ptof( dragSource.x ) : clip["position"];
-                var cEndPos = clip["position"] + clip["length"] - 1;
-
-                // Note that in transition mode, they will never collide.
-                if ( isTransitionMode === true ) {
-                    leastDistance = ptof( magneticMargin );
-                    if ( Math.abs( newPos - cPos ) < leastDistance ) {
-                        leastDistance = Math.abs( newPos - cPos );
-                        newPos = cPos;
-                    }
-                    if ( Math.abs( newPos + target.length - 1 - cPos ) < leastDistance ) {
-                        leastDistance = Math.abs( newPos + target.length - 1 - cPos );
-                        newPos = cPos - target.length + 1;
-                    }
-                    if ( Math.abs( newPos - cEndPos ) < leastDistance ) {
-                        leastDistance = Math.abs( newPos - cEndPos );
-                        newPos = cEndPos;
-                    }
-                    if ( Math.abs( newPos + target.length - 1 - cEndPos ) < leastDistance ) {
-                        leastDistance = Math.abs( newPos + target.length - 1 - cEndPos );
-                        newPos = cEndPos - target.length + 1;
-                    }
-                }
-                else {
-                    // In theory, they share the same deltaPos, therefore unable to collide each other.
-                    if ( findClipItem( clip.uuid ).selected === true )
-                        continue;
-
-                    if ( cEndPos >= newPos && newPos + target.length - 1 >= cPos )
-                        isCollided = true;
-
-                    // HACK: If magnetic mode, consider clips bigger
-                    var clipMargin = useMagneticMode ? ptof( magneticMargin ) : 0;
-                    cPos -= clipMargin;
-                    cEndPos += clipMargin;
-                    if ( cEndPos >= newPos && newPos + target.length - 1 >= cPos ) {
-                        if ( cPos >= newPos ) {
-                            if ( cPos - target.length + clipMargin >= 0 )
-                                newPos = cPos - target.length + clipMargin;
-                            else
-                                newPos = target.position;
-                        } else {
-                            newPos = cEndPos - clipMargin + 1;
-                        }
-                    }
-                }
+        // Note that in transition mode, they will never collide.
+        if ( isTransitionMode === true )
+            return timelineModel.snapToClips( newPos, target.length, ptof( magneticMargin ),
+                                              target.type, target.newTrackId, [target.uuid] );
 
-                if ( isCollided )
-                    break;
-            }
-        }
-
-        if ( isCollided ) {
-            for ( k = 0; k < clips.count; ++k ) {
-                clip = clips.get( k );
-                if ( clip.uuid === target.uuid ||
-                     ( clip.uuid === dragSource.uuid && target.newTrackId !== dragSource.newTrackId ) )
-                    continue;
-                cPos = clip.uuid === dragSource.uuid ? ptof( dragSource.x ) : clip["position"];
-                cEndPos = clip["position"] + clip["length"] - 1;
-                newPos = Math.max( newPos, cEndPos + 1 );
-            }
-        }
+        // In theory, the selected clips share the same deltaPos, therefore unable to collide each other.
+        // HACK: If magnetic mode, consider clips bigger
+        return timelineModel.freePosition( target.type, target.newTrackId, newPos, target.length,
+                                           useMagneticMode ? ptof( magneticMargin ) : 0,
+                                           target.position, selectedClips.concat( [target.uuid] ) );
+    }
 
-        return newPos;
+    // Only the clips around the visible part of the timeline are drawn
+    function updateVisibleRange() {
+        var contentX = sView.flickableItem.contentX - initPosOfCursor;
+        timelineModel.setVisibleRange( Math.max( ptof( contentX - sView.width ), 0 ),
+                                       ptof( contentX + 2 * sView.width ) );
     }
 
     function clearSelectedClips() {
         while ( selectedClips.length ) {
-            var clip = findClipItem( selectedClips.pop() );
+            var uuid = selectedClips.pop();
+            var clip = findClipItem( uuid );
             if ( clip )
                 clip.selected = false;
+            timelineModel.setSelected( uuid, false );
         }
     }
 
+    function selectClip( uuid ) {
+        var clip = findClipItem( uuid );
+        if ( clip )
+            clip.selected = true;
+        else
+            // Its delegate gets created if it was offscreen, and restores the selection
+            timelineModel.setSelected( uuid, true );
+    }
+
     function zerofill( number, width ) {
         var str = "" + number;
         while ( str.length < width ) {
@@ -186,7 +119,7 @@ Rectangle {
 
     function addTrack( trackType )
     {
-        trackContainer( trackType )["tracks"].append( { "clips": [], "transitions": [] } );
+        trackContainer( trackType )["tracks"].append( { "type": trackType } );
     }
 
     function removeTrack( trackType )
@@ -195,9 +128,11 @@ Rectangle {
         tracks.remove( tracks.count - 1 );
     }
 
+    // Shows a clip dragged from the library until it is dropped
     function addClip( trackType, trackId, clipDict )
     {
         var newDict = {};
+        newDict["kind"] = "clip";
         newDict["begin"] = clipDict["begin"];
         newDict["end"] = clipDict["end"];
         newDict["position"] = clipDict["position"];
@@ -208,150 +143,25 @@ Rectangle {
         newDict["type"] = trackType;
         newDict["name"] = clipDict["name"];
         newDict["selected"] = clipDict["selected"] === false ? false : true ;
-        var tracks = trackContainer( trackType )["tracks"];
-        while ( trackId > tracks.count - 1 )
-            addTrack( trackType );
-        tracks.get( trackId )["clips"].append( newDict );
+        timelineModel.addPreview( newDict );
         return newDict;
     }
 
-    function removeClipFromTrack( trackType, trackId, uuid )
-    {
-        var ret = false;
-        var tracks = trackContainer( trackType )["tracks"];
-        var clips = tracks.get( trackId )["clips"];
-
-        for ( var j = 0; j < clips.count; j++ ) {
-            var clip = clips.get( j );
-            if ( clip.uuid === uuid ) {
-                clips.remove( j );
-                ret = true;
-                j--;
-            }
-        }
-        return ret;
-    }
-
-    function removeClipFromTrackContainer( trackType, uuid )
-    {
-        for ( var i = 0; i < trackContainer( trackType )["tracks"].count; i++  )
-            removeClipFromTrack( trackType, i, uuid );
-    }
-
-    function removeClip( uuid )
-    {
-        removeClipFromTrackContainer( "Audio", uuid );
-        removeClipFromTrackContainer( "Video", uuid );
-    }
-
-    function findClipFromTrackContainer( trackType, uuid )
-    {
-        var tracks = trackContainer( trackType )["tracks"];
-        for ( var i = 0; i < tracks.count; i++  ) {
-            var clip = findClipFromTrack( trackType, i, uuid );
-            if( clip )
-                return clip;
-        }
-
-        return null;
-    }
-
-    function findClipFromTrack( trackType, trackId, uuid )
-    {
-        var clips = trackContainer( trackType )["tracks"].get( trackId )["clips"];
-        for ( var j = 0; j < clips.count; j++ ) {
-            var clip = clips.get( j );
-            if ( clip.uuid === uuid )
-                return clip;
-        }
-        return null;
-    }
-
-    function findClip( uuid )
-    {
-        var v = findClipFromTrackContainer( "Video", uuid );
-        if ( !v )
-            return findClipFromTrackContainer( "Audio", uuid );
-        return v;
-    }
-
+    // Shows a transition until it is dropped or the drag is over
     function addTransition( trackType, trackId, transitionDict )
     {
         var newDict = {};
+        newDict["kind"] = "transition";
         newDict["begin"] = transitionDict["begin"];
         newDict["end"] = transitionDict["end"];
         newDict["uuid"] = transitionDict["uuid"];
         newDict["trackId"] = trackId;
         newDict["type"] = trackType;
         newDict["identifier"] = transitionDict["identifier"];
-        newDict["name"] = transitionDict["name"];
-        var tracks = trackContainer( trackType )["tracks"];
-        while ( trackId > tracks.count - 1 )
-            addTrack( trackType );
-        tracks.get( trackId )["transitions"].append( newDict );
+        timelineModel.addPreview( newDict );
         return newDict;
     }
 
-    function removeTransitionFromTrack( trackType, trackId, uuid )
-    {
-        var ret = false;
-        var tracks = trackContainer( trackType )["tracks"];
-        var trans = tracks.get( trackId )["transitions"];
-
-        for ( var j = 0; j < trans.count; j++ ) {
-            var t = trans.get( j );
-            if ( t.uuid === uuid ) {
-                trans.remove( j );
-                ret = true;
-                j--;
-            }
-        }
-        return ret;
-    }
-
-    function removeTransitionFromTrackContainer( trackType, uuid )
-    {
-        for ( var i = 0; i < trackContainer( trackType )["tracks"].count; ++i )
-            removeTransitionFromTrack( trackType, i, uuid );
-    }
-
-    function removeTransition( uuid )
-    {
-        removeTransitionFromTrackContainer( "Audio", uuid );
-        removeTransitionFromTrackContainer( "Video", uuid );
-    }
-
-    function findTransitionFromTrack( trackType, trackId, uuid )
-    {
-        var trans = trackContainer( trackType )["tracks"].get( trackId )["transitions"];
-        for ( var j = 0; j < trans.count; ++j ) {
-            var t = trans.get( j );
-            if ( t.uuid === uuid )
-                return t;
-        }
-        return null;
-    }
-
-    function findTransitionFromTrackContainer( trackType, uuid )
-    {
-        var tracks = trackContainer( trackType )["tracks"];
-        for ( var i = 0; i < tracks.count; ++i  ) {
-            var t = findTransitionFromTrack( trackType, i, uuid );
-            if( t )
-                return t;
-        }
-
-        return null;
-    }
-
-    function findTransition( uuid )
-    {
-        var t = findTransitionFromTrackContainer( "Video", uuid );
-        if ( !t )
-            return findTransitionFromTrackContainer( "Audio", uuid );
-        return t;
-    }
-
     function findClipItem( uuid ) {
         return allClipsDict[uuid];
     }
@@ -362,12 +172,12 @@ Rectangle {
 
     function adjustTracks( trackType ) {
         var tracks = trackContainer( trackType )["tracks"];
+        // Keep an empty track after the last one holding clips
+        var count = timelineModel.trackCount( trackType ) + 1;
 
-        while ( tracks.count > 1 && tracks.get( tracks.count - 1 )["clips"].count === 0 &&
-               tracks.get( tracks.count - 2 )["clips"].count === 0 )
+        while ( tracks.count > count )
             removeTrack( trackType );
-
-        if ( tracks.get( tracks.count - 1 )["clips"].count > 0 )
+        while ( tracks.count < count )
             addTrack( trackType );
     }
 
@@ -422,12 +232,6 @@ Rectangle {
         }
     }
 
-    function updateLinkedClips( uuid ) {
-        var item = findClipItem( uuid );
-        if ( item )
-            item.linkedClips = linkedClipsDict[uuid];
-    }
-
     function zoomIn( ratio, scrollToCuror ) {
         var newPpu = ppu;
         var newUnit = unit;
@@ -542,11 +346,13 @@ Rectangle {
             }
         }
 
-        removeTransition( "transitionUuid" );
+        timelineModel.removePreview( "transitionUuid" );
 
         for ( i = 0; i < toAdd.length; ++i ) {
             var newUuid = workflow.addTransition( toAdd[i][0], toAdd[i][1], toAdd[i][2], toAdd[i][3], toAdd[i][4] );
-            findTransitionItem( newUuid ).clips = toAdd[i][5];
+            var newTransitionItem = findTransitionItem( newUuid );
+            if ( newTransitionItem )
+                newTransitionItem.clips = toAdd[i][5];
         }
 
         for ( i = 0; i < toMove.length; ++i )
@@ -560,6 +366,7 @@ Rectangle {
             var clip = findClipItem( selectedClips[i] );
             toMove.push( [clip.uuid, clip.newTrackId, clip.position] );
         }
+        // Recorded by the gesture of the drag, along with the transitions moved above
         for ( i = 0; i < toMove.length; ++i )
             workflow.moveClip( toMove[i][0], toMove[i][1], toMove[i][2] );
 
@@ -581,8 +388,8 @@ Rectangle {
         }
 
         Component.onCompleted: {
-            addTrack( "Video" );
-            addTrack( "Audio" );
+            adjustTracks( "Video" );
+            adjustTracks( "Audio" );
         }
     }
 
@@ -629,6 +436,8 @@ Rectangle {
 
         readonly property int sViewPadding: 50
 
+        onWidthChanged: updateVisibleRange()
+
         flickableItem.contentWidth: Math.max( page.width, ftop( length ) + initPosOfCursor + sViewPadding )
         flickableItem.contentHeight: Math.max( sView.height,
                                               topArea.height + videoTrackContainer.height +
@@ -850,42 +659,34 @@ Rectangle {
         }
 
         onClipAdded: {
-            var clipInfo = workflow.clipInfo( uuid );
-            var type = clipInfo["audio"] ? "Audio" : "Video";
-            clipInfo["selected"] = false;
-            linkedClipsDict[uuid] = clipInfo["linkedClips"];
-            addClip( type, clipInfo["trackId"], clipInfo );
-            adjustTracks( type );
+            adjustTracks( timelineModel.get( uuid )["type"] );
         }
 
         onClipMoved: {
-            var clipInfo = workflow.clipInfo( uuid );
-            var type = clipInfo["audio"] ? "Audio" : "Video";
-            var oldClip = findClipFromTrackContainer( type, uuid );
-            linkedClipsDict[uuid] = clipInfo["linkedClips"];
-            updateLinkedClips( uuid );
-
-            if ( clipInfo["trackId"] !== oldClip["trackId"] ) {
-                addClip( type, clipInfo["trackId"], clipInfo );
-                removeClipFromTrack( type, oldClip["trackId"], uuid );
+            // The model already shows the clip on its new track
+            var item = findClipItem( uuid );
+            if ( item ) {
+                var position = timelineModel.get( uuid )["position"];
+                item.position = position;
+                item.lastPosition = position;
             }
-            else
-            {
-                findClipItem( uuid ).position = clipInfo["position"];
-                findClipItem( uuid ).lastPosition = clipInfo["position"];
-            }
-            adjustTracks( type );
+            adjustTracks( "Audio" );
+            adjustTracks( "Video" );
         }
 
         onClipRemoved: {
-            removeClip( uuid );
+            var i = selectedClips.indexOf( uuid );
+            if ( i !== -1 )
+                selectedClips.splice( i, 1 );
             adjustTracks( "Audio" );
             adjustTracks( "Video" );
         }
 
         onClipResized: {
-            var clipInfo = workflow.clipInfo( uuid );
             var clip = findClipItem( uuid );
+            if ( !clip )
+                return;
+            var clipInfo = workflow.clipInfo( uuid );
             clip.position = clipInfo["position"];
             clip.lastPosition = clipInfo["position"];
             clip.end = clipInfo["end"];
@@ -894,55 +695,13 @@ Rectangle {
             clip.updateEffects( clipInfo );
         }
 
-        onClipLinked: {
-            linkedClipsDict[uuidA].push( uuidB );
-            linkedClipsDict[uuidB].push( uuidA );
-            updateLinkedClips( uuidA );
-            updateLinkedClips( uuidB );
-        }
-
-        onClipUnlinked: {
-            for ( var i = 0; i < linkedClipsDict[uuidA].length; ++i )
-                if ( linkedClipsDict[uuidA][i] === uuidB )
-                {
-                    linkedClipsDict[uuidA].splice( i, 1 );
-                    break;
-                }
-            for ( i = 0; i < linkedClipsDict[uuidB].length; ++i )
-                if ( linkedClipsDict[uuidB][i] === uuidA )
-                {
-                    linkedClipsDict[uuidB].splice( i, 1 );
-                    break;
-                }
-            updateLinkedClips( uuidA );
-            updateLinkedClips( uuidB );
-        }
-
-        onTransitionAdded: {
-            var transitionInfo = workflow.transitionInfo( uuid );
-            var type = transitionInfo["audio"] ? "Audio" : "Video";
-            if ( transitionInfo["isInTrack"] )
-                addTransition( type, transitionInfo["trackId"], transitionInfo );
-            else
-                addTransition( type, transitionInfo["trackBId"], transitionInfo );
-        }
-
         onTransitionMoved: {
+            var transition = findTransitionItem( uuid );
+            if ( !transition )
+                return;
             var transitionInfo = workflow.transitionInfo( uuid );
-            var transition = findTransition( uuid );
-            var type = transitionInfo["audio"] ? "Audio" : "Video";
-            if ( transitionInfo["isInTrack"] || transitionInfo["trackBId"] === transition["trackId"] ) {
-                transition["begin"] = transitionInfo["begin"];
-                transition["end"] = transitionInfo["end"];
-            }
-            else {
-                removeTransition( uuid );
-                addTransition( type, transitionInfo["trackBId"], transitionInfo );
-            }
-        }
-
-        onTransitionRemoved: {
-            removeTransition( uuid );
+            transition.begin = transitionInfo["begin"];
+            transition.end = transitionInfo["end"];
         }
 
         onEffectsUpdated: {
@@ -952,6 +711,14 @@ Rectangle {
         }
     }
 
+    Connections {
+        target: sView.flickableItem
+        onContentXChanged: updateVisibleRange()
+    }
+
+    onPpuChanged: updateVisibleRange()
+    onUnitChanged: updateVisibleRange()
+
     Connections {
         target: mainwindow
         onScaleChanged: {
@@ -0,0 +1,425 @@
+/*****************************************************************************
+ * AnalysisScheduler.cpp: Runs media analysis jobs in the background
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "AnalysisScheduler.h"
+
+#include "Main/Core.h"
+#include "Project/Workspace.h"
+#include "Settings/Settings.h"
+#include "Tools/VlmcDebug.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QMetaEnum>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QThread>
+#include <QUrl>
+
+class AnalysisScheduler::Worker : public QThread
+{
+    public:
+        explicit Worker( AnalysisScheduler& scheduler )
+            : m_scheduler( scheduler )
+        {
+        }
+
+    protected:
+        void run() override
+        {
+            m_scheduler.work();
+        }
+
+    private:
+        AnalysisScheduler&  m_scheduler;
+};
+
+AnalysisScheduler::AnalysisScheduler( Settings* vlmcSettings )
+    : m_nextSeq( 0 )
+    , m_threadCount( 1 )
+    , m_stop( false )
+{
+    qRegisterMetaType<AnalysisScheduler::Kind>();
+
+    // Leave half of the cores to the playback and the user interface
+    auto threads = vlmcSettings->createVar( SettingValue::Int, "vlmc/AnalysisThreads",
+                             qMax( 1, QThread::idealThreadCount() / 2 ),
+                             QT_TRANSLATE_NOOP( "Settings", "Media analysis threads" ),
+                             QT_TRANSLATE_NOOP( "Settings", "The number of media analyzed at once in the background" ),
+                             SettingValue::Nothing );
+    setThreadCount( threads->get().toInt() );
+    connect( threads, &SettingValue::changed, this, [this]( const QVariant& count )
+    {
+        setThreadCount( count.toInt() );
+    } );
+}
+
+AnalysisScheduler::~AnalysisScheduler()
+{
+    {
+        QMutexLocker    lock( &m_mutex );
+        m_stop = true;
+        m_queue.clear();
+        m_pending.clear();
+        for ( const auto& cancelled : m_running )
+            *cancelled = true;
+        m_wakeUp.wakeAll();
+    }
+    for ( auto& worker : m_workers )
+        worker->wait();
+}
+
+QString
+AnalysisScheduler::kindName( AnalysisScheduler::Kind kind )
+{
+    return QString::fromLatin1( QMetaEnum::fromType<Kind>().valueToKey( kind ) );
+}
+
+void
+AnalysisScheduler::setAnalyzer( AnalysisScheduler::Kind kind, AnalysisScheduler::Analyzer analyzer,
+                                bool persistent )
+{
+    QMutexLocker    lock( &m_mutex );
+    m_analyzers[kind] = std::move( analyzer );
+    if ( persistent == true )
+        m_transient.remove( kind );
+    else
+        m_transient.insert( kind );
+}
+
+void
+AnalysisScheduler::setSharedAnalyzer( const QVector<AnalysisScheduler::Kind>& kinds,
+                                      AnalysisScheduler::SharedAnalyzer analyzer )
+{
+    std::shared_ptr<const SharedGroup>  group( new SharedGroup{ kinds, std::move( analyzer ) } );
+    QMutexLocker    lock( &m_mutex );
+    for ( auto kind : kinds )
+        m_sharedAnalyzers[kind] = group;
+}
+
+void
+AnalysisScheduler::enqueue( qint64 mediaId, const QString& mrl, AnalysisScheduler::Kind kind,
+                            AnalysisScheduler::Priority priority )
+{
+    auto file = cacheFile( mrl, kind );
+    QMutexLocker    lock( &m_mutex );
+    if ( m_stop == true || ( m_analyzers.contains( kind ) == false &&
+                             m_sharedAnalyzers.contains( kind ) == false ) )
+        return;
+    if ( m_transient.contains( kind ) == true )
+        file.clear();
+    JobId id( mediaId, kind );
+    if ( m_running.contains( id ) == true )
+        return;
+    auto pending = m_pending.find( id );
+    if ( pending != m_pending.end() )
+    {
+        promote( *pending, priority );
+        return;
+    }
+    QueueKey key( -priority, m_nextSeq++ );
+    m_queue[key] = Job{ mediaId, mrl, kind, priority, file };
+    m_pending[id] = key;
+
+    // Start another thread if the budget allows it and no worker is idle
+    auto needed = qMin( m_threadCount, m_running.size() + static_cast<int>( m_queue.size() ) );
+    if ( static_cast<int>( m_workers.size() ) < needed )
+    {
+        m_workers.emplace_back( new Worker( *this ) );
+        m_workers.back()->start( QThread::LowPriority );
+    }
+    m_wakeUp.wakeOne();
+}
+
+void
+AnalysisScheduler::raisePriority( qint64 mediaId, AnalysisScheduler::Priority priority )
+{
+    QMutexLocker    lock( &m_mutex );
+    for ( auto kind = 0; kind < NbKinds; ++kind )
+    {
+        auto pending = m_pending.find( JobId( mediaId, kind ) );
+        if ( pending != m_pending.end() )
+            promote( *pending, priority );
+    }
+}
+
+void
+AnalysisScheduler::cancel( qint64 mediaId )
+{
+    QMutexLocker    lock( &m_mutex );
+    for ( auto kind = 0; kind < NbKinds; ++kind )
+    {
+        JobId id( mediaId, kind );
+        auto pending = m_pending.find( id );
+        if ( pending != m_pending.end() )
+        {
+            m_queue.erase( *pending );
+            m_pending.erase( pending );
+        }
+        auto running = m_running.find( id );
+        if ( running != m_running.end() )
+            **running = true;
+    }
+}
+
+void
+AnalysisScheduler::cancelAll()
+{
+    QMutexLocker    lock( &m_mutex );
+    m_queue.clear();
+    m_pending.clear();
+    for ( const auto& cancelled : m_running )
+        *cancelled = true;
+}
+
+QVariant
+AnalysisScheduler::result( const QString& mrl, AnalysisScheduler::Kind kind ) const
+{
+    {
+        QMutexLocker    lock( &m_mutex );
+        if ( m_transient.contains( kind ) == true )
+            return QVariant();
+    }
+    return load( cacheFile( mrl, kind ) );
+}
+
+int
+AnalysisScheduler::threadCount() const
+{
+    QMutexLocker    lock( &m_mutex );
+    return m_threadCount;
+}
+
+void
+AnalysisScheduler::setThreadCount( int threadCount )
+{
+    QMutexLocker    lock( &m_mutex );
+    // Extra workers are started on demand, superfluous ones just stop taking jobs
+    m_threadCount = qMax( 1, threadCount );
+    m_wakeUp.wakeAll();
+}
+
+QJsonObject
+AnalysisScheduler::stats() const
+{
+    QMutexLocker    lock( &m_mutex );
+    QJsonArray  pending;
+    for ( const auto& p : m_queue )
+    {
+        pending.append( QJsonObject{
+            { "mediaId", p.second.mediaId },
+            { "kind", kindName( p.second.kind ) },
+            { "priority", p.second.priority },
+        } );
+    }
+    QJsonArray  running;
+    for ( auto it = m_running.cbegin(); it != m_running.cend(); ++it )
+    {
+        running.append( QJsonObject{
+            { "mediaId", it.key().first },
+            { "kind", kindName( static_cast<Kind>( it.key().second ) ) },
+        } );
+    }
+    return QJsonObject{
+        { "threads", m_threadCount },
+        { "pending", pending },
+        { "running", running },
+    };
+}
+
+void
+AnalysisScheduler::promote( AnalysisScheduler::QueueKey& key, AnalysisScheduler::Priority priority )
+{
+    if ( -key.first >= priority )
+        return;
+    auto job = m_queue[key];
+    m_queue.erase( key );
+    job.priority = priority;
+    // The job keeps its submission order among the jobs of its new priority
+    key.first = -priority;
+    m_queue[key] = job;
+}
+
+QString
+AnalysisScheduler::localFile( const QString& mrl )
+{
+    // Media locations are decoded URLs, ie. "file:///home/user/a b.mp4"
+    if ( mrl.startsWith( QStringLiteral( "file://" ) ) == false )
+        return mrl;
+    return QUrl( mrl, QUrl::TolerantMode ).toLocalFile();
+}
+
+QString
+AnalysisScheduler::cacheFile( const QString& mrl, AnalysisScheduler::Kind kind ) const
+{
+    auto workspace = Core::instance()->workspace();
+    QFileInfo   info( localFile( mrl ) );
+    if ( workspace == nullptr || info.exists() == false )
+        return QString();
+    auto dir = workspace->cacheDirectory( QStringLiteral( "analysis" ) );
+    if ( dir.isEmpty() == true )
+        return QString();
+    // A modified file gets a new key, the stale result is simply never read again
+    auto key = info.absoluteFilePath() + '/' + QString::number( info.size() ) + '/' +
+            QString::number( info.lastModified().toMSecsSinceEpoch() );
+    auto hash = QCryptographicHash::hash( key.toUtf8(), QCryptographicHash::Sha1 ).toHex();
+    return dir + '/' + QString::fromLatin1( hash ) + '.' + kindName( kind ) + ".json";
+}
+
+QVariant
+AnalysisScheduler::load( const QString& cacheFile )
+{
+    if ( cacheFile.isEmpty() == true )
+        return QVariant();
+    QFile   file( cacheFile );
+    if ( file.open( QIODevice::ReadOnly ) == false )
+        return QVariant();
+    return QJsonDocument::fromJson( file.readAll() ).object()["result"].toVariant();
+}
+
+void
+AnalysisScheduler::save( const QString& cacheFile, const QVariant& result )
+{
+    if ( cacheFile.isEmpty() == true )
+        return;
+    // Written atomically, a crash never leaves a truncated result behind
+    QSaveFile   file( cacheFile );
+    if ( file.open( QIODevice::WriteOnly ) == false )
+    {
+        vlmcWarning() << "Can't save analysis result to" << cacheFile;
+        return;
+    }
+    QJsonObject o{ { "result", QJsonValue::fromVariant( result ) } };
+    file.write( QJsonDocument( o ).toJson( QJsonDocument::Compact ) );
+    if ( file.commit() == false )
+        vlmcWarning() << "Can't save analysis result to" << cacheFile;
+}
+
+void
+AnalysisScheduler::work()
+{
+    QMutexLocker    lock( &m_mutex );
+    while ( true )
+    {
+        while ( m_stop == false && ( m_queue.empty() == true ||
+                                     m_running.size() >= m_threadCount ) )
+            m_wakeUp.wait( &m_mutex );
+        if ( m_stop == true )
+            return;
+        std::vector<Job>    jobs{ m_queue.begin()->second };
+        m_queue.erase( m_queue.begin() );
+        m_pending.remove( JobId( jobs[0].mediaId, jobs[0].kind ) );
+        // Take the pending jobs which share the decoding of this one, whatever their priority
+        auto group = m_sharedAnalyzers.value( jobs[0].kind );
+        for ( auto kind : ( group != nullptr ? group->kinds : QVector<Kind>() ) )
+        {
+            auto pending = m_pending.find( JobId( jobs[0].mediaId, kind ) );
+            if ( pending == m_pending.end() )
+                continue;
+            jobs.push_back( m_queue[*pending] );
+            m_queue.erase( *pending );
+            m_pending.erase( pending );
+        }
+        // Cancelling a media interrupts the whole group
+        auto cancelled = std::make_shared<std::atomic_bool>( false );
+        for ( const auto& job : jobs )
+            m_running[JobId( job.mediaId, job.kind )] = cancelled;
+        lock.unlock();
+
+        run( jobs, cancelled );
+
+        lock.relock();
+        for ( const auto& job : jobs )
+            m_running.remove( JobId( job.mediaId, job.kind ) );
+        // Another worker may have been held back by the thread budget
+        m_wakeUp.wakeOne();
+    }
+}
+
+void
+AnalysisScheduler::run( const std::vector<AnalysisScheduler::Job>& jobs,
+                        const std::shared_ptr<std::atomic_bool>& cancelled )
+{
+    std::vector<Job>    missing;
+    for ( const auto& job : jobs )
+    {
+        auto result = load( job.cacheFile );
+        if ( result.isValid() == true )
+            emit finished( job.mediaId, job.kind, result );
+        else
+            missing.push_back( job );
+    }
+    if ( missing.empty() == true )
+        return;
+    const auto& first = missing.front();
+    QVector<Kind>   kinds;
+    for ( const auto& job : missing )
+        kinds << job.kind;
+    // Don't flood the receivers, one notification per percent is plenty
+    int lastPercent = -1;
+    auto reportProgress = [this, &missing, &cancelled, &lastPercent]( double ratio )
+    {
+        auto percent = static_cast<int>( ratio * 100 );
+        if ( percent != lastPercent )
+        {
+            lastPercent = percent;
+            for ( const auto& job : missing )
+                emit progress( job.mediaId, job.kind, ratio );
+        }
+        return *cancelled == false;
+    };
+
+    Analyzer                            analyzer;
+    std::shared_ptr<const SharedGroup>  group;
+    {
+        QMutexLocker    lock( &m_mutex );
+        analyzer = m_analyzers.value( first.kind );
+        group = m_sharedAnalyzers.value( first.kind );
+    }
+    QHash<int, QVariant>    results;
+    if ( group != nullptr )
+        results = group->analyzer( first.mrl, kinds, reportProgress );
+    else
+        results[first.kind] = analyzer( first.mrl, reportProgress );
+    if ( *cancelled == true )
+        return;
+    for ( const auto& job : missing )
+    {
+        auto result = results.value( job.kind );
+        if ( result.isValid() == false )
+        {
+            vlmcWarning() << "Analysis" << kindName( job.kind ) << "failed for" << job.mrl;
+            emit failed( job.mediaId, job.kind );
+            continue;
+        }
+        save( job.cacheFile, result );
+        emit finished( job.mediaId, job.kind, result );
+    }
+}
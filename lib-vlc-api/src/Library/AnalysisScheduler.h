@@ -0,0 +1,216 @@
+/*****************************************************************************
+ * AnalysisScheduler.h: Runs media analysis jobs in the background
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef ANALYSISSCHEDULER_H
+#define ANALYSISSCHEDULER_H
+
+#include <QHash>
+#include <QJsonObject>
+#include <QMutex>
+#include <QObject>
+#include <QPair>
+#include <QSet>
+#include <QVariant>
+#include <QVector>
+#include <QWaitCondition>
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+class Settings;
+
+/**
+ *  \brief  Computes per media data (thumbnails, audio peaks, ...) from worker threads.
+ *
+ *  Jobs are identified by a media and a kind of analysis, so that asking twice for
+ *  the same result only runs the analysis once. The pending jobs are sorted by
+ *  priority, then by submission order, and at most "vlmc/AnalysisThreads" of them
+ *  run at once, on low priority threads.
+ *  Results are stored in the workspace, keyed by the media file and its modification
+ *  date, so that they survive the application and are shared between projects.
+ *
+ *  Every method can be called from any thread. The signals are emitted from the
+ *  worker threads.
+ */
+class AnalysisScheduler : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY( AnalysisScheduler )
+
+    public:
+        enum Kind
+        {
+            Thumbnails,
+            Peaks,
+            KeyframeIndex,
+            Loudness,
+            SceneCuts,
+            // A full resolution, all-intra copy, see MediaAnalyzers::optimizedMedia()
+            OptimizedMedia,
+            NbKinds
+        };
+        Q_ENUM( Kind )
+
+        enum Priority
+        {
+            Background,
+            Normal,
+            // Media used by the timeline
+            Visible
+        };
+        Q_ENUM( Priority )
+
+        /**
+         *  Reports the progress of a job, from 0 to 1. It returns false once the job
+         *  is cancelled, the analyzer should then give up as soon as possible.
+         */
+        using Progress = std::function<bool( double )>;
+        /**
+         *  Analyzes a media file. The result must be convertible to JSON, an invalid
+         *  QVariant meaning the analysis failed or was cancelled.
+         */
+        using Analyzer = std::function<QVariant( const QString& mrl, const Progress& progress )>;
+        /**
+         *  Computes several kinds of results at once, typically from a single decoding
+         *  pass. It returns the result of each requested kind, a missing or invalid one
+         *  meaning that this analysis failed.
+         */
+        using SharedAnalyzer = std::function<QHash<int, QVariant>( const QString& mrl,
+                                                                   const QVector<Kind>& kinds,
+                                                                   const Progress& progress )>;
+
+        explicit AnalysisScheduler( Settings* vlmcSettings );
+        /**
+         *  Cancels the pending jobs and waits for the running ones to give up.
+         */
+        ~AnalysisScheduler();
+
+        static QString      kindName( Kind kind );
+        /**
+         *  \brief  The local path of a media location, which may be a file:// URL.
+         */
+        static QString      localFile( const QString& mrl );
+
+        /**
+         *  \brief  Registers the analyzer of a kind.
+         *  \param  persistent  Whether the results are saved in the workspace. Results
+         *                      pointing to files which may be deleted must not be.
+         */
+        void                setAnalyzer( Kind kind, Analyzer analyzer, bool persistent = true );
+        /**
+         *  \brief  Registers an analyzer for a group of kinds.
+         *
+         *  When a job of the group starts, the pending jobs of the other kinds of the
+         *  group for the same media are started along, and handed to a single call.
+         */
+        void                setSharedAnalyzer( const QVector<Kind>& kinds, SharedAnalyzer analyzer );
+
+        /**
+         *  \brief  Schedules an analysis, unless it is already pending or running.
+         *
+         *  Scheduling a pending job again only raises its priority. If a result was
+         *  persisted, finished() is emitted without analyzing the media again.
+         */
+        void                enqueue( qint64 mediaId, const QString& mrl, Kind kind,
+                                     Priority priority = Normal );
+        /**
+         *  \brief  Raises the priority of every pending job of a media.
+         */
+        void                raisePriority( qint64 mediaId, Priority priority );
+        /**
+         *  \brief  Drops the pending jobs of a media and interrupts its running ones.
+         */
+        void                cancel( qint64 mediaId );
+        void                cancelAll();
+
+        /**
+         *  \brief  Returns a persisted result, or an invalid QVariant.
+         */
+        QVariant            result( const QString& mrl, Kind kind ) const;
+
+        int                 threadCount() const;
+        void                setThreadCount( int threadCount );
+
+        /**
+         *  \brief  Describes the pending and running jobs
+         */
+        QJsonObject         stats() const;
+
+    signals:
+        void                progress( qint64 mediaId, AnalysisScheduler::Kind kind, double ratio );
+        void                finished( qint64 mediaId, AnalysisScheduler::Kind kind, const QVariant& result );
+        void                failed( qint64 mediaId, AnalysisScheduler::Kind kind );
+
+    private:
+        class   Worker;
+
+        using JobId = QPair<qint64, int>;
+
+        struct Job
+        {
+            qint64          mediaId;
+            QString         mrl;
+            Kind            kind;
+            Priority        priority;
+            // Where to persist the result, empty without a workspace
+            QString         cacheFile;
+        };
+
+        // Higher priorities first, then by submission order
+        using QueueKey = std::pair<int, quint64>;
+
+        // Must be called with m_mutex held
+        void                promote( QueueKey& key, Priority priority );
+        QString             cacheFile( const QString& mrl, Kind kind ) const;
+        static QVariant     load( const QString& cacheFile );
+        static void         save( const QString& cacheFile, const QVariant& result );
+
+        struct SharedGroup
+        {
+            QVector<Kind>   kinds;
+            SharedAnalyzer  analyzer;
+        };
+
+        void                work();
+        // The jobs all concern the same media
+        void                run( const std::vector<Job>& jobs,
+                                 const std::shared_ptr<std::atomic_bool>& cancelled );
+
+    private:
+        mutable QMutex                      m_mutex;
+        QWaitCondition                      m_wakeUp;
+        std::map<QueueKey, Job>             m_queue;
+        QHash<JobId, QueueKey>              m_pending;
+        QHash<JobId, std::shared_ptr<std::atomic_bool>>  m_running;
+        quint64                             m_nextSeq;
+        QHash<int, Analyzer>                m_analyzers;
+        QSet<int>                           m_transient;
+        QHash<int, std::shared_ptr<const SharedGroup>>  m_sharedAnalyzers;
+        std::vector<std::unique_ptr<Worker>>    m_workers;
+        int                                 m_threadCount;
+        bool                                m_stop;
+};
+
+#endif // ANALYSISSCHEDULER_H
@@ -32,13 +32,21 @@
 #endif
 
 #include "Library.h"
+#include "Backend/FrameIndex.h"
+#include "Commands/Commands.h"
+#include "Main/Core.h"
 #include "Media/Clip.h"
 #include "Media/Media.h"
 #include "MediaLibraryModel.h"
 #include "Project/Project.h"
+#include "Project/Workspace.h"
 #include "Settings/Settings.h"
+#include "Tools/BackgroundReleaser.h"
 #include "Tools/VlmcDebug.h"
+#include "Workflow/MainWorkflow.h"
 
+#include <QDir>
+#include <QFileInfo>
 #include <QVariant>
 #include <QHash>
 #include <QUuid>
@@ -57,6 +65,26 @@ Library::Library( Settings* vlmcSettings, Settings *projectSettings )
                         "Media Library folders", "List of folders VLMC will search for media files",
                          SettingValue::Folders );
     connect( s, &SettingValue::changed, this, &Library::mlDirsChanged );
+    vlmcSettings->createVar( SettingValue::Bool, QStringLiteral( "vlmc/OptimizeMedia" ), false,
+                        QT_TRANSLATE_NOOP( "Settings", "Optimize imported media" ),
+                        QT_TRANSLATE_NOOP( "Settings", "Transcode imported videos to an all-intra codec in the "
+                                                       "workspace, for a smooth playback at full resolution" ),
+                        SettingValue::Nothing );
+    vlmcSettings->createVar( SettingValue::Bool, QStringLiteral( "vlmc/ImportImageSequences" ), false,
+                        QT_TRANSLATE_NOOP( "Settings", "Import image sequences" ),
+                        QT_TRANSLATE_NOOP( "Settings", "Import a run of zero-padded numbered images, ie. "
+                                                       "shot_0001.png, shot_0002.png..., as a single video" ),
+                        SettingValue::Nothing );
+    vlmcSettings->createVar( SettingValue::Double, QStringLiteral( "vlmc/ImageSequenceFps" ), 24.0,
+                        QT_TRANSLATE_NOOP( "Settings", "Image sequence frame rate" ),
+                        QT_TRANSLATE_NOOP( "Settings", "The frame rate numbered images are played at "
+                                                       "when imported as a sequence" ),
+                        SettingValue::Nothing );
+    vlmcSettings->createVar( SettingValue::Int, QStringLiteral( "vlmc/ImageSequenceReadAhead" ), 8,
+                        QT_TRANSLATE_NOOP( "Settings", "Image sequence read-ahead" ),
+                        QT_TRANSLATE_NOOP( "Settings", "How many images of a sequence are decoded "
+                                                       "ahead of the playback" ),
+                        SettingValue::Nothing );
     auto ws = vlmcSettings->value( "vlmc/WorkspaceLocation" );
     connect( ws, &SettingValue::changed, this, &Library::workspaceChanged );
 
@@ -92,6 +120,7 @@ Library::postLoad()
                 m->loadSubclip( subClip.toMap() );
         }
     }
+    releasePreloadedInputs();
 }
 
 Library::~Library()
@@ -106,6 +135,32 @@ Library::addMedia( QSharedPointer<Media> media )
         return;
     m_media[media->id()] = media;
     m_clips[media->baseClip()->uuid()] = media->baseClip();
+    auto scheduler = Core::instance()->analysisScheduler();
+    const auto& sequence = media->imageSequence();
+    if ( sequence.isValid() == true )
+    {
+        // The other analyses would only look at the first image: a sequence has
+        // no keyframes, no audio, and nothing to optimize
+        scheduler->enqueue( media->id(), sequence.resource(), AnalysisScheduler::Thumbnails, AnalysisScheduler::Background );
+    }
+    else
+    {
+        if ( media->hasVideoTracks() == true )
+        {
+            // Indexing only reads the packets, and makes the seeks of everything else cheaper
+            scheduler->enqueue( media->id(), media->mrl(), AnalysisScheduler::KeyframeIndex, AnalysisScheduler::Normal );
+            scheduler->enqueue( media->id(), media->mrl(), AnalysisScheduler::Thumbnails, AnalysisScheduler::Background );
+            scheduler->enqueue( media->id(), media->mrl(), AnalysisScheduler::SceneCuts, AnalysisScheduler::Background );
+            if ( media->optimizedFile().isEmpty() == true &&
+                 Core::instance()->settings()->value( "vlmc/OptimizeMedia" )->get().toBool() == true )
+                scheduler->enqueue( media->id(), media->mrl(), AnalysisScheduler::OptimizedMedia, AnalysisScheduler::Background );
+        }
+        if ( media->hasAudioTracks() == true )
+        {
+            scheduler->enqueue( media->id(), media->mrl(), AnalysisScheduler::Peaks, AnalysisScheduler::Background );
+            scheduler->enqueue( media->id(), media->mrl(), AnalysisScheduler::Loudness, AnalysisScheduler::Background );
+        }
+    }
     emit clipAdded( media->baseClip()->uuid().toString() );
     vlmcDebug() << "Clip" << media->baseClip()->uuid().toString() << "is added to Library";
     connect( media.data(), &Media::subclipAdded, [this]( QSharedPointer<Clip> c ) {
@@ -157,11 +212,201 @@ Library::clip( const QUuid& uuid )
 void
 Library::clear()
 {
+    // Media are destroyed from the releaser thread, make sure nothing will be notified
+    for ( const auto& m : m_media )
+        m->disconnect();
+    for ( const auto& c : m_clips )
+        c->disconnect();
+    Core::instance()->analysisScheduler()->cancelAll();
+    auto garbage = qMakePair( m_media, m_clips );
     m_media.clear();
     m_clips.clear();
+    m_sceneCuts.clear();
+    m_thumbnails.clear();
+    m_peaks.clear();
+    m_loudness.clear();
+    Core::instance()->releaser()->release( std::move( garbage ) );
+    releasePreloadedInputs();
     setCleanState( true );
 }
 
+void
+Library::setPreloadedInputs( std::map<qint64, std::unique_ptr<Backend::IInput>> inputs )
+{
+    m_preloadedInputs = std::move( inputs );
+}
+
+void
+Library::releasePreloadedInputs()
+{
+    if ( m_preloadedInputs.empty() == true )
+        return;
+    Core::instance()->releaser()->release( std::move( m_preloadedInputs ) );
+    m_preloadedInputs.clear();
+}
+
+QVector<qint64>
+Library::sceneCuts( qint64 mediaId ) const
+{
+    return m_sceneCuts.value( mediaId );
+}
+
+QImage
+Library::thumbnail( qint64 mediaId, qint64 frame ) const
+{
+    auto it = m_thumbnails.constFind( mediaId );
+    if ( it == m_thumbnails.cend() || it->isEmpty() == true )
+        return QImage();
+    // The thumbnail showing the frame is the last one starting before it, if any
+    auto next = it->upperBound( frame );
+    if ( next != it->cbegin() )
+        --next;
+    return *next;
+}
+
+QByteArray
+Library::peaks( qint64 mediaId ) const
+{
+    return m_peaks.value( mediaId );
+}
+
+bool
+Library::splitAtSceneCuts( qint64 mediaId )
+{
+    auto m = media( mediaId );
+    auto cuts = m_sceneCuts.value( mediaId );
+    if ( m == nullptr || cuts.isEmpty() == true )
+        return false;
+    Core::instance()->workflow()->trigger( new Commands::Media::SplitAtCuts( m, cuts ) );
+    return true;
+}
+
+bool
+Library::optimizeMedia( qint64 mediaId )
+{
+    auto m = media( mediaId );
+    if ( m == nullptr || m->hasVideoTracks() == false || m->imageSequence().isValid() == true )
+        return false;
+    Core::instance()->analysisScheduler()->enqueue( mediaId, m->mrl(), AnalysisScheduler::OptimizedMedia,
+                                                    AnalysisScheduler::Normal );
+    return true;
+}
+
+QVariantMap
+Library::optimizedMediaUsage() const
+{
+    QVariantList    list;
+    qint64          used = 0;
+    for ( const auto& m : m_media )
+    {
+        if ( m->optimizedFile().isEmpty() == true )
+            continue;
+        auto size = QFileInfo( m->optimizedFile() ).size();
+        used += size;
+        list << QVariantMap{
+            { "mediaId", m->id() },
+            { "file", m->optimizedFile() },
+            { "size", size },
+        };
+    }
+    // The copies of media other projects use are kept in the same folder
+    qint64  total = 0;
+    auto workspace = Core::instance()->workspace();
+    auto dir = workspace != nullptr ? workspace->cacheDirectory( QStringLiteral( "optimized" ) ) : QString();
+    if ( dir.isEmpty() == false )
+    {
+        for ( const auto& f : QDir( dir ).entryInfoList( QDir::Files ) )
+            total += f.size();
+    }
+    return QVariantMap{
+        { "media", list },
+        { "projectSize", used },
+        { "workspaceSize", total },
+    };
+}
+
+QVariantMap
+Library::loudness( qint64 mediaId ) const
+{
+    return m_loudness.value( mediaId );
+}
+
+void
+Library::analysisFinished( qint64 mediaId, AnalysisScheduler::Kind kind, const QVariant& result )
+{
+    if ( m_media.contains( mediaId ) == false )
+        return;
+    if ( kind == AnalysisScheduler::Loudness )
+    {
+        m_loudness[mediaId] = result.toMap();
+        return;
+    }
+    if ( kind == AnalysisScheduler::OptimizedMedia )
+    {
+        auto file = result.toMap()["file"].toString();
+        if ( QFileInfo::exists( file ) == false )
+            return;
+        m_media[mediaId]->setOptimizedFile( file );
+        setCleanState( false );
+        vlmcDebug() << "Media" << mediaId << "is optimized, the copy will be played once the project is reloaded";
+        return;
+    }
+    if ( kind == AnalysisScheduler::KeyframeIndex )
+    {
+        auto data = QByteArray::fromBase64( result.toMap()["index"].toString().toLatin1() );
+        auto index = Backend::FrameIndex::deserialize( data.toStdString() );
+        if ( index == nullptr )
+        {
+            vlmcWarning() << "Invalid frame index for media" << mediaId;
+            return;
+        }
+        Backend::FrameIndex::publish( qPrintable( m_media[mediaId]->mrl() ), index );
+        return;
+    }
+    if ( kind == AnalysisScheduler::Thumbnails )
+    {
+        QMap<qint64, QImage>    thumbnails;
+        for ( const auto& t : result.toList() )
+        {
+            auto map = t.toMap();
+            auto data = QByteArray::fromBase64( map["image"].toString().toLatin1() );
+            auto image = QImage::fromData( data, "PNG" );
+            if ( image.isNull() == false )
+                thumbnails[map["frame"].toLongLong()] = image;
+        }
+        m_thumbnails[mediaId] = thumbnails;
+        emit thumbnailsChanged( mediaId );
+        return;
+    }
+    if ( kind == AnalysisScheduler::Peaks )
+    {
+        QByteArray  peaks;
+        for ( const auto& p : result.toMap()["peaks"].toList() )
+            peaks.append( static_cast<char>( p.toInt() ) );
+        m_peaks[mediaId] = peaks;
+        emit peaksChanged( mediaId );
+        return;
+    }
+    if ( kind != AnalysisScheduler::SceneCuts )
+        return;
+    QVector<qint64> cuts;
+    for ( const auto& cut : result.toMap()["cuts"].toList() )
+        cuts << cut.toLongLong();
+    m_sceneCuts[mediaId] = cuts;
+    emit sceneCutsChanged( mediaId );
+}
+
+std::unique_ptr<Backend::IInput>
+Library::takePreloadedInput( qint64 mediaId )
+{
+    auto it = m_preloadedInputs.find( mediaId );
+    if ( it == m_preloadedInputs.end() )
+        return nullptr;
+    auto input = std::move( it->second );
+    m_preloadedInputs.erase( it );
+    return input;
+}
+
 void
 Library::setCleanState( bool newState )
 {
@@ -232,9 +477,12 @@ void
 Library::onMediaDeleted( std::vector<int64_t> mediaList )
 {
     for ( auto id : mediaList )
+    {
+        Core::instance()->analysisScheduler()->cancel( id );
         QMetaObject::invokeMethod( m_model, "removeMedia",
                                    Qt::QueuedConnection,
                                    Q_ARG( int64_t, id ) );
+    }
 }
 
 void
@@ -32,10 +32,16 @@
 
 #include <QObject>
 #include <QHash>
+#include <QImage>
+#include <QMap>
 #include <QSharedPointer>
+#include <QVector>
+
+#include "AnalysisScheduler.h"
 
 #include <medialibrary/IMediaLibrary.h>
 
+#include <map>
 #include <memory>
 
 class Clip;
@@ -44,6 +50,11 @@ class MediaLibraryModel;
 class ProjectManager;
 class Settings;
 
+namespace Backend
+{
+class IInput;
+}
+
 /**
  *  \class Library
  *  \brief Library Object that handles public Clips
@@ -72,10 +83,67 @@ public:
      * This can be any clip, the given UUID doesn't have to refer to a root clip
      */
     QSharedPointer<Clip>        clip( const QUuid& uuid );
+    /**
+     * @brief clear     Drops every media and clip at once
+     * Their producers are closed from a background thread.
+     */
     void            clear();
 
+    /**
+     * @brief setPreloadedInputs    Provides inputs opened ahead of time for the next project
+     * @param inputs    The inputs, by media library ID. They are used by the next project
+     *                  load, and the unused ones are released afterward.
+     */
+    void            setPreloadedInputs( std::map<qint64, std::unique_ptr<Backend::IInput>> inputs );
+    /**
+     * @brief takePreloadedInput    Returns the preloaded input of a media, if any
+     */
+    std::unique_ptr<Backend::IInput>    takePreloadedInput( qint64 mediaId );
+
+    /**
+     * @brief sceneCuts The first frame of each shot of a media, but the first one
+     * This is empty until the media has been analyzed, see sceneCutsChanged()
+     */
+    QVector<qint64>     sceneCuts( qint64 mediaId ) const;
+    /**
+     * @brief thumbnail Returns the analyzed thumbnail closest to a frame of a media
+     * This is a null image until the media has been analyzed, see thumbnailsChanged()
+     */
+    QImage              thumbnail( qint64 mediaId, qint64 frame ) const;
+    /**
+     * @brief peaks The audio peak of each frame of a media, from 0 to 255
+     * This is empty until the media has been analyzed, see peaksChanged()
+     */
+    QByteArray          peaks( qint64 mediaId ) const;
+    /**
+     * @brief splitAtSceneCuts  Creates a subclip per shot of a media, as an undoable action
+     * @return false if no cut is known for this media
+     */
+    bool                splitAtSceneCuts( qint64 mediaId );
+    /**
+     * @brief loudness  The EBU R128 measures of a media, see MediaAnalyzers::loudness()
+     * This is empty until the media has been analyzed
+     */
+    QVariantMap         loudness( qint64 mediaId ) const;
+    /**
+     * @brief optimizeMedia Transcodes a video to an all-intra copy in the background
+     * The progress is reported by the AnalysisScheduler, as for any analysis.
+     * @return false if the media is unknown or has no video
+     */
+    bool                optimizeMedia( qint64 mediaId );
+    /**
+     * @brief optimizedMediaUsage   Describes the disk space used by the optimized copies
+     * @return { "media": [{ "mediaId", "file", "size" }], "projectSize", "workspaceSize" },
+     *         in bytes. The workspace may also hold copies of media from other projects.
+     */
+    QVariantMap         optimizedMediaUsage() const;
+
+public slots:
+    void            analysisFinished( qint64 mediaId, AnalysisScheduler::Kind kind, const QVariant& result );
+
 private:
     void            setCleanState( bool newState );
+    void            releasePreloadedInputs();
     void            mlDirsChanged( const QVariant& value );
     void            workspaceChanged(const QVariant& workspace );
 
@@ -122,6 +190,12 @@ private:
      *                  subclip hierarchy
      */
     QHash<QUuid, QSharedPointer<Clip>>              m_clips;
+    std::map<qint64, std::unique_ptr<Backend::IInput>>  m_preloadedInputs;
+    QHash<qint64, QVector<qint64>>                  m_sceneCuts;
+    // Decoded once, by first frame
+    QHash<qint64, QMap<qint64, QImage>>             m_thumbnails;
+    QHash<qint64, QByteArray>                       m_peaks;
+    QHash<qint64, QVariantMap>                      m_loudness;
 
 signals:
     /**
@@ -136,6 +210,10 @@ signals:
     void    clipAdded( const QString& uuid );
     void    clipRemoved( const QString& uuid );
 
+    void    sceneCutsChanged( qint64 mediaId );
+    void    thumbnailsChanged( qint64 mediaId );
+    void    peaksChanged( qint64 mediaId );
+
 };
 
 #endif // LIBRARY_H
@@ -0,0 +1,760 @@
+/*****************************************************************************
+ * MediaAnalyzers.cpp: Analyses run by the AnalysisScheduler
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "MediaAnalyzers.h"
+
+#include "Backend/FrameIndex.h"
+#include "Backend/MLT/MLTInput.h"
+#include "Main/Core.h"
+#include "Project/Workspace.h"
+#include "Tools/VlmcDebug.h"
+
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QThread>
+#include <QtMath>
+
+#include <mlt++/MltConsumer.h>
+#include <mlt++/MltEvent.h>
+#include <mlt++/MltFrame.h>
+#include <mlt++/MltProducer.h>
+#include <mlt++/MltProfile.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+namespace
+{
+
+std::unique_ptr<Backend::MLT::MLTInput>
+open( const QString& mrl )
+{
+    try
+    {
+        return std::unique_ptr<Backend::MLT::MLTInput>( new Backend::MLT::MLTInput( qPrintable( mrl ) ) );
+    }
+    catch ( Backend::InvalidServiceException& e )
+    {
+        vlmcWarning() << "Can't open" << mrl << "for analysis";
+        return {};
+    }
+}
+
+// Small enough for the comparisons to be negligible next to the decoding
+const int   SceneWidth = 64;
+const int   SceneHeight = 36;
+const int   ScenePixels = SceneWidth * SceneHeight;
+const int   HistogramBins = 32;
+
+// Plain loops over bytes, without branches, which the compiler vectorizes
+int
+sumOfAbsoluteDifferences( const uint8_t* a, const uint8_t* b )
+{
+    int sum = 0;
+    for ( auto i = 0; i < ScenePixels; ++i )
+        sum += std::abs( static_cast<int>( a[i] ) - static_cast<int>( b[i] ) );
+    return sum;
+}
+
+void
+histogram( const uint8_t* pixels, int* bins )
+{
+    std::fill( bins, bins + HistogramBins, 0 );
+    for ( auto i = 0; i < ScenePixels; ++i )
+        ++bins[pixels[i] * HistogramBins / 256];
+}
+
+int
+histogramDifference( const int* a, const int* b )
+{
+    int sum = 0;
+    for ( auto i = 0; i < HistogramBins; ++i )
+        sum += std::abs( a[i] - b[i] );
+    return sum;
+}
+
+/**
+ *  Finds the shot boundaries from the luma of consecutive frames, see
+ *  MediaAnalyzers::decodingPass()
+ */
+class SceneDetector
+{
+    public:
+        explicit SceneDetector( double fps )
+            : m_previous( ScenePixels )
+            , m_current( ScenePixels )
+            , m_hasPrevious( false )
+            , m_average( 0 )
+            , m_samples( 0 )
+            , m_lastCut( 0 )
+            // Shots shorter than half a second are most likely flashes
+            , m_minShot( qMax<qint64>( 1, qRound64( fps / 2 ) ) )
+        {
+        }
+
+        // To be filled with the luma of the next frame, before calling push()
+        uint8_t*    luma()
+        {
+            return m_current.data();
+        }
+
+        void        push( qint64 frame )
+        {
+            // A cut needs a score above this, and this many times the recent average
+            const double    threshold = 0.3;
+            const double    contrast = 3.0;
+
+            histogram( m_current.data(), m_currentBins );
+            if ( m_hasPrevious == true )
+            {
+                auto sad = static_cast<double>( sumOfAbsoluteDifferences( m_previous.data(), m_current.data() ) ) /
+                        ( 255 * ScenePixels );
+                auto hist = static_cast<double>( histogramDifference( m_previousBins, m_currentBins ) ) /
+                        ( 2 * ScenePixels );
+                auto score = ( sad + hist ) / 2;
+                // The average needs a few frames of the shot before it means anything
+                if ( score > threshold && score > contrast * m_average &&
+                     frame - m_lastCut >= m_minShot && m_samples >= m_minShot )
+                {
+                    m_cuts << frame;
+                    m_lastCut = frame;
+                    // Start over, the new shot has its own level of motion
+                    m_average = 0;
+                    m_samples = 0;
+                }
+                else if ( m_samples < m_minShot )
+                {
+                    // A plain mean over the first frames of a shot, then a decayed one
+                    ++m_samples;
+                    m_average += ( score - m_average ) / m_samples;
+                }
+                else
+                    m_average = m_average * 0.9 + score * 0.1;
+            }
+            m_hasPrevious = true;
+            m_current.swap( m_previous );
+            std::copy( m_currentBins, m_currentBins + HistogramBins, m_previousBins );
+        }
+
+        const QVariantList& cuts() const
+        {
+            return m_cuts;
+        }
+
+    private:
+        std::vector<uint8_t>    m_previous;
+        std::vector<uint8_t>    m_current;
+        int                     m_previousBins[HistogramBins];
+        int                     m_currentBins[HistogramBins];
+        bool                    m_hasPrevious;
+        double                  m_average;
+        // The number of scores in the average, since the last cut
+        qint64                  m_samples;
+        qint64                  m_lastCut;
+        qint64                  m_minShot;
+        QVariantList            m_cuts;
+};
+
+// Samples an RGBA picture down to the scene detection size, with BT.601 weights
+void
+toLuma( const uint8_t* rgba, int width, int height, uint8_t* luma )
+{
+    for ( auto y = 0; y < SceneHeight; ++y )
+    {
+        auto line = rgba + ( y * height / SceneHeight ) * width * 4;
+        for ( auto x = 0; x < SceneWidth; ++x )
+        {
+            auto p = line + ( x * width / SceneWidth ) * 4;
+            *luma++ = static_cast<uint8_t>( ( 77 * p[0] + 150 * p[1] + 29 * p[2] ) >> 8 );
+        }
+    }
+}
+
+// Fired by the avformat consumer when it can't encode or write a frame
+void
+onFatalError( mlt_properties, std::atomic_bool* failed )
+{
+    *failed = true;
+}
+
+const int   ThumbnailCount = 8;
+const int   ThumbnailWidth = 160;
+const int   ThumbnailHeight = 90;
+
+// Skip the very first frames, which are often black
+qint64
+thumbnailFrame( int index, qint64 length )
+{
+    return length * ( 2 * index + 1 ) / ( 2 * ThumbnailCount );
+}
+
+QVariantMap
+encodeThumbnail( const uint8_t* rgba, int width, int height, qint64 frame )
+{
+    QImage  image( rgba, width, height, QImage::Format_RGBA8888 );
+    QBuffer buffer;
+    buffer.open( QIODevice::WriteOnly );
+    image.save( &buffer, "PNG" );
+    return QVariantMap{
+        { "frame", frame },
+        { "image", QString::fromLatin1( buffer.data().toBase64() ) },
+    };
+}
+
+QVariant
+seekThumbnails( Backend::MLT::MLTInput& input, const AnalysisScheduler::Progress& progress )
+{
+    auto producer = input.producer();
+    auto length = input.length();
+    QVariantList    list;
+    for ( auto i = 0; i < ThumbnailCount; ++i )
+    {
+        if ( progress( static_cast<double>( i ) / ThumbnailCount ) == false )
+            return QVariant();
+        // Once the media is indexed, land on keyframes so that a single frame is
+        // decoded for each thumbnail
+        auto frame = input.keyframe( thumbnailFrame( i, length ) );
+        producer->seek( static_cast<int>( frame ) );
+        std::unique_ptr<Mlt::Frame> f( producer->get_frame() );
+        mlt_image_format format = mlt_image_rgb24a;
+        auto w = ThumbnailWidth;
+        auto h = ThumbnailHeight;
+        auto data = f->get_image( format, w, h );
+        // The frame owns the picture, encode it before releasing the frame
+        if ( data != nullptr )
+            list << encodeThumbnail( data, w, h, frame );
+    }
+    progress( 1.0 );
+    return list;
+}
+
+struct Biquad
+{
+    double  b0, b1, b2, a1, a2;
+};
+
+/*
+ * ITU-R BS.1770 K-weighting: a high shelf, then a high pass. The standard only gives
+ * their coefficients at 48kHz, they are derived from the analog prototypes for other
+ * sample rates, through the bilinear transform.
+ */
+Biquad
+kShelf( int frequency )
+{
+    const double f0 = 1681.974450955533;
+    const double gain = 3.999843853973347;
+    const double q = 0.7071752369554196;
+    auto k = std::tan( M_PI * f0 / frequency );
+    auto vh = std::pow( 10.0, gain / 20 );
+    auto vb = std::pow( vh, 0.4996667741545416 );
+    auto a0 = 1 + k / q + k * k;
+    return { ( vh + vb * k / q + k * k ) / a0, 2 * ( k * k - vh ) / a0, ( vh - vb * k / q + k * k ) / a0,
+             2 * ( k * k - 1 ) / a0, ( 1 - k / q + k * k ) / a0 };
+}
+
+Biquad
+kHighPass( int frequency )
+{
+    const double f0 = 38.13547087602444;
+    const double q = 0.5003270373238773;
+    auto k = std::tan( M_PI * f0 / frequency );
+    auto a0 = 1 + k / q + k * k;
+    return { 1.0, -2.0, 1.0, 2 * ( k * k - 1 ) / a0, ( 1 - k / q + k * k ) / a0 };
+}
+
+struct BiquadState
+{
+    BiquadState() : z1( .0 ), z2( .0 ) {}
+    double  z1, z2;
+};
+
+// Transposed direct form II, in place
+void
+filter( const Biquad& f, BiquadState& s, float* samples, int count )
+{
+    for ( auto i = 0; i < count; ++i )
+    {
+        double x = samples[i];
+        double y = f.b0 * x + s.z1;
+        s.z1 = f.b1 * x - f.a1 * y + s.z2;
+        s.z2 = f.b2 * x - f.a2 * y;
+        samples[i] = static_cast<float>( y );
+    }
+}
+
+// The channel weights, in the 5.1 order (L R C LFE Ls Rs). The LFE isn't measured.
+double
+channelWeight( int channel, int channels )
+{
+    if ( channels < 6 || channel < 3 )
+        return 1.0;
+    if ( channel == 3 )
+        return .0;
+    return 1.41;
+}
+
+/*
+ * Peak of the signal once oversampled 4 times, through a polyphase windowed sinc.
+ */
+class TruePeakMeter
+{
+    public:
+        static const int    Oversampling = 4;
+        static const int    TapsPerPhase = 12;
+
+        TruePeakMeter()
+            : m_window( TapsPerPhase - 1, .0f )
+            , m_peak( .0f )
+        {
+            const int taps = Oversampling * TapsPerPhase;
+            for ( auto n = 0; n < taps; ++n )
+            {
+                // The first phase goes through the original samples
+                double t = static_cast<double>( n - taps / 2 ) / Oversampling;
+                double sinc = t == .0 ? 1.0 : std::sin( M_PI * t ) / ( M_PI * t );
+                double hann = 0.5 - 0.5 * std::cos( 2 * M_PI * n / taps );
+                m_coefficients[n % Oversampling][n / Oversampling] = static_cast<float>( sinc * hann );
+            }
+        }
+
+        void    process( const float* samples, int count )
+        {
+            m_window.insert( m_window.end(), samples, samples + count );
+            for ( auto p = 0; p < Oversampling; ++p )
+            {
+                const float* c = m_coefficients[p];
+                for ( auto i = 0; i < count; ++i )
+                {
+                    const float* x = m_window.data() + i + TapsPerPhase - 1;
+                    float y = 0;
+                    for ( auto k = 0; k < TapsPerPhase; ++k )
+                        y += c[k] * x[-k];
+                    m_peak = std::max( m_peak, std::abs( y ) );
+                }
+            }
+            // Keep the history the next samples' phases need
+            m_window.erase( m_window.begin(), m_window.end() - ( TapsPerPhase - 1 ) );
+        }
+
+        float   peak() const
+        {
+            return m_peak;
+        }
+
+    private:
+        float               m_coefficients[Oversampling][TapsPerPhase];
+        std::vector<float>  m_window;
+        float               m_peak;
+};
+
+double
+toLufs( double power )
+{
+    return -0.691 + 10 * std::log10( power );
+}
+
+/*
+ * Two stages gating: the blocks under -70 LUFS are dropped, then the ones more
+ * than relativeGate LU under the mean of the remaining ones.
+ * Returns the loudness of the kept blocks.
+ */
+std::vector<double>
+gate( const std::vector<double>& powers, double relativeGate )
+{
+    const double absoluteGate = -70;
+    double  sum = 0;
+    int     count = 0;
+    for ( auto p : powers )
+    {
+        if ( toLufs( p ) > absoluteGate )
+        {
+            sum += p;
+            ++count;
+        }
+    }
+    std::vector<double> kept;
+    if ( count == 0 )
+        return kept;
+    auto threshold = toLufs( sum / count ) - relativeGate;
+    for ( auto p : powers )
+    {
+        auto lufs = toLufs( p );
+        if ( lufs > absoluteGate && lufs > threshold )
+            kept.push_back( lufs );
+    }
+    return kept;
+}
+
+}
+
+namespace MediaAnalyzers
+{
+
+QHash<int, QVariant>
+decodingPass( const QString& mrl, const QVector<AnalysisScheduler::Kind>& kinds,
+              const AnalysisScheduler::Progress& progress )
+{
+    auto input = open( mrl );
+    if ( input == nullptr )
+        return {};
+    auto wantThumbnails = kinds.contains( AnalysisScheduler::Thumbnails ) && input->hasVideo();
+    auto wantCuts = kinds.contains( AnalysisScheduler::SceneCuts ) && input->hasVideo();
+    auto wantPeaks = kinds.contains( AnalysisScheduler::Peaks ) && input->hasAudio();
+    QHash<int, QVariant>    results;
+    // A few seeks are much cheaper than decoding the whole media
+    if ( wantCuts == false && wantPeaks == false )
+    {
+        if ( wantThumbnails == true )
+            results[AnalysisScheduler::Thumbnails] = seekThumbnails( *input, progress );
+        return results;
+    }
+
+    auto producer = input->producer();
+    // Don't decode what no analysis looks at
+    auto wantVideo = wantThumbnails == true || wantCuts == true;
+    if ( wantVideo == false )
+        producer->set( "video_index", -1 );
+    if ( wantPeaks == false )
+        producer->set( "audio_index", -1 );
+    auto length = input->length();
+    auto fps = input->fps();
+    QVariantList    thumbnails;
+    auto            nextThumbnail = 0;
+    SceneDetector   detector( fps );
+    QVariantList    peaks;
+    if ( wantPeaks == true )
+        peaks.reserve( static_cast<int>( length ) );
+    for ( qint64 i = 0; i < length; ++i )
+    {
+        if ( i % 250 == 0 && progress( static_cast<double>( i ) / length ) == false )
+            return {};
+        producer->seek( static_cast<int>( i ) );
+        std::unique_ptr<Mlt::Frame> f( producer->get_frame() );
+        if ( wantVideo == true )
+        {
+            // A thumbnail sized picture, which the scene detection samples down
+            mlt_image_format format = mlt_image_rgb24a;
+            auto w = ThumbnailWidth;
+            auto h = ThumbnailHeight;
+            auto data = f->get_image( format, w, h );
+            if ( data != nullptr && format == mlt_image_rgb24a )
+            {
+                if ( wantCuts == true )
+                {
+                    toLuma( data, w, h, detector.luma() );
+                    detector.push( i );
+                }
+                if ( wantThumbnails == true && nextThumbnail < ThumbnailCount &&
+                     i >= thumbnailFrame( nextThumbnail, length ) )
+                {
+                    thumbnails << encodeThumbnail( data, w, h, i );
+                    ++nextThumbnail;
+                }
+            }
+        }
+        if ( wantPeaks == true )
+        {
+            mlt_audio_format format = mlt_audio_s16;
+            int frequency = 48000;
+            int channels = 2;
+            int samples = mlt_sample_calculator( static_cast<float>( fps ), frequency, i );
+            auto pcm = static_cast<int16_t*>( f->get_audio( format, frequency, channels, samples ) );
+            int peak = 0;
+            for ( auto s = 0; pcm != nullptr && s < samples * channels; ++s )
+                peak = qMax( peak, std::abs( static_cast<int>( pcm[s] ) ) );
+            peaks << peak * 255 / 32768;
+        }
+    }
+    progress( 1.0 );
+    if ( wantThumbnails == true )
+        results[AnalysisScheduler::Thumbnails] = thumbnails;
+    if ( wantCuts == true )
+    {
+        results[AnalysisScheduler::SceneCuts] = QVariantMap{
+            { "fps", fps },
+            { "cuts", detector.cuts() },
+        };
+    }
+    if ( wantPeaks == true )
+    {
+        results[AnalysisScheduler::Peaks] = QVariantMap{
+            { "fps", fps },
+            { "peaks", peaks },
+        };
+    }
+    return results;
+}
+
+QVariant
+loudness( const QString& mrl, const AnalysisScheduler::Progress& progress )
+{
+    // The measures are made over 100ms segments: momentary blocks last 4 of them, short term ones 30
+    const int momentarySegments = 4;
+    const int shortTermSegments = 30;
+
+    auto input = open( mrl );
+    if ( input == nullptr || input->hasAudio() == false )
+        return QVariant();
+    auto producer = input->producer();
+    producer->set( "video_index", -1 );
+    auto length = input->length();
+    auto fps = input->fps();
+    // Measured at the sample rate of the media, resampling would alter the true peak
+    auto index = producer->get_int( "audio_index" );
+    auto sampleRate = producer->get_int( qPrintable( QString( "meta.media.%1.codec.sample_rate" ).arg( index ) ) );
+    if ( sampleRate <= 0 )
+        sampleRate = 48000;
+
+    // The K-weighting filters, once the actual sample rate is known
+    int                         rate = 0;
+    Biquad                      shelf = {};
+    Biquad                      highPass = {};
+    int                         segmentSamples = 0;
+    std::vector<BiquadState>    shelves;
+    std::vector<BiquadState>    highPasses;
+    std::vector<TruePeakMeter>  meters;
+    std::vector<float>          weighted;
+    std::vector<double>         power;
+    // The weighted energy of each complete segment
+    std::vector<double>         segments;
+    double                      segmentEnergy = 0;
+    int                         segmentFill = 0;
+    for ( qint64 i = 0; i < length; ++i )
+    {
+        if ( i % 250 == 0 && progress( static_cast<double>( i ) / length ) == false )
+            return QVariant();
+        producer->seek( static_cast<int>( i ) );
+        std::unique_ptr<Mlt::Frame> f( producer->get_frame() );
+        // Planar, so that each channel is filtered from a contiguous buffer
+        mlt_audio_format format = mlt_audio_float;
+        int frequency = sampleRate;
+        int channels = 2;
+        int samples = mlt_sample_calculator( static_cast<float>( fps ), frequency, i );
+        auto pcm = static_cast<float*>( f->get_audio( format, frequency, channels, samples ) );
+        if ( pcm == nullptr || format != mlt_audio_float || samples <= 0 )
+            continue;
+        if ( rate == 0 )
+        {
+            rate = frequency;
+            shelf = kShelf( rate );
+            highPass = kHighPass( rate );
+            segmentSamples = rate / 10;
+        }
+        else if ( frequency != rate )
+        {
+            vlmcWarning() << "The sample rate of" << mrl << "changes from" << rate << "to" << frequency << "Hz";
+            return QVariant();
+        }
+        if ( static_cast<int>( meters.size() ) < channels )
+        {
+            shelves.resize( channels );
+            highPasses.resize( channels );
+            meters.resize( channels );
+        }
+        power.assign( samples, .0 );
+        for ( auto c = 0; c < channels; ++c )
+        {
+            auto plane = pcm + c * samples;
+            meters[c].process( plane, samples );
+            auto weight = channelWeight( c, channels );
+            if ( weight == .0 )
+                continue;
+            weighted.assign( plane, plane + samples );
+            filter( shelf, shelves[c], weighted.data(), samples );
+            filter( highPass, highPasses[c], weighted.data(), samples );
+            for ( auto s = 0; s < samples; ++s )
+                power[s] += weight * weighted[s] * weighted[s];
+        }
+        for ( auto s = 0; s < samples; ++s )
+        {
+            segmentEnergy += power[s];
+            if ( ++segmentFill == segmentSamples )
+            {
+                segments.push_back( segmentEnergy );
+                segmentEnergy = 0;
+                segmentFill = 0;
+            }
+        }
+    }
+
+    // Mean power of the sliding windows, stepping by one segment
+    std::vector<double> sums( segments.size() + 1, .0 );
+    for ( size_t s = 0; s < segments.size(); ++s )
+        sums[s + 1] = sums[s] + segments[s];
+    auto windows = [&sums, segmentSamples]( size_t count ) {
+        std::vector<double> powers;
+        for ( auto s = count; s < sums.size(); ++s )
+            powers.push_back( ( sums[s] - sums[s - count] ) / ( count * segmentSamples ) );
+        return powers;
+    };
+
+    float peak = 0;
+    for ( const auto& m : meters )
+        peak = std::max( peak, m.peak() );
+    QVariantMap result{ { "range", .0 } };
+    if ( peak > 0 )
+        result["truePeak"] = 20 * std::log10( peak );
+    // Integrated loudness, over the momentary blocks
+    auto momentary = gate( windows( momentarySegments ), 10 );
+    if ( momentary.empty() == false )
+    {
+        double sum = 0;
+        for ( auto lufs : momentary )
+            sum += std::pow( 10, ( lufs + 0.691 ) / 10 );
+        result["integrated"] = toLufs( sum / momentary.size() );
+    }
+    // Loudness range (EBU Tech 3342): the spread between the 10th and the 95th percentiles
+    auto shortTerm = gate( windows( shortTermSegments ), 20 );
+    if ( shortTerm.size() > 1 )
+    {
+        std::sort( shortTerm.begin(), shortTerm.end() );
+        auto percentile = [&shortTerm]( double ratio ) {
+            return shortTerm[static_cast<size_t>( std::round( ratio * ( shortTerm.size() - 1 ) ) )];
+        };
+        result["range"] = percentile( 0.95 ) - percentile( 0.10 );
+    }
+    progress( 1.0 );
+    return result;
+}
+
+QVariant
+keyframeIndex( const QString& mrl, const AnalysisScheduler::Progress& progress )
+{
+    auto index = Backend::FrameIndex::build( qPrintable( mrl ), progress );
+    if ( index == nullptr )
+        return QVariant();
+    auto data = index->serialize();
+    return QVariantMap{
+        { "frames", static_cast<qulonglong>( index->frameCount() ) },
+        { "keyframes", static_cast<qulonglong>( index->keyframeCount() ) },
+        { "variableFrameRate", index->isVariableFrameRate() },
+        { "index", QString::fromLatin1( QByteArray( data.data(), static_cast<int>( data.size() ) ).toBase64() ) },
+    };
+}
+
+QVariant
+optimizedMedia( const QString& mrl, const AnalysisScheduler::Progress& progress )
+{
+    auto workspace = Core::instance()->workspace();
+    auto dir = workspace != nullptr ? workspace->cacheDirectory( QStringLiteral( "optimized" ) ) : QString();
+    QFileInfo   info( AnalysisScheduler::localFile( mrl ) );
+    if ( dir.isEmpty() == true || info.exists() == false )
+        return QVariant();
+    // A modified source gets a new copy
+    auto key = info.absoluteFilePath() + '/' + QString::number( info.size() ) + '/' +
+            QString::number( info.lastModified().toMSecsSinceEpoch() );
+    auto name = QCryptographicHash::hash( key.toUtf8(), QCryptographicHash::Sha1 ).toHex();
+    auto target = dir + '/' + QString::fromLatin1( name ) + ".mov";
+    auto partial = target + ".part";
+    // The result isn't persisted, so that a deleted copy is made again, see setup()
+    if ( QFileInfo::exists( target ) == true )
+    {
+        progress( 1.0 );
+        return QVariantMap{
+            { "file", target },
+            { "size", QFileInfo( target ).size() },
+        };
+    }
+
+    // The copy keeps the source resolution & frame rate, whatever the project settings are
+    Mlt::Profile    profile;
+    {
+        Mlt::Producer probe( profile, "avformat", qPrintable( mrl ) );
+        if ( probe.is_valid() == false || probe.get_int( "video_index" ) < 0 )
+            return QVariant();
+        profile.from_producer( probe );
+        profile.set_explicit( 1 );
+    }
+    Mlt::Producer   producer( profile, "avformat", qPrintable( mrl ) );
+    if ( producer.is_valid() == false )
+        return QVariant();
+    Mlt::Consumer   consumer( profile, "avformat", qPrintable( partial ) );
+    // ProRes: each frame is decoded on its own, at any resolution
+    consumer.set( "f", "mov" );
+    consumer.set( "vcodec", "prores_ks" );
+    consumer.set( "pix_fmt", "yuv422p10le" );
+    consumer.set( "acodec", "pcm_s16le" );
+    consumer.set( "terminate_on_pause", 1 );
+    // Encode every frame, however long it takes
+    consumer.set( "real_time", -1 );
+    // The consumer stops on encoding & writing errors too
+    std::atomic_bool    failed( false );
+    std::unique_ptr<Mlt::Event> event( consumer.listen( "consumer-fatal-error", &failed,
+                                                        (mlt_listener)onFatalError ) );
+    consumer.connect( producer );
+    if ( consumer.start() != 0 )
+        return QVariant();
+    auto length = qMax( 1, producer.get_playtime() );
+    while ( consumer.is_stopped() == false )
+    {
+        if ( progress( static_cast<double>( producer.position() ) / length ) == false )
+        {
+            consumer.stop();
+            QFile::remove( partial );
+            return QVariant();
+        }
+        QThread::msleep( 250 );
+    }
+    if ( failed == true || QFileInfo( partial ).size() == 0 )
+    {
+        vlmcWarning() << "Can't transcode" << mrl << "to" << partial;
+        QFile::remove( partial );
+        return QVariant();
+    }
+    QFile::remove( target );
+    if ( QFile::rename( partial, target ) == false )
+    {
+        vlmcWarning() << "Can't write optimized media" << target;
+        QFile::remove( partial );
+        return QVariant();
+    }
+    progress( 1.0 );
+    return QVariantMap{
+        { "file", target },
+        { "size", QFileInfo( target ).size() },
+    };
+}
+
+void
+setup( AnalysisScheduler& scheduler )
+{
+    scheduler.setSharedAnalyzer( { AnalysisScheduler::Thumbnails, AnalysisScheduler::Peaks,
+                                   AnalysisScheduler::SceneCuts }, &decodingPass );
+    scheduler.setAnalyzer( AnalysisScheduler::Loudness, &loudness );
+    scheduler.setAnalyzer( AnalysisScheduler::KeyframeIndex, &keyframeIndex );
+    // The copy may be deleted, to save space or along with the workspace cache
+    scheduler.setAnalyzer( AnalysisScheduler::OptimizedMedia, &optimizedMedia, false );
+}
+
+}
@@ -0,0 +1,85 @@
+/*****************************************************************************
+ * MediaAnalyzers.h: Analyses run by the AnalysisScheduler
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef MEDIAANALYZERS_H
+#define MEDIAANALYZERS_H
+
+#include "AnalysisScheduler.h"
+
+/**
+ *  Each analyzer opens its own producer, so that it never competes with the
+ *  playback or the library for a decoder.
+ */
+namespace MediaAnalyzers
+{
+    /**
+     *  @brief  Computes the thumbnails, audio peaks, and scene cuts of a media at once.
+     *
+     *  The media is decoded once for all the requested kinds, each frame being decoded
+     *  as a thumbnail sized picture. Thumbnails alone only need a few seeks.
+     *  The results are:
+     *  - Thumbnails: small PNG snapshots spread over the media, as a list of
+     *    { "frame", "image" } maps, the image being base64 encoded.
+     *  - Peaks: { "fps", "peaks" }, the audio peak of each frame, from 0 to 255.
+     *  - SceneCuts: { "fps", "cuts" }, cuts being the first frame of each shot but the
+     *    first one. Each frame is sampled down to a small grayscale picture, and compared
+     *    to the previous one through the difference of their histograms and their mean
+     *    absolute difference. A cut is reported when that score is both high and well
+     *    above the recent ones, so that camera motion and flashes don't split a shot.
+     */
+    QHash<int, QVariant>    decodingPass( const QString& mrl, const QVector<AnalysisScheduler::Kind>& kinds,
+                                          const AnalysisScheduler::Progress& progress );
+
+    /**
+     *  @brief  Measures the loudness of a media, as defined by EBU R128.
+     *
+     *  The audio is K-weighted and gated as per ITU-R BS.1770, and its true peak is
+     *  measured on a 4 times oversampled signal.
+     *  @return { "integrated", "range", "truePeak" }, in LUFS, LU and dBTP. The integrated
+     *          loudness and the true peak are missing for a silent media.
+     */
+    QVariant    loudness( const QString& mrl, const AnalysisScheduler::Progress& progress );
+
+    /**
+     *  @brief  Indexes the keyframes and timestamps of a video, see Backend::FrameIndex.
+     *  @return { "frames", "keyframes", "variableFrameRate", "index" }, the index being
+     *          serialized and base64 encoded.
+     */
+    QVariant    keyframeIndex( const QString& mrl, const AnalysisScheduler::Progress& progress );
+
+    /**
+     *  @brief  Transcodes a video to an all-intra intermediate codec, for smooth playback.
+     *
+     *  Long-GOP sources need the frames before the one shown to be decoded, which
+     *  several tracks at full resolution can't afford in real time. The copy keeps the
+     *  resolution and the frame rate of the source, and is written to the workspace.
+     *  @return { "file", "size" }, the size being in bytes
+     */
+    QVariant    optimizedMedia( const QString& mrl, const AnalysisScheduler::Progress& progress );
+
+    /**
+     *  @brief  Registers the analyzers above to a scheduler.
+     */
+    void        setup( AnalysisScheduler& scheduler );
+}
+
+#endif // MEDIAANALYZERS_H
@@ -23,6 +23,8 @@
 #include "config.h"
 
 #include "MediaLibraryModel.h"
+#include "Media/ImageSequence.h"
+#include "Media/Media.h"
 #include <QUrl>
 
 MediaLibraryModel::MediaLibraryModel( medialibrary::IMediaLibrary& ml, QObject *parent )
@@ -34,6 +36,9 @@ MediaLibraryModel::MediaLibraryModel( medialibrary::IMediaLibrary& ml, QObject *
 
 void MediaLibraryModel::addMedia( medialibrary::MediaPtr media )
 {
+    // The rest of an image sequence is imported along with its first image
+    if ( ImageSequence::isFollowingImage( Media::mrl( media ) ) == true )
+        return;
     auto size = m_media.size();
     beginInsertRows( QModelIndex(), size, size );
     m_media.push_back( media );
@@ -33,24 +33,33 @@
 
 
 #include <Backend/IBackend.h>
+#include "Library/AnalysisScheduler.h"
 #include "Library/Library.h"
+#include "Library/MediaAnalyzers.h"
+#include "Media/Clip.h"
+#include "Media/Media.h"
 #include "Project/RecentProjects.h"
 #include "Project/Workspace.h"
 #include <Settings/Settings.h>
+#include "Tools/BackgroundReleaser.h"
 #include <Tools/VlmcLogger.h>
 #include "Workflow/MainWorkflow.h"
+#include "Workflow/SequenceWorkflow.h"
 
 Core::Core()
 {
     m_backend = Backend::instance();
     m_logger = new VlmcLogger;
+    m_releaser = new BackgroundReleaser;
 
     createSettings();
     m_currentProject = new Project( m_settings );
     m_workspace = new Workspace( m_settings );
+    m_analysisScheduler = new AnalysisScheduler( m_settings );
+    MediaAnalyzers::setup( *m_analysisScheduler );
     m_library = new Library( m_settings, m_currentProject->settings() );
     m_recentProjects = new RecentProjects( m_settings );
-    m_workflow = new MainWorkflow( m_currentProject->settings() );
+    m_workflow = new MainWorkflow( m_settings, m_currentProject->settings() );
 
     QObject::connect( m_workflow, &MainWorkflow::cleanChanged, m_currentProject, &Project::cleanChanged );
     QObject::connect( m_currentProject, &Project::projectSaved, m_workflow, &MainWorkflow::setClean );
@@ -60,6 +69,15 @@ Core::Core()
     QObject::connect( m_currentProject, &Project::projectClosed, m_library, &Library::clear );
     QObject::connect( m_currentProject, &Project::projectClosed, m_workflow, &MainWorkflow::clear );
     QObject::connect( m_currentProject, &Project::fpsChanged, m_workflow, &MainWorkflow::fpsChanged );
+    QObject::connect( m_analysisScheduler, &AnalysisScheduler::finished, m_library, &Library::analysisFinished );
+    // Analyze what the timeline uses before the rest of the library
+    auto sequence = m_workflow->sequenceWorkflow();
+    QObject::connect( sequence, &SequenceWorkflow::clipAdded, [this, sequence]( SlotHandle handle )
+    {
+        auto c = sequence->clip( handle );
+        if ( c != nullptr )
+            m_analysisScheduler->raisePriority( c->clip->media()->id(), AnalysisScheduler::Visible );
+    } );
 
     m_timer.start();
 }
@@ -68,10 +86,14 @@ Core::~Core()
 {
     delete m_workflow;
     delete m_recentProjects;
+    // Analyzers own producers, and may still use the library media
+    delete m_analysisScheduler;
     delete m_library;
     delete m_workspace;
     delete m_currentProject;
     delete m_settings;
+    // Producers still being released must be closed before the backend
+    delete m_releaser;
     delete m_backend;
     delete m_logger;
 }
@@ -134,6 +156,18 @@ Core::library()
     return m_library;
 }
 
+BackgroundReleaser*
+Core::releaser()
+{
+    return m_releaser;
+}
+
+AnalysisScheduler*
+Core::analysisScheduler()
+{
+    return m_analysisScheduler;
+}
+
 qint64
 Core::runtime()
 {
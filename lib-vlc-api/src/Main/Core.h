@@ -23,7 +23,9 @@
 #ifndef CORE_H
 #define CORE_H
 
+class AnalysisScheduler;
 class AutomaticBackup;
+class BackgroundReleaser;
 class Library;
 class MainWorkflow;
 class Project;
@@ -51,6 +53,14 @@ class Core : public MeyersSingleton<Core>
         Project*                project();
         MainWorkflow*           workflow();
         Library*                library();
+        /**
+         * @brief releaser  The thread destroying torn down project objects
+         */
+        BackgroundReleaser*     releaser();
+        /**
+         * @brief analysisScheduler The background media analysis jobs
+         */
+        AnalysisScheduler*      analysisScheduler();
         /**
          * @brief runtime returns the application runtime
          */
@@ -72,6 +82,8 @@ class Core : public MeyersSingleton<Core>
         Project*                m_currentProject;
         MainWorkflow*           m_workflow;
         Library*                m_library;
+        BackgroundReleaser*     m_releaser;
+        AnalysisScheduler*      m_analysisScheduler;
         QElapsedTimer           m_timer;
 
         friend Singleton_t::AllowInstantiation;
@@ -32,17 +32,23 @@
 
 #include "Tools/VlmcDebug.h"
 #include "Workflow/Types.h"
+#include "Tools/SlotMap.hpp"
 #include "Renderer/ConsoleRenderer.h"
+#include "Renderer/RenderFarmWorker.h"
 #include "Project/Project.h"
 #include "Backend/IBackend.h"
 #include "Main/Core.h"
 #include "Settings/Settings.h"
+#include "Tools/VlmcLogger.h"
 #ifdef HAVE_GUI
 #include "Gui/MainWindow.h"
 #include "Gui/IntroDialog.h"
 #include "Gui/LanguageHelper.h"
 #include "Gui/wizard/firstlaunch/FirstLaunchWizard.h"
 #endif
+#ifdef HAVE_CONTROLSERVER
+#include "ControlServer/ControlServer.h"
+#endif
 
 #ifdef HAVE_GUI
 #include <QApplication>
@@ -57,6 +63,8 @@
 #include <QTextCodec>
 #include <QCommandLineParser>
 
+#include <memory>
+
 #ifdef Q_WS_X11
 #include <X11/Xlib.h>
 #endif
@@ -77,13 +85,39 @@ setupCommandLine( QCommandLineParser& parser )
                                   QCoreApplication::translate( "main", "Project file to open." ),
                                   "[filename|URI]" );
     parser.addPositionalArgument( "output",
-                                  QCoreApplication::translate( "main", "Output file to write to." ),
+                                  QCoreApplication::translate( "main", "Output file to write to. Use - to stream to the "
+                                                             "standard output, or a .m3u8/.mpd name for live HLS/DASH." ),
                                   "[filename]" );
 
     parser.addOption( { "v",
                         QCoreApplication::translate( "main", "Log level - Verbose" ) } );
     parser.addOption( { "vv",
                         QCoreApplication::translate( "main", "Log level - Debug" ) } );
+    parser.addOption( { "incremental",
+                        QCoreApplication::translate( "main", "Render as checkpointed segments, resuming an interrupted export "
+                                                          "and reusing the unchanged segments of a previous one" ) } );
+    parser.addOption( { "loudness",
+                        QCoreApplication::translate( "main", "Normalize the audio clips to the given integrated loudness, "
+                                                          "ie. -23 LUFS for EBU R128" ),
+                        "LUFS" } );
+    parser.addOption( { "farm",
+                        QCoreApplication::translate( "main", "Render using the given number of local worker processes" ),
+                        "workers" } );
+    parser.addOption( { "farm-port",
+                        QCoreApplication::translate( "main", "Port on which the render farm accepts remote workers, "
+                                                          "which must share the VLMC_FARM_TOKEN environment variable" ),
+                        "port" } );
+    parser.addOption( { "worker",
+                        QCoreApplication::translate( "main", "Run as a render farm worker for the given coordinator" ),
+                        "host:port" } );
+#ifdef HAVE_CONTROLSERVER
+    parser.addOption( { "control-port",
+                        QCoreApplication::translate( "main", "Port on which a local client can remote control VLMC" ),
+                        "port" } );
+    parser.addOption( { "control-token",
+                        QCoreApplication::translate( "main", "Token the remote control client must authenticate with" ),
+                        "token" } );
+#endif
     parser.addOption( { { "b", "backendverbose" },
                         QCoreApplication::translate( "main", "Backend Log level to set" ),
                         "value" } );
@@ -98,6 +132,7 @@ VLMCmainCommon( Backend::IBackend** backend )
     qRegisterMetaType<Vlmc::FrameChangedReason>( "Vlmc::FrameChangedReason" );
     qRegisterMetaType<QVariant>( "QVariant" );
     qRegisterMetaType<QUuid>( "QUuid" );
+    qRegisterMetaType<SlotHandle>( "SlotHandle" );
 
     *backend = Backend::instance();
 }
@@ -109,7 +144,7 @@ VLMCmainCommon( Backend::IBackend** backend )
  */
 #ifdef HAVE_GUI
 int
-VLMCGuimain( const QString& projectFile )
+VLMCGuimain( const QString& projectFile, const QCommandLineParser& parser )
 {
 #ifdef Q_WS_X11
     XInitThreads();
@@ -166,6 +201,20 @@ VLMCGuimain( const QString& projectFile )
     qApp->setAttribute( Qt::AA_DontCreateNativeWidgetSiblings, true );
     MainWindow w( backend );
 
+#ifdef HAVE_CONTROLSERVER
+    std::unique_ptr<ControlServer> controlServer;
+    if ( parser.isSet( "control-port" ) == true )
+    {
+        if ( parser.value( "control-token" ).isEmpty() == true )
+            vlmcWarning() << "A token is required to enable the control server";
+        else
+            controlServer.reset( new ControlServer( parser.value( "control-port" ).toUShort(),
+                                                    parser.value( "control-token" ) ) );
+    }
+#else
+    Q_UNUSED( parser );
+#endif
+
     if ( FirstLaunchWizard::shouldRun() == true )
     {
         FirstLaunchWizard wiz;
@@ -195,12 +244,19 @@ VLMCGuimain( const QString& projectFile )
  *  \return Return value of vlmc
  */
 int
-VLMCCoremain( const QString& projectFile , const QString& outputFile)
+VLMCCoremain( const QString& projectFile , const QString& outputFile, const QCommandLineParser& parser )
 {
     Backend::IBackend* backend;
     VLMCmainCommon( &backend );
 
-    ConsoleRenderer renderer( outputFile );
+    // Keep the standard output clean when it carries the rendered stream
+    if ( outputFile == "-" || outputFile.startsWith( "pipe:1" ) == true )
+        Core::instance()->logger()->setConsoleStream( stderr );
+    ConsoleRenderer renderer( outputFile, parser.isSet( "incremental" ) );
+    if ( parser.isSet( "farm" ) == true )
+        renderer.setRenderFarm( parser.value( "farm" ).toUInt(), parser.value( "farm-port" ).toUShort() );
+    if ( parser.isSet( "loudness" ) == true )
+        renderer.setLoudnessTarget( parser.value( "loudness" ).toDouble() );
     Project  *p = Core::instance()->project();
 
     QCoreApplication::connect( p, &Project::projectLoaded, &renderer, &ConsoleRenderer::startRender );
@@ -213,6 +269,24 @@ VLMCCoremain( const QString& projectFile , const QString& outputFile)
     return res;
 }
 
+/**
+ *  \brief Render farm worker entry point
+ *  \sa    RenderFarmWorker
+ */
+int
+VLMCWorkermain( const QString& server )
+{
+    Backend::IBackend* backend;
+    VLMCmainCommon( &backend );
+
+    RenderFarmWorker worker( server );
+    QCoreApplication::connect( &worker, &RenderFarmWorker::finished, qApp, &QCoreApplication::quit, Qt::QueuedConnection );
+    Core::instance()->settings()->load();
+    worker.start();
+
+    return qApp->exec();
+}
+
 int
 VLMCmain( int argc, char **argv )
 {
@@ -240,13 +314,15 @@ VLMCmain( int argc, char **argv )
 
     const auto& args = parser.positionalArguments();
 
+    if ( parser.isSet( "worker" ) == true )
+        return VLMCWorkermain( parser.value( "worker" ) );
     if ( args.size() >= 2  )
-        return VLMCCoremain( args.at( 0 ), args.at( 1 ) );
+        return VLMCCoremain( args.at( 0 ), args.at( 1 ), parser );
 #ifdef HAVE_GUI
     else if ( args.size() == 1 )
-        return VLMCGuimain( args.at( 0 ) );
+        return VLMCGuimain( args.at( 0 ), parser );
     else
-        return VLMCGuimain( "" );
+        return VLMCGuimain( "", parser );
 #else
     else
         parser.showHelp( 1 ); // This function exits the application. No need to return any value.
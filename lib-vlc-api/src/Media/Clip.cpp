@@ -47,6 +47,14 @@ Clip::Clip( QSharedPointer<Media> media, qint64 begin /*= 0*/, qint64 end /*= Ba
 {
 }
 
+Clip::Clip( QSharedPointer<Media> media, std::unique_ptr<Backend::IInput> input, const QUuid& uuid ) :
+        Workflow::Helper( uuid ),
+        m_media( media ),
+        m_input( std::move( input ) ),
+        m_onTimeline( false )
+{
+}
+
 Clip::~Clip()
 {
     emit unloaded( this );
@@ -57,6 +57,17 @@ class   Clip : public Workflow::Helper
          *  \param  uuid    A unique identifier. If not given, one will be generated.
          */
         Clip( QSharedPointer<Media> parent, qint64 begin = 0, qint64 end = Backend::IInput::EndOfMedia, const QUuid &uuid = QStringLiteral() );
+        /**
+         *  \brief  Constructs a Clip reading from its own producer instead of
+         *          a cut of the parent's one.
+         *
+         *  Such a clip doesn't share any state with the media input, so it can
+         *  be rendered while the parent is being played.
+         *  \param  parent  The media to represent.
+         *  \param  input   The clip input, with its boundaries already set.
+         *  \param  uuid    A unique identifier.
+         */
+        Clip( QSharedPointer<Media> parent, std::unique_ptr<Backend::IInput> input, const QUuid &uuid );
 
         virtual ~Clip();
 
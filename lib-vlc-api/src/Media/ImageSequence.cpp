@@ -0,0 +1,313 @@
+/*****************************************************************************
+ * ImageSequence.cpp: A numbered series of images, played as a video
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "ImageSequence.h"
+
+#include "Backend/MLT/MLTImageSequence.h"
+#include "Main/Core.h"
+#include "Media.h"
+#include "Settings/Settings.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QRegularExpression>
+#include <QUrl>
+#include <QVector>
+
+#include <algorithm>
+
+namespace
+{
+
+QString
+localPath( const QString& path )
+{
+    if ( path.startsWith( QStringLiteral( "file://" ) ) == true )
+        return QUrl( path, QUrl::TolerantMode ).toLocalFile();
+    return path;
+}
+
+bool
+isImage( const QFileInfo& info )
+{
+    return Media::ImageExtensions.split( ' ' ).contains( "*." + info.suffix().toLower() );
+}
+
+// Splits an image name around its last number, ie. "shot_" "0042" ".png"
+bool
+split( const QString& fileName, QString& prefix, QString& number, QString& suffix )
+{
+    static const QRegularExpression re( QStringLiteral( "^(.*?)(\\d+)(\\D*)$" ) );
+    auto match = re.match( fileName );
+    if ( match.hasMatch() == false )
+        return false;
+    prefix = match.captured( 1 );
+    number = match.captured( 2 );
+    suffix = match.captured( 3 );
+    return true;
+}
+
+// The numbers of the images sharing a prefix & suffix in a directory
+struct Numbering
+{
+    QDateTime                           modified;
+    // By number of digits, ie. 4 for "0042" and "1042"
+    QHash<int, QVector<int>>            byWidth;
+    // The numbers written without leading zeros, ie. "42" and "1042"
+    QVector<int>                        unpadded;
+};
+
+/*
+ * The media library adds the images of a directory one by one: the listing is parsed
+ * once, rather than for each image, until the directory changes. The copies returned
+ * share their numbers with the cache.
+ */
+Numbering
+numbering( const QDir& dir, const QString& prefix, const QString& suffix )
+{
+    static QMutex                       lock;
+    static QHash<QString, Numbering>    cache;
+
+    auto modified = QFileInfo( dir.absolutePath() ).lastModified();
+    auto key = dir.absolutePath() + '/' + prefix + QChar( 0 ) + suffix;
+    QMutexLocker locker( &lock );
+    auto it = cache.find( key );
+    if ( it != cache.end() && it->modified == modified )
+        return *it;
+
+    Numbering res;
+    res.modified = modified;
+    QRegularExpression re( '^' + QRegularExpression::escape( prefix ) + QStringLiteral( "(\\d+)" ) +
+                           QRegularExpression::escape( suffix ) + '$' );
+    for ( const auto& name : dir.entryList( QDir::Files ) )
+    {
+        auto match = re.match( name );
+        if ( match.hasMatch() == false )
+            continue;
+        auto digits = match.captured( 1 );
+        bool ok;
+        auto n = digits.toInt( &ok );
+        if ( ok == false )
+            continue;
+        res.byWidth[digits.size()].push_back( n );
+        if ( digits == QString::number( n ) )
+            res.unpadded.push_back( n );
+    }
+    for ( auto& numbers : res.byWidth )
+        std::sort( numbers.begin(), numbers.end() );
+    std::sort( res.unpadded.begin(), res.unpadded.end() );
+    cache[key] = res;
+    return res;
+}
+
+// The run of images around a number, over the missing ones the backend can replace
+bool
+findRun( const QVector<int>& numbers, int number, int& first, int& last )
+{
+    auto current = std::lower_bound( numbers.begin(), numbers.end(), number );
+    if ( current == numbers.end() || *current != number )
+        return false;
+    const auto maxGap = Backend::MLT::ImageSequenceProducer::MaxGap;
+    auto begin = current;
+    while ( begin != numbers.begin() && *begin - *( begin - 1 ) <= maxGap )
+        --begin;
+    auto end = current;
+    while ( end + 1 != numbers.end() && *( end + 1 ) - *end <= maxGap )
+        ++end;
+    first = *begin;
+    last = *end;
+    return end - begin + 1 >= ImageSequence::MinimumCount;
+}
+
+}
+
+const int ImageSequence::MinimumCount = 8;
+
+ImageSequence::ImageSequence()
+    : m_first( 0 )
+    , m_last( -1 )
+    , m_fps( .0 )
+{
+}
+
+ImageSequence
+ImageSequence::detect( const QString& path )
+{
+    // Numbered photos, ie. IMG_0001.jpg, look just like renders: this is an explicit choice
+    if ( VLMC_GET_BOOL( "vlmc/ImportImageSequences" ) == false )
+        return ImageSequence();
+    auto fps = VLMC_GET_DOUBLE( "vlmc/ImageSequenceFps" );
+    QFileInfo info( localPath( path ) );
+    QString prefix;
+    QString number;
+    QString suffix;
+    if ( fps <= .0 || info.exists() == false || isImage( info ) == false ||
+         split( info.fileName(), prefix, number, suffix ) == false )
+        return ImageSequence();
+
+    bool ok;
+    auto n = number.toInt( &ok );
+    if ( ok == false )
+        return ImageSequence();
+    auto numbers = numbering( info.dir(), prefix, suffix );
+    int first;
+    int last;
+    // Zero-padded numbers all have the same width, ie. "0998" to "1042". A run without
+    // any leading zero, ie. "998" to "1042" or "1001" to "1042", is written as is.
+    int width = number.size();
+    if ( findRun( numbers.byWidth.value( width ), n, first, last ) == false ||
+         QString::number( first ).size() == width )
+    {
+        if ( number != QString::number( n ) || findRun( numbers.unpadded, n, first, last ) == false )
+            return ImageSequence();
+        width = 0;
+    }
+
+    ImageSequence sequence;
+    auto base = info.absolutePath() + '/' + prefix;
+    sequence.m_pattern = base.replace( '%', QStringLiteral( "%%" ) ) +
+            ( width > 0 ? "%0" + QString::number( width ) + 'd' : QStringLiteral( "%d" ) ) +
+            suffix.replace( '%', QStringLiteral( "%%" ) );
+    sequence.m_first = first;
+    sequence.m_last = last;
+    sequence.m_fps = fps;
+    return sequence;
+}
+
+bool
+ImageSequence::isFollowingImage( const QString& path )
+{
+    QFileInfo info( localPath( path ) );
+    QString prefix;
+    QString number;
+    QString suffix;
+    if ( isImage( info ) == false || split( info.fileName(), prefix, number, suffix ) == false )
+        return false;
+    auto sequence = detect( path );
+    return sequence.isValid() == true && number.toInt() != sequence.first();
+}
+
+bool
+ImageSequence::isValid() const
+{
+    return m_pattern.isEmpty() == false && m_last >= m_first && m_fps > .0;
+}
+
+const QString&
+ImageSequence::pattern() const
+{
+    return m_pattern;
+}
+
+int
+ImageSequence::first() const
+{
+    return m_first;
+}
+
+int
+ImageSequence::last() const
+{
+    return m_last;
+}
+
+int
+ImageSequence::count() const
+{
+    return m_last - m_first + 1;
+}
+
+double
+ImageSequence::fps() const
+{
+    return m_fps;
+}
+
+QString
+ImageSequence::name() const
+{
+    auto fileName = m_pattern.mid( m_pattern.lastIndexOf( '/' ) + 1 );
+    QString name;
+    for ( int i = 0; i < fileName.size(); ++i )
+    {
+        if ( fileName[i] != '%' )
+            name += fileName[i];
+        else if ( i + 1 < fileName.size() && fileName[i + 1] == '%' )
+        {
+            name += '%';
+            ++i;
+        }
+        else
+        {
+            // "%04d" becomes "####", i ends up on the 'd'
+            int digits = 0;
+            while ( i + 1 < fileName.size() && fileName[i + 1].isDigit() == true )
+                digits = digits * 10 + fileName[++i].digitValue();
+            ++i;
+            name += QString( std::max( digits, 1 ), '#' );
+        }
+    }
+    return name;
+}
+
+QString
+ImageSequence::resource() const
+{
+    auto readAhead = VLMC_GET_INT( "vlmc/ImageSequenceReadAhead" );
+    // The numbers are formatted regardless of the locale, as the backend expects them
+    return m_pattern + QStringLiteral( "?first=" ) + QString::number( m_first ) +
+            QStringLiteral( "&last=" ) + QString::number( m_last ) +
+            QStringLiteral( "&fps=" ) + QString::number( m_fps, 'g', 10 ) +
+            QStringLiteral( "&readahead=" ) + QString::number( readAhead );
+}
+
+QVariant
+ImageSequence::toVariant() const
+{
+    return QVariantMap{
+        { "pattern", m_pattern },
+        { "first", m_first },
+        { "last", m_last },
+        { "fps", m_fps },
+    };
+}
+
+ImageSequence
+ImageSequence::fromVariant( const QVariant& v )
+{
+    auto m = v.toMap();
+    ImageSequence sequence;
+    if ( m.contains( "pattern" ) == false )
+        return sequence;
+    sequence.m_pattern = m["pattern"].toString();
+    sequence.m_first = m["first"].toInt();
+    sequence.m_last = m["last"].toInt();
+    sequence.m_fps = m["fps"].toDouble();
+    return sequence;
+}
@@ -0,0 +1,85 @@
+/*****************************************************************************
+ * ImageSequence.h: A numbered series of images, played as a video
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef IMAGESEQUENCE_H
+#define IMAGESEQUENCE_H
+
+#include <QString>
+#include <QVariant>
+
+/**
+ * @brief The ImageSequence class describes numbered images, ie. renders, imported as a single media
+ *
+ * The images are played by the backend's "vlmc_sequence" producer, which decodes them
+ * ahead of the playback on worker threads.
+ */
+class ImageSequence
+{
+public:
+    ImageSequence();
+
+    /**
+     * @brief detect    Finds the sequence an image is part of
+     * @param path      The image, as a path or a file:// mrl
+     * @return  An invalid sequence if sequences aren't imported, see "vlmc/ImportImageSequences",
+     *          or if the file isn't part of a run of at least MinimumCount numbered images.
+     *          The numbers are either zero-padded to the same width, or not padded at all.
+     *
+     * The images are played at the "vlmc/ImageSequenceFps" frame rate.
+     */
+    static ImageSequence    detect( const QString& path );
+    /**
+     * @brief isFollowingImage  Returns true if the image is part of a sequence, but not its first image
+     *
+     * The media library indexes each image. Only the first one of a sequence is listed,
+     * and importing it imports the whole sequence.
+     */
+    static bool             isFollowingImage( const QString& path );
+
+    // Shorter runs of numbered images, ie. a few photos, are imported one by one
+    static const int        MinimumCount;
+
+    bool                    isValid() const;
+    // ie. "/renders/shot_%04d.png", or "/renders/shot_%d.png" without padding, "%" being escaped as "%%"
+    const QString&          pattern() const;
+    int                     first() const;
+    int                     last() const;
+    int                     count() const;
+    double                  fps() const;
+    // ie. "shot_####.png"
+    QString                 name() const;
+    /**
+     * @brief resource  Returns what the backend opens, including the read-ahead setting
+     */
+    QString                 resource() const;
+
+    QVariant                toVariant() const;
+    static ImageSequence    fromVariant( const QVariant& v );
+
+private:
+    QString                 m_pattern;
+    int                     m_first;
+    int                     m_last;
+    double                  m_fps;
+};
+
+#endif // IMAGESEQUENCE_H
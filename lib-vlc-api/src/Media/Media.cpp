@@ -42,6 +42,7 @@
 #include "Library/Library.h"
 #include "Tools/VlmcDebug.h"
 #include "Project/Workspace.h"
+#include "Settings/Settings.h"
 
 const QString   Media::VideoExtensions = "*.avi *.3gp *.amv *.asf *.divx *.dv *.flv *.gxf "
                                          "*.iso *.m1v *.m2v *.m2t *.m2ts *.m4v *.mkv *.mov "
@@ -59,24 +60,58 @@ const QString   Media::AudioExtensions = "*.a52 *.aac *.ac3 *.aiff *.amr *.aob *
 const QString   Media::streamPrefix = "stream://";
 
 Media::Media( medialibrary::MediaPtr media, const QUuid& uuid /* = QUuid() */ )
-    : m_input( nullptr )
+    : Media( media, nullptr, uuid )
+{
+}
+
+Media::Media( medialibrary::MediaPtr media, std::unique_ptr<Backend::IInput> input, const QUuid& uuid )
+    : m_input( std::move( input ) )
     , m_mlMedia( media )
+    , m_mlFile( mainFile( media ) )
     , m_baseClipUuid( uuid )
     , m_baseClip( nullptr )
+{
+    if ( m_mlFile == nullptr )
+        vlmcFatal( "No file representing media %s", media->title().c_str(), "was found" );
+    if ( m_input == nullptr )
+        m_input.reset( new Backend::MLT::MLTInput( qPrintable( mrl() ) ) );
+}
+
+Media::Media( medialibrary::MediaPtr media, const ImageSequence& sequence, const QUuid& uuid /* = QUuid() */ )
+    : Media( media, std::unique_ptr<Backend::IInput>( new Backend::MLT::MLTInput( qPrintable( sequence.resource() ) ) ), uuid )
+{
+    m_sequence = sequence;
+}
+
+QSharedPointer<Media>
+Media::fromMediaLibrary( medialibrary::MediaPtr media )
+{
+    auto sequence = ImageSequence::detect( mrl( media ) );
+    if ( sequence.isValid() == true )
+        return QSharedPointer<Media>::create( media, sequence );
+    return QSharedPointer<Media>::create( media );
+}
+
+medialibrary::FilePtr
+Media::mainFile( const medialibrary::MediaPtr& media )
 {
     auto files = media->files();
     Q_ASSERT( files.size() > 0 );
     for ( const auto& f : files )
     {
         if ( f->type() == medialibrary::IFile::Type::Main )
-        {
-            m_mlFile = f;
-            break;
-        }
+            return f;
     }
-    if ( m_mlFile == nullptr )
-        vlmcFatal( "No file representing media %s", media->title().c_str(), "was found" );
-    m_input.reset( new Backend::MLT::MLTInput( qPrintable( mrl() ) ) );
+    return nullptr;
+}
+
+QString
+Media::mrl( const medialibrary::MediaPtr& media )
+{
+    auto f = mainFile( media );
+    if ( f == nullptr )
+        return QString();
+    return QUrl::fromPercentEncoding( QByteArray( f->mrl().c_str() ) );
 }
 
 QString
@@ -88,6 +123,8 @@ Media::mrl() const
 QString
 Media::title() const
 {
+    if ( m_sequence.isValid() == true )
+        return m_sequence.name();
     return QUrl::fromPercentEncoding( QByteArray( m_mlMedia->title().c_str() ) );
 }
 
@@ -129,6 +166,10 @@ Media::toVariant() const
         { "uuid", m_baseClip->uuid() },
         { "mlId", static_cast<qlonglong>( m_mlMedia->id() ) }
     };
+    if ( m_optimizedFile.isEmpty() == false )
+        h.insert( "optimized", m_optimizedFile );
+    if ( m_sequence.isValid() == true )
+        h.insert( "sequence", m_sequence.toVariant() );
     if ( m_clips.isEmpty() == false )
     {
         QVariantList l;
@@ -151,6 +192,24 @@ Media::input() const
     return m_input.get();
 }
 
+const QString&
+Media::optimizedFile() const
+{
+    return m_optimizedFile;
+}
+
+void
+Media::setOptimizedFile( const QString& optimizedFile )
+{
+    m_optimizedFile = optimizedFile;
+}
+
+const ImageSequence&
+Media::imageSequence() const
+{
+    return m_sequence;
+}
+
 bool
 Media::hasVideoTracks() const
 {
@@ -171,6 +230,8 @@ Media::fromVariant( const QVariant& v )
      * media: {
      *  mlId: <id>   // The media library ID
      *  uuid: <uuid> // The root clip UUID
+     *  optimized: <path>   // The optimized copy, optional
+     *  sequence: <sequence> // The images played, for an image sequence
      *  clips: [
      *    <clip 1>,  // The subclips
      *    ...
@@ -186,9 +247,40 @@ Media::fromVariant( const QVariant& v )
     }
     auto mediaId = m["mlId"].toLongLong();
     auto uuid = m["uuid"].toUuid();
-    auto mlMedia = Core::instance()->library()->mlMedia( mediaId );
+    auto library = Core::instance()->library();
+    auto mlMedia = library->mlMedia( mediaId );
+    // The input may have been opened ahead of time, see ProjectPreloader
+    auto input = library->takePreloadedInput( mediaId );
+    // Play the optimized copy rather than the source, as long as it's still around
+    auto optimized = m["optimized"].toString();
+    if ( optimized.isEmpty() == false && QFileInfo::exists( optimized ) == false )
+    {
+        vlmcWarning() << "Optimized media" << optimized << "is missing, using the original file";
+        optimized.clear();
+    }
+    if ( input == nullptr && optimized.isEmpty() == false )
+    {
+        try
+        {
+            input.reset( new Backend::MLT::MLTInput( qPrintable( optimized ) ) );
+        }
+        catch ( Backend::InvalidServiceException& e )
+        {
+            vlmcWarning() << "Can't open optimized media" << optimized;
+            optimized.clear();
+        }
+    }
+    auto sequence = ImageSequence::fromVariant( m["sequence"] );
     //FIXME: Is QSharedPointer exception safe in case its constructor throws an exception?
-    auto media = QSharedPointer<Media>::create( mlMedia, uuid );
+    QSharedPointer<Media> media;
+    if ( input != nullptr )
+        media = QSharedPointer<Media>::create( mlMedia, std::move( input ), uuid );
+    else if ( sequence.isValid() == true )
+        media = QSharedPointer<Media>::create( mlMedia, sequence, uuid );
+    else
+        media = QSharedPointer<Media>::create( mlMedia, uuid );
+    media->setOptimizedFile( optimized );
+    media->m_sequence = sequence;
 
     // Now load the subclips:
     if ( m.contains( "clips" ) == false )
@@ -42,6 +42,7 @@
 #include <QXmlStreamWriter>
 
 #include "Backend/MLT/MLTInput.h"
+#include "ImageSequence.h"
 
 #include <medialibrary/IMedia.h>
 #include <medialibrary/IFile.h>
@@ -70,8 +71,25 @@ public:
     static const QString        streamPrefix;
 
     Media( medialibrary::MediaPtr media, const QUuid& uuid = QUuid() );
+    /**
+     * @brief Media     Creates a media reading from an already opened input
+     */
+    Media( medialibrary::MediaPtr media, std::unique_ptr<Backend::IInput> input, const QUuid& uuid );
+    /**
+     * @brief Media     Creates a media playing a whole image sequence
+     * @param media     The media library media of the sequence's first image
+     */
+    Media( medialibrary::MediaPtr media, const ImageSequence& sequence, const QUuid& uuid = QUuid() );
+    /**
+     * @brief fromMediaLibrary  Creates a media, as an image sequence if it's a numbered image
+     */
+    static QSharedPointer<Media> fromMediaLibrary( medialibrary::MediaPtr media );
 
     QString                     mrl() const;
+    /**
+     * @brief mrl   Returns the location of a media library media's main file
+     */
+    static QString              mrl( const medialibrary::MediaPtr& media );
     QString                     title() const;
     qint64                      id() const;
 
@@ -91,6 +109,24 @@ public:
     Backend::IInput*         input();
     const Backend::IInput*   input() const;
 
+    /**
+     * @brief optimizedFile The all-intra copy of this media, empty if it wasn't optimized
+     */
+    const QString&              optimizedFile() const;
+    /**
+     * @brief setOptimizedFile  Records the optimized copy of this media
+     *
+     * The input reads from it the next time the media is opened, ie. when the project
+     * is loaded. Switching the decoder of the clips already on the timeline would
+     * require rebuilding them all.
+     */
+    void                        setOptimizedFile( const QString& optimizedFile );
+
+    /**
+     * @brief imageSequence The images this media plays, invalid for a regular media
+     */
+    const ImageSequence&        imageSequence() const;
+
     bool                        hasVideoTracks() const;
     bool                        hasAudioTracks() const;
 
@@ -100,12 +136,16 @@ public:
     QString                    snapshot();
 
 protected:
+    static medialibrary::FilePtr    mainFile( const medialibrary::MediaPtr& media );
+
     std::unique_ptr<Backend::IInput>         m_input;
     medialibrary::MediaPtr      m_mlMedia;
     medialibrary::FilePtr       m_mlFile;
     QUuid                       m_baseClipUuid;
     QSharedPointer<Clip>        m_baseClip;
     QHash<QUuid, QSharedPointer<Clip>>      m_clips;
+    QString                     m_optimizedFile;
+    ImageSequence               m_sequence;
 
 signals:
     /**
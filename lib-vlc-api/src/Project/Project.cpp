@@ -33,7 +33,9 @@
 
 #include "Backend/IBackend.h"
 #include "Backend/IProfile.h"
+#include "Library/Library.h"
 #include "Project.h"
+#include "ProjectPreloader.h"
 #include "RecentProjects.h"
 #include "Settings/Settings.h"
 #include "Tools/VlmcDebug.h"
@@ -72,6 +74,7 @@ Project::Project( Settings* settings )
 
 Project::~Project()
 {
+    m_preloader.reset();
     delete m_settings;
     delete m_timer;
 }
@@ -87,7 +90,15 @@ Project::settings()
 bool
 Project::load( const QString& path )
 {
+    std::unique_ptr<ProjectPreloader> preloader;
+    if ( m_preloader != nullptr && m_preloader->path() == QFileInfo( path ).absoluteFilePath() )
+        preloader = std::move( m_preloader );
+    // A preloaded project we're not switching to is no longer needed
+    m_preloader.reset();
+
     closeProject();
+    if ( preloader != nullptr )
+        Core::instance()->library()->setPreloadedInputs( preloader->takeInputs() );
 
     QString         backupFilename = path + Project::backupSuffix;
     QFile           autoBackup( backupFilename );
@@ -146,6 +157,20 @@ Project::load( const QString& path )
     return true;
 }
 
+void
+Project::preload( const QString& path )
+{
+    if ( m_preloader != nullptr && m_preloader->path() == QFileInfo( path ).absoluteFilePath() )
+        return;
+    m_preloader.reset( new ProjectPreloader( path ) );
+    auto preloaderPath = m_preloader->path();
+    connect( m_preloader.get(), &QThread::finished, this, [this, preloaderPath]
+    {
+        emit projectPreloaded( preloaderPath );
+    } );
+    m_preloader->start( QThread::LowPriority );
+}
+
 void
 Project::save()
 {
@@ -262,6 +287,14 @@ Project::hasProjectFile() const
     return m_projectFile != nullptr;
 }
 
+QString
+Project::fileName() const
+{
+    if ( m_projectFile == nullptr )
+        return QString();
+    return QFileInfo( *m_projectFile ).absoluteFilePath();
+}
+
 void
 Project::removeBackupFile()
 {
@@ -37,6 +37,7 @@ class AutomaticBackup;
 class Library;
 class MainWorkflow;
 class ProjectManager;
+class ProjectPreloader;
 class Settings;
 
 class Project : public QObject
@@ -62,10 +63,23 @@ class Project : public QObject
          *                  an absolute file path.
          */
         bool            load( const QString& path );
+        /**
+         *  @brief          Opens the media of another project in the background.
+         *
+         *  The current project is left untouched. A later call to load() with the same
+         *  path reuses the opened media instead of probing them again.
+         *  projectPreloaded() is emitted once they are all opened.
+         *  @param path     The path of the project file to preload.
+         */
+        void            preload( const QString& path );
         void            emergencyBackup();
         bool            isClean() const;
         void            closeProject();
         bool            hasProjectFile() const;
+        /**
+         * @brief fileName  Returns the project file path, or an empty string if it has none
+         */
+        QString         fileName() const;
         /**
          * @brief removeBackupFile Removes the current project backup file, if any
          */
@@ -121,6 +135,7 @@ class Project : public QObject
         void                projectLoading( const QString& projectName );
         void                projectLoaded( const QString& projectName, const QString& projectFilePath );
         void                projectClosed();
+        void                projectPreloaded( const QString& projectFilePath );
         void                backupProjectLoaded();
         void                outdatedBackupFileFound();
         void                fpsChanged( double fps );
@@ -130,6 +145,7 @@ class Project : public QObject
         bool                m_isClean;
         bool                m_libraryCleanState;
         QTimer*             m_timer;
+        std::unique_ptr<ProjectPreloader>   m_preloader;
 
     ///////////////////////////////////
     // Dependent components part below:
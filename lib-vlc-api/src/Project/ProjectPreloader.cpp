@@ -0,0 +1,123 @@
+/*****************************************************************************
+ * ProjectPreloader.cpp: Opens the media of a project ahead of time
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "ProjectPreloader.h"
+
+#include "Backend/MLT/MLTInput.h"
+#include "Library/Library.h"
+#include "Main/Core.h"
+#include "Media/Media.h"
+#include "Project/Project.h"
+#include "Tools/BackgroundReleaser.h"
+#include "Tools/VlmcDebug.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+
+ProjectPreloader::ProjectPreloader( const QString& path )
+    : m_path( QFileInfo( path ).absoluteFilePath() )
+{
+    // Read the same file Project::load would
+    QFileInfo   projectFileInfo( m_path );
+    QFileInfo   backupFileInfo( m_path + Project::backupSuffix );
+    QFile       file( backupFileInfo.exists() == true &&
+                      backupFileInfo.lastModified() >= projectFileInfo.lastModified() ?
+                          backupFileInfo.absoluteFilePath() : m_path );
+    if ( file.open( QFile::ReadOnly ) == false )
+    {
+        vlmcWarning() << "Can't preload project" << m_path;
+        return;
+    }
+    auto doc = QJsonDocument::fromJson( file.readAll() );
+    auto library = Core::instance()->library();
+    for ( const auto& v : doc.object()["Library"].toObject()["medias"].toArray() )
+    {
+        auto mediaId = static_cast<qint64>( v.toObject()["mlId"].toDouble() );
+        auto mlMedia = library->mlMedia( mediaId );
+        if ( mlMedia == nullptr )
+            continue;
+        auto mrl = Media::mrl( mlMedia );
+        // Media::fromVariant opens the optimized copy instead, if any
+        auto optimized = v.toObject()["optimized"].toString();
+        auto sequence = ImageSequence::fromVariant( v.toObject()["sequence"].toVariant() );
+        if ( optimized.isEmpty() == false && QFileInfo::exists( optimized ) == true )
+            mrl = optimized;
+        else if ( sequence.isValid() == true )
+            mrl = sequence.resource();
+        if ( mrl.isEmpty() == false )
+            m_media << qMakePair( mediaId, mrl );
+    }
+}
+
+ProjectPreloader::~ProjectPreloader()
+{
+    requestInterruption();
+    wait();
+    if ( m_inputs.empty() == false )
+        Core::instance()->releaser()->release( std::move( m_inputs ) );
+}
+
+const QString&
+ProjectPreloader::path() const
+{
+    return m_path;
+}
+
+std::map<qint64, std::unique_ptr<Backend::IInput>>
+ProjectPreloader::takeInputs()
+{
+    wait();
+    QMutexLocker    lock( &m_mutex );
+    return std::move( m_inputs );
+}
+
+void
+ProjectPreloader::run()
+{
+    vlmcDebug() << "Preloading" << m_media.size() << "media for" << m_path;
+    for ( const auto& m : m_media )
+    {
+        if ( isInterruptionRequested() == true )
+            return;
+        std::unique_ptr<Backend::IInput>    input;
+        try
+        {
+            input.reset( new Backend::MLT::MLTInput( qPrintable( m.second ) ) );
+        }
+        catch ( Backend::InvalidServiceException& e )
+        {
+            // Media::fromVariant will report it when the project gets loaded
+            vlmcWarning() << "Can't preload" << m.second;
+            continue;
+        }
+        QMutexLocker    lock( &m_mutex );
+        m_inputs[m.first] = std::move( input );
+    }
+}
@@ -0,0 +1,79 @@
+/*****************************************************************************
+ * ProjectPreloader.h: Opens the media of a project ahead of time
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef PROJECTPRELOADER_H
+#define PROJECTPRELOADER_H
+
+#include <QList>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+#include <QThread>
+
+#include <map>
+#include <memory>
+
+namespace Backend
+{
+class IInput;
+}
+
+/**
+ *  \brief  Opens the inputs of every media used by a project in a background thread.
+ *
+ *  Probing each media file is most of the time spent loading a project. Preloading
+ *  the next project while the current one is still being edited, or rendered, makes
+ *  switching to it only cost the timeline reconstruction.
+ *  See Project::preload() and Project::load().
+ */
+class ProjectPreloader : public QThread
+{
+    public:
+        /**
+         *  Reads the project file and resolves its media. This must be called from the
+         *  main thread, start() then opens the inputs in the background.
+         */
+        explicit ProjectPreloader( const QString& path );
+        /**
+         *  Interrupts the preloading, unused inputs are handed to the background releaser
+         */
+        ~ProjectPreloader();
+
+        const QString&      path() const;
+        /**
+         *  \brief  Waits for the preloading to complete and returns the opened inputs,
+         *          by media library ID.
+         */
+        std::map<qint64, std::unique_ptr<Backend::IInput>>  takeInputs();
+
+    protected:
+        void                run() override;
+
+    private:
+        QString                                             m_path;
+        // Media library ID and file of each media to open
+        QList<QPair<qint64, QString>>                       m_media;
+        QMutex                                              m_mutex;
+        std::map<qint64, std::unique_ptr<Backend::IInput>>  m_inputs;
+};
+
+#endif // PROJECTPRELOADER_H
@@ -80,3 +80,17 @@ Workspace::isInWorkspace(const Media *media)
 {
     return isInWorkspace( media->mrl() );
 }
+
+QString
+Workspace::cacheDirectory( const QString& name ) const
+{
+    if ( m_workspaceDir.isEmpty() == true )
+        return QString();
+    QDir    dir( m_workspaceDir );
+    if ( dir.mkpath( name ) == false )
+    {
+        vlmcWarning() << "Can't create workspace directory" << name;
+        return QString();
+    }
+    return dir.absoluteFilePath( name );
+}
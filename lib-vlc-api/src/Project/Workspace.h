@@ -43,6 +43,12 @@ class Workspace : public QObject, public ErrorHandler
         Workspace( Settings* settings );
         bool                        isInWorkspace( const QString &path );
         bool                        isInWorkspace( const Media *media );
+        /**
+         * @brief cacheDirectory    Returns a workspace subdirectory, creating it if needed
+         * @param name              The directory, relative to the workspace root
+         * @return                  Its absolute path, or an empty string when no workspace is set
+         */
+        QString                     cacheDirectory( const QString& name ) const;
 
     private:
         bool                        isInWorkspace( const QFileInfo &fInfo );
@@ -27,6 +27,7 @@
 
 #include "AbstractRenderer.h"
 
+#include "FramePrefetcher.h"
 #include "Tools/RendererEventWatcher.h"
 #include "Backend/MLT/MLTOutput.h"
 
@@ -38,6 +39,10 @@ AbstractRenderer::AbstractRenderer()
 {
     connect( m_eventWatcher.data(), &RendererEventWatcher::stopped, this, &AbstractRenderer::stop );
     connect( m_eventWatcher.data(), &RendererEventWatcher::positionChanged, this, [this]( qint64 pos ){ emit frameChanged( pos, Vlmc::Renderer ); } );
+    connect( m_eventWatcher.data(), &RendererEventWatcher::positionChanged, this, [this]( qint64 pos ) {
+        if ( m_prefetcher != nullptr )
+            m_prefetcher->positionChanged( pos, isPaused() );
+    } );
     connect( m_eventWatcher.data(), &RendererEventWatcher::lengthChanged, this, &AbstractRenderer::lengthChanged );
     connect( m_eventWatcher.data(), &RendererEventWatcher::endReached, this, &AbstractRenderer::stop );
 }
@@ -65,7 +70,11 @@ void
 AbstractRenderer::setPosition( qint64 pos )
 {
     if ( m_input )
+    {
+        if ( m_prefetcher != nullptr )
+            m_prefetcher->seek( pos, false );
         m_input->setPosition( pos );
+    }
 }
 
 void
@@ -99,14 +108,22 @@ void
 AbstractRenderer::nextFrame()
 {
     if ( isRendering() && m_input )
+    {
+        if ( m_prefetcher != nullptr && m_input->position() + 1 < m_input->playableLength() )
+            m_prefetcher->seek( m_input->position() + 1, true );
         m_input->nextFrame();
+    }
 }
 
 void
 AbstractRenderer::previousFrame()
 {
     if ( isRendering() && m_input )
+    {
+        if ( m_prefetcher != nullptr && m_input->position() > 0 )
+            m_prefetcher->seek( m_input->position() - 1, true );
         m_input->previousFrame();
+    }
 }
 
 qint64
@@ -159,6 +176,8 @@ void
 AbstractRenderer::setInput( Backend::IInput* input )
 {
     m_input = input;
+    if ( m_prefetcher != nullptr )
+        m_prefetcher->setInput( input );
 
     if ( m_input )
     {
@@ -182,11 +201,37 @@ AbstractRenderer::setOutput( std::unique_ptr<Backend::IOutput> consuemr )
         m_output->connect( *m_input );
 }
 
+void
+AbstractRenderer::setPrefetchMemory( qint64 bytes )
+{
+    if ( bytes <= 0 )
+    {
+        m_prefetcher.reset();
+        return;
+    }
+    if ( m_prefetcher != nullptr )
+    {
+        m_prefetcher->setBudget( bytes );
+        return;
+    }
+    m_prefetcher.reset( new FramePrefetcher( bytes ) );
+    m_prefetcher->setInput( m_input );
+}
+
 void
 AbstractRenderer::previewWidgetCursorChanged( qint64 newFrame )
 {
     if ( isRendering() == true )
     {
+        if ( m_prefetcher != nullptr )
+            m_prefetcher->seek( newFrame, false );
         m_input->setPosition( newFrame );
     }
 }
+
+void
+AbstractRenderer::inputEdited()
+{
+    if ( m_prefetcher != nullptr )
+        m_prefetcher->inputEdited();
+}
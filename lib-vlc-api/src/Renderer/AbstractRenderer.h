@@ -38,6 +38,7 @@ class   Clip;
 class   Media;
 
 class RendererEventWatcher;
+class FramePrefetcher;
 
 namespace Backend
 {
@@ -150,12 +151,19 @@ public:
     virtual void                    setInput( Backend::IInput* input );
     virtual void                    setOutput( std::unique_ptr<Backend::IOutput> consuemr );
 
+    /**
+     *  \brief  Prefetches the frames around the playhead while paused, see FramePrefetcher
+     *  \param  bytes   The memory the prefetched frames can use, 0 to disable prefetching
+     */
+    void                            setPrefetchMemory( qint64 bytes );
+
     QSharedPointer<RendererEventWatcher>           eventWatcher();
 protected:
     std::unique_ptr<Backend::IOutput>             m_output;
 
     Backend::IInput*                             m_input;
     QSharedPointer<RendererEventWatcher>           m_eventWatcher;
+    std::unique_ptr<FramePrefetcher>               m_prefetcher;
 
 
 public slots:
@@ -167,6 +175,11 @@ public slots:
      */
     virtual void                    previewWidgetCursorChanged( qint64 newFrame );
 
+    /**
+     *  \brief      Drops the frames prefetched before the input was edited.
+     */
+    void                            inputEdited();
+
 
 signals:
     void                            frameChanged( qint64 newFrame,
@@ -44,8 +44,15 @@ ClipRenderer::ClipRenderer() :
     AbstractRenderer(),
     m_clipLoaded( false ),
     m_selectedClip( nullptr ),
-    m_mediaChanged( false )
+    m_mediaChanged( false ),
+    m_scrubTarget( 0 )
 {
+    m_scrubTimer.setSingleShot( true );
+    m_scrubTimer.setInterval( 150 );
+    connect( &m_scrubTimer, &QTimer::timeout, this, [this]() {
+        if ( isRendering() == true && m_input != nullptr )
+            m_input->setPosition( m_scrubTarget );
+    });
 }
 
 ClipRenderer::~ClipRenderer()
@@ -96,6 +103,7 @@ ClipRenderer::startPreview()
 void
 ClipRenderer::stop()
 {
+    m_scrubTimer.stop();
     if ( m_clipLoaded == true && isRendering() == true )
     {
         m_output->stop();
@@ -161,6 +169,25 @@ ClipRenderer::getClip()
 /////SLOTS :
 /////////////////////////////////////////////////////////////////////
 
+void
+ClipRenderer::previewWidgetCursorChanged( qint64 newFrame )
+{
+    if ( isRendering() == false )
+        return;
+    // A paused preview shows the frame the cursor is on
+    if ( isPaused() == true )
+    {
+        m_scrubTimer.stop();
+        m_input->setPosition( newFrame );
+        return;
+    }
+    // While playing, a keyframe is decoded at once, while reaching any other frame may
+    // require decoding the whole GOP before it
+    m_scrubTarget = newFrame;
+    m_input->setPosition( m_input->keyframe( newFrame ) );
+    m_scrubTimer.start();
+}
+
 void
 ClipRenderer::videoStopped()
 {
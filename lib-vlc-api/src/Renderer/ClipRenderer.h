@@ -28,6 +28,7 @@
 
 #include <QObject>
 #include <QSharedPointer>
+#include <QTimer>
 
 class   Clip;
 class   Media;
@@ -58,6 +59,13 @@ private:
      * library. If so, we must relaunch the render if the play button is clicked again.
      */
     bool                    m_mediaChanged;
+    /**
+     *  \brief  While the cursor is dragged during the playback, only keyframes are shown.
+     *          The exact frame is shown once the cursor stays still for this timer's
+     *          interval. A paused preview always shows the exact frame.
+     */
+    QTimer                  m_scrubTimer;
+    qint64                  m_scrubTarget;
 
 public slots:
     /**
@@ -77,6 +85,7 @@ public slots:
      */
     void                    positionChanged( qint64 time );
     void                    videoStopped();
+    virtual void            previewWidgetCursorChanged( qint64 newFrame ) override;
 };
 
 #endif // CLIPRENDERER_H
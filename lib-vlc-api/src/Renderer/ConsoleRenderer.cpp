@@ -25,14 +25,21 @@
 #endif
 
 #include "ConsoleRenderer.h"
+#include "Library/AnalysisScheduler.h"
 #include "Main/Core.h"
 #include "Project/Project.h"
+#include "Renderer/RenderSettings.h"
 #include "Tools/VlmcDebug.h"
 #include "Workflow/MainWorkflow.h"
 
-ConsoleRenderer::ConsoleRenderer( const QString& outputFileName, QObject *parent )
+ConsoleRenderer::ConsoleRenderer( const QString& outputFileName, bool incremental, QObject *parent )
     : QObject( parent )
     , m_outputFileName( outputFileName )
+    , m_incremental( incremental )
+    , m_renderFarm( false )
+    , m_localWorkers( 0 )
+    , m_port( 0 )
+    , m_loudnessTarget( .0 )
 {
     connect( Core::instance()->workflow(), &MainWorkflow::frameChanged,
              this, &ConsoleRenderer::frameChanged, Qt::DirectConnection );
@@ -52,19 +59,78 @@ ConsoleRenderer::frameChanged( qint64 frame, qint64 length ) const
     }
 }
 
+void
+ConsoleRenderer::setRenderFarm( quint32 localWorkers, quint16 port )
+{
+    m_renderFarm = true;
+    m_localWorkers = localWorkers;
+    m_port = port;
+}
+
+void
+ConsoleRenderer::setLoudnessTarget( double loudnessTarget )
+{
+    m_loudnessTarget = loudnessTarget;
+}
+
+bool
+ConsoleRenderer::waitForLoudness()
+{
+    auto unmeasured = Core::instance()->workflow()->scheduleLoudnessMeasures();
+    if ( unmeasured.isEmpty() == true )
+        return false;
+    vlmcDebug() << "ConsoleRenderer: Waiting for the loudness of" << unmeasured.size() << "media";
+    auto scheduler = Core::instance()->analysisScheduler();
+    connect( scheduler, &AnalysisScheduler::finished, this, [this, scheduler]( qint64, AnalysisScheduler::Kind kind )
+    {
+        if ( kind != AnalysisScheduler::Loudness )
+            return;
+        disconnect( scheduler, nullptr, this, nullptr );
+        startRender();
+    } );
+    connect( scheduler, &AnalysisScheduler::failed, this, [this, scheduler, unmeasured]( qint64 mediaId,
+                                                                                          AnalysisScheduler::Kind kind )
+    {
+        if ( kind != AnalysisScheduler::Loudness || unmeasured.contains( mediaId ) == false )
+            return;
+        disconnect( scheduler, nullptr, this, nullptr );
+        vlmcCritical() << "ConsoleRenderer: Can't measure the loudness of media" << mediaId;
+        emit finished();
+    } );
+    return true;
+}
+
 void
 ConsoleRenderer::startRender()
 {
+    // Wait for the measures, rather than exporting the media at their own levels
+    if ( m_loudnessTarget != .0 && waitForLoudness() == true )
+        return;
     auto project = Core::instance()->project();
-    Core::instance()->workflow()->startRenderToFile( m_outputFileName,
-                                                     project->width(),
-                                                     project->height(),
-                                                     project->fps(),
-                                                     project->aspectRatio(),
-                                                     project->videoBitrate(),
-                                                     project->audioBitrate(),
-                                                     project->nbChannels(),
-                                                     project->sampleRate()
-                                                     );
+    RenderSettings settings;
+    settings.outputFileName = m_outputFileName;
+    settings.width = project->width();
+    settings.height = project->height();
+    settings.fps = project->fps();
+    settings.aspectRatio = project->aspectRatio();
+    settings.videoBitrate = project->videoBitrate();
+    settings.audioBitrate = project->audioBitrate();
+    settings.nbChannels = project->nbChannels();
+    settings.sampleRate = project->sampleRate();
+    settings.loudnessTarget = m_loudnessTarget;
+
+    auto workflow = Core::instance()->workflow();
+    if ( m_renderFarm == true )
+        workflow->startDistributedRenderToFile( settings, m_localWorkers, m_port );
+    else if ( m_incremental == true )
+        workflow->startIncrementalRenderToFile( settings );
+    else
+    {
+        // The export may still be running in the background when this returns
+        connect( workflow, &MainWorkflow::exportFinished, this, &ConsoleRenderer::finished );
+        if ( workflow->startRenderToFiles( { settings } ) == false )
+            emit finished();
+        return;
+    }
     emit finished();
 }
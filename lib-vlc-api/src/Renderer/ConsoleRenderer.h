@@ -31,15 +31,33 @@ class ConsoleRenderer : public QObject
     Q_OBJECT
 
 public:
-    explicit ConsoleRenderer( const QString& outputFileName, QObject *parent = 0 );
+    explicit ConsoleRenderer( const QString& outputFileName, bool incremental = false, QObject *parent = 0 );
+
+    /**
+     *  \brief Renders through worker processes instead of this process
+     *  \sa    MainWorkflow::startDistributedRenderToFile
+     */
+    void        setRenderFarm( quint32 localWorkers, quint16 port );
+    /**
+     *  \brief Normalizes the audio clips to the given integrated loudness, in LUFS
+     *  \sa    RenderSettings::loudnessTarget
+     */
+    void        setLoudnessTarget( double loudnessTarget );
 
     void        startRender();
 
 private:
     void        frameChanged( qint64 frame, qint64 length ) const;
+    // Restarts the render once the loudness of every media of the timeline is measured
+    bool        waitForLoudness();
 
 private:
     QString                 m_outputFileName;
+    bool                    m_incremental;
+    bool                    m_renderFarm;
+    quint32                 m_localWorkers;
+    quint16                 m_port;
+    double                  m_loudnessTarget;
 
 signals:
     void        finished();
@@ -0,0 +1,189 @@
+/*****************************************************************************
+ * ExportJob.cpp: Renders a frozen copy of the timeline in the background
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "ExportJob.h"
+
+#include "Backend/IInput.h"
+#include "Backend/MLT/MLTOutput.h"
+#include "Tools/OutputEventWatcher.h"
+#include "Tools/RendererEventWatcher.h"
+#include "Tools/VlmcDebug.h"
+
+#include <QThread>
+
+class ExportJob::Opener : public QThread
+{
+    public:
+        Opener( const SequenceSnapshot& snapshot, bool withPreview )
+            : m_snapshot( snapshot )
+            , m_withPreview( withPreview )
+        {
+        }
+
+        std::unique_ptr<Backend::IInput>    input;
+        std::unique_ptr<Backend::IInput>    preview;
+
+    protected:
+        void run() override
+        {
+            input = m_snapshot.open();
+            if ( input != nullptr && m_withPreview == true )
+                preview = m_snapshot.open();
+        }
+
+    private:
+        const SequenceSnapshot&             m_snapshot;
+        bool                                m_withPreview;
+};
+
+ExportJob::ExportJob( const SequenceSnapshot& sequence, const QList<RenderSettings>& renditions,
+                      QObject* parent )
+    : QObject( parent )
+    , m_renditions( renditions )
+    , m_snapshot( sequence )
+    , m_previewEnabled( false )
+    , m_inputWatcher( new RendererEventWatcher )
+    , m_outputWatcher( new OutputEventWatcher )
+    , m_running( false )
+    , m_stopRequested( false )
+{
+    // Backend events are raised from the consumer thread
+    connect( m_inputWatcher.get(), &RendererEventWatcher::positionChanged, this, [this]( qint64 pos )
+    {
+        emit progress( pos, m_snapshot.length() );
+    }, Qt::QueuedConnection );
+    connect( m_outputWatcher.get(), &OutputEventWatcher::stopped,
+             this, &ExportJob::outputStopped, Qt::QueuedConnection );
+}
+
+ExportJob::~ExportJob()
+{
+    if ( m_opener != nullptr )
+        m_opener->wait();
+    if ( m_output != nullptr )
+    {
+        m_output->stop();
+        m_output.reset();
+    }
+}
+
+const QList<RenderSettings>&
+ExportJob::renditions() const
+{
+    return m_renditions;
+}
+
+void
+ExportJob::setPreviewEnabled( bool enabled )
+{
+    m_previewEnabled = enabled;
+}
+
+Backend::IInput*
+ExportJob::preview()
+{
+    return m_preview.get();
+}
+
+bool
+ExportJob::isRunning() const
+{
+    return m_running;
+}
+
+bool
+ExportJob::start()
+{
+    if ( m_renditions.isEmpty() == true || m_snapshot.length() <= 0 || m_running == true )
+        return false;
+
+    // A single rendition doesn't need the extra frame copies of the multi consumer
+    if ( m_renditions.size() == 1 )
+    {
+        auto ffmpegOutput = new Backend::MLT::MLTFFmpegOutput;
+        m_renditions.first().apply( *ffmpegOutput );
+        m_output.reset( ffmpegOutput );
+    }
+    else
+    {
+        auto multiOutput = new Backend::MLT::MLTMultiOutput;
+        for ( const auto& r : m_renditions )
+        {
+            Backend::MLT::MLTFFmpegOutput   rendition;
+            r.apply( rendition );
+            multiOutput->addRendition( rendition );
+        }
+        m_output.reset( multiOutput );
+    }
+    m_running = true;
+    m_stopRequested = false;
+    m_opener.reset( new Opener( m_snapshot, m_previewEnabled ) );
+    connect( m_opener.get(), &QThread::finished, this, &ExportJob::opened );
+    m_opener->start();
+    return true;
+}
+
+void
+ExportJob::opened()
+{
+    m_input = std::move( m_opener->input );
+    m_preview = std::move( m_opener->preview );
+    if ( m_stopRequested == true || m_input == nullptr )
+    {
+        m_running = false;
+        emit finished( false );
+        return;
+    }
+    m_input->setCallback( m_inputWatcher.get() );
+    m_output->setCallback( m_outputWatcher.get() );
+    m_output->connect( *m_input );
+
+    vlmcDebug() << "Exporting to" << m_renditions.first().outputFileName << "in the background";
+    m_input->setPosition( 0 );
+    m_output->start();
+}
+
+void
+ExportJob::stop()
+{
+    if ( m_running == false )
+        return;
+    m_stopRequested = true;
+    // Still opening the copy, see opened()
+    if ( m_input == nullptr )
+        return;
+    m_output->stop();
+}
+
+void
+ExportJob::outputStopped()
+{
+    // Stopping an output notifies again upon its destruction
+    if ( m_running == false || m_output->isStopped() == false )
+        return;
+    m_running = false;
+    emit finished( m_stopRequested == false );
+}
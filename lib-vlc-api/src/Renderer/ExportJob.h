@@ -0,0 +1,113 @@
+/*****************************************************************************
+ * ExportJob.h: Renders a frozen copy of the timeline in the background
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef EXPORTJOB_H
+#define EXPORTJOB_H
+
+#include <QObject>
+#include <QList>
+
+#include <memory>
+
+#include "RenderSettings.h"
+#include "Workflow/SequenceSnapshot.h"
+
+class   OutputEventWatcher;
+class   RendererEventWatcher;
+
+namespace Backend
+{
+class   IInput;
+namespace MLT
+{
+class   MLTOutput;
+}
+}
+
+/**
+ *  \brief  Renders a snapshot of a sequence to one or several outputs.
+ *
+ *  The job opens its own copy of the sequence, from a thread of its own, so the
+ *  timeline can keep being edited and previewed while the decoders are opened and
+ *  the encoder runs on the backend threads.
+ *  \sa     SequenceWorkflow::snapshot
+ */
+class   ExportJob : public QObject
+{
+    Q_OBJECT
+
+    public:
+        ExportJob( const SequenceSnapshot& sequence, const QList<RenderSettings>& renditions,
+                   QObject* parent = nullptr );
+        ~ExportJob();
+
+        const QList<RenderSettings>&    renditions() const;
+        /**
+         * @brief setPreviewEnabled Opens another copy of the sequence, for previewing the export.
+         *                          Seeking the exported one would disturb the export.
+         */
+        void                    setPreviewEnabled( bool enabled );
+        /**
+         * @brief preview   The copy to preview the export with, once it started, or nullptr
+         */
+        Backend::IInput*        preview();
+        bool                    isRunning() const;
+
+        /**
+         * @brief start     Starts encoding once the copy is opened. This returns immediately,
+         *                  finished() is emitted if the copy can't be opened.
+         */
+        bool                    start();
+
+    public slots:
+        void                    stop();
+
+    private slots:
+        void                    outputStopped();
+
+    private:
+        class Opener;
+
+        // Called once the copies are opened
+        void                    opened();
+
+    private:
+        QList<RenderSettings>                       m_renditions;
+        SequenceSnapshot                            m_snapshot;
+        bool                                        m_previewEnabled;
+        // Declaration order matters: the output must go before the inputs, which
+        // must go before the watchers they notify
+        std::unique_ptr<RendererEventWatcher>       m_inputWatcher;
+        std::unique_ptr<OutputEventWatcher>         m_outputWatcher;
+        std::unique_ptr<Backend::IInput>            m_input;
+        std::unique_ptr<Backend::IInput>            m_preview;
+        std::unique_ptr<Backend::MLT::MLTOutput>    m_output;
+        std::unique_ptr<Opener>                     m_opener;
+        bool                                        m_running;
+        bool                                        m_stopRequested;
+
+    signals:
+        void                    progress( qint64 frame, qint64 length );
+        void                    finished( bool success );
+};
+
+#endif // EXPORTJOB_H
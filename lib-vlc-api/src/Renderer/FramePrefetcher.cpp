@@ -0,0 +1,407 @@
+/*****************************************************************************
+ * FramePrefetcher.cpp: Renders the preview frames the playhead is likely to reach
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "FramePrefetcher.h"
+
+#include "Backend/IInput.h"
+#include "Backend/MLT/MLTFrameBuffer.h"
+#include "Backend/MLT/MLTInput.h"
+#include "Main/Core.h"
+#include "Tools/BackgroundReleaser.h"
+#include "Tools/VlmcDebug.h"
+
+#include <QFile>
+#include <QMutexLocker>
+#include <QThread>
+
+#ifdef Q_OS_WIN
+# include <windows.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+
+// Frames prefetched in the direction of a frame by frame move, and behind it
+static const int StepAhead = 12;
+static const int StepBehind = 3;
+// Moves of a shuttle prefetched ahead of the playhead
+static const int ShuttleAhead = 8;
+// Consecutive moves of about the same size & direction which make a shuttle
+static const int ShuttleMoves = 2;
+// The longest pause between two moves of a shuttle, in milliseconds
+static const qint64 SteadyInterval = 250;
+// Neighbours of a scrub target prefetched on each side
+static const int ScrubAround = 2;
+// The system memory prefetching leaves available, at least
+static const quint64 LowMemory = 512 * 1024 * 1024;
+static const qint64 MemoryCheckInterval = 1000;
+
+class FramePrefetcher::Worker : public QThread
+{
+    public:
+        explicit Worker( FramePrefetcher& prefetcher )
+            : generation( 0 )
+            , busy( false )
+            , m_prefetcher( prefetcher )
+        {
+        }
+
+        // Those are guarded by the prefetcher mutex. The reader is only swapped while idle
+        std::unique_ptr<Backend::IInput>    reader;
+        // The buffer generation the reader was copied at
+        quint64                             generation;
+        bool                                busy;
+
+    protected:
+        void run() override
+        {
+            m_prefetcher.work( *this );
+        }
+
+    private:
+        FramePrefetcher&                    m_prefetcher;
+};
+
+/**
+ *  \return The memory the system can still hand out without swapping, in bytes, or 0 if unknown
+ */
+static quint64
+availableMemory()
+{
+#if defined( Q_OS_LINUX )
+    QFile meminfo( QStringLiteral( "/proc/meminfo" ) );
+    if ( meminfo.open( QIODevice::ReadOnly | QIODevice::Text ) == false )
+        return 0;
+    // ie. "MemAvailable:    8072196 kB"
+    while ( meminfo.atEnd() == false )
+    {
+        auto line = meminfo.readLine().simplified();
+        if ( line.startsWith( "MemAvailable:" ) == false )
+            continue;
+        auto fields = line.split( ' ' );
+        if ( fields.size() < 2 )
+            return 0;
+        return fields[1].toULongLong() * 1024;
+    }
+    return 0;
+#elif defined( Q_OS_WIN )
+    MEMORYSTATUSEX status;
+    status.dwLength = sizeof( status );
+    if ( GlobalMemoryStatusEx( &status ) == FALSE )
+        return 0;
+    return status.ullAvailPhys;
+#else
+    return 0;
+#endif
+}
+
+FramePrefetcher::FramePrefetcher( size_t budget )
+    : m_input( nullptr )
+    , m_buffer( std::make_shared<Backend::MLT::FrameBuffer>() )
+    , m_budget( budget )
+    , m_motion( Idle )
+    , m_position( 0 )
+    , m_lastMove( 0 )
+    , m_pace( .0 )
+    , m_steadyMoves( 0 )
+    , m_lastSeek( 0 )
+    , m_standingDown( false )
+    , m_stop( false )
+{
+    m_buffer->setBudget( budget );
+    m_buffer->setRecording( true );
+    auto nbWorkers = std::max( 1, std::min( 4, QThread::idealThreadCount() / 2 ) );
+    for ( auto i = 0; i < nbWorkers; ++i )
+        m_workers.emplace_back( new Worker( *this ) );
+    m_clock.start();
+}
+
+FramePrefetcher::~FramePrefetcher()
+{
+    {
+        QMutexLocker    lock( &m_mutex );
+        m_stop = true;
+        m_queue.clear();
+        m_wakeUp.wakeAll();
+    }
+    for ( auto& w : m_workers )
+        w->wait();
+}
+
+void
+FramePrefetcher::setInput( Backend::IInput* input )
+{
+    cancel();
+    m_input = input;
+    m_motion = Idle;
+    m_position = 0;
+    m_lastMove = 0;
+    m_steadyMoves = 0;
+    auto mltInput = dynamic_cast<Backend::MLT::MLTInput*>( input );
+    if ( mltInput != nullptr )
+        m_buffer->attach( *mltInput );
+    else
+        m_buffer->invalidate();
+    releaseReaders();
+}
+
+void
+FramePrefetcher::setBudget( size_t budget )
+{
+    m_budget = budget;
+    m_buffer->setBudget( budget );
+    m_buffer->trim( m_position );
+}
+
+void
+FramePrefetcher::inputEdited()
+{
+    cancel();
+    m_buffer->invalidate();
+    releaseReaders();
+}
+
+void
+FramePrefetcher::seek( qint64 position, bool step )
+{
+    if ( m_input == nullptr )
+        return;
+    auto now = m_clock.elapsed();
+    auto move = position - m_position;
+    if ( step == true )
+    {
+        m_motion = Step;
+        m_steadyMoves = 0;
+        m_pace = move;
+    }
+    else
+    {
+        bool steady = move != 0 && m_lastMove != 0 && ( move > 0 ) == ( m_lastMove > 0 ) &&
+                std::abs( move ) <= 2 * std::abs( m_lastMove ) &&
+                std::abs( m_lastMove ) <= 2 * std::abs( move ) &&
+                now - m_lastSeek <= SteadyInterval;
+        if ( steady == true )
+        {
+            ++m_steadyMoves;
+            m_pace = ( m_pace + move ) / 2.0;
+        }
+        else
+        {
+            m_steadyMoves = 0;
+            m_pace = move;
+        }
+        m_motion = m_steadyMoves >= ShuttleMoves ? Shuttle : Scrub;
+    }
+    m_lastMove = move;
+    m_lastSeek = now;
+    m_position = position;
+    if ( checkMemory() == false )
+        return;
+    m_buffer->expect( position );
+    schedule( position );
+}
+
+void
+FramePrefetcher::positionChanged( qint64 position, bool paused )
+{
+    // While paused, the positions are the ones seek() was told about already
+    if ( paused == true || m_input == nullptr )
+        return;
+    if ( m_motion != Play )
+    {
+        // The consumer reads ahead by itself, its frames are only recorded
+        m_motion = Play;
+        cancel();
+    }
+    m_position = position;
+    m_lastMove = 0;
+    if ( checkMemory() == true )
+        m_buffer->trim( position );
+}
+
+void
+FramePrefetcher::schedule( qint64 position )
+{
+    auto length = m_input->playableLength();
+    std::deque<qint64> targets;
+    auto add = [this, position, length, &targets]( double target ) {
+        auto pos = static_cast<qint64>( std::llround( target ) );
+        if ( pos < 0 || pos >= length || pos == position || m_buffer->contains( pos ) == true )
+            return;
+        if ( std::find( targets.begin(), targets.end(), pos ) == targets.end() )
+            targets.push_back( pos );
+    };
+    auto direction = m_pace < 0 ? -1 : 1;
+    switch ( m_motion )
+    {
+    case Step:
+        for ( auto i = 1; i <= StepAhead; ++i )
+        {
+            add( position + direction * i );
+            if ( i <= StepBehind )
+                add( position - direction * i );
+        }
+        break;
+    case Shuttle:
+        for ( auto i = 1; i <= ShuttleAhead; ++i )
+            add( position + m_pace * i );
+        break;
+    case Scrub:
+        for ( auto i = 1; i <= ScrubAround; ++i )
+        {
+            add( position + i );
+            add( position - i );
+        }
+        break;
+    default:
+        break;
+    }
+    m_buffer->trim( position );
+    if ( targets.empty() == true )
+        return;
+    {
+        QMutexLocker    lock( &m_mutex );
+        m_queue = std::move( targets );
+        m_wakeUp.wakeAll();
+    }
+    updateReaders();
+}
+
+void
+FramePrefetcher::updateReaders()
+{
+    // Copying the input takes a while, a single worker gets a new reader per move
+    Worker* worker = nullptr;
+    quint64 generation;
+    {
+        QMutexLocker    lock( &m_mutex );
+        // The buffer also moves on by itself, when its filter finds that the input changed
+        generation = m_buffer->generation();
+        for ( const auto& w : m_workers )
+        {
+            if ( w->busy == false && ( w->reader == nullptr || w->generation != generation ) )
+            {
+                worker = w.get();
+                break;
+            }
+        }
+    }
+    if ( worker == nullptr )
+        return;
+    // Only this thread swaps readers, the worker stays idle meanwhile. Should the buffer be
+    // invalidated while the input is copied, the copy is replaced at the next move.
+    auto reader = m_input->reader( true );
+    if ( reader == nullptr )
+        return;
+    std::unique_ptr<Backend::IInput> old;
+    {
+        QMutexLocker    lock( &m_mutex );
+        old = std::move( worker->reader );
+        worker->reader = std::move( reader );
+        worker->generation = generation;
+        m_wakeUp.wakeAll();
+    }
+    if ( old != nullptr )
+        Core::instance()->releaser()->release( std::move( old ) );
+    if ( worker->isRunning() == false )
+        worker->start( QThread::LowPriority );
+}
+
+void
+FramePrefetcher::releaseReaders()
+{
+    std::vector<std::unique_ptr<Backend::IInput>> garbage;
+    {
+        QMutexLocker    lock( &m_mutex );
+        // The busy ones are replaced once they're done with their frame
+        for ( auto& w : m_workers )
+        {
+            if ( w->busy == false && w->reader != nullptr )
+                garbage.push_back( std::move( w->reader ) );
+        }
+    }
+    if ( garbage.empty() == false )
+        Core::instance()->releaser()->release( std::move( garbage ) );
+}
+
+void
+FramePrefetcher::cancel()
+{
+    QMutexLocker    lock( &m_mutex );
+    m_queue.clear();
+}
+
+bool
+FramePrefetcher::checkMemory()
+{
+    if ( m_memoryClock.isValid() == true && m_memoryClock.elapsed() < MemoryCheckInterval )
+        return m_standingDown == false;
+    m_memoryClock.start();
+    auto available = availableMemory();
+    if ( available == 0 )
+        return m_standingDown == false;
+    auto threshold = std::max<quint64>( LowMemory, 2 * m_budget );
+    if ( m_standingDown == false && available < threshold )
+    {
+        vlmcWarning() << "Low on memory, dropping the prefetched frames";
+        m_standingDown = true;
+        cancel();
+        m_buffer->setRecording( false );
+        m_buffer->invalidate();
+        releaseReaders();
+    }
+    else if ( m_standingDown == true && available >= threshold + threshold / 2 )
+    {
+        vlmcDebug() << "Resuming the frame prefetching";
+        m_standingDown = false;
+        m_buffer->setRecording( true );
+    }
+    return m_standingDown == false;
+}
+
+void
+FramePrefetcher::work( Worker& worker )
+{
+    QMutexLocker    lock( &m_mutex );
+    while ( m_stop == false )
+    {
+        if ( m_queue.empty() == true || worker.reader == nullptr ||
+             worker.generation != m_buffer->generation() )
+        {
+            m_wakeUp.wait( &m_mutex );
+            continue;
+        }
+        auto position = m_queue.front();
+        m_queue.pop_front();
+        worker.busy = true;
+        lock.unlock();
+        // Renders from an older version of the input are dropped by the buffer
+        if ( m_buffer->contains( position ) == false )
+            m_buffer->render( *worker.reader, position, worker.generation );
+        lock.relock();
+        worker.busy = false;
+    }
+}
@@ -0,0 +1,139 @@
+/*****************************************************************************
+ * FramePrefetcher.h: Renders the preview frames the playhead is likely to reach
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef FRAMEPREFETCHER_H
+#define FRAMEPREFETCHER_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QWaitCondition>
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace Backend
+{
+class IInput;
+namespace MLT
+{
+class FrameBuffer;
+}
+}
+
+/**
+ *  \brief  Renders the frames around the playhead ahead of time, on worker threads.
+ *
+ *  The preview otherwise renders each frame on demand: every step, seek or scrub
+ *  decodes again, from the previous keyframe. The motion of the playhead is guessed
+ *  from its last moves, and the frames it's likely to reach next are rendered into
+ *  a bounded buffer, from independent copies of the input:
+ *  - frame by frame, the next ones in the same direction, and a few behind;
+ *  - when seeking at a steady pace and direction (shuttle), the next ones at that pace;
+ *  - for any other seek (scrub), the neighbours of the target and the next ones at its pace.
+ *  The consumer reads ahead on its own during the playback, its frames are only kept,
+ *  so that stepping back afterwards doesn't decode them again.
+ *
+ *  Everything is dropped and the workers stand down while the system runs low on memory.
+ */
+class FramePrefetcher
+{
+    public:
+        explicit FramePrefetcher( size_t budget );
+        /**
+         *  Waits for the frames being rendered, the pending ones are dropped.
+         */
+        ~FramePrefetcher();
+
+        /**
+         *  \brief  Attaches the buffer to the previewed input.
+         *
+         *  The previous input may have been released already, it isn't touched.
+         */
+        void                setInput( Backend::IInput* input );
+        // In bytes
+        void                setBudget( size_t budget );
+        /**
+         *  \brief  Drops the frames and the copies of the previous version of the input.
+         */
+        void                inputEdited();
+        /**
+         *  \brief  Called before the playhead is moved while paused.
+         *
+         *  The frame is served from the buffer if it's there, and the next moves are prefetched.
+         *  \param  step    true for a frame by frame move
+         */
+        void                seek( qint64 position, bool step );
+        /**
+         *  \brief  Called when the consumer showed a frame
+         */
+        void                positionChanged( qint64 position, bool paused );
+
+    private:
+        enum Motion
+        {
+            Idle,
+            Play,
+            Step,
+            Shuttle,
+            Scrub,
+        };
+
+        class Worker;
+
+        void                schedule( qint64 position );
+        // Hands a fresh copy of the input to an idle worker which needs one, ie. whose
+        // copy is older than the frames of the buffer
+        void                updateReaders();
+        void                releaseReaders();
+        void                cancel();
+        // false while the system runs low on memory
+        bool                checkMemory();
+        void                work( Worker& worker );
+
+    private:
+        Backend::IInput*                            m_input;
+        std::shared_ptr<Backend::MLT::FrameBuffer>  m_buffer;
+        size_t                                      m_budget;
+        std::vector<std::unique_ptr<Worker>>        m_workers;
+
+        // The playhead motion
+        Motion                                      m_motion;
+        qint64                                      m_position;
+        // The last move, in frames, and the average one of a shuttle
+        qint64                                      m_lastMove;
+        double                                      m_pace;
+        int                                         m_steadyMoves;
+        QElapsedTimer                               m_clock;
+        qint64                                      m_lastSeek;
+
+        bool                                        m_standingDown;
+        QElapsedTimer                               m_memoryClock;
+
+        // Shared with the workers
+        QMutex                                      m_mutex;
+        QWaitCondition                              m_wakeUp;
+        std::deque<qint64>                          m_queue;
+        bool                                        m_stop;
+};
+
+#endif // FRAMEPREFETCHER_H
@@ -0,0 +1,449 @@
+/*****************************************************************************
+ * RenderFarmCoordinator.cpp: Distributes segment renders to worker processes
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "RenderFarmCoordinator.h"
+#include "RenderFarmProtocol.h"
+#include "SegmentedRenderer.h"
+#include "Tools/VlmcDebug.h"
+
+#include <QCoreApplication>
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUuid>
+
+#include <algorithm>
+
+RenderFarmCoordinator::RenderFarmCoordinator( SegmentedRenderer& renderer, const QString& projectFile,
+                                              QObject* parent )
+    : QObject( parent )
+    , m_renderer( renderer )
+    , m_projectFile( projectFile )
+    , m_token( RenderFarm::token() )
+    , m_totalJobDuration( 0 )
+    , m_completedJobs( 0 )
+    , m_running( false )
+{
+    if ( m_token.isEmpty() == true )
+        m_token = QString::fromLatin1( QUuid::createUuid().toRfc4122().toHex() +
+                                       QUuid::createUuid().toRfc4122().toHex() );
+    connect( &m_server, &QTcpServer::newConnection, this, &RenderFarmCoordinator::newConnection );
+    m_watchdog.setInterval( 5000 );
+    connect( &m_watchdog, &QTimer::timeout, this, &RenderFarmCoordinator::watchdog );
+}
+
+RenderFarmCoordinator::~RenderFarmCoordinator()
+{
+    for ( auto& w : m_workers )
+    {
+        RenderFarm::send( *w.socket, { { "type", "quit" } } );
+        w.socket->flush();
+    }
+    for ( auto p : m_processes )
+    {
+        if ( p->state() != QProcess::NotRunning && p->waitForFinished( 5000 ) == false )
+            p->kill();
+        delete p;
+    }
+}
+
+bool
+RenderFarmCoordinator::listen( quint16 port, bool remote )
+{
+    if ( remote == true && RenderFarm::token().isEmpty() == true )
+    {
+        vlmcWarning() << "Render farm: Set" << RenderFarm::TokenVariable
+                      << "to share a token with the remote workers";
+        return false;
+    }
+    auto address = remote == true ? QHostAddress::Any : QHostAddress::LocalHost;
+    if ( m_server.listen( address, port ) == false )
+    {
+        vlmcWarning() << "Render farm: Can't listen on port" << port << ':' << m_server.errorString();
+        return false;
+    }
+    vlmcDebug() << "Render farm: Waiting for workers on port" << m_server.serverPort();
+    return true;
+}
+
+quint16
+RenderFarmCoordinator::port() const
+{
+    return m_server.serverPort();
+}
+
+void
+RenderFarmCoordinator::spawnLocalWorkers( quint32 count )
+{
+    Q_ASSERT( m_server.isListening() == true );
+    auto server = QStringLiteral( "127.0.0.1:%1" ).arg( port() );
+    for ( quint32 i = 0; i < count; ++i )
+    {
+        auto p = new QProcess;
+        p->setProcessChannelMode( QProcess::ForwardedChannels );
+        auto environment = QProcessEnvironment::systemEnvironment();
+        environment.insert( RenderFarm::TokenVariable, m_token );
+        p->setProcessEnvironment( environment );
+        connect( p, static_cast<void (QProcess::*)( int, QProcess::ExitStatus )>( &QProcess::finished ),
+                 this, [this, p]{ processExited( p ); } );
+        connect( p, static_cast<void (QProcess::*)( QProcess::ProcessError )>( &QProcess::error ), this, [this, p]( QProcess::ProcessError error )
+        {
+            // finished() isn't emitted for a process which couldn't start
+            if ( error == QProcess::FailedToStart )
+                processExited( p );
+        });
+        p->start( QCoreApplication::applicationFilePath(), { "--worker", server } );
+        m_processes << p;
+    }
+}
+
+void
+RenderFarmCoordinator::start()
+{
+    m_jobs.clear();
+    const auto& segments = m_renderer.segments();
+    for ( auto i = 0; i < segments.size(); ++i )
+    {
+        if ( m_renderer.isRendered( i ) == true )
+            continue;
+        Job job;
+        job.segment = i;
+        job.attempts = 0;
+        job.runningCount = 0;
+        job.done = false;
+        m_jobs << job;
+    }
+    vlmcDebug() << "Render farm:" << m_jobs.size() << "out of" << segments.size() << "segments to render";
+    m_running = true;
+    if ( m_jobs.isEmpty() == true )
+    {
+        QTimer::singleShot( 0, this, [this]{ finish( m_renderer.finalize() ); } );
+        return;
+    }
+    m_lastWorker.start();
+    m_watchdog.start();
+    dispatch();
+}
+
+void
+RenderFarmCoordinator::stop()
+{
+    finish( false );
+}
+
+void
+RenderFarmCoordinator::newConnection()
+{
+    while ( m_server.hasPendingConnections() == true )
+    {
+        // Only a worker once it said hello, see authenticate()
+        auto socket = m_server.nextPendingConnection();
+        connect( socket, &QTcpSocket::readyRead, this, [this, socket]{ readMessages( socket ); } );
+        connect( socket, &QTcpSocket::disconnected, this, [this, socket]{ workerDisconnected( socket ); } );
+    }
+}
+
+void
+RenderFarmCoordinator::authenticate( QTcpSocket* socket, const QVariantHash& message )
+{
+    if ( message["type"].toString() != "hello" || message["token"].toString() != m_token )
+    {
+        vlmcWarning() << "Render farm: Rejected a connection from" << socket->peerAddress().toString();
+        // Handled by workerDisconnected()
+        socket->abort();
+        return;
+    }
+    vlmcDebug() << "Render farm: Worker connected from" << socket->peerAddress().toString();
+    Worker w;
+    w.socket = socket;
+    w.job = -1;
+    m_workers << w;
+    dispatch();
+}
+
+void
+RenderFarmCoordinator::readMessages( QTcpSocket* socket )
+{
+    QVariantHash message;
+    while ( socket->state() == QAbstractSocket::ConnectedState &&
+            RenderFarm::readMessage( *socket, message ) == true )
+    {
+        auto isWorker = std::any_of( m_workers.begin(), m_workers.end(), [socket]( const Worker& w ) {
+            return w.socket == socket;
+        });
+        if ( isWorker == false )
+        {
+            authenticate( socket, message );
+            continue;
+        }
+        auto type = message["type"].toString();
+        auto jobId = message["id"].toInt();
+        // Ignore reports about jobs this worker was cancelled from
+        bool isCurrentJob = false;
+        for ( auto& w : m_workers )
+        {
+            if ( w.socket == socket && w.job == jobId )
+            {
+                w.job = -1;
+                isCurrentJob = true;
+            }
+        }
+        if ( isCurrentJob == false )
+            continue;
+        if ( type == "done" )
+            jobDone( jobId, socket );
+        else if ( type == "failed" )
+            jobFailed( jobId );
+    }
+}
+
+void
+RenderFarmCoordinator::workerDisconnected( QTcpSocket* socket )
+{
+    bool wasWorker = false;
+    for ( auto it = m_workers.begin(); it != m_workers.end(); ++it )
+    {
+        if ( ( *it ).socket != socket )
+            continue;
+        wasWorker = true;
+        auto jobId = ( *it ).job;
+        m_workers.erase( it );
+        if ( jobId >= 0 )
+        {
+            vlmcWarning() << "Render farm: Lost a worker while rendering segment" << m_jobs[jobId].segment;
+            jobFailed( jobId );
+        }
+        break;
+    }
+    socket->deleteLater();
+    // A rejected connection doesn't change anything
+    if ( wasWorker == true && m_running == true && m_workers.isEmpty() == true &&
+         hasRunningProcesses() == false )
+    {
+        vlmcCritical() << "Render farm: No worker left to render the pending segments";
+        finish( false );
+    }
+}
+
+void
+RenderFarmCoordinator::processExited( QProcess* process )
+{
+    if ( m_running == false )
+        return;
+    vlmcWarning() << "Render farm: A local worker exited:" << process->errorString();
+    if ( m_workers.isEmpty() == true && hasRunningProcesses() == false )
+    {
+        vlmcCritical() << "Render farm: Every local worker exited before the export was done";
+        finish( false );
+    }
+}
+
+bool
+RenderFarmCoordinator::hasRunningProcesses() const
+{
+    for ( auto p : m_processes )
+        if ( p->state() != QProcess::NotRunning )
+            return true;
+    return false;
+}
+
+void
+RenderFarmCoordinator::watchdog()
+{
+    if ( m_running == false )
+        return;
+    if ( m_workers.isEmpty() == false )
+        m_lastWorker.restart();
+    else if ( m_processes.isEmpty() == false && hasRunningProcesses() == false )
+    {
+        // The local workers may have exited before the export started
+        vlmcCritical() << "Render farm: Every local worker exited before the export was done";
+        finish( false );
+        return;
+    }
+    else if ( m_lastWorker.elapsed() > ConnectTimeout )
+    {
+        vlmcCritical() << "Render farm: No worker connected in" << ConnectTimeout / 1000 << "seconds";
+        finish( false );
+        return;
+    }
+    auto timeout = JobTimeout;
+    if ( m_completedJobs > 0 )
+        timeout = std::max( timeout, 4 * m_totalJobDuration / m_completedJobs );
+    QList<QTcpSocket*> stuck;
+    for ( const auto& w : m_workers )
+    {
+        if ( w.job < 0 || m_jobs[w.job].timer.elapsed() <= timeout )
+            continue;
+        vlmcWarning() << "Render farm: Segment" << m_jobs[w.job].segment << "timed out";
+        stuck << w.socket;
+    }
+    // Handled as lost workers once disconnected, which may happen right away
+    for ( auto socket : stuck )
+        socket->abort();
+}
+
+void
+RenderFarmCoordinator::jobDone( int jobId, QTcpSocket* socket )
+{
+    auto& job = m_jobs[jobId];
+    job.runningCount--;
+    if ( job.done == false )
+    {
+        job.done = true;
+        m_renderer.markRendered( job.segment );
+        m_totalJobDuration += job.timer.elapsed();
+        ++m_completedJobs;
+        // Stop the duplicates of this job, if any
+        for ( auto& w : m_workers )
+        {
+            if ( w.job != jobId || w.socket == socket )
+                continue;
+            RenderFarm::send( *w.socket, { { "type", "cancel" }, { "id", jobId } } );
+            w.job = -1;
+            job.runningCount--;
+        }
+
+        const auto& segments = m_renderer.segments();
+        qint64 length = segments.isEmpty() ? 0 : segments.last().end;
+        qint64 pending = 0;
+        for ( const auto& j : m_jobs )
+            if ( j.done == false )
+                pending += segments[j.segment].end - segments[j.segment].begin;
+        emit progress( length - pending, length );
+    }
+    for ( const auto& j : m_jobs )
+    {
+        if ( j.done == false )
+        {
+            dispatch();
+            return;
+        }
+    }
+    finish( m_renderer.finalize() );
+}
+
+void
+RenderFarmCoordinator::jobFailed( int jobId )
+{
+    auto& job = m_jobs[jobId];
+    job.runningCount--;
+    // Another worker may still complete it
+    if ( job.done == false && job.runningCount == 0 )
+    {
+        if ( ++job.attempts >= MaxAttempts )
+        {
+            vlmcCritical() << "Render farm: Giving up on segment" << job.segment << "after"
+                           << job.attempts << "attempts";
+            finish( false );
+            return;
+        }
+        vlmcWarning() << "Render farm: Retrying segment" << job.segment;
+    }
+    dispatch();
+}
+
+void
+RenderFarmCoordinator::dispatch()
+{
+    if ( m_running == false )
+        return;
+    for ( auto& w : m_workers )
+    {
+        if ( w.job >= 0 )
+            continue;
+        auto jobId = nextJob();
+        if ( jobId < 0 )
+            jobId = stragglerJob();
+        if ( jobId < 0 )
+            return;
+        assign( w, jobId );
+    }
+}
+
+int
+RenderFarmCoordinator::nextJob() const
+{
+    for ( auto i = 0; i < m_jobs.size(); ++i )
+    {
+        if ( m_jobs[i].done == false && m_jobs[i].runningCount == 0 )
+            return i;
+    }
+    return -1;
+}
+
+int
+RenderFarmCoordinator::stragglerJob() const
+{
+    if ( m_completedJobs == 0 )
+        return -1;
+    // Only duplicate jobs running for twice as long as a job usually takes
+    auto threshold = 2 * m_totalJobDuration / m_completedJobs;
+    int res = -1;
+    qint64 longest = threshold;
+    for ( auto i = 0; i < m_jobs.size(); ++i )
+    {
+        const auto& job = m_jobs[i];
+        if ( job.done == true || job.runningCount != 1 )
+            continue;
+        if ( job.timer.elapsed() > longest )
+        {
+            longest = job.timer.elapsed();
+            res = i;
+        }
+    }
+    return res;
+}
+
+void
+RenderFarmCoordinator::assign( Worker& worker, int jobId )
+{
+    auto& job = m_jobs[jobId];
+    if ( job.runningCount++ == 0 )
+        job.timer.start();
+    worker.job = jobId;
+    RenderFarm::send( *worker.socket, {
+        { "type", "job" },
+        { "id", jobId },
+        { "project", m_projectFile },
+        { "segment", RenderFarm::segmentToVariant( m_renderer.segments()[job.segment] ) },
+        { "settings", m_renderer.settings().toVariant() },
+    } );
+}
+
+void
+RenderFarmCoordinator::finish( bool success )
+{
+    if ( m_running == false )
+        return;
+    m_running = false;
+    m_watchdog.stop();
+    for ( auto& w : m_workers )
+        RenderFarm::send( *w.socket, { { "type", "quit" } } );
+    emit finished( success );
+}
@@ -0,0 +1,142 @@
+/*****************************************************************************
+ * RenderFarmCoordinator.h: Distributes segment renders to worker processes
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+
+#ifndef RENDERFARMCOORDINATOR_H
+#define RENDERFARMCOORDINATOR_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <QTcpServer>
+#include <QTimer>
+
+class   QProcess;
+class   QTcpSocket;
+class   SegmentedRenderer;
+
+/**
+ *  \brief  Renders the segments planned by a SegmentedRenderer using worker processes.
+ *
+ *  Workers are vlmc instances started with --worker <host:port>. They can either be
+ *  spawned locally, or started by hand on other hosts sharing the workspace storage.
+ *  Only local workers are accepted, unless remote ones are explicitly allowed. Either
+ *  way, workers must present the farm's token, see RenderFarm::TokenVariable.
+ *  Failed segments are retried, and once nothing is left to dispatch, idle workers
+ *  duplicate the slowest running segments so that a single straggler doesn't hold
+ *  the whole export.
+ *  The export fails when no worker is left to render the pending segments: every
+ *  spawned process exited and no worker is connected, or none connected in time.
+ *  A job running for much longer than expected is given to another worker.
+ */
+class   RenderFarmCoordinator : public QObject
+{
+    Q_OBJECT
+
+    public:
+        static const int        MaxAttempts = 3;
+        // How long the farm waits for a worker while none is connected, in milliseconds
+        static const int        ConnectTimeout = 60000;
+        // A job running longer than this, or 4 times the average, is given up, in milliseconds
+        static const qint64     JobTimeout = 30 * 60 * 1000;
+
+        /**
+         * @param renderer      A planned renderer, which is only used for bookkeeping.
+         * @param projectFile   The saved project the workers will load.
+         */
+        RenderFarmCoordinator( SegmentedRenderer& renderer, const QString& projectFile,
+                               QObject* parent = nullptr );
+        ~RenderFarmCoordinator();
+
+        /**
+         * @brief listen    Starts accepting workers
+         * @param port      The port to listen on, or 0 to pick any available port
+         * @param remote    Listens on every interface instead of the loopback one. The
+         *                  token must then be set in the environment, to be shared with
+         *                  the remote workers.
+         */
+        bool                    listen( quint16 port = 0, bool remote = false );
+        quint16                 port() const;
+        void                    spawnLocalWorkers( quint32 count );
+
+        void                    start();
+
+    public slots:
+        void                    stop();
+
+    private:
+        struct Worker
+        {
+            QTcpSocket*         socket;
+            // -1 when idle
+            int                 job;
+        };
+
+        struct Job
+        {
+            int                 segment;
+            int                 attempts;
+            int                 runningCount;
+            bool                done;
+            QElapsedTimer       timer;
+        };
+
+        void                    newConnection();
+        // Accepts a worker once it sent the token, closes the connection otherwise
+        void                    authenticate( QTcpSocket* socket, const QVariantHash& message );
+        void                    readMessages( QTcpSocket* socket );
+        void                    workerDisconnected( QTcpSocket* socket );
+        void                    processExited( QProcess* process );
+        // Fails the export if nothing is left to render it, and drops the stuck workers
+        void                    watchdog();
+        bool                    hasRunningProcesses() const;
+        void                    jobDone( int jobId, QTcpSocket* socket );
+        void                    jobFailed( int jobId );
+        void                    dispatch();
+        int                     nextJob() const;
+        int                     stragglerJob() const;
+        void                    assign( Worker& worker, int jobId );
+        void                    finish( bool success );
+
+    private:
+        SegmentedRenderer&      m_renderer;
+        QString                 m_projectFile;
+        // Taken from the environment, or made up for the local workers
+        QString                 m_token;
+        QTcpServer              m_server;
+        QList<Worker>           m_workers;
+        QList<Job>              m_jobs;
+        QList<QProcess*>        m_processes;
+        QTimer                  m_watchdog;
+        // Restarted whenever a worker is connected
+        QElapsedTimer           m_lastWorker;
+        // Sum of the successful job durations, to detect stragglers
+        qint64                  m_totalJobDuration;
+        int                     m_completedJobs;
+        bool                    m_running;
+
+    signals:
+        void                    progress( qint64 renderedFrames, qint64 length );
+        void                    finished( bool success );
+};
+
+#endif // RENDERFARMCOORDINATOR_H
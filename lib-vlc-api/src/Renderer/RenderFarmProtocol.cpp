@@ -0,0 +1,86 @@
+/*****************************************************************************
+ * RenderFarmProtocol.cpp: Messages exchanged by render farm processes
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "RenderFarmProtocol.h"
+
+#include <QIODevice>
+#include <QJsonDocument>
+
+const char* const RenderFarm::TokenVariable = "VLMC_FARM_TOKEN";
+
+QString
+RenderFarm::token()
+{
+    return QString::fromLocal8Bit( qgetenv( TokenVariable ) );
+}
+
+QVariant
+RenderFarm::segmentToVariant( const SegmentedRenderer::Segment& segment )
+{
+    return QVariantHash{
+        { "begin", segment.begin },
+        { "end", segment.end },
+        { "fingerprint", QString::fromLatin1( segment.fingerprint.toHex() ) },
+        { "fileName", segment.fileName },
+    };
+}
+
+SegmentedRenderer::Segment
+RenderFarm::segmentFromVariant( const QVariant& variant )
+{
+    auto h = variant.toHash();
+    SegmentedRenderer::Segment segment;
+    segment.begin = h["begin"].toLongLong();
+    segment.end = h["end"].toLongLong();
+    segment.fingerprint = QByteArray::fromHex( h["fingerprint"].toString().toLatin1() );
+    segment.fileName = h["fileName"].toString();
+    return segment;
+}
+
+void
+RenderFarm::send( QIODevice& device, const QVariantHash& message )
+{
+    device.write( QJsonDocument::fromVariant( message ).toJson( QJsonDocument::Compact ) );
+    device.write( "\n" );
+}
+
+bool
+RenderFarm::readMessage( QIODevice& device, QVariantHash& message )
+{
+    while ( device.canReadLine() == true )
+    {
+        auto line = device.readLine().trimmed();
+        if ( line.isEmpty() == true )
+            continue;
+        auto doc = QJsonDocument::fromJson( line );
+        if ( doc.isObject() == false )
+            continue;
+        message = doc.toVariant().toHash();
+        return true;
+    }
+    return false;
+}
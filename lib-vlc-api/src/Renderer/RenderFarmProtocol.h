@@ -0,0 +1,67 @@
+/*****************************************************************************
+ * RenderFarmProtocol.h: Messages exchanged by render farm processes
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+
+#ifndef RENDERFARMPROTOCOL_H
+#define RENDERFARMPROTOCOL_H
+
+#include <QVariant>
+
+#include "SegmentedRenderer.h"
+
+class   QIODevice;
+
+/**
+ *  The coordinator and its workers exchange JSON objects, one per line.
+ *  Each message has a "type":
+ *      - "hello"       worker -> coordinator, once connected: "token"
+ *      - "job"         coordinator -> worker: "id", "project", "segment" & "settings"
+ *      - "cancel"      coordinator -> worker: "id", the job was completed elsewhere
+ *      - "done"        worker -> coordinator: "id"
+ *      - "failed"      worker -> coordinator: "id"
+ *      - "quit"        coordinator -> worker
+ *  Segment files are exchanged by path, so remote workers must see the
+ *  coordinator's workspace at the same location.
+ *
+ *  A connection which doesn't start with a hello holding the coordinator's token
+ *  is closed. Workers read the token from the TokenVariable environment variable,
+ *  which keeps it out of the process list.
+ */
+namespace RenderFarm
+{
+    extern const char* const        TokenVariable;
+
+    // The token set in the environment, if any
+    QString                         token();
+
+    QVariant                        segmentToVariant( const SegmentedRenderer::Segment& segment );
+    SegmentedRenderer::Segment      segmentFromVariant( const QVariant& variant );
+
+    void                            send( QIODevice& device, const QVariantHash& message );
+    /**
+     * @brief readMessage   Reads the next complete message, if any.
+     * @return false if no complete message is available
+     */
+    bool                            readMessage( QIODevice& device, QVariantHash& message );
+}
+
+#endif // RENDERFARMPROTOCOL_H
@@ -0,0 +1,143 @@
+/*****************************************************************************
+ * RenderFarmWorker.cpp: Renders segments on behalf of a render farm coordinator
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "RenderFarmWorker.h"
+#include "RenderFarmProtocol.h"
+#include "SegmentedRenderer.h"
+
+#include "Main/Core.h"
+#include "Project/Project.h"
+#include "Tools/VlmcDebug.h"
+#include "Workflow/MainWorkflow.h"
+
+#include <QFileInfo>
+
+RenderFarmWorker::RenderFarmWorker( const QString& server, QObject* parent )
+    : QObject( parent )
+    , m_server( server )
+    , m_jobId( -1 )
+{
+    connect( &m_socket, &QTcpSocket::connected, this, [this]
+    {
+        send( { { "type", "hello" }, { "token", RenderFarm::token() } } );
+    });
+    connect( &m_socket, &QTcpSocket::readyRead, this, &RenderFarmWorker::readMessages );
+    connect( &m_socket, &QTcpSocket::disconnected, this, &RenderFarmWorker::finished );
+    connect( &m_socket, static_cast<void (QTcpSocket::*)( QAbstractSocket::SocketError )>( &QTcpSocket::error ),
+             this, [this]( QAbstractSocket::SocketError )
+    {
+        vlmcCritical() << "Render farm worker:" << m_socket.errorString();
+        emit finished();
+    });
+}
+
+RenderFarmWorker::~RenderFarmWorker()
+{
+}
+
+void
+RenderFarmWorker::start()
+{
+    auto host = m_server.section( ':', 0, -2 );
+    auto port = m_server.section( ':', -1 ).toUShort();
+    if ( host.isEmpty() == true || port == 0 )
+    {
+        vlmcCritical() << "Render farm worker: Invalid coordinator address" << m_server;
+        emit finished();
+        return;
+    }
+    m_socket.connectToHost( host, port );
+}
+
+void
+RenderFarmWorker::readMessages()
+{
+    QVariantHash message;
+    while ( RenderFarm::readMessage( m_socket, message ) == true )
+    {
+        auto type = message["type"].toString();
+        if ( type == "job" )
+            startJob( message );
+        else if ( type == "cancel" && message["id"].toInt() == m_jobId )
+        {
+            vlmcDebug() << "Render farm worker: Job" << m_jobId << "was completed by another worker";
+            m_jobId = -1;
+            if ( m_renderer != nullptr )
+                m_renderer->stop();
+        }
+        else if ( type == "quit" )
+        {
+            if ( m_renderer != nullptr )
+                m_renderer->stop();
+            m_socket.disconnectFromHost();
+        }
+    }
+}
+
+void
+RenderFarmWorker::startJob( const QVariantHash& job )
+{
+    m_jobId = job["id"].toInt();
+    auto projectFile = job["project"].toString();
+    auto project = Core::instance()->project();
+    if ( projectFile != m_projectFile )
+    {
+        if ( project->load( projectFile ) == false )
+        {
+            vlmcCritical() << "Render farm worker: Can't load project" << projectFile;
+            send( { { "type", "failed" }, { "id", m_jobId } } );
+            m_jobId = -1;
+            return;
+        }
+        m_projectFile = projectFile;
+    }
+
+    auto segment = RenderFarm::segmentFromVariant( job["segment"] );
+    auto settings = RenderSettings::fromVariant( job["settings"] );
+    m_renderer.reset( new SegmentedRenderer( settings, QFileInfo( segment.fileName ).absolutePath() ) );
+    m_renderer->setSegments( { segment } );
+    connect( m_renderer.get(), &SegmentedRenderer::finished, this, &RenderFarmWorker::jobFinished );
+    vlmcDebug() << "Render farm worker: Rendering frames" << segment.begin << "to" << segment.end;
+    Core::instance()->workflow()->renderSegments( *m_renderer, false );
+}
+
+void
+RenderFarmWorker::jobFinished( bool success )
+{
+    // The renderer can't be destroyed from its own signal
+    m_renderer.release()->deleteLater();
+    if ( m_jobId < 0 )
+        return;
+    send( { { "type", success == true ? "done" : "failed" }, { "id", m_jobId } } );
+    m_jobId = -1;
+}
+
+void
+RenderFarmWorker::send( const QVariantHash& message )
+{
+    RenderFarm::send( m_socket, message );
+}
@@ -0,0 +1,65 @@
+/*****************************************************************************
+ * RenderFarmWorker.h: Renders segments on behalf of a render farm coordinator
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+
+#ifndef RENDERFARMWORKER_H
+#define RENDERFARMWORKER_H
+
+#include <QObject>
+#include <QTcpSocket>
+#include <QVariant>
+
+#include <memory>
+
+class   SegmentedRenderer;
+
+class   RenderFarmWorker : public QObject
+{
+    Q_OBJECT
+
+    public:
+        /**
+         * @param server    The coordinator address, as host:port
+         */
+        explicit RenderFarmWorker( const QString& server, QObject* parent = nullptr );
+        ~RenderFarmWorker();
+
+        void                    start();
+
+    private:
+        void                    readMessages();
+        void                    startJob( const QVariantHash& job );
+        void                    jobFinished( bool success );
+        void                    send( const QVariantHash& message );
+
+    private:
+        QString                             m_server;
+        QTcpSocket                          m_socket;
+        QString                             m_projectFile;
+        std::unique_ptr<SegmentedRenderer>  m_renderer;
+        int                                 m_jobId;
+
+    signals:
+        void                    finished();
+};
+
+#endif // RENDERFARMWORKER_H
@@ -0,0 +1,195 @@
+/*****************************************************************************
+ * RenderSettings.cpp: Encoder settings for a single export rendition
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "RenderSettings.h"
+#include "Backend/MLT/MLTOutput.h"
+
+#include <QFileInfo>
+#include <QStringList>
+
+RenderSettings::RenderSettings()
+    : width( 0 )
+    , height( 0 )
+    , fps( .0 )
+    , aspectRatio( QStringLiteral( "16/9" ) )
+    , videoBitrate( 0 )
+    , audioBitrate( 0 )
+    , nbChannels( 2 )
+    , sampleRate( 48000 )
+    , loudnessTarget( .0 )
+    , useOptimizedMedia( false )
+{
+}
+
+bool
+RenderSettings::isValid() const
+{
+    return outputFileName.isEmpty() == false && width > 0 && height > 0 &&
+            fps > .0 && videoBitrate > 0 && audioBitrate > 0 &&
+            aspectRatio.split( '/' ).size() == 2;
+}
+
+QString
+RenderSettings::effectiveFormat() const
+{
+    if ( format.isEmpty() == false )
+        return format;
+    auto suffix = QFileInfo( outputFileName ).suffix().toLower();
+    if ( suffix == "m3u8" )
+        return QStringLiteral( "hls" );
+    if ( suffix == "mpd" )
+        return QStringLiteral( "dash" );
+    if ( suffix == "y4m" )
+        return QStringLiteral( "yuv4mpegpipe" );
+    // A pipe has no name to guess from, NUT carries any codec and needs no seeking
+    if ( effectiveTarget().startsWith( "pipe:" ) == true )
+        return QStringLiteral( "nut" );
+    return QString();
+}
+
+QString
+RenderSettings::effectiveTarget() const
+{
+    if ( outputFileName == "-" )
+        return QStringLiteral( "pipe:1" );
+    return outputFileName;
+}
+
+bool
+RenderSettings::isStreaming() const
+{
+    auto f = effectiveFormat();
+    return effectiveTarget().startsWith( "pipe:" ) == true || f == "hls" ||
+            f == "dash" || f == "yuv4mpegpipe";
+}
+
+void
+RenderSettings::apply( Backend::MLT::MLTFFmpegOutput& output ) const
+{
+    output.setTarget( qPrintable( effectiveTarget() ) );
+    output.setWidth( width );
+    output.setHeight( height );
+    output.setFrameRate( fps * 100, 100 );
+    auto temp = aspectRatio.split( '/' );
+    output.setAspectRatio( temp[0].toInt(), temp[1].toInt() );
+    output.setVideoBitrate( videoBitrate );
+    output.setAudioBitrate( audioBitrate );
+    output.setChannels( nbChannels );
+    output.setAudioSampleRate( sampleRate );
+    if ( videoCodec.isEmpty() == false )
+        output.setVideoCodec( qPrintable( videoCodec ) );
+    if ( audioCodec.isEmpty() == false )
+        output.setAudioCodec( qPrintable( audioCodec ) );
+
+    auto f = effectiveFormat();
+    if ( f.isEmpty() == true )
+        return;
+    output.setFormat( qPrintable( f ) );
+    QVariantHash options;
+    // Live playlists: publish each segment once closed, and keep them all listed
+    // so that viewers can seek back to the beginning of the export.
+    const int segmentDuration = 2;
+    if ( f == "hls" )
+    {
+        options["hls_time"] = segmentDuration;
+        options["hls_list_size"] = 0;
+        options["hls_playlist_type"] = "event";
+        options["hls_flags"] = "independent_segments+temp_file";
+    }
+    else if ( f == "dash" )
+    {
+        options["seg_duration"] = segmentDuration;
+        options["window_size"] = 0;
+        options["streaming"] = 1;
+        options["use_template"] = 1;
+        options["use_timeline"] = 1;
+    }
+    else if ( f == "yuv4mpegpipe" )
+    {
+        // yuv4mpeg only carries raw video
+        options["vcodec"] = "rawvideo";
+        options["pix_fmt"] = "yuv420p";
+        options["an"] = 1;
+    }
+    if ( f == "hls" || f == "dash" )
+    {
+        // Segments can only be cut on keyframes
+        options["g"] = qRound( fps * segmentDuration );
+    }
+    for ( auto it = formatOptions.begin(); it != formatOptions.end(); ++it )
+        options[it.key()] = it.value();
+    for ( auto it = options.begin(); it != options.end(); ++it )
+        output.setOption( qPrintable( it.key() ), qPrintable( it.value().toString() ) );
+}
+
+QVariant
+RenderSettings::toVariant() const
+{
+    QVariantHash h = {
+        { "outputFileName", outputFileName },
+        { "width", width },
+        { "height", height },
+        { "fps", fps },
+        { "aspectRatio", aspectRatio },
+        { "videoBitrate", videoBitrate },
+        { "audioBitrate", audioBitrate },
+        { "nbChannels", nbChannels },
+        { "sampleRate", sampleRate },
+        { "videoCodec", videoCodec },
+        { "audioCodec", audioCodec },
+        { "format", format },
+        { "formatOptions", formatOptions },
+        { "loudnessTarget", loudnessTarget },
+        { "useOptimizedMedia", useOptimizedMedia },
+    };
+    return QVariant( h );
+}
+
+RenderSettings
+RenderSettings::fromVariant( const QVariant& v )
+{
+    auto h = v.toHash();
+    RenderSettings settings;
+    settings.outputFileName = h["outputFileName"].toString();
+    settings.width = h["width"].toUInt();
+    settings.height = h["height"].toUInt();
+    settings.fps = h["fps"].toDouble();
+    if ( h.contains( "aspectRatio" ) == true )
+        settings.aspectRatio = h["aspectRatio"].toString();
+    settings.videoBitrate = h["videoBitrate"].toUInt();
+    settings.audioBitrate = h["audioBitrate"].toUInt();
+    if ( h.contains( "nbChannels" ) == true )
+        settings.nbChannels = h["nbChannels"].toUInt();
+    if ( h.contains( "sampleRate" ) == true )
+        settings.sampleRate = h["sampleRate"].toUInt();
+    settings.videoCodec = h["videoCodec"].toString();
+    settings.audioCodec = h["audioCodec"].toString();
+    settings.format = h["format"].toString();
+    settings.formatOptions = h["formatOptions"].toHash();
+    settings.loudnessTarget = h["loudnessTarget"].toDouble();
+    settings.useOptimizedMedia = h["useOptimizedMedia"].toBool();
+    return settings;
+}
@@ -0,0 +1,101 @@
+/*****************************************************************************
+ * RenderSettings.h: Encoder settings for a single export rendition
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef RENDERSETTINGS_H
+#define RENDERSETTINGS_H
+
+#include <QString>
+#include <QVariant>
+
+namespace Backend
+{
+namespace MLT
+{
+class MLTFFmpegOutput;
+}
+}
+
+/**
+ *  \brief  Describes one encoded output of an export.
+ *
+ *  Several renditions can be fed from a single composite of the timeline,
+ *  see MainWorkflow::startRenderToFiles.
+ *  Empty codec names let the muxer pick its default codecs.
+ *
+ *  Besides regular files, the output can be streamed while it is encoded:
+ *  "-" or a "pipe:N" target writes a NUT stream (or yuv4mpeg, for a .y4m name
+ *  or the yuv4mpegpipe format) to a file descriptor, and a .m3u8 or .mpd output
+ *  is published as a live HLS or DASH playlist whose segments appear as soon
+ *  as they are closed.
+ */
+struct RenderSettings
+{
+    RenderSettings();
+
+    QString     outputFileName;
+    quint32     width;
+    quint32     height;
+    double      fps;
+    QString     aspectRatio;
+    quint32     videoBitrate;
+    quint32     audioBitrate;
+    quint32     nbChannels;
+    quint32     sampleRate;
+    QString     videoCodec;
+    QString     audioCodec;
+    // The muxer short name. Empty to guess it from the output name
+    QString     format;
+    // Extra muxer options, ie. "hls_time". They override the format defaults.
+    QVariantHash    formatOptions;
+    // The integrated loudness to normalize the audio to, in LUFS (ie. -23 for EBU R128).
+    // 0 keeps the clips' levels.
+    double      loudnessTarget;
+    // Encodes from the optimized copies of the media instead of the originals.
+    // Faster to decode, but the copies are only as good as their codec.
+    bool        useOptimizedMedia;
+
+    bool        isValid() const;
+    /**
+     *  \brief  The muxer to use, after guessing it from the output name if needed.
+     *  \return An empty string when avformat should guess it itself.
+     */
+    QString     effectiveFormat() const;
+    /**
+     *  \brief  The URL given to avformat, "-" being translated to the standard output.
+     */
+    QString     effectiveTarget() const;
+    /**
+     *  \brief  true if the output is consumed while being encoded (pipe, HLS, DASH).
+     *
+     *  Such outputs can't be split into segments and joined afterward.
+     */
+    bool        isStreaming() const;
+    /**
+     *  \brief  Applies those settings to an avformat output.
+     */
+    void        apply( Backend::MLT::MLTFFmpegOutput& output ) const;
+
+    QVariant                toVariant() const;
+    static RenderSettings   fromVariant( const QVariant& v );
+};
+
+#endif // RENDERSETTINGS_H
@@ -0,0 +1,413 @@
+/*****************************************************************************
+ * SegmentedRenderer.cpp: Exports a sequence as independently encoded segments
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "SegmentedRenderer.h"
+
+#include "Backend/MLT/MLTOutput.h"
+#include "Main/Core.h"
+#include "Settings/Settings.h"
+#include "Tools/OutputEventWatcher.h"
+#include "Tools/VlmcDebug.h"
+#include "Workflow/SequenceWorkflow.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QProcess>
+#include <QSaveFile>
+#include <QSet>
+#include <QTemporaryFile>
+#include <QTextStream>
+
+const QString SegmentedRenderer::ManifestFileName = QStringLiteral( "manifest.json" );
+
+SegmentedRenderer::SegmentedRenderer( const RenderSettings& settings, const QString& cacheDir, QObject* parent )
+    : QObject( parent )
+    , m_settings( settings )
+    , m_cacheDir( cacheDir )
+    , m_length( 0 )
+    , m_ownsManifest( false )
+    , m_input( nullptr )
+    , m_eventWatcher( new OutputEventWatcher )
+    , m_current( 0 )
+    , m_segmentFailed( false )
+    , m_join( true )
+    , m_stopRequested( false )
+{
+    connect( m_eventWatcher.get(), &OutputEventWatcher::stopped,
+             this, &SegmentedRenderer::segmentStopped, Qt::QueuedConnection );
+    // Queued as well, so that it's handled before the stop which follows the error
+    connect( m_eventWatcher.get(), &OutputEventWatcher::errorEncountered,
+             this, &SegmentedRenderer::segmentFailed, Qt::QueuedConnection );
+}
+
+SegmentedRenderer::~SegmentedRenderer()
+{
+    if ( m_output != nullptr )
+    {
+        m_output.reset();
+        QFile::remove( partialFileName( m_segments[m_current] ) );
+    }
+}
+
+void
+SegmentedRenderer::plan( const SequenceWorkflow& sequence, qint64 length, qint64 segmentLength )
+{
+    Q_ASSERT( segmentLength > 0 );
+    m_segments.clear();
+    m_length = length;
+
+    // The destination doesn't change the encoded content, so it mustn't invalidate the cache
+    auto settings = m_settings.toVariant().toHash();
+    settings.remove( "outputFileName" );
+    auto settingsFingerprint = QJsonDocument::fromVariant( settings ).toJson( QJsonDocument::Compact );
+    auto suffix = QFileInfo( m_settings.outputFileName ).suffix();
+    QDir cacheDir( m_cacheDir );
+
+    for ( qint64 begin = 0; begin < length; begin += segmentLength )
+    {
+        Segment s;
+        s.begin = begin;
+        s.end = qMin( begin + segmentLength, length );
+        QCryptographicHash hash( QCryptographicHash::Sha1 );
+        hash.addData( sequence.fingerprint( s.begin, s.end ) );
+        hash.addData( settingsFingerprint );
+        s.fingerprint = hash.result();
+        s.fileName = cacheDir.absoluteFilePath( QString::fromLatin1( s.fingerprint.toHex() ) + '.' + suffix );
+        m_segments << s;
+    }
+    m_ownsManifest = true;
+    loadManifest();
+}
+
+void
+SegmentedRenderer::setSegments( const QList<Segment>& segments )
+{
+    m_segments = segments;
+    m_length = 0;
+    for ( const auto& s : segments )
+        m_length = qMax( m_length, s.end );
+}
+
+const QList<SegmentedRenderer::Segment>&
+SegmentedRenderer::segments() const
+{
+    return m_segments;
+}
+
+const RenderSettings&
+SegmentedRenderer::settings() const
+{
+    return m_settings;
+}
+
+bool
+SegmentedRenderer::isRendered( int index ) const
+{
+    QFileInfo fInfo( m_segments[index].fileName );
+    if ( m_ownsManifest == false )
+        return fInfo.exists();
+    auto it = m_completed.find( fInfo.fileName() );
+    return it != m_completed.end() && fInfo.exists() == true && fInfo.size() == it.value();
+}
+
+int
+SegmentedRenderer::pendingCount() const
+{
+    int count = 0;
+    for ( auto i = 0; i < m_segments.size(); ++i )
+        if ( isRendered( i ) == false )
+            ++count;
+    return count;
+}
+
+void
+SegmentedRenderer::markRendered( int index )
+{
+    QFileInfo fInfo( m_segments[index].fileName );
+    m_completed[fInfo.fileName()] = fInfo.size();
+    writeManifest();
+}
+
+void
+SegmentedRenderer::start( Backend::IInput& input, bool join )
+{
+    if ( m_ownsManifest == true )
+    {
+        removePartialFiles();
+        writeManifest();
+    }
+    m_input = &input;
+    m_current = 0;
+    m_join = join;
+    m_stopRequested = false;
+    // Don't emit finished() before the caller had a chance to wait for it
+    QMetaObject::invokeMethod( this, "renderNext", Qt::QueuedConnection );
+}
+
+void
+SegmentedRenderer::stop()
+{
+    m_stopRequested = true;
+    if ( m_output != nullptr )
+        m_output->stop();
+}
+
+void
+SegmentedRenderer::renderNext()
+{
+    m_output.reset();
+    m_segmentInput.reset();
+
+    if ( m_stopRequested == true )
+    {
+        emit finished( false );
+        return;
+    }
+    while ( m_current < m_segments.size() && isRendered( m_current ) == true )
+        ++m_current;
+    if ( m_current == m_segments.size() )
+    {
+        emit progress( m_length, m_length );
+        emit finished( m_join == false || finalize() == true );
+        return;
+    }
+
+    const auto& segment = m_segments[m_current];
+    emit progress( segment.begin, m_length );
+    vlmcDebug() << "Rendering segment" << m_current << "[" << segment.begin << ',' << segment.end << ']';
+
+    auto settings = m_settings;
+    settings.outputFileName = partialFileName( segment );
+    m_segmentInput = m_input->cut( segment.begin, segment.end - 1 );
+    m_segmentFailed = false;
+    m_output.reset( new Backend::MLT::MLTFFmpegOutput );
+    settings.apply( *m_output );
+    m_output->setCallback( m_eventWatcher.get() );
+    m_output->connect( *m_segmentInput );
+    m_output->start();
+}
+
+void
+SegmentedRenderer::segmentStopped()
+{
+    // Stopping an output notifies again upon its destruction
+    if ( m_output == nullptr || m_output->isStopped() == false )
+        return;
+    // The consumer only stops by itself once it read the whole cut
+    auto complete = m_segmentFailed == false &&
+            m_segmentInput->position() >= m_segmentInput->playableLength() - 1;
+    m_output.reset();
+    m_segmentInput.reset();
+
+    const auto& segment = m_segments[m_current];
+    auto partial = partialFileName( segment );
+    if ( m_stopRequested == true )
+    {
+        QFile::remove( partial );
+        emit finished( false );
+        return;
+    }
+    // A truncated segment would be reused by every later export, see isRendered()
+    if ( complete == false || QFileInfo( partial ).size() <= 0 )
+    {
+        vlmcWarning() << "Failed to render segment" << m_current << "[" << segment.begin << ','
+                      << segment.end << ']';
+        QFile::remove( partial );
+        emit finished( false );
+        return;
+    }
+    QFile::remove( segment.fileName );
+    if ( QFile::rename( partial, segment.fileName ) == false )
+    {
+        vlmcWarning() << "Failed to store rendered segment" << segment.fileName;
+        emit finished( false );
+        return;
+    }
+    if ( m_ownsManifest == true )
+        markRendered( m_current );
+    ++m_current;
+    renderNext();
+}
+
+void
+SegmentedRenderer::segmentFailed()
+{
+    m_segmentFailed = true;
+}
+
+bool
+SegmentedRenderer::finalize()
+{
+    QStringList files;
+    for ( auto i = 0; i < m_segments.size(); ++i )
+    {
+        if ( isRendered( i ) == false )
+        {
+            vlmcWarning() << "Can't finalize export: segment" << i << "is missing";
+            return false;
+        }
+        files << m_segments[i].fileName;
+    }
+    if ( concatenate( files, m_settings.outputFileName ) == false )
+        return false;
+    removeStaleSegments();
+    return true;
+}
+
+void
+SegmentedRenderer::removeStaleSegments()
+{
+    QSet<QString> used;
+    for ( const auto& s : m_segments )
+        used.insert( s.fileName );
+    QDir cacheDir( m_cacheDir );
+    for ( const auto& fInfo : cacheDir.entryInfoList( QDir::Files ) )
+    {
+        if ( fInfo.fileName() == ManifestFileName )
+            continue;
+        if ( used.contains( fInfo.absoluteFilePath() ) == false )
+        {
+            m_completed.remove( fInfo.fileName() );
+            QFile::remove( fInfo.absoluteFilePath() );
+        }
+    }
+    if ( m_ownsManifest == true )
+        writeManifest();
+}
+
+bool
+SegmentedRenderer::concatenate( const QStringList& files, const QString& target )
+{
+    if ( files.isEmpty() == true )
+        return false;
+    // Never leave a truncated output behind: join into a temporary file first
+    QFileInfo targetInfo( target );
+    auto partialTarget = targetInfo.absolutePath() + '/' + targetInfo.completeBaseName() +
+            ".part." + targetInfo.suffix();
+    QFile::remove( partialTarget );
+    if ( files.size() == 1 )
+    {
+        if ( QFile::copy( files.first(), partialTarget ) == false )
+            return false;
+        QFile::remove( target );
+        return QFile::rename( partialTarget, target );
+    }
+
+    // Let FFmpeg's concat demuxer rebase the timestamps of each segment
+    QTemporaryFile list( QDir::temp().absoluteFilePath( "vlmc-concat-XXXXXX.txt" ) );
+    if ( list.open() == false )
+        return false;
+    QTextStream stream( &list );
+    for ( const auto& f : files )
+        stream << "file '" << QString( f ).replace( '\'', "'\\''" ) << "'\n";
+    stream.flush();
+
+    QStringList args = { "-y", "-v", "error", "-f", "concat", "-safe", "0", "-i", list.fileName(),
+                         "-map", "0", "-c", "copy", partialTarget };
+    auto res = QProcess::execute( VLMC_GET_STRING( "vlmc/FFmpegPath" ), args );
+    if ( res != 0 )
+    {
+        vlmcWarning() << "Failed to join" << files.size() << "segments into" << target;
+        QFile::remove( partialTarget );
+        return false;
+    }
+    QFile::remove( target );
+    return QFile::rename( partialTarget, target );
+}
+
+QString
+SegmentedRenderer::partialFileName( const Segment& segment ) const
+{
+    QFileInfo fInfo( segment.fileName );
+    // Several processes may render the same segment, see RenderFarmCoordinator.
+    // Keep the extension last, the muxer is guessed from it
+    return fInfo.absolutePath() + '/' + fInfo.completeBaseName() + ".part-" +
+            QString::number( QCoreApplication::applicationPid() ) + '.' + fInfo.suffix();
+}
+
+void
+SegmentedRenderer::loadManifest()
+{
+    m_completed.clear();
+    QFile file( QDir( m_cacheDir ).absoluteFilePath( ManifestFileName ) );
+    if ( file.open( QFile::ReadOnly ) == false )
+        return;
+    auto manifest = QJsonDocument::fromJson( file.readAll() ).toVariant().toHash();
+    for ( const auto& var : manifest["segments"].toList() )
+    {
+        auto h = var.toHash();
+        if ( h.contains( "size" ) == true )
+            m_completed[h["file"].toString()] = h["size"].toLongLong();
+    }
+    vlmcDebug() << "Found" << m_completed.size() << "completed segments in" << m_cacheDir;
+}
+
+void
+SegmentedRenderer::writeManifest() const
+{
+    QVariantList segments;
+    for ( const auto& s : m_segments )
+    {
+        auto fileName = QFileInfo( s.fileName ).fileName();
+        QVariantHash h = {
+            { "begin", s.begin },
+            { "end", s.end },
+            { "file", fileName },
+        };
+        auto it = m_completed.find( fileName );
+        if ( it != m_completed.end() )
+            h["size"] = it.value();
+        segments << h;
+    }
+    QVariantHash manifest = {
+        { "output", m_settings.outputFileName },
+        { "settings", m_settings.toVariant() },
+        { "length", m_length },
+        { "segments", segments },
+    };
+    // Don't let an interruption corrupt the manifest itself
+    QSaveFile file( QDir( m_cacheDir ).absoluteFilePath( ManifestFileName ) );
+    if ( file.open( QFile::WriteOnly ) == false )
+    {
+        vlmcWarning() << "Can't write export manifest in" << m_cacheDir;
+        return;
+    }
+    file.write( QJsonDocument::fromVariant( manifest ).toJson() );
+    file.commit();
+}
+
+void
+SegmentedRenderer::removePartialFiles() const
+{
+    // Leftovers from an interrupted export
+    QDir cacheDir( m_cacheDir );
+    for ( const auto& fInfo : cacheDir.entryInfoList( { "*.part-*" }, QDir::Files ) )
+        QFile::remove( fInfo.absoluteFilePath() );
+}
@@ -0,0 +1,167 @@
+/*****************************************************************************
+ * SegmentedRenderer.h: Exports a sequence as independently encoded segments
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef SEGMENTEDRENDERER_H
+#define SEGMENTEDRENDERER_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QStringList>
+
+#include <memory>
+
+#include "RenderSettings.h"
+
+class   OutputEventWatcher;
+class   SequenceWorkflow;
+
+namespace Backend
+{
+class   IInput;
+namespace MLT
+{
+class   MLTFFmpegOutput;
+}
+}
+
+/**
+ *  \brief  Renders a sequence as a list of fixed length segments.
+ *
+ *  Each segment is named after the fingerprint of its content and encoder settings,
+ *  so segments left in the cache directory by a previous export are reused as long
+ *  as the part of the timeline they cover didn't change.
+ *  Segments are then joined without reencoding by finalize().
+ *
+ *  When the plan is computed by this renderer, a manifest in the cache directory
+ *  records the encoder settings and every closed segment. A segment only counts as
+ *  rendered once listed there, so an export interrupted at any point resumes
+ *  after its last completed segment.
+ */
+class   SegmentedRenderer : public QObject
+{
+    Q_OBJECT
+
+    public:
+        static const QString    ManifestFileName;
+
+        struct Segment
+        {
+            qint64      begin;
+            // Exclusive
+            qint64      end;
+            QByteArray  fingerprint;
+            // Absolute path of the encoded segment in the cache directory
+            QString     fileName;
+        };
+
+        SegmentedRenderer( const RenderSettings& settings, const QString& cacheDir, QObject* parent = nullptr );
+        ~SegmentedRenderer();
+
+        /**
+         * @brief plan          Splits [0, length) in segments and fingerprints them
+         * @param segmentLength The length of a segment, in frames
+         */
+        void                    plan( const SequenceWorkflow& sequence, qint64 length, qint64 segmentLength );
+        /**
+         * @brief setSegments   Uses an externally computed plan, ie. a render farm job
+         */
+        void                    setSegments( const QList<Segment>& segments );
+
+        const QList<Segment>&   segments() const;
+        const RenderSettings&   settings() const;
+        bool                    isRendered( int index ) const;
+        int                     pendingCount() const;
+        /**
+         * @brief markRendered  Records a segment rendered by another process
+         */
+        void                    markRendered( int index );
+
+        /**
+         * @brief start     Renders every pending segment, one after another.
+         *
+         * This returns immediately, finished() is emitted once all segments
+         * are rendered and joined, or when an error occurs.
+         * The input must outlive the rendering.
+         * @param join      false to leave the segments in the cache without joining them
+         */
+        void                    start( Backend::IInput& input, bool join = true );
+
+        /**
+         * @brief finalize  Joins every segment into the settings output file.
+         * @return          true if all segments were rendered and joined.
+         */
+        bool                    finalize();
+
+        /**
+         * @brief removeStaleSegments   Removes cached files not used by the current plan
+         */
+        void                    removeStaleSegments();
+
+        /**
+         * @brief concatenate   Joins encoded files without reencoding them
+         * @param files         The files to join, in order. They must share their encoder settings.
+         * @param target        The output file
+         */
+        static bool             concatenate( const QStringList& files, const QString& target );
+
+    public slots:
+        void                    stop();
+
+    private slots:
+        void                    renderNext();
+        void                    segmentStopped();
+        void                    segmentFailed();
+
+    private:
+        QString                 partialFileName( const Segment& segment ) const;
+        void                    loadManifest();
+        void                    writeManifest() const;
+        void                    removePartialFiles() const;
+
+    private:
+        RenderSettings                                  m_settings;
+        QString                                         m_cacheDir;
+        QList<Segment>                                  m_segments;
+        qint64                                          m_length;
+        // Only the process which planned the export maintains the manifest
+        bool                                            m_ownsManifest;
+        // Completed segment file names, relative to the cache directory, and their size
+        QHash<QString, qint64>                          m_completed;
+
+        Backend::IInput*                                m_input;
+        // Declaration order matters: the output must go before its input & watcher
+        std::unique_ptr<OutputEventWatcher>             m_eventWatcher;
+        std::unique_ptr<Backend::IInput>                m_segmentInput;
+        std::unique_ptr<Backend::MLT::MLTFFmpegOutput>  m_output;
+        int                                             m_current;
+        // The encoder of the current segment reported an error
+        bool                                            m_segmentFailed;
+        bool                                            m_join;
+        bool                                            m_stopRequested;
+
+    signals:
+        void                    progress( qint64 renderedFrames, qint64 length );
+        void                    finished( bool success );
+};
+
+#endif // SEGMENTEDRENDERER_H
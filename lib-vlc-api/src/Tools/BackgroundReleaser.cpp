@@ -0,0 +1,90 @@
+/*****************************************************************************
+ * BackgroundReleaser.cpp: Destroys objects away from the main thread
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "BackgroundReleaser.h"
+
+#include <QMutexLocker>
+
+BackgroundReleaser::BackgroundReleaser()
+    : m_busy( false )
+    , m_stop( false )
+{
+}
+
+BackgroundReleaser::~BackgroundReleaser()
+{
+    {
+        QMutexLocker    lock( &m_mutex );
+        m_stop = true;
+        m_wakeUp.wakeAll();
+    }
+    wait();
+    // Objects queued after the thread exited, or if it never started
+    m_queue.clear();
+}
+
+void
+BackgroundReleaser::enqueue( std::shared_ptr<void> garbage )
+{
+    QMutexLocker    lock( &m_mutex );
+    m_queue.push_back( std::move( garbage ) );
+    if ( isRunning() == false && m_stop == false )
+        start( QThread::LowPriority );
+    m_wakeUp.wakeAll();
+}
+
+void
+BackgroundReleaser::waitForIdle()
+{
+    QMutexLocker    lock( &m_mutex );
+    while ( m_queue.empty() == false || m_busy == true )
+        m_idle.wait( &m_mutex );
+}
+
+void
+BackgroundReleaser::run()
+{
+    QMutexLocker    lock( &m_mutex );
+    while ( true )
+    {
+        while ( m_queue.empty() == false )
+        {
+            std::vector<std::shared_ptr<void>>  batch;
+            batch.swap( m_queue );
+            m_busy = true;
+            lock.unlock();
+            // Destroy in release order, without holding the lock
+            for ( auto& garbage : batch )
+                garbage.reset();
+            lock.relock();
+            m_busy = false;
+        }
+        m_idle.wakeAll();
+        if ( m_stop == true )
+            break;
+        m_wakeUp.wait( &m_mutex );
+    }
+}
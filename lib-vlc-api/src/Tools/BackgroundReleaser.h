@@ -0,0 +1,79 @@
+/*****************************************************************************
+ * BackgroundReleaser.h: Destroys objects away from the main thread
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef BACKGROUNDRELEASER_H
+#define BACKGROUNDRELEASER_H
+
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+
+#include <memory>
+#include <vector>
+
+/**
+ *  \brief  Releases objects from a worker thread.
+ *
+ *  Closing a media producer flushes its decoders and closes its demuxer, which adds
+ *  up to seconds when a whole project is torn down. Anything handed to release()
+ *  is destroyed in order by a single low priority thread instead.
+ *
+ *  Released objects must not be used by anyone else anymore. QObjects among them
+ *  must have been disconnected, as they get destroyed outside of their thread.
+ */
+class BackgroundReleaser : public QThread
+{
+    public:
+        BackgroundReleaser();
+        /**
+         *  Waits for every pending object to be released, so that this can be
+         *  destroyed before the backend.
+         */
+        ~BackgroundReleaser();
+
+        template <typename T>
+        void                release( T garbage )
+        {
+            enqueue( std::make_shared<T>( std::move( garbage ) ) );
+        }
+
+        /**
+         *  \brief  Blocks until everything released so far is destroyed.
+         */
+        void                waitForIdle();
+
+    protected:
+        void                run() override;
+
+    private:
+        void                enqueue( std::shared_ptr<void> garbage );
+
+    private:
+        QMutex                              m_mutex;
+        QWaitCondition                      m_wakeUp;
+        QWaitCondition                      m_idle;
+        std::vector<std::shared_ptr<void>>  m_queue;
+        bool                                m_busy;
+        bool                                m_stop;
+};
+
+#endif // BACKGROUNDRELEASER_H
@@ -0,0 +1,93 @@
+/*****************************************************************************
+ * ReaderPool.cpp: Per thread decoders of media inputs
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "ReaderPool.h"
+
+#include "Backend/IInput.h"
+#include "Backend/MLT/MLTService.h"
+#include "Tools/VlmcDebug.h"
+
+#include <QThreadStorage>
+
+#include <list>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace
+{
+
+// Most recently used first
+using Readers = std::list<std::pair<std::string, std::unique_ptr<Backend::IInput>>>;
+
+QThreadStorage<Readers*>    threadReaders;
+
+Readers&
+readers()
+{
+    if ( threadReaders.hasLocalData() == false )
+        threadReaders.setLocalData( new Readers );
+    return *threadReaders.localData();
+}
+
+}
+
+Backend::IInput*
+ReaderPool::acquire( const Backend::IInput& input )
+{
+    auto& pool = readers();
+    std::string path( input.path() );
+    auto it = pool.begin();
+    while ( it != pool.end() && it->first != path )
+        ++it;
+    if ( it != pool.end() )
+        pool.splice( pool.begin(), pool, it );
+    else
+    {
+        try
+        {
+            pool.emplace_front( path, input.reader() );
+        }
+        catch ( Backend::InvalidServiceException& e )
+        {
+            vlmcWarning() << "Can't open a reader of" << input.path();
+            return nullptr;
+        }
+        if ( pool.size() > Capacity )
+            pool.pop_back();
+    }
+    auto reader = pool.front().second.get();
+    if ( reader->begin() != input.begin() || reader->end() != input.end() )
+        reader->setBoundaries( input.begin(), input.end() );
+    return reader;
+}
+
+void
+ReaderPool::clear()
+{
+    if ( threadReaders.hasLocalData() == true )
+        threadReaders.localData()->clear();
+}
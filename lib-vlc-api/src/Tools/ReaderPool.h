@@ -0,0 +1,64 @@
+/*****************************************************************************
+ * ReaderPool.h: Per thread decoders of media inputs
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef READERPOOL_H
+#define READERPOOL_H
+
+#include <cstddef>
+
+namespace Backend
+{
+class IInput;
+}
+
+/**
+ *  \brief  Keeps the readers opened by each thread, see IInput::reader.
+ *
+ *  Opening a decoder costs a probe of the file, so threads pulling frames from the
+ *  same media over and over (thumbnails, analysis, export workers...) reuse theirs.
+ *  A reader is never shared between threads, and the pool of a thread is released
+ *  when it exits.
+ *
+ *  Readers are keyed by media file, which only makes sense for media inputs: a
+ *  track or a sequence changes while it is edited, use IInput::reader for them.
+ */
+class ReaderPool
+{
+    public:
+        // The number of readers each thread keeps open
+        static const size_t         Capacity = 8;
+
+        /**
+         *  \brief  Returns the calling thread reader of an input, opening it if needed.
+         *
+         *  The reader gets the boundaries of the input. It stays valid until the thread
+         *  acquires Capacity other readers, calls clear() or exits.
+         *  \return nullptr if the media can't be opened
+         */
+        static Backend::IInput*     acquire( const Backend::IInput& input );
+        /**
+         *  \brief  Closes every reader of the calling thread.
+         */
+        static void                 clear();
+};
+
+#endif // READERPOOL_H
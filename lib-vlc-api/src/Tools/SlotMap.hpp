@@ -0,0 +1,172 @@
+/*****************************************************************************
+ * SlotMap.hpp : Contiguous storage addressed by generational handles
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef SLOTMAP_HPP
+#define SLOTMAP_HPP
+
+#include <QHash>
+#include <QMetaType>
+#include <QVector>
+
+/**
+ *  \brief  Identifies an element of a SlotMap.
+ *
+ *  A handle is two integers, cheap to copy, compare and hash. The generation
+ *  is bumped each time a slot is freed, so a handle to a removed element never
+ *  resolves to the element reusing its slot.
+ */
+struct  SlotHandle
+{
+    SlotHandle() : index( 0 ), generation( 0 ) {}
+    SlotHandle( quint32 i, quint32 g ) : index( i ), generation( g ) {}
+
+    bool    isNull() const { return generation == 0; }
+    bool    operator==( const SlotHandle& h ) const { return index == h.index && generation == h.generation; }
+    bool    operator!=( const SlotHandle& h ) const { return !( *this == h ); }
+
+    quint32     index;
+    quint32     generation;
+};
+
+Q_DECLARE_METATYPE( SlotHandle )
+
+inline uint
+qHash( const SlotHandle& h, uint seed = 0 )
+{
+    return ::qHash( ( static_cast<quint64>( h.generation ) << 32 ) | h.index, seed );
+}
+
+/**
+ *  \brief  Stores values in a vector, reusing the slots of removed values.
+ *
+ *  Insertion, removal and lookup are O(1) and don't allocate once the vector
+ *  reached its peak size. Iterating visits live values in slot order.
+ */
+template <typename T>
+class   SlotMap
+{
+    private:
+        struct  Slot
+        {
+            Slot() : generation( 1 ), alive( false ) {}
+            T           value;
+            quint32     generation;
+            bool        alive;
+        };
+
+    public:
+        class   const_iterator
+        {
+            public:
+                const_iterator( const QVector<Slot>* slots, int index )
+                    : m_slots( slots ), m_index( index ) { skipDead(); }
+
+                const T&        operator*() const { return (*m_slots)[m_index].value; }
+                const T*        operator->() const { return &(*m_slots)[m_index].value; }
+                SlotHandle      handle() const { return SlotHandle( m_index, (*m_slots)[m_index].generation ); }
+                const_iterator& operator++() { ++m_index; skipDead(); return *this; }
+                bool            operator==( const const_iterator& it ) const { return m_index == it.m_index; }
+                bool            operator!=( const const_iterator& it ) const { return m_index != it.m_index; }
+
+            private:
+                void    skipDead()
+                {
+                    while ( m_index < m_slots->size() && (*m_slots)[m_index].alive == false )
+                        ++m_index;
+                }
+
+                const QVector<Slot>*    m_slots;
+                int                     m_index;
+        };
+
+        SlotMap() : m_size( 0 ) {}
+
+        SlotHandle  insert( const T& value )
+        {
+            quint32 index;
+            if ( m_free.isEmpty() == false )
+            {
+                index = m_free.takeLast();
+            }
+            else
+            {
+                index = m_slots.size();
+                m_slots.append( Slot() );
+            }
+            auto& slot = m_slots[index];
+            slot.value = value;
+            slot.alive = true;
+            ++m_size;
+            return SlotHandle( index, slot.generation );
+        }
+
+        bool        remove( SlotHandle h )
+        {
+            if ( contains( h ) == false )
+                return false;
+            auto& slot = m_slots[h.index];
+            slot.value = T();
+            slot.alive = false;
+            // 0 is reserved for null handles
+            if ( ++slot.generation == 0 )
+                slot.generation = 1;
+            m_free.append( h.index );
+            --m_size;
+            return true;
+        }
+
+        bool        contains( SlotHandle h ) const
+        {
+            return h.index < static_cast<quint32>( m_slots.size() ) && m_slots[h.index].alive == true &&
+                    m_slots[h.index].generation == h.generation;
+        }
+
+        /**
+         * @return  The value for h, or a default constructed value if h is stale
+         */
+        T           value( SlotHandle h ) const
+        {
+            if ( contains( h ) == false )
+                return T();
+            return m_slots[h.index].value;
+        }
+
+        int         size() const { return m_size; }
+        bool        isEmpty() const { return m_size == 0; }
+
+        void        clear()
+        {
+            // Keep the slots, so that generations keep invalidating previous handles
+            for ( int i = 0; i < m_slots.size(); ++i )
+                remove( SlotHandle( i, m_slots[i].generation ) );
+        }
+
+        const_iterator  begin() const { return const_iterator( &m_slots, 0 ); }
+        const_iterator  end() const { return const_iterator( &m_slots, m_slots.size() ); }
+
+    private:
+        QVector<Slot>       m_slots;
+        QVector<quint32>    m_free;
+        int                 m_size;
+};
+
+#endif // SLOTMAP_HPP
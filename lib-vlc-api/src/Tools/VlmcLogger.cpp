@@ -37,6 +37,7 @@
 
 VlmcLogger::VlmcLogger()
     : m_logFile( nullptr )
+    , m_console( stdout )
     , m_backendLogLevel( Backend::IBackend::None )
 {
 }
@@ -111,6 +112,12 @@ VlmcLogger::setup()
     qInstallMessageHandler( VlmcLogger::vlmcMessageHandler );
 }
 
+void
+VlmcLogger::setConsoleStream( FILE* stream )
+{
+    m_console = stream;
+}
+
 void
 VlmcLogger::logLevelChanged( const QVariant &logLevel )
 {
@@ -162,7 +169,7 @@ VlmcLogger::outputToConsole( int level, const char *msg )
 #endif
     case QtWarningMsg:
     case QtCriticalMsg:
-        fprintf(stdout, "%s\n", msg);
+        fprintf(m_console, "%s\n", msg);
         break;
     case QtFatalMsg:
         fprintf(stderr, "%s\n", msg);
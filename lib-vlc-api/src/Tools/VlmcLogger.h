@@ -53,11 +53,16 @@ class   VlmcLogger : public QObject
         void            backendLogHandler( Backend::IBackend::LogLevel logLevel, const QString& msg );
 
         void            setup();
+        /**
+         *  \brief Redirects console messages, ie. when the standard output carries a stream
+         */
+        void            setConsoleStream( FILE* stream );
     private:
         void            writeToFile(const char* msg);
         void            outputToConsole( int level, const char* msg );
 
         FILE*                           m_logFile;
+        FILE*                           m_console;
         LogLevel                        m_currentLogLevel;
         Backend::IBackend::LogLevel     m_backendLogLevel;
 
@@ -94,6 +94,12 @@ Transition::setBoundaries( qint64 begin, qint64 end )
         transition->setBoundaries( begin, end );
 }
 
+const QString&
+Transition::identifier() const
+{
+    return m_identifier;
+}
+
 Workflow::TrackType
 Transition::type() const
 {
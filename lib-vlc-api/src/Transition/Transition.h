@@ -30,6 +30,8 @@ public:
     virtual qint64          length() const override;
     virtual void            setBoundaries( qint64 begin, qint64 end ) override;
 
+    const QString&          identifier() const;
+
     Workflow::TrackType     type() const;
     void                    setType( Workflow::TrackType type );
 
@@ -33,16 +33,22 @@
 #include "Backend/MLT/MLTMultiTrack.h"
 #include "Backend/MLT/MLTTrack.h"
 #include "Renderer/AbstractRenderer.h"
+#include "Renderer/ExportJob.h"
+#include "Renderer/RenderSettings.h"
+#include "Renderer/SegmentedRenderer.h"
+#include "Renderer/RenderFarmCoordinator.h"
 #include "EffectsEngine/EffectHelper.h"
 #ifdef HAVE_GUI
 #include "Gui/effectsengine/EffectStack.h"
 #include "Gui/WorkflowFileRendererDialog.h"
 #endif
 #include "Project/Project.h"
+#include "Project/Workspace.h"
 #include "Media/Clip.h"
 #include "Media/Media.h"
 #include "Library/Library.h"
 #include "MainWorkflow.h"
+#include "Preroller.h"
 #include "Project/Project.h"
 #include "SequenceWorkflow.h"
 #include "Settings/Settings.h"
@@ -52,25 +58,28 @@
 #include "Transition/Transition.h"
 #include "Workflow/Types.h"
 
+#include <QCryptographicHash>
+#include <QEventLoop>
+#include <QFileInfo>
 #include <QJsonArray>
 #include <QMutex>
 
-MainWorkflow::MainWorkflow( Settings* projectSettings, int trackCount ) :
+#include <algorithm>
+
+// Length of an incremental export segment, in seconds
+static const int SegmentDuration = 10;
+// The highest true peak EBU R128 allows, in dBTP
+static const double TruePeakCeiling = -1.0;
+
+MainWorkflow::MainWorkflow( Settings* vlmcSettings, Settings* projectSettings, int trackCount ) :
         m_trackCount( trackCount ),
         m_settings( new Settings ),
         m_renderer( new AbstractRenderer ),
         m_undoStack( new Commands::AbstractUndoStack ),
-        m_sequenceWorkflow( new SequenceWorkflow( trackCount ) )
-{
-    connect( m_sequenceWorkflow.get(), &SequenceWorkflow::clipAdded, this, &MainWorkflow::clipAdded );
-    connect( m_sequenceWorkflow.get(), &SequenceWorkflow::clipRemoved, this, &MainWorkflow::clipRemoved );
-    connect( m_sequenceWorkflow.get(), &SequenceWorkflow::clipLinked, this, &MainWorkflow::clipLinked );
-    connect( m_sequenceWorkflow.get(), &SequenceWorkflow::clipUnlinked, this, &MainWorkflow::clipUnlinked );
-    connect( m_sequenceWorkflow.get(), &SequenceWorkflow::clipMoved, this, &MainWorkflow::clipMoved );
-    connect( m_sequenceWorkflow.get(), &SequenceWorkflow::clipResized, this, &MainWorkflow::clipResized );
-    connect( m_sequenceWorkflow.get(), &SequenceWorkflow::transitionAdded, this, &MainWorkflow::transitionAdded );
-    connect( m_sequenceWorkflow.get(), &SequenceWorkflow::transitionMoved, this, &MainWorkflow::transitionMoved );
-    connect( m_sequenceWorkflow.get(), &SequenceWorkflow::transitionRemoved, this, &MainWorkflow::transitionRemoved );
+        m_sequenceWorkflow( new SequenceWorkflow( trackCount ) ),
+        m_preroller( new Preroller( *m_sequenceWorkflow ) )
+{
+    connectSequence();
     m_renderer->setInput( m_sequenceWorkflow->input() );
 
     connect( m_renderer->eventWatcher().data(), &RendererEventWatcher::lengthChanged, this, &MainWorkflow::lengthChanged );
@@ -79,6 +88,50 @@ MainWorkflow::MainWorkflow( Settings* projectSettings, int trackCount ) :
     {
         emit frameChanged( pos, m_sequenceWorkflow->input()->playableLength(), Vlmc::Renderer );
     }, Qt::DirectConnection );
+    // Scheduled from this thread, where the sequence is edited
+    connect( m_renderer->eventWatcher().data(), &RendererEventWatcher::positionChanged, this, [this]( qint64 pos )
+    {
+        m_preroller->setPlayhead( pos );
+    });
+
+    vlmcSettings->createVar( SettingValue::String, "vlmc/FFmpegPath", "ffmpeg",
+                             QT_TRANSLATE_NOOP( "Settings", "FFmpeg executable" ),
+                             QT_TRANSLATE_NOOP( "Settings", "Used to join the segments of incremental exports" ),
+                             SettingValue::Nothing );
+    auto undoLimit = vlmcSettings->createVar( SettingValue::Int, "vlmc/UndoLimit", 0,
+                             QT_TRANSLATE_NOOP( "Settings", "Undo history entries" ),
+                             QT_TRANSLATE_NOOP( "Settings", "The number of actions kept in the undo history, 0 for no limit" ),
+                             SettingValue::Nothing );
+#ifdef HAVE_GUI
+    // QUndoStack drops the oldest commands instead, and only accepts a limit while it's empty.
+    // It can't fold commands into checkpoints either, so it has no memory limit.
+    m_undoStack->setUndoLimit( undoLimit->get().toInt() );
+#else
+    auto undoMemoryLimit = vlmcSettings->createVar( SettingValue::Int, "vlmc/UndoMemoryLimit", 64,
+                             QT_TRANSLATE_NOOP( "Settings", "Undo history memory (MiB)" ),
+                             QT_TRANSLATE_NOOP( "Settings", "Above this estimate, the oldest actions of the undo history are compacted. 0 for no limit" ),
+                             SettingValue::Nothing );
+    m_undoStack->setSequence( m_sequenceWorkflow );
+    m_undoStack->setUndoLimit( undoLimit->get().toInt() );
+    m_undoStack->setMemoryLimit( undoMemoryLimit->get().toLongLong() * 1024 * 1024 );
+    connect( undoLimit, &SettingValue::changed, this, [this]( const QVariant& limit )
+    {
+        m_undoStack->setUndoLimit( limit.toInt() );
+    });
+    connect( undoMemoryLimit, &SettingValue::changed, this, [this]( const QVariant& limit )
+    {
+        m_undoStack->setMemoryLimit( limit.toLongLong() * 1024 * 1024 );
+    });
+#endif
+    auto prefetchMemory = vlmcSettings->createVar( SettingValue::Int, "vlmc/PrefetchMemory", 256,
+                             QT_TRANSLATE_NOOP( "Settings", "Preview prefetch memory (MiB)" ),
+                             QT_TRANSLATE_NOOP( "Settings", "Frames around the playhead are rendered ahead of stepping and seeking, within this memory. 0 to disable" ),
+                             SettingValue::Nothing );
+    m_renderer->setPrefetchMemory( prefetchMemory->get().toLongLong() * 1024 * 1024 );
+    connect( prefetchMemory, &SettingValue::changed, this, [this]( const QVariant& memory )
+    {
+        m_renderer->setPrefetchMemory( memory.toLongLong() * 1024 * 1024 );
+    });
 
     m_settings->createVar( SettingValue::List, "tracks", QVariantList(), "", "", SettingValue::Nothing );
     connect( m_settings, &Settings::postLoad, this, &MainWorkflow::postLoad, Qt::DirectConnection );
@@ -86,6 +139,16 @@ MainWorkflow::MainWorkflow( Settings* projectSettings, int trackCount ) :
     projectSettings->addSettings( QStringLiteral( "Workspace" ), *m_settings );
 
     connect( m_undoStack.get(), &Commands::AbstractUndoStack::cleanChanged, this, &MainWorkflow::cleanChanged );
+    // The commands record their outcome in the sequence state themselves
+    connect( m_undoStack.get(), &Commands::AbstractUndoStack::indexChanged, this, [this]
+    {
+        m_renderer->inputEdited();
+    });
+    connect( this, &MainWorkflow::effectsUpdated, this, [this]( const QString& uuid )
+    {
+        m_sequenceWorkflow->updateFilters( QUuid( uuid ) );
+        m_renderer->inputEdited();
+    });
 }
 
 MainWorkflow::~MainWorkflow()
@@ -122,10 +185,69 @@ MainWorkflow::trigger( Commands::Generic* command )
 void
 MainWorkflow::clear()
 {
+    m_gesture.reset();
+    // The history refers to the instances being dropped, let it release them as well
+    m_undoStack->clear();
+    // The sequence is rebuilt on new backend tracks: nothing may read from the previous ones
+    m_renderer->stop();
+    m_preroller->reset();
     m_sequenceWorkflow->clear();
+    m_clipUuids.clear();
+    m_transitionUuids.clear();
+    m_renderer->setInput( m_sequenceWorkflow->input() );
     emit cleared();
 }
 
+void
+MainWorkflow::connectSequence()
+{
+    auto sw = m_sequenceWorkflow.get();
+    auto clipUuid = [this]( SlotHandle handle )
+    {
+        return m_clipUuids.value( handle ).toString();
+    };
+    connect( sw, &SequenceWorkflow::clipAdded, this, [this, sw]( SlotHandle handle )
+    {
+        auto uuid = sw->clip( handle )->uuid;
+        m_clipUuids.insert( handle, uuid );
+        emit clipAdded( uuid.toString() );
+    } );
+    connect( sw, &SequenceWorkflow::clipRemoved, this, [this]( SlotHandle handle )
+    {
+        emit clipRemoved( m_clipUuids.take( handle ).toString() );
+    } );
+    connect( sw, &SequenceWorkflow::clipLinked, this, [this, clipUuid]( SlotHandle a, SlotHandle b )
+    {
+        emit clipLinked( clipUuid( a ), clipUuid( b ) );
+    } );
+    connect( sw, &SequenceWorkflow::clipUnlinked, this, [this, clipUuid]( SlotHandle a, SlotHandle b )
+    {
+        emit clipUnlinked( clipUuid( a ), clipUuid( b ) );
+    } );
+    connect( sw, &SequenceWorkflow::clipMoved, this, [this, clipUuid]( SlotHandle handle )
+    {
+        emit clipMoved( clipUuid( handle ) );
+    } );
+    connect( sw, &SequenceWorkflow::clipResized, this, [this, clipUuid]( SlotHandle handle )
+    {
+        emit clipResized( clipUuid( handle ) );
+    } );
+    connect( sw, &SequenceWorkflow::transitionAdded, this, [this, sw]( SlotHandle handle )
+    {
+        auto uuid = sw->transition( handle )->transition->uuid();
+        m_transitionUuids.insert( handle, uuid );
+        emit transitionAdded( uuid.toString() );
+    } );
+    connect( sw, &SequenceWorkflow::transitionMoved, this, [this]( SlotHandle handle )
+    {
+        emit transitionMoved( m_transitionUuids.value( handle ).toString() );
+    } );
+    connect( sw, &SequenceWorkflow::transitionRemoved, this, [this]( SlotHandle handle )
+    {
+        emit transitionRemoved( m_transitionUuids.take( handle ).toString() );
+    } );
+}
+
 void
 MainWorkflow::setClean()
 {
@@ -150,6 +272,14 @@ MainWorkflow::showEffectStack()
 {
 #ifdef HAVE_GUI
     auto w = new EffectStack( m_sequenceWorkflow->input() );
+    // The prefetched frames are outdated by any change, not only once the stack is closed
+    auto update = [this]
+    {
+        m_sequenceWorkflow->updateFilters( m_sequenceWorkflow->input() );
+        m_renderer->inputEdited();
+    };
+    connect( w, &EffectStack::edited, this, update );
+    connect( w, &EffectStack::finished, this, update );
     w->show();
 #endif
 }
@@ -159,6 +289,13 @@ MainWorkflow::showEffectStack( quint32 trackId )
 {
 #ifdef HAVE_GUI
     auto w = new EffectStack( m_sequenceWorkflow->trackInput( trackId ) );
+    auto update = [this, trackId]
+    {
+        m_sequenceWorkflow->updateFilters( m_sequenceWorkflow->trackInput( trackId ) );
+        m_renderer->inputEdited();
+    };
+    connect( w, &EffectStack::edited, this, update );
+    connect( w, &EffectStack::finished, this, update );
     w->show();
 #endif
 }
@@ -168,7 +305,9 @@ MainWorkflow::showEffectStack( const QString& uuid )
 {
 #ifdef HAVE_GUI
     auto w = new EffectStack( m_sequenceWorkflow->clip( uuid )->clip->input() );
-    connect( w, &EffectStack::finished, Core::instance()->workflow(), [uuid]{ emit Core::instance()->workflow()->effectsUpdated( uuid ); } );
+    auto update = [uuid]{ emit Core::instance()->workflow()->effectsUpdated( uuid ); };
+    connect( w, &EffectStack::edited, Core::instance()->workflow(), update );
+    connect( w, &EffectStack::finished, Core::instance()->workflow(), update );
     w->show();
 #endif
 }
@@ -257,15 +396,253 @@ MainWorkflow::transitionInfo( const QString& uuid )
     return QJsonObject::fromVariantHash( t->toVariant().toHash() );
 }
 
+static QJsonObject
+instanceToJson( const SequenceWorkflow::ClipInstance& c )
+{
+    return QJsonObject{
+        { "uuid", c.uuid.toString() },
+        { "clipUuid", c.clip->uuid().toString() },
+        { "trackId", static_cast<qint64>( c.trackId ) },
+        { "position", c.pos },
+        { "begin", c.clip->begin() },
+        { "end", c.clip->end() },
+        { "audio", c.isAudio },
+    };
+}
+
+static QJsonObject
+usageToJson( const QList<QSharedPointer<SequenceWorkflow::ClipInstance>>& instances )
+{
+    QJsonArray  list;
+    QList<QPair<qint64, qint64>>    ranges;
+    for ( const auto& c : instances )
+    {
+        list.append( instanceToJson( *c ) );
+        ranges << qMakePair( c->clip->begin(), c->clip->end() );
+    }
+    std::sort( ranges.begin(), ranges.end() );
+    QJsonArray  mergedRanges;
+    for ( int i = 0; i < ranges.size(); )
+    {
+        auto begin = ranges[i].first;
+        auto end = ranges[i].second;
+        for ( ++i; i < ranges.size() && ranges[i].first <= end + 1; ++i )
+            end = qMax( end, ranges[i].second );
+        mergedRanges.append( QJsonArray{ begin, end } );
+    }
+    return QJsonObject{
+        { "count", instances.size() },
+        { "instances", list },
+        { "ranges", mergedRanges },
+    };
+}
+
+QJsonObject
+MainWorkflow::clipUsage( const QString& uuid )
+{
+    return usageToJson( m_sequenceWorkflow->clipInstances( QUuid( uuid ) ) );
+}
+
+QJsonObject
+MainWorkflow::mediaUsage( qint64 mediaId )
+{
+    return usageToJson( m_sequenceWorkflow->mediaInstances( mediaId ) );
+}
+
+QJsonObject
+MainWorkflow::timelineRange( qint64 startFrame, qint64 endFrame, const QVariantList& trackIds )
+{
+    QVector<quint32> tracks;
+    for ( const auto& id : trackIds )
+        tracks << id.toUInt();
+
+    QJsonArray  clips;
+    for ( const auto& c : m_sequenceWorkflow->clipsInRange( startFrame, endFrame, tracks ) )
+    {
+        auto h = instanceToJson( *c );
+        QJsonArray linkedClips;
+        for ( const auto& uuid : c->linkedClips )
+            linkedClips.append( uuid.toString() );
+        h["linkedClips"] = linkedClips;
+        clips.append( h );
+    }
+    QJsonArray  transitions;
+    for ( const auto& t : m_sequenceWorkflow->transitionsInRange( startFrame, endFrame, tracks ) )
+        transitions.append( QJsonObject::fromVariantHash( t->toVariant().toHash() ) );
+    return QJsonObject{
+        { "startFrame", startFrame },
+        { "endFrame", endFrame },
+        { "clips", clips },
+        { "transitions", transitions },
+    };
+}
+
+QJsonObject
+MainWorkflow::undoStats() const
+{
+    QJsonArray commands;
+    for ( int i = 0; i < m_undoStack->count(); ++i )
+    {
+        commands.append( QJsonObject{
+            { "text", m_undoStack->text( i ) },
+            { "estimatedSize", m_undoStack->estimatedSize( i ) },
+        } );
+    }
+    return QJsonObject{
+        { "count", m_undoStack->count() },
+        { "index", m_undoStack->index() },
+        { "estimatedSize", m_undoStack->estimatedSize() },
+        { "commands", commands },
+    };
+}
+
+void
+MainWorkflow::beginGesture( const QStringList& clips, bool allowOverlaps )
+{
+    if ( m_gesture != nullptr )
+        vlmcWarning() << "A gesture is already in progress, merging them";
+    else
+        m_gesture.reset( new Commands::Clip::Gesture( m_sequenceWorkflow, allowOverlaps ) );
+    for ( const auto& uuid : clips )
+        m_gesture->add( QUuid( uuid ) );
+}
+
+void
+MainWorkflow::endGesture()
+{
+    if ( m_gesture == nullptr )
+        return;
+    auto gesture = m_gesture.release();
+    if ( gesture->isEmpty() == true )
+        delete gesture;
+    else
+        trigger( gesture );
+}
+
+void
+MainWorkflow::cancelGesture()
+{
+    m_gesture.reset();
+}
+
+bool
+MainWorkflow::isFree( const QUuid& uuid, bool isAudio, quint32 trackId, qint64 begin, qint64 end ) const
+{
+    if ( m_gesture != nullptr && m_gesture->allowsOverlaps() == true )
+        return true;
+    auto type = isAudio == true ? Workflow::AudioTrack : Workflow::VideoTrack;
+    for ( const auto& other : m_sequenceWorkflow->clipsInRange( begin, end, { trackId }, type ) )
+    {
+        if ( other->uuid == uuid )
+            continue;
+        if ( m_gesture != nullptr && m_gesture->contains( other->uuid ) == true )
+            continue;
+        return false;
+    }
+    return true;
+}
+
+bool
+MainWorkflow::canMoveClip( const QString& uuid, quint32 trackId, qint64 startFrame ) const
+{
+    auto c = m_sequenceWorkflow->clip( m_sequenceWorkflow->clipHandle( QUuid( uuid ) ) );
+    if ( c == nullptr || trackId >= m_trackCount || startFrame < 0 )
+        return false;
+    return isFree( c->uuid, c->isAudio, trackId, startFrame,
+                   startFrame + c->clip->end() - c->clip->begin() );
+}
+
+bool
+MainWorkflow::canResizeClip( const QString& uuid, qint64 newBegin, qint64 newEnd, qint64 newPos ) const
+{
+    auto c = m_sequenceWorkflow->clip( m_sequenceWorkflow->clipHandle( QUuid( uuid ) ) );
+    if ( c == nullptr || newPos < 0 || newBegin < 0 || newBegin > newEnd )
+        return false;
+    auto length = c->clip->media()->input()->length();
+    if ( length > 0 && newEnd >= length )
+        return false;
+    return isFree( c->uuid, c->isAudio, c->trackId, newPos, newPos + newEnd - newBegin );
+}
+
+bool
+MainWorkflow::moveClips( const QStringList& uuids, qint32 trackOffset, qint64 posOffset )
+{
+    QVector<QUuid> clips;
+    for ( const auto& uuid : uuids )
+        clips << QUuid( uuid );
+    QVector<SequenceWorkflow::ClipEdit> edits;
+    if ( m_sequenceWorkflow->planGroupMove( clips, trackOffset, posOffset, edits ) == false )
+        return false;
+    trigger( new Commands::Clip::GroupEdit( m_sequenceWorkflow, tr( "Moving clip(s)", "", edits.count() ), edits ) );
+    return true;
+}
+
+bool
+MainWorkflow::rippleInsert( qint64 pos, qint64 length )
+{
+    QVector<SequenceWorkflow::ClipEdit> edits;
+    if ( m_sequenceWorkflow->planRippleInsert( pos, length, edits ) == false )
+        return false;
+    if ( edits.isEmpty() == false )
+        trigger( new Commands::Clip::GroupEdit( m_sequenceWorkflow, tr( "Inserting space" ), edits ) );
+    return true;
+}
+
+bool
+MainWorkflow::rippleDelete( qint64 begin, qint64 end )
+{
+    QVector<SequenceWorkflow::ClipEdit> edits;
+    QVector<QUuid>                      removed;
+    if ( m_sequenceWorkflow->planRippleDelete( begin, end, edits, removed ) == false )
+        return false;
+    if ( edits.isEmpty() == false || removed.isEmpty() == false )
+        trigger( new Commands::Clip::GroupEdit( m_sequenceWorkflow, tr( "Ripple delete" ), edits, removed ) );
+    return true;
+}
+
+bool
+MainWorkflow::rollEdit( const QString& leftUuid, const QString& rightUuid, qint64 offset )
+{
+    QVector<SequenceWorkflow::ClipEdit> edits;
+    if ( m_sequenceWorkflow->planRoll( QUuid( leftUuid ), QUuid( rightUuid ), offset, edits ) == false )
+        return false;
+    trigger( new Commands::Clip::GroupEdit( m_sequenceWorkflow, tr( "Rolling edit" ), edits ) );
+    return true;
+}
+
+bool
+MainWorkflow::slipClip( const QString& uuid, qint64 offset )
+{
+    QVector<SequenceWorkflow::ClipEdit> edits;
+    if ( m_sequenceWorkflow->planSlip( QUuid( uuid ), offset, edits ) == false )
+        return false;
+    trigger( new Commands::Clip::GroupEdit( m_sequenceWorkflow, tr( "Slipping clip" ), edits ) );
+    return true;
+}
+
 void
 MainWorkflow::moveClip( const QString& uuid, quint32 trackId, qint64 startFrame )
 {
+    if ( m_gesture != nullptr )
+    {
+        if ( canMoveClip( uuid, trackId, startFrame ) == false ||
+             m_gesture->move( QUuid( uuid ), trackId, startFrame ) == false )
+            vlmcWarning() << "Ignoring invalid move of" << uuid;
+        return;
+    }
     trigger( new Commands::Clip::Move( m_sequenceWorkflow, uuid, trackId, startFrame ) );
 }
 
 void
 MainWorkflow::resizeClip( const QString& uuid, qint64 newBegin, qint64 newEnd, qint64 newPos )
 {
+    if ( m_gesture != nullptr )
+    {
+        if ( canResizeClip( uuid, newBegin, newEnd, newPos ) == false ||
+             m_gesture->resize( QUuid( uuid ), newBegin, newEnd, newPos ) == false )
+            vlmcWarning() << "Ignoring invalid resize of" << uuid;
+        return;
+    }
     trigger( new Commands::Clip::Resize( m_sequenceWorkflow, uuid, newBegin, newEnd, newPos ) );
 }
 
@@ -310,7 +687,7 @@ MainWorkflow::addEffect( const QString &clipUuid, const QString &effectId )
     auto clip = m_sequenceWorkflow->clip( clipUuid );
     if ( clip && clip->clip->input() )
     {
-        trigger( new Commands::Effect::Add( newEffect, clip->clip->input() ) );
+        trigger( new Commands::Effect::Add( m_sequenceWorkflow, newEffect, clip->clip->input() ) );
         emit effectsUpdated( clipUuid );
         return newEffect->uuid().toString();
     }
@@ -340,6 +717,12 @@ MainWorkflow::addTransitionBetweenTracks( const QString& identifier, qint64 begi
 void
 MainWorkflow::moveTransition( const QUuid& uuid, qint64 begin, qint64 end )
 {
+    if ( m_gesture != nullptr )
+    {
+        if ( m_gesture->moveTransition( uuid, begin, end ) == false )
+            vlmcWarning() << "Ignoring invalid move of transition" << uuid;
+        return;
+    }
     trigger( new Commands::Transition::Move( m_sequenceWorkflow, uuid, begin, end ) );
 }
 
@@ -355,61 +738,298 @@ MainWorkflow::removeTransition( const QUuid& uuid )
     trigger( new Commands::Transition::Remove( m_sequenceWorkflow, uuid ) );
 }
 
+/*
+ * The background analysis of a media's loudness, or an empty map if it isn't done yet.
+ */
+static QVariantMap
+loudnessMeasures( const Media& media )
+{
+    auto measures = Core::instance()->library()->loudness( media.id() );
+    if ( measures.isEmpty() == true )
+        measures = Core::instance()->analysisScheduler()->result( media.mrl(), AnalysisScheduler::Loudness ).toMap();
+    return measures;
+}
+
+/*
+ * The gain bringing a media to the target loudness, from its measures.
+ * It is lowered if needed, so that the media's peaks stay under the ceiling.
+ */
+static double
+loudnessGain( const Media& media, double target )
+{
+    auto measures = loudnessMeasures( media );
+    // A silent media has no integrated loudness
+    if ( measures.contains( "integrated" ) == false )
+        return .0;
+    auto gain = target - measures["integrated"].toDouble();
+    if ( measures.contains( "truePeak" ) == true )
+        gain = qMin( gain, TruePeakCeiling - measures["truePeak"].toDouble() );
+    return gain;
+}
+
+QList<qint64>
+MainWorkflow::unmeasuredLoudness() const
+{
+    QList<qint64>   res;
+    auto length = m_sequenceWorkflow->input()->playableLength();
+    for ( const auto& c : m_sequenceWorkflow->clipsInRange( 0, length, {}, Workflow::AudioTrack ) )
+    {
+        auto media = c->clip->media();
+        if ( res.contains( media->id() ) == true || media->input()->hasAudio() == false ||
+             loudnessMeasures( *media ).isEmpty() == false )
+            continue;
+        res << media->id();
+    }
+    return res;
+}
+
+QList<qint64>
+MainWorkflow::scheduleLoudnessMeasures()
+{
+    auto unmeasured = unmeasuredLoudness();
+    for ( auto mediaId : unmeasured )
+    {
+        auto media = Core::instance()->library()->media( mediaId );
+        Core::instance()->analysisScheduler()->enqueue( mediaId, media->mrl(),
+                                                        AnalysisScheduler::Loudness, AnalysisScheduler::Visible );
+    }
+    return unmeasured;
+}
+
 bool
 MainWorkflow::startRenderToFile( const QString &outputFileName, quint32 width, quint32 height,
                                  double fps, const QString &ar, quint32 vbitrate, quint32 abitrate,
-                                 quint32 nbChannels, quint32 sampleRate )
+                                 quint32 nbChannels, quint32 sampleRate, double loudnessTarget )
 {
-    m_renderer->stop();
+    RenderSettings  settings;
+    settings.outputFileName = outputFileName;
+    settings.width = width;
+    settings.height = height;
+    settings.fps = fps;
+    settings.aspectRatio = ar;
+    settings.videoBitrate = vbitrate;
+    settings.audioBitrate = abitrate;
+    settings.nbChannels = nbChannels;
+    settings.sampleRate = sampleRate;
+    settings.loudnessTarget = loudnessTarget;
+    return startRenderToFiles( { settings } );
+}
 
-    if ( canRender() == false )
+bool
+MainWorkflow::startRenderToFiles( const QList<RenderSettings>& renditions )
+{
+    if ( canRender() == false || renditions.isEmpty() == true )
         return false;
+    for ( const auto& r : renditions )
+    {
+        if ( r.isValid() == false )
+        {
+            vlmcWarning() << "Invalid render settings for" << r.outputFileName;
+            return false;
+        }
+    }
 
-    Backend::MLT::MLTFFmpegOutput output;
-    auto input = m_sequenceWorkflow->input();
-    OutputEventWatcher            cEventWatcher;
-    output.setCallback( &cEventWatcher );
-    output.setTarget( qPrintable( outputFileName ) );
-    output.setWidth( width );
-    output.setHeight( height );
-    output.setFrameRate( fps * 100, 100 );
-    auto temp = ar.split( "/" );
-    output.setAspectRatio( temp[0].toInt(), temp[1].toInt() );
-    output.setVideoBitrate( vbitrate );
-    output.setAudioBitrate( abitrate );
-    output.setChannels( nbChannels );
-    output.setAudioSampleRate( sampleRate );
-    output.connect( *input );
+    // Render a frozen copy, so that the timeline can still be edited & previewed meanwhile.
+    // The renditions share the composite, hence its audio levels. The gains come from the
+    // media analysis, which saves a measuring pass over the whole export.
+    auto loudnessTarget = renditions.first().loudnessTarget;
+    std::function<double( const Media& )> gain;
+    if ( loudnessTarget != .0 )
+    {
+        // Exporting now would leave these media at their own level
+        auto unmeasured = scheduleLoudnessMeasures();
+        if ( unmeasured.isEmpty() == false )
+        {
+            vlmcWarning() << "Can't normalize the export yet, the loudness of" << unmeasured.size()
+                          << "media is being measured";
+            return false;
+        }
+        gain = [loudnessTarget]( const Media& media ) {
+            return loudnessGain( media, loudnessTarget );
+        };
+    }
+    auto sequence = m_sequenceWorkflow->snapshot( renditions.first().useOptimizedMedia, gain );
+    if ( sequence.isValid() == false )
+        return false;
+    auto job = new ExportJob( sequence, renditions, this );
+    connect( job, &ExportJob::finished, job, &ExportJob::deleteLater );
+    connect( job, &ExportJob::finished, this, [this, job]( bool success )
+    {
+        emit exportFinished( job->renditions().first().outputFileName, success );
+    });
 
 #ifdef HAVE_GUI
-    WorkflowFileRendererDialog  dialog( width, height );
-    dialog.setModal( true );
-    dialog.setOutputFileName( outputFileName );
-    connect( this, &MainWorkflow::frameChanged, &dialog, &WorkflowFileRendererDialog::frameChanged );
-    connect( &dialog, &WorkflowFileRendererDialog::stop, this, [&output]{ output.stop(); } );
-    connect( m_renderer->eventWatcher().data(), &RendererEventWatcher::positionChanged, &dialog,
-             [this, input, &dialog, width, height]( qint64 pos )
+    const auto& preview = renditions.first();
+    auto width = preview.width;
+    auto height = preview.height;
+    auto dialog = new WorkflowFileRendererDialog( width, height );
+    dialog->setAttribute( Qt::WA_DeleteOnClose );
+    dialog->setModal( false );
+    dialog->setOutputFileName( preview.outputFileName );
+    job->setPreviewEnabled( true );
+    connect( job, &ExportJob::progress, dialog, [job, dialog, width, height]( qint64 pos, qint64 length )
     {
+        dialog->frameChanged( pos, length );
         // Update the preview per five seconds
-        if ( pos % qRound( input->fps() * 5 ) == 0 )
+        auto preview = job->preview();
+        if ( preview != nullptr && pos % qRound( preview->fps() * 5 ) == 0 )
         {
-            dialog.updatePreview( input->image( width, height ) );
+            preview->setPosition( pos );
+            dialog->updatePreview( preview->image( width, height ) );
         }
     });
-    connect( &cEventWatcher, &OutputEventWatcher::stopped, &dialog, &WorkflowFileRendererDialog::accept );
+    // Closing the dialog leaves the export running, only cancelling stops it
+    connect( dialog, &WorkflowFileRendererDialog::stop, job, &ExportJob::stop );
+    connect( job, &ExportJob::finished, dialog, &WorkflowFileRendererDialog::close );
+    if ( job->start() == false )
+    {
+        delete dialog;
+        delete job;
+        return false;
+    }
+    dialog->show();
+    return true;
+#else
+    return waitForExport( *job, renditions.first(), [job]
+    {
+        if ( job->start() == true )
+            return true;
+        job->deleteLater();
+        return false;
+    });
 #endif
+}
 
-    input->setPosition( 0 );
-    output.start();
+QString
+MainWorkflow::segmentCacheDirectory( const RenderSettings& settings ) const
+{
+    if ( settings.isStreaming() == true )
+    {
+        vlmcWarning() << "Streamed outputs can't be rendered as segments:" << settings.outputFileName;
+        return QString();
+    }
+    // One cache per destination, so that exporting elsewhere doesn't evict it
+    auto key = QCryptographicHash::hash( QFileInfo( settings.outputFileName ).absoluteFilePath().toUtf8(),
+                                         QCryptographicHash::Sha1 ).toHex();
+    auto cacheDir = Core::instance()->workspace()->cacheDirectory( QStringLiteral( "render/" ) + key );
+    if ( cacheDir.isEmpty() == true )
+        vlmcWarning() << "Segmented exports require a workspace";
+    return cacheDir;
+}
 
+template <typename T>
+bool
+MainWorkflow::waitForExport( T& job, const RenderSettings& settings, const std::function<bool()>& start )
+{
+    bool success = false;
 #ifdef HAVE_GUI
+    WorkflowFileRendererDialog  dialog( settings.width, settings.height );
+    dialog.setModal( true );
+    dialog.setOutputFileName( settings.outputFileName );
+    connect( &job, &T::progress, &dialog, &WorkflowFileRendererDialog::frameChanged );
+    connect( &dialog, &WorkflowFileRendererDialog::stop, &job, &T::stop );
+    connect( &job, &T::finished, &dialog, [&dialog, &success]( bool res )
+    {
+        success = res;
+        dialog.accept();
+    });
+    if ( start() == false )
+        return false;
     if ( dialog.exec() == QDialog::Rejected )
         return false;
 #else
-    while ( output.isStopped() == false )
-        SleepS( 1 );
+    Q_UNUSED( settings );
+    QEventLoop  loop;
+    connect( &job, &T::progress, this, [this]( qint64 frame, qint64 length )
+    {
+        emit frameChanged( frame, length, Vlmc::Renderer );
+    });
+    connect( &job, &T::finished, &loop, [&loop, &success]( bool res )
+    {
+        success = res;
+        loop.quit();
+    });
+    if ( start() == false )
+        return false;
+    loop.exec();
 #endif
-    return true;
+    return success;
+}
+
+bool
+MainWorkflow::startIncrementalRenderToFile( const RenderSettings& settings )
+{
+    m_renderer->stop();
+
+    if ( canRender() == false || settings.isValid() == false )
+        return false;
+    auto cacheDir = segmentCacheDirectory( settings );
+    if ( cacheDir.isEmpty() == true )
+        return false;
+
+    auto input = m_sequenceWorkflow->input();
+    SegmentedRenderer   renderer( settings, cacheDir );
+    renderer.plan( *m_sequenceWorkflow, input->playableLength(), qRound64( input->fps() * SegmentDuration ) );
+    vlmcDebug() << "Incremental export:" << renderer.pendingCount() << "out of"
+                << renderer.segments().size() << "segments need to be rendered";
+
+    return waitForExport( renderer, settings, [&renderer, input]
+    {
+        renderer.start( *input );
+        return true;
+    });
+}
+
+bool
+MainWorkflow::startDistributedRenderToFile( const RenderSettings& settings, quint32 localWorkers, quint16 port )
+{
+    m_renderer->stop();
+
+    if ( canRender() == false || settings.isValid() == false )
+        return false;
+    auto project = Core::instance()->project();
+    if ( project->hasProjectFile() == false || project->isClean() == false )
+    {
+        vlmcWarning() << "The project must be saved before being rendered by workers";
+        return false;
+    }
+    auto cacheDir = segmentCacheDirectory( settings );
+    if ( cacheDir.isEmpty() == true )
+        return false;
+
+    auto input = m_sequenceWorkflow->input();
+    SegmentedRenderer   renderer( settings, cacheDir );
+    renderer.plan( *m_sequenceWorkflow, input->playableLength(), qRound64( input->fps() * SegmentDuration ) );
+
+    RenderFarmCoordinator   coordinator( renderer, project->fileName() );
+    // Accepting remote workers is opt-in, and needs a shared token
+    if ( coordinator.listen( port, port != 0 ) == false )
+        return false;
+    coordinator.spawnLocalWorkers( localWorkers );
+    return waitForExport( coordinator, settings, [&coordinator]
+    {
+        coordinator.start();
+        return true;
+    });
+}
+
+void
+MainWorkflow::renderSegments( SegmentedRenderer& renderer, bool join )
+{
+    m_renderer->stop();
+    renderer.start( *m_sequenceWorkflow->input(), join );
+}
+
+SequenceState
+MainWorkflow::sequenceState() const
+{
+    return m_sequenceWorkflow->state();
+}
+
+SequenceWorkflow*
+MainWorkflow::sequenceWorkflow() const
+{
+    return m_sequenceWorkflow.get();
 }
 
 bool
@@ -421,7 +1041,8 @@ MainWorkflow::canRender()
 void
 MainWorkflow::preSave()
 {
-    m_settings->value( "tracks" )->set( m_sequenceWorkflow->toVariant() );
+    m_sequenceWorkflow->updateFilters();
+    m_settings->value( "tracks" )->set( m_sequenceWorkflow->state().toVariant() );
 }
 
 void
@@ -31,7 +31,9 @@
 
 #include "Types.h"
 #include <QJsonObject>
+#include <QStringList>
 
+#include <functional>
 #include <memory>
 
 class   Clip;
@@ -39,11 +41,19 @@ class   EffectsEngine;
 class   Effect;
 class   AbstractRenderer;
 class   SequenceWorkflow;
+class   SequenceState;
+struct  RenderSettings;
+class   SegmentedRenderer;
+class   Preroller;
 
 namespace Commands
 {
 class AbstractUndoStack;
 class Generic;
+namespace Clip
+{
+class Gesture;
+}
 }
 
 namespace Backend
@@ -54,6 +64,8 @@ class IInput;
 
 class   Settings;
 
+#include "Tools/SlotMap.hpp"
+
 #include <QObject>
 #include <QUuid>
 #include <QMap>
@@ -66,7 +78,7 @@ class   MainWorkflow : public QObject
     Q_OBJECT
 
     public:
-        MainWorkflow( Settings* projectSettings, int trackCount = 64 );
+        MainWorkflow( Settings* vlmcSettings, Settings* projectSettings, int trackCount = 64 );
         ~MainWorkflow();
 
         /**
@@ -131,6 +143,108 @@ class   MainWorkflow : public QObject
         Q_INVOKABLE
         QJsonObject             transitionInfo( const QString& uuid );
 
+        /**
+         *  \brief      Lists where a library clip is used on the timeline
+         *
+         *  \return     An object holding the instances "count", the "instances" themselves,
+         *              and the merged source frame "ranges" they use.
+         */
+        Q_INVOKABLE
+        QJsonObject             clipUsage( const QString& uuid );
+
+        /**
+         *  \brief      Lists where any clip of a media is used on the timeline
+         *  \sa         clipUsage
+         */
+        Q_INVOKABLE
+        QJsonObject             mediaUsage( qint64 mediaId );
+
+        /**
+         *  \brief      Lists what a timeline viewport shows, so that clients can page as they scroll
+         *
+         *  \param      trackIds    The tracks to look at, every track if empty
+         *  \return     An object holding the "clips" and "transitions" overlapping
+         *              [startFrame, endFrame], each ordered by position then track.
+         */
+        Q_INVOKABLE
+        QJsonObject             timelineRange( qint64 startFrame, qint64 endFrame,
+                                               const QVariantList& trackIds = QVariantList() );
+
+        /**
+         *  \brief      Describes the undo history, for monitoring its memory use
+         *
+         *  \return     An object holding the "count" of entries, the current "index",
+         *              the "estimatedSize" of the whole history in bytes, and every
+         *              "commands" with its "text" and "estimatedSize".
+         */
+        Q_INVOKABLE
+        QJsonObject             undoStats() const;
+
+        /**
+         *  \brief     Starts an interactive edit, ie. a drag of the selected clips.
+         *
+         *  Until endGesture() is called, moveClip(), resizeClip() and moveTransition() only
+         *  record their target, after checking it against the sequence model. The backend
+         *  tracks are left untouched, and the final positions are then applied at once, as
+         *  a single undo entry.
+         *  \param     clips   The clips being dragged. They move along, so they are not
+         *                     checked against each other.
+         *  \param     allowOverlaps   Lets the clips overlap others, to create cross-dissolves
+         */
+        Q_INVOKABLE
+        void                    beginGesture( const QStringList& clips = QStringList(),
+                                              bool allowOverlaps = false );
+        Q_INVOKABLE
+        void                    endGesture();
+        /**
+         *  \brief     Drops the edits recorded since beginGesture()
+         */
+        Q_INVOKABLE
+        void                    cancelGesture();
+
+        /**
+         *  \brief     Checks a clip move against the sequence model, without applying it
+         *
+         *  The clip must not overlap another one on its new track, unless the current
+         *  gesture allows it, or the other clip is part of the gesture too.
+         */
+        Q_INVOKABLE
+        bool                    canMoveClip( const QString& uuid, quint32 trackId, qint64 startFrame ) const;
+        /**
+         *  \brief     Checks a clip resize against the sequence model, without applying it
+         */
+        Q_INVOKABLE
+        bool                    canResizeClip( const QString& uuid, qint64 newBegin,
+                                               qint64 newEnd, qint64 newPos ) const;
+
+        /**
+         *  \brief     Moves clips, and the clips linked to them, by the same offset
+         *  \return    false if one of the clips can't be moved there. Nothing is moved then.
+         */
+        Q_INVOKABLE
+        bool                    moveClips( const QStringList& uuids, qint32 trackOffset, qint64 posOffset );
+        /**
+         *  \brief     Shifts every clip starting at or after pos by length frames
+         */
+        Q_INVOKABLE
+        bool                    rippleInsert( qint64 pos, qint64 length );
+        /**
+         *  \brief     Removes everything within [begin, end], and shifts the following clips back
+         *  \return    false if a clip straddles one of the bounds
+         */
+        Q_INVOKABLE
+        bool                    rippleDelete( qint64 begin, qint64 end );
+        /**
+         *  \brief     Moves the cut between two adjacent clips by offset frames
+         */
+        Q_INVOKABLE
+        bool                    rollEdit( const QString& leftUuid, const QString& rightUuid, qint64 offset );
+        /**
+         *  \brief     Shifts the part of its media a clip shows by offset frames
+         */
+        Q_INVOKABLE
+        bool                    slipClip( const QString& uuid, qint64 offset );
+
         Q_INVOKABLE
         void                    moveClip( const QString& uuid, quint32 trackId, qint64 startFrame );
 
@@ -170,9 +284,83 @@ class   MainWorkflow : public QObject
         Q_INVOKABLE
         void                    removeTransition( const QUuid& uuid );
 
+        /**
+         *  \brief     Renders the timeline to a single file.
+         *  \param     loudnessTarget  The integrated loudness to normalize the audio clips to,
+         *                              in LUFS. 0 keeps their levels. The export fails while
+         *                              the loudness of a media isn't known, and schedules
+         *                              its measurement, see scheduleLoudnessMeasures()
+         *  \sa        RenderSettings::loudnessTarget
+         */
         bool                    startRenderToFile( const QString& outputFileName, quint32 width, quint32 height,
                                                    double fps, const QString& ar, quint32 vbitrate, quint32 abitrate,
-                                                   quint32 nbChannels, quint32 sampleRate );
+                                                   quint32 nbChannels, quint32 sampleRate, double loudnessTarget = .0 );
+
+        /**
+         *  \brief     Renders the timeline once and encodes it to several outputs.
+         *
+         *  Each frame is decoded and composited a single time, then handed to every
+         *  rendition, which scales and encodes it with its own settings.
+         *  The export runs from a snapshot of the timeline: with the GUI, this returns
+         *  as soon as it started and the timeline remains editable.
+         *  \param  renditions  The outputs to produce. The first one is previewed.
+         *  \sa     exportFinished
+         */
+        bool                    startRenderToFiles( const QList<RenderSettings>& renditions );
+        /**
+         *  \brief     Lists the media of the timeline whose loudness isn't measured yet.
+         *
+         *  Exports normalizing the loudness can only start once this is empty.
+         *  \sa        scheduleLoudnessMeasures()
+         */
+        QList<qint64>           unmeasuredLoudness() const;
+        /**
+         *  \brief     Schedules the measurement of the unmeasured media ahead of the other analyses.
+         *  \return    The media being measured, as listed by unmeasuredLoudness()
+         */
+        QList<qint64>           scheduleLoudnessMeasures();
+
+        /**
+         *  \brief     Renders the timeline as segments cached in the workspace.
+         *
+         *  Segments whose content didn't change since the previous export to the same
+         *  file are reused as is, then all segments are joined into the output file.
+         */
+        bool                    startIncrementalRenderToFile( const RenderSettings& settings );
+
+        /**
+         *  \brief     Renders the timeline segments using worker processes.
+         *
+         *  The project must be saved, as workers load it from its file.
+         *  \param  localWorkers    The number of worker processes to spawn on this host
+         *  \param  port            The port remote workers connect to. With 0, only the local
+         *                          workers are accepted, on any port.
+         *  \sa     RenderFarmCoordinator
+         */
+        bool                    startDistributedRenderToFile( const RenderSettings& settings,
+                                                              quint32 localWorkers, quint16 port = 0 );
+
+        /**
+         *  \brief     Renders the planned segments of renderer from the timeline
+         *
+         *  This returns immediately, see SegmentedRenderer::start
+         */
+        void                    renderSegments( SegmentedRenderer& renderer, bool join );
+
+        /**
+         *  \brief     Returns a consistent view of the timeline, in constant time.
+         *
+         *  The returned state is never modified, and can be handed to another thread,
+         *  ie. for autosaving or diffing, while the timeline is being edited.
+         */
+        SequenceState           sequenceState() const;
+
+        /**
+         *  \brief     Returns the sequence, to address its elements by handle from C++.
+         *
+         *  QML only knows the elements by UUID, through this class' signals.
+         */
+        SequenceWorkflow*       sequenceWorkflow() const;
 
         bool                    canRender();
 
@@ -187,6 +375,16 @@ class   MainWorkflow : public QObject
         void                    preSave();
         void                    postLoad();
 
+        QString                 segmentCacheDirectory( const RenderSettings& settings ) const;
+        // start returns false if the job couldn't start, finished() is never emitted then
+        template <typename T>
+        bool                    waitForExport( T& job, const RenderSettings& settings,
+                                               const std::function<bool()>& start );
+        void                    connectSequence();
+        // Whether a clip could occupy [begin, end] of a track, see canMoveClip()
+        bool                    isFree( const QUuid& uuid, bool isAudio, quint32 trackId,
+                                        qint64 begin, qint64 end ) const;
+
     private:
         const quint32                   m_trackCount;
 
@@ -196,13 +394,21 @@ class   MainWorkflow : public QObject
 
         std::unique_ptr<Commands::AbstractUndoStack> m_undoStack;
         std::shared_ptr<SequenceWorkflow>            m_sequenceWorkflow;
+        // Prepares the upcoming clips during the playback
+        std::unique_ptr<Preroller>                   m_preroller;
+        // The interactive edit in progress, if any
+        std::unique_ptr<Commands::Clip::Gesture>     m_gesture;
+        // What the sequence notifies by handle is given to QML by UUID. Removed elements
+        // don't resolve anymore, so their UUIDs are kept here until then.
+        QHash<SlotHandle, QUuid>        m_clipUuids;
+        QHash<SlotHandle, QUuid>        m_transitionUuids;
     public slots:
         /**
          *  \brief      Clear the workflow.
          *
-         *  Calling this method will cause every clip workflow to be deleted, along with
-         *  the associated Clip.
-         *  This method will emit cleared() signal once finished.
+         *  Calling this method drops every clip and transition of the sequence at once.
+         *  Their producers are released from a background thread, see BackgroundReleaser.
+         *  This method will emit cleared() signal once finished, and no per clip signal.
          *  \sa     reCip( const QUuid&, unsigned int, Workflow::TrackType )
          *  \sa     cleared()
          */
@@ -272,6 +478,13 @@ class   MainWorkflow : public QObject
         void                    transitionRemoved( const QString& uuid );
 
         void                    effectsUpdated( const QString& clipUuid );
+
+        /**
+         *  \brief  Emitted when a background export completes or is cancelled.
+         *
+         *  \param  outputFileName  The output of the first rendition
+         */
+        void                    exportFinished( const QString& outputFileName, bool success );
 };
 
 #endif // MAINWORKFLOW_H
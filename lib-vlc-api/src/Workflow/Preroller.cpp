@@ -0,0 +1,172 @@
+/*****************************************************************************
+ * Preroller.cpp: Warms the caches for the clips the playhead is about to reach
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "Preroller.h"
+
+#include "Backend/IBackend.h"
+#include "Backend/IInput.h"
+#include "Backend/IProfile.h"
+#include "Media/Clip.h"
+#include "Media/Media.h"
+#include "SequenceWorkflow.h"
+#include "Tools/ReaderPool.h"
+
+#include <QMutexLocker>
+
+#include <algorithm>
+#include <cmath>
+
+// How far ahead of the playhead clips are prerolled, in seconds
+static const double LookAhead = 3.0;
+// The consumer reads about a second ahead of what it shows: closer clips may be read already
+static const double MinimumLead = 1.5;
+// The largest step between two positions which is still a playback, in seconds
+static const double MaximumStep = 0.5;
+// The frames read at the beginning of each clip
+static const int64_t PrerollFrames = 3;
+
+Preroller::Preroller( SequenceWorkflow& sequence )
+    : m_sequence( sequence )
+    , m_playhead( -1 )
+    , m_busy( false )
+    , m_stop( false )
+{
+}
+
+Preroller::~Preroller()
+{
+    {
+        QMutexLocker    lock( &m_mutex );
+        m_stop = true;
+        m_queue.clear();
+        m_wakeUp.wakeAll();
+    }
+    wait();
+    m_done.clear();
+}
+
+void
+Preroller::setPlayhead( qint64 frame )
+{
+    auto fps = Backend::instance()->profile().fps();
+    auto step = frame - m_playhead;
+    m_playhead = frame;
+    if ( step <= 0 || step > std::ceil( fps * MaximumStep ) )
+    {
+        cancel();
+        return;
+    }
+
+    // Release the clips the playhead reached
+    for ( auto it = m_scheduled.begin(); it != m_scheduled.end(); )
+    {
+        if ( it.value() <= frame )
+            it = m_scheduled.erase( it );
+        else
+            ++it;
+    }
+    {
+        QMutexLocker    lock( &m_mutex );
+        m_done.clear();
+    }
+
+    auto first = frame + qRound64( fps * MinimumLead );
+    auto last = frame + qRound64( fps * LookAhead );
+    for ( const auto& c : m_sequence.clipsInRange( first, last ) )
+    {
+        if ( c->pos < first || m_scheduled.contains( c->handle ) == true )
+            continue;
+        // Its file is being read already
+        auto mediaId = c->clip->media()->id();
+        auto playing = m_sequence.clipsInRange( frame, c->pos - 1 );
+        auto sameMedia = std::any_of( playing.begin(), playing.end(),
+                                      [mediaId]( const QSharedPointer<SequenceWorkflow::ClipInstance>& p ) {
+            return p->clip->media()->id() == mediaId;
+        });
+        if ( sameMedia == true )
+            continue;
+        m_scheduled.insert( c->handle, c->pos );
+        enqueue( c->clip );
+    }
+}
+
+void
+Preroller::reset()
+{
+    cancel();
+    QMutexLocker    lock( &m_mutex );
+    while ( m_busy == true )
+        m_idle.wait( &m_mutex );
+    m_done.clear();
+}
+
+void
+Preroller::cancel()
+{
+    m_scheduled.clear();
+    QMutexLocker    lock( &m_mutex );
+    m_queue.clear();
+}
+
+void
+Preroller::enqueue( const QSharedPointer<Clip>& clip )
+{
+    QMutexLocker    lock( &m_mutex );
+    // The audio and video instances of a clip share its input
+    if ( std::find( m_queue.begin(), m_queue.end(), clip ) != m_queue.end() )
+        return;
+    m_queue.push_back( clip );
+    if ( isRunning() == false && m_stop == false )
+        start();
+    m_wakeUp.wakeAll();
+}
+
+void
+Preroller::run()
+{
+    QMutexLocker    lock( &m_mutex );
+    while ( m_stop == false )
+    {
+        if ( m_queue.empty() == true )
+        {
+            m_wakeUp.wait( &m_mutex );
+            continue;
+        }
+        auto clip = m_queue.front();
+        m_queue.pop_front();
+        m_busy = true;
+        lock.unlock();
+        // The clip's own producer is left to the consumer, which may be reading from it:
+        // only the caches it will read through get warmed
+        auto reader = ReaderPool::acquire( *clip->input() );
+        if ( reader != nullptr )
+            reader->warmCache( PrerollFrames );
+        lock.relock();
+        m_busy = false;
+        m_done.push_back( std::move( clip ) );
+        m_idle.wakeAll();
+    }
+}
@@ -0,0 +1,100 @@
+/*****************************************************************************
+ * Preroller.h: Warms the caches for the clips the playhead is about to reach
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef PREROLLER_H
+#define PREROLLER_H
+
+#include <QHash>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QThread>
+#include <QWaitCondition>
+
+#include <deque>
+#include <vector>
+
+#include "Tools/SlotMap.hpp"
+
+class   Clip;
+class   SequenceWorkflow;
+
+/**
+ *  \brief  Reads the beginning of the upcoming clips while the timeline plays.
+ *
+ *  The clips starting within the next few seconds are read by this thread's own
+ *  readers, see ReaderPool and Backend::IInput::warmCache, so that their data at the
+ *  in point is in the system or network caches when the playback reaches them. This
+ *  only hides the I/O latency, ie. of slow disks or remote media: the consumer still
+ *  opens, seeks and primes the clip's own decoder at the cut, which this thread can't
+ *  touch while the playlist may be reading from it.
+ *
+ *  A clip is prerolled once, and released when the playhead reaches it or jumps
+ *  elsewhere. Clips of a media which is being played are left alone, as its data
+ *  is being read already.
+ */
+class   Preroller : public QThread
+{
+    public:
+        explicit Preroller( SequenceWorkflow& sequence );
+        /**
+         *  Waits for the clip being prerolled, the pending ones are dropped.
+         */
+        ~Preroller();
+
+        /**
+         *  \brief  Schedules the clips ahead of the playhead.
+         *
+         *  This must be called from the thread editing the sequence. Any move but
+         *  a few frames forward is a seek or a pause, which cancels the pending clips.
+         */
+        void                setPlayhead( qint64 frame );
+        /**
+         *  \brief  Drops the pending clips, and waits for the current one.
+         *
+         *  The backend tracks must not be replaced while a clip is being prerolled.
+         */
+        void                reset();
+
+    protected:
+        void                run() override;
+
+    private:
+        void                enqueue( const QSharedPointer<Clip>& clip );
+        void                cancel();
+
+    private:
+        SequenceWorkflow&                       m_sequence;
+        qint64                                  m_playhead;
+        // The instances queued or prerolled ahead of the playhead, by position
+        QHash<SlotHandle, qint64>               m_scheduled;
+
+        QMutex                                  m_mutex;
+        QWaitCondition                          m_wakeUp;
+        QWaitCondition                          m_idle;
+        std::deque<QSharedPointer<Clip>>        m_queue;
+        // Handed back to be released from the sequence thread, as clips are QObjects
+        std::vector<QSharedPointer<Clip>>       m_done;
+        bool                                    m_busy;
+        bool                                    m_stop;
+};
+
+#endif // PREROLLER_H
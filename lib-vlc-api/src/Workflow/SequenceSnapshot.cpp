@@ -0,0 +1,161 @@
+/*****************************************************************************
+ * SequenceSnapshot.cpp: Frozen description of a sequence, to render it apart
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "SequenceSnapshot.h"
+
+#include "Backend/MLT/MLTInput.h"
+#include "Backend/IBackend.h"
+#include "Library/AnalysisScheduler.h"
+#include "Tools/VlmcDebug.h"
+
+#include <QFileInfo>
+#include <QStringList>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+
+SequenceSnapshot::SequenceSnapshot()
+    : m_length( 0 )
+{
+}
+
+SequenceSnapshot::SequenceSnapshot( const std::string& description, qint64 length )
+    : m_description( QByteArray::fromStdString( description ) )
+    , m_length( length )
+{
+}
+
+bool
+SequenceSnapshot::isValid() const
+{
+    return m_description.isEmpty() == false;
+}
+
+qint64
+SequenceSnapshot::length() const
+{
+    return m_length;
+}
+
+void
+SequenceSnapshot::setResource( const QString& mrl, const QString& file )
+{
+    m_resources[normalize( mrl )] = file;
+}
+
+void
+SequenceSnapshot::setAudioGain( const QString& mrl, double gain )
+{
+    m_gains[normalize( mrl )] = gain;
+}
+
+std::unique_ptr<Backend::IInput>
+SequenceSnapshot::open() const
+{
+    if ( isValid() == false )
+        return nullptr;
+    try
+    {
+        auto description = m_resources.isEmpty() == true && m_gains.isEmpty() == true ?
+                    m_description : rewrite();
+        return Backend::MLT::MLTInput::deserialize( description.toStdString() );
+    }
+    catch ( Backend::InvalidServiceException& )
+    {
+        vlmcWarning() << "Couldn't open a copy of the sequence";
+        return nullptr;
+    }
+}
+
+QString
+SequenceSnapshot::normalize( const QString& mrl )
+{
+    return QFileInfo( AnalysisScheduler::localFile( mrl ) ).absoluteFilePath();
+}
+
+QByteArray
+SequenceSnapshot::rewrite() const
+{
+    // Media are described once each, by a top level producer whose properties come first:
+    // <producer><property name="resource">...</property>...<filter>...</filter></producer>
+    QByteArray res;
+    QXmlStreamReader reader( m_description );
+    QXmlStreamWriter writer( &res );
+    QStringList elements;
+    QString resource;
+    int nbGains = 0;
+    while ( reader.atEnd() == false )
+    {
+        auto token = reader.readNext();
+        if ( token == QXmlStreamReader::StartElement )
+        {
+            auto isProducerProperty = elements.isEmpty() == false && elements.last() == "producer";
+            elements << reader.name().toString();
+            if ( elements.last() == "producer" )
+                resource.clear();
+            if ( isProducerProperty == true && elements.last() == "property" &&
+                 reader.attributes().value( "name" ) == "resource" )
+            {
+                writer.writeCurrentToken( reader );
+                resource = reader.readElementText();
+                elements.removeLast();
+                auto it = m_resources.find( normalize( resource ) );
+                writer.writeCharacters( it != m_resources.end() ? it.value() : resource );
+                writer.writeEndElement();
+                continue;
+            }
+        }
+        else if ( token == QXmlStreamReader::EndElement )
+        {
+            if ( elements.last() == "producer" && resource.isEmpty() == false )
+            {
+                // The resource may have been substituted already, the gains are keyed on the original
+                auto it = m_gains.find( normalize( resource ) );
+                if ( it != m_gains.end() )
+                {
+                    writer.writeStartElement( "filter" );
+                    writer.writeAttribute( "id", QStringLiteral( "vlmc_gain%1" ).arg( nbGains++ ) );
+                    writer.writeStartElement( "property" );
+                    writer.writeAttribute( "name", "mlt_service" );
+                    writer.writeCharacters( "volume" );
+                    writer.writeEndElement();
+                    writer.writeStartElement( "property" );
+                    writer.writeAttribute( "name", "level" );
+                    writer.writeCharacters( QString::number( it.value() ) );
+                    writer.writeEndElement();
+                    writer.writeEndElement();
+                }
+            }
+            elements.removeLast();
+        }
+        writer.writeCurrentToken( reader );
+    }
+    if ( reader.hasError() == true )
+    {
+        vlmcWarning() << "Couldn't rewrite the sequence description:" << reader.errorString();
+        return m_description;
+    }
+    return res;
+}
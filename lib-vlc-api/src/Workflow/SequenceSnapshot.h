@@ -0,0 +1,85 @@
+/*****************************************************************************
+ * SequenceSnapshot.h: Frozen description of a sequence, to render it apart
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef SEQUENCESNAPSHOT_H
+#define SEQUENCESNAPSHOT_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+
+#include <memory>
+
+namespace Backend
+{
+class IInput;
+}
+
+/**
+ *  \brief  A frozen description of a sequence backend graph, suitable for rendering.
+ *
+ *  Taking a snapshot only serializes the graph, which opens nothing and stays cheap
+ *  on large timelines. The copy is opened afterward, from any thread, so that an
+ *  export doesn't block the editor while it opens the decoders of each clip.
+ *  The media can be read from other files, ie. their optimized copies, and their
+ *  audio can be amplified, both at the media level.
+ *  \sa     SequenceWorkflow::snapshot
+ */
+class   SequenceSnapshot
+{
+    public:
+        SequenceSnapshot();
+        SequenceSnapshot( const std::string& description, qint64 length );
+
+        bool                    isValid() const;
+        // The playable length of the sequence, in frames
+        qint64                  length() const;
+
+        /**
+         * @brief setResource   Reads a media from another file in the copy
+         */
+        void                    setResource( const QString& mrl, const QString& file );
+        /**
+         * @brief setAudioGain  Amplifies the audio of a media in the copy, in dB
+         */
+        void                    setAudioGain( const QString& mrl, double gain );
+
+        /**
+         * @brief open  Opens an independent copy of the sequence. This opens every media
+         *              it uses, so it takes a while on large timelines. This is thread safe.
+         * @return  nullptr if the copy couldn't be opened
+         */
+        std::unique_ptr<Backend::IInput>    open() const;
+
+    private:
+        // The local, absolute path of a media location, to match the described ones
+        static QString          normalize( const QString& mrl );
+        QByteArray              rewrite() const;
+
+    private:
+        QByteArray              m_description;
+        qint64                  m_length;
+        QHash<QString, QString> m_resources;
+        QHash<QString, double>  m_gains;
+};
+
+#endif // SEQUENCESNAPSHOT_H
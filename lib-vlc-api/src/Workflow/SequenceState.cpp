@@ -0,0 +1,156 @@
+/*****************************************************************************
+ * SequenceState.cpp: Implicitly shared snapshot of a sequence
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "SequenceState.h"
+
+SequenceState::SequenceState()
+    : m_filters( QVariantList() )
+    , m_revision( 0 )
+{
+}
+
+quint64
+SequenceState::revision() const
+{
+    return m_revision;
+}
+
+const QMap<QUuid, QSharedPointer<const SequenceState::Clip>>&
+SequenceState::clips() const
+{
+    return m_clips;
+}
+
+const QMap<QUuid, QSharedPointer<const SequenceState::Transition>>&
+SequenceState::transitions() const
+{
+    return m_transitions;
+}
+
+QSharedPointer<const SequenceState::Clip>
+SequenceState::clip( const QUuid& uuid ) const
+{
+    return m_clips.value( uuid );
+}
+
+QSharedPointer<const SequenceState::Transition>
+SequenceState::transition( const QUuid& uuid ) const
+{
+    return m_transitions.value( uuid );
+}
+
+QVariant
+SequenceState::trackFilters( quint32 trackId ) const
+{
+    if ( trackId >= static_cast<quint32>( m_trackFilters.size() ) )
+        return QVariantList();
+    return m_trackFilters[trackId];
+}
+
+QVariant
+SequenceState::filters() const
+{
+    return m_filters;
+}
+
+QVariant
+SequenceState::toVariant() const
+{
+    QVariantList transitions;
+    for ( const auto& t : m_transitions )
+    {
+        QVariantHash h = {
+            { "uuid", t->uuid.toString() },
+            { "begin", t->begin },
+            { "end", t->end },
+            { "length", t->end - t->begin + 1 },
+            { "audio", t->isAudio },
+            { "identifier", t->identifier },
+            { "isInTrack", t->isInTrack },
+        };
+        if ( t->isInTrack == true )
+            h["trackId"] = t->trackAId;
+        else
+        {
+            h["trackAId"] = t->trackAId;
+            h["trackBId"] = t->trackBId;
+        }
+        transitions << h;
+    }
+
+    QVariantList l;
+    for ( const auto& c : m_clips )
+    {
+        QVariantList linkedClipList;
+        for ( const auto& uuid : c->linkedClips )
+            linkedClipList.append( uuid.toString() );
+        QVariantHash h = {
+            { "uuid", c->uuid.toString() },
+            { "clipUuid", c->clipUuid.toString() },
+            { "position", c->pos },
+            { "trackId", c->trackId },
+            { "filters", c->filters },
+            { "isAudio", c->isAudio },
+            { "linkedClips", linkedClipList },
+        };
+        l << h;
+    }
+    QVariantHash h{ { "transitions", transitions }, { "clips", l },
+                    { "filters", m_filters } };
+    return h;
+}
+
+template <typename T>
+static QList<QUuid>
+changedRecords( const QMap<QUuid, QSharedPointer<const T>>& current,
+                const QMap<QUuid, QSharedPointer<const T>>& previous )
+{
+    QList<QUuid> res;
+    // Unchanged records are shared, comparing pointers is enough
+    for ( auto it = current.begin(); it != current.end(); ++it )
+    {
+        if ( previous.value( it.key() ) != it.value() )
+            res << it.key();
+    }
+    for ( auto it = previous.begin(); it != previous.end(); ++it )
+    {
+        if ( current.contains( it.key() ) == false )
+            res << it.key();
+    }
+    return res;
+}
+
+QList<QUuid>
+SequenceState::changedClips( const SequenceState& previous ) const
+{
+    return changedRecords( m_clips, previous.m_clips );
+}
+
+QList<QUuid>
+SequenceState::changedTransitions( const SequenceState& previous ) const
+{
+    return changedRecords( m_transitions, previous.m_transitions );
+}
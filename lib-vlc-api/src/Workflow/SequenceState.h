@@ -0,0 +1,110 @@
+/*****************************************************************************
+ * SequenceState.h: Implicitly shared snapshot of a sequence
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef SEQUENCESTATE_H
+#define SEQUENCESTATE_H
+
+#include <QList>
+#include <QMap>
+#include <QSharedPointer>
+#include <QUuid>
+#include <QVariant>
+#include <QVector>
+
+/**
+ *  \brief  An immutable view of a SequenceWorkflow.
+ *
+ *  Copying a state is O(1): the containers are implicitly shared, and each clip
+ *  and transition is a shared, never modified record. When the sequence changes,
+ *  only the records of the modified elements are replaced, so two successive
+ *  states share every record which didn't change, and can be diffed by comparing
+ *  record pointers.
+ *  A copy can be read from any thread while the sequence keeps being edited.
+ *  \sa     SequenceWorkflow::state
+ */
+class   SequenceState
+{
+    public:
+        struct Clip
+        {
+            QUuid           uuid;
+            // The library clip this instance uses
+            QUuid           clipUuid;
+            QString         mrl;
+            qint64          begin;
+            qint64          end;
+            quint32         trackId;
+            qint64          pos;
+            bool            isAudio;
+            QVector<QUuid>  linkedClips;
+            QVariant        filters;
+        };
+
+        struct Transition
+        {
+            QUuid           uuid;
+            QString         identifier;
+            qint64          begin;
+            qint64          end;
+            quint32         trackAId;
+            quint32         trackBId;
+            bool            isInTrack;
+            bool            isAudio;
+        };
+
+        SequenceState();
+
+        /**
+         * @brief revision  Increases with each modification of the sequence
+         */
+        quint64                     revision() const;
+
+        const QMap<QUuid, QSharedPointer<const Clip>>&          clips() const;
+        const QMap<QUuid, QSharedPointer<const Transition>>&    transitions() const;
+        QSharedPointer<const Clip>                  clip( const QUuid& uuid ) const;
+        QSharedPointer<const Transition>            transition( const QUuid& uuid ) const;
+        QVariant                    trackFilters( quint32 trackId ) const;
+        QVariant                    filters() const;
+
+        /**
+         * @brief toVariant Serializes the state as SequenceWorkflow::toVariant does
+         */
+        QVariant                    toVariant() const;
+
+        /**
+         * @brief changedClips  Lists the clip instances added, removed or modified since previous
+         */
+        QList<QUuid>                changedClips( const SequenceState& previous ) const;
+        QList<QUuid>                changedTransitions( const SequenceState& previous ) const;
+
+    private:
+        QMap<QUuid, QSharedPointer<const Clip>>         m_clips;
+        QMap<QUuid, QSharedPointer<const Transition>>   m_transitions;
+        QVector<QVariant>                               m_trackFilters;
+        QVariant                                        m_filters;
+        quint64                                         m_revision;
+
+        // Only the sequence modifies its state
+        friend class SequenceWorkflow;
+};
+
+#endif // SEQUENCESTATE_H
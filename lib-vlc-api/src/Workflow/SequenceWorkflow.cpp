@@ -33,15 +33,33 @@
 #include "Workflow/MainWorkflow.h"
 #include "Main/Core.h"
 #include "Library/Library.h"
+#include "Tools/BackgroundReleaser.h"
 #include "Tools/VlmcDebug.h"
 #include "Media/Media.h"
 #include "Transition/Transition.h"
 
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QUrl>
+
 SequenceWorkflow::SequenceWorkflow( size_t trackCount )
-    : m_multitrack( new Backend::MLT::MLTMultiTrack )
-    , m_trackCount( trackCount )
+    : m_trackCount( trackCount )
+{
+    createTracks();
+    m_state.m_trackFilters.fill( QVariantList(), static_cast<int>( trackCount ) );
+}
+
+SequenceWorkflow::~SequenceWorkflow()
+{
+}
+
+void
+SequenceWorkflow::createTracks()
 {
-    for ( int i = 0; i < trackCount; ++i )
+    m_multitrack.reset( new Backend::MLT::MLTMultiTrack );
+    for ( int i = 0; i < m_trackCount; ++i )
     {
         auto audioTrack = QSharedPointer<Track>( new Track( Workflow::AudioTrack ) );
         m_tracks[Workflow::AudioTrack] <<  audioTrack;
@@ -59,10 +77,6 @@ SequenceWorkflow::SequenceWorkflow( size_t trackCount )
     }
 }
 
-SequenceWorkflow::~SequenceWorkflow()
-{
-}
-
 QUuid
 SequenceWorkflow::addClip( QSharedPointer<::Clip> clip, quint32 trackId, qint64 pos, const QUuid& uuid, bool isAudioClip )
 {
@@ -74,22 +88,33 @@ SequenceWorkflow::addClip( QSharedPointer<::Clip> clip, quint32 trackId, qint64
     if ( ret == false )
         return {};
     vlmcDebug() << "adding" << (isAudioClip ? "audio" : "video") <<  "clip instance:" << c->uuid;
-    m_clips.insert( c->uuid, c ) ;
-    clip->setOnTimeline( true );
-    emit clipAdded( c->uuid.toString() );
+    c->handle = m_clips.insert( c );
+    m_clipHandles.insert( c->uuid, c->handle );
+    addUsage( *clip, c->handle );
+    updateState( c );
+    emit clipAdded( c->handle );
     return c->uuid;
 }
 
 bool
 SequenceWorkflow::moveClip( const QUuid& uuid, quint32 trackId, qint64 pos )
 {
-    auto it = m_clips.find( uuid );
-    if ( it == m_clips.end() )
+    auto handle = clipHandle( uuid );
+    if ( handle.isNull() == true )
     {
         vlmcCritical() << "Couldn't find a clip:" << uuid;
         return false;
     }
-    auto& c = it.value();
+    return moveClip( handle, trackId, pos );
+}
+
+bool
+SequenceWorkflow::moveClip( SlotHandle handle, quint32 trackId, qint64 pos )
+{
+    auto c = clip( handle );
+    if ( c == nullptr )
+        return false;
+    const auto& uuid = c->uuid;
     auto oldTrackId = c->trackId;
     auto oldPosition = c->pos;
     if ( oldPosition == pos && oldTrackId == trackId )
@@ -112,7 +137,8 @@ SequenceWorkflow::moveClip( const QUuid& uuid, quint32 trackId, qint64 pos )
             return false;
     }
     c->pos = pos;
-    emit clipMoved( uuid.toString() );
+    updateState( c );
+    emit clipMoved( handle );
     // CAUTION: You must not move a clip to a place where it would overlap another clip!
     return true;
 }
@@ -120,21 +146,33 @@ SequenceWorkflow::moveClip( const QUuid& uuid, quint32 trackId, qint64 pos )
 bool
 SequenceWorkflow::resizeClip( const QUuid& uuid, qint64 newBegin, qint64 newEnd, qint64 newPos )
 {
-    auto it = m_clips.find( uuid );
-    if ( it == m_clips.end() )
+    auto handle = clipHandle( uuid );
+    if ( handle.isNull() == true )
     {
         vlmcCritical() << "Couldn't find a clip:" << uuid;
         return false;
     }
-    auto& c = it.value();
+    return resizeClip( handle, newBegin, newEnd, newPos );
+}
+
+bool
+SequenceWorkflow::resizeClip( SlotHandle handle, qint64 newBegin, qint64 newEnd, qint64 newPos )
+{
+    auto c = clip( handle );
+    if ( c == nullptr )
+        return false;
+    const auto& uuid = c->uuid;
     auto trackId = c->trackId;
     auto position = c->pos;
     auto t = track( trackId, c->isAudio );
     bool ret;
+    auto previousClip = c->clip;
     // This will only duplicate the clip once; no need to panic about endless duplications
     if ( c->duplicateClipForResize( newBegin, newEnd ) == true )
     {
         vlmcDebug() << "Duplicating clip for resize" << c->uuid << "is now using" << c->clip->uuid();
+        removeUsage( *previousClip, c->handle );
+        addUsage( *c->clip, c->handle );
         t->removeClip( uuid );
         ret = t->addClip( c, position );
     }
@@ -143,33 +181,44 @@ SequenceWorkflow::resizeClip( const QUuid& uuid, qint64 newBegin, qint64 newEnd,
     if ( ret == false )
         return false;
     c->pos = newPos;
-    emit clipResized( uuid.toString() );
+    updateState( c );
+    emit clipResized( handle );
     return ret;
 }
 
 QSharedPointer<SequenceWorkflow::ClipInstance>
 SequenceWorkflow::removeClip( const QUuid& uuid )
 {
-    vlmcDebug() << "Removing clip instance" << uuid;
-    auto it = m_clips.find( uuid );
-    if ( it == m_clips.end() )
+    auto handle = clipHandle( uuid );
+    if ( handle.isNull() == true )
     {
         vlmcCritical() << "Couldn't find a sequence workflow clip:" << uuid;
         return {};
     }
-    auto c = it.value();
+    return removeClip( handle );
+}
+
+QSharedPointer<SequenceWorkflow::ClipInstance>
+SequenceWorkflow::removeClip( SlotHandle handle )
+{
+    auto c = this->clip( handle );
+    if ( c == nullptr )
+        return {};
+    // Copied, as the instance can be released once it's removed
+    const auto uuid = c->uuid;
+    vlmcDebug() << "Removing clip instance" << uuid;
     auto clip = c->clip;
     auto trackId = c->trackId;
     auto t = track( trackId, c->isAudio );
     t->removeClip( uuid );
-    m_clips.erase( it );
+    removeUsage( *clip, c->handle );
+    m_clipIndex.remove( c->handle );
+    m_clips.remove( c->handle );
+    m_clipHandles.remove( uuid );
+    c->handle = SlotHandle();
+    removeFromState( uuid );
     clip->disconnect( this );
-    bool onTimeline = false;
-    for ( const auto& clipInstance : m_clips )
-        if ( clipInstance->clip->uuid() == clip->uuid() )
-            onTimeline = true;
-    clip->setOnTimeline( onTimeline );
-    emit clipRemoved( uuid.toString() );
+    emit clipRemoved( handle );
     return c;
 
 }
@@ -177,30 +226,46 @@ SequenceWorkflow::removeClip( const QUuid& uuid )
 bool
 SequenceWorkflow::linkClips( const QUuid& uuidA, const QUuid& uuidB )
 {
-    auto clipA = clip( uuidA );
-    auto clipB = clip( uuidB );
+    return linkClips( clipHandle( uuidA ), clipHandle( uuidB ) );
+}
+
+bool
+SequenceWorkflow::linkClips( SlotHandle handleA, SlotHandle handleB )
+{
+    auto clipA = clip( handleA );
+    auto clipB = clip( handleB );
     if ( !clipA || !clipB )
     {
-        vlmcCritical() << "Couldn't find clips:" << uuidA << "and" << uuidB;
+        vlmcCritical() << "Couldn't find the clips to link";
         return false;
     }
-    clipA->linkedClips.append( uuidB );
-    clipB->linkedClips.append( uuidA );
-    emit clipLinked( uuidA.toString(), uuidB.toString() );
+    clipA->linkedClips.append( clipB->uuid );
+    clipB->linkedClips.append( clipA->uuid );
+    updateState( clipA );
+    updateState( clipB );
+    emit clipLinked( handleA, handleB );
     return true;
 }
 
 bool
 SequenceWorkflow::unlinkClips( const QUuid& uuidA, const QUuid& uuidB )
 {
-    vlmcDebug() << "Unlinking clips" << uuidA.toString() << "and" << uuidB.toString();
-    auto clipA = clip( uuidA );
-    auto clipB = clip( uuidB );
+    return unlinkClips( clipHandle( uuidA ), clipHandle( uuidB ) );
+}
+
+bool
+SequenceWorkflow::unlinkClips( SlotHandle handleA, SlotHandle handleB )
+{
+    auto clipA = clip( handleA );
+    auto clipB = clip( handleB );
     if ( !clipA || !clipB )
     {
-        vlmcCritical() << "Couldn't find clips:" << uuidA << "and" << uuidB;
+        vlmcCritical() << "Couldn't find the clips to unlink";
         return false;
     }
+    const auto& uuidA = clipA->uuid;
+    const auto& uuidB = clipB->uuid;
+    vlmcDebug() << "Unlinking clips" << uuidA.toString() << "and" << uuidB.toString();
     bool ret = true;
     if ( clipA->linkedClips.removeOne( uuidB ) == false )
     {
@@ -212,11 +277,335 @@ SequenceWorkflow::unlinkClips( const QUuid& uuidA, const QUuid& uuidB )
         ret = false;
         vlmcWarning() << "Failed to unlink" << uuidA << "from Clip instance" << uuidB;
     }
+    updateState( clipA );
+    updateState( clipB );
     if ( ret == true )
-        emit clipUnlinked( uuidA.toString(), uuidB.toString() );
+        emit clipUnlinked( handleA, handleB );
     return ret;
 }
 
+SequenceWorkflow::ClipEdit
+SequenceWorkflow::placement( const QUuid& uuid ) const
+{
+    auto c = clip( clipHandle( uuid ) );
+    if ( c == nullptr )
+        return ClipEdit{ uuid, 0, -1, -1, -1 };
+    return ClipEdit{ uuid, c->trackId, c->pos, c->clip->begin(), c->clip->end() };
+}
+
+bool
+SequenceWorkflow::isValid( const ClipEdit& edit ) const
+{
+    auto c = clip( clipHandle( edit.uuid ) );
+    if ( c == nullptr )
+    {
+        vlmcCritical() << "Couldn't find a clip:" << edit.uuid;
+        return false;
+    }
+    if ( edit.trackId >= m_trackCount || edit.pos < 0 || edit.begin < 0 || edit.begin > edit.end )
+        return false;
+    auto length = c->clip->media()->input()->length();
+    return length <= 0 || edit.end < length;
+}
+
+bool
+SequenceWorkflow::applyEdits( const QVector<ClipEdit>& edits, const QVector<QUuid>& removed,
+                              const QVector<QSharedPointer<ClipInstance>>& added )
+{
+    for ( const auto& e : edits )
+    {
+        if ( isValid( e ) == false || removed.contains( e.uuid ) == true )
+            return false;
+    }
+    for ( const auto& uuid : removed )
+    {
+        if ( clipHandle( uuid ).isNull() == true )
+            return false;
+    }
+    for ( const auto& c : added )
+    {
+        if ( clipHandle( c->uuid ).isNull() == false || c->trackId >= m_trackCount )
+            return false;
+    }
+
+    // The tracks' clips are changed first, and the playlists rebuilt from them. The rest of
+    // the sequence only follows once the playlists accepted the new layout.
+    struct Previous
+    {
+        QSharedPointer<ClipInstance>    instance;
+        ClipInstance                    placement;
+        qint64                          begin;
+        qint64                          end;
+    };
+    QHash<Track*, QSharedPointer<Track>>    tracks;
+    QHash<Track*, QSet<QUuid>>              changed;
+    QVector<Previous>                       previous;
+    QVector<QUuid>                          moved;
+    QVector<QUuid>                          resized;
+
+    for ( const auto& uuid : removed )
+    {
+        auto c = clip( uuid );
+        auto t = track( c->trackId, c->isAudio );
+        t->detachClip( uuid );
+        tracks[t.data()] = t;
+    }
+    for ( const auto& c : added )
+    {
+        auto t = track( c->trackId, c->isAudio );
+        t->attachClip( c );
+        tracks[t.data()] = t;
+        changed[t.data()].insert( c->uuid );
+    }
+    for ( const auto& e : edits )
+    {
+        auto c = clip( e.uuid );
+        previous << Previous{ c, *c, c->clip->begin(), c->clip->end() };
+        if ( c->clip->begin() != e.begin || c->clip->end() != e.end )
+        {
+            if ( c->duplicateClipForResize( e.begin, e.end ) == false )
+                c->clip->setBoundaries( e.begin, e.end );
+            resized << e.uuid;
+        }
+        if ( c->trackId != e.trackId || c->pos != e.pos )
+            moved << e.uuid;
+        auto t = track( c->trackId, c->isAudio );
+        if ( c->trackId != e.trackId )
+        {
+            t->detachClip( e.uuid );
+            tracks[t.data()] = t;
+            t = track( e.trackId, c->isAudio );
+            t->attachClip( c );
+            c->trackId = e.trackId;
+        }
+        c->pos = e.pos;
+        tracks[t.data()] = t;
+        changed[t.data()].insert( e.uuid );
+    }
+
+    bool ret = true;
+    for ( const auto& t : tracks )
+    {
+        if ( t->relayout( changed.value( t.data() ) ) == false )
+            ret = false;
+    }
+    if ( ret == false )
+    {
+        vlmcCritical() << "Couldn't lay the edited clips out, restoring the previous placements";
+        changed.clear();
+        for ( auto it = previous.crbegin(); it != previous.crend(); ++it )
+        {
+            const auto& c = it->instance;
+            // Drop the clip a resize duplicated, or give the resized one its boundaries back
+            if ( c->clip != it->placement.clip )
+                c->clip->media()->removeSubclip( c->clip->uuid() );
+            else if ( c->clip->begin() != it->begin || c->clip->end() != it->end )
+                c->clip->setBoundaries( it->begin, it->end );
+            auto t = track( it->placement.trackId, c->isAudio );
+            if ( c->trackId != it->placement.trackId )
+            {
+                track( c->trackId, c->isAudio )->detachClip( c->uuid );
+                t->attachClip( c );
+            }
+            *c = it->placement;
+            changed[t.data()].insert( c->uuid );
+        }
+        for ( const auto& c : added )
+            track( c->trackId, c->isAudio )->detachClip( c->uuid );
+        for ( const auto& uuid : removed )
+        {
+            auto c = clip( uuid );
+            track( c->trackId, c->isAudio )->attachClip( c );
+        }
+        for ( const auto& t : tracks )
+            t->relayout( changed.value( t.data() ) );
+        return false;
+    }
+
+    QVector<SlotHandle> removedHandles;
+    for ( const auto& uuid : removed )
+    {
+        auto c = clip( uuid );
+        removeUsage( *c->clip, c->handle );
+        m_clipIndex.remove( c->handle );
+        m_clips.remove( c->handle );
+        m_clipHandles.remove( uuid );
+        removedHandles << c->handle;
+        c->handle = SlotHandle();
+        removeFromState( uuid );
+        c->clip->disconnect( this );
+    }
+    for ( const auto& c : added )
+    {
+        c->handle = m_clips.insert( c );
+        m_clipHandles.insert( c->uuid, c->handle );
+        addUsage( *c->clip, c->handle );
+    }
+    for ( const auto& p : previous )
+    {
+        // The resized instances which got their own clip
+        if ( p.instance->clip == p.placement.clip )
+            continue;
+        removeUsage( *p.placement.clip, p.instance->handle );
+        addUsage( *p.instance->clip, p.instance->handle );
+    }
+
+    for ( const auto& handle : removedHandles )
+        emit clipRemoved( handle );
+    for ( const auto& c : added )
+    {
+        updateState( c );
+        emit clipAdded( c->handle );
+    }
+    for ( const auto& e : edits )
+        updateState( clip( e.uuid ) );
+    for ( const auto& uuid : resized )
+        emit clipResized( clipHandle( uuid ) );
+    for ( const auto& uuid : moved )
+        emit clipMoved( clipHandle( uuid ) );
+    return true;
+}
+
+QVector<QSharedPointer<SequenceWorkflow::ClipInstance>>
+SequenceWorkflow::withLinkedClips( const QVector<QUuid>& uuids ) const
+{
+    QVector<QSharedPointer<ClipInstance>>   res;
+    QSet<QUuid>                             seen;
+    for ( const auto& uuid : uuids )
+    {
+        auto c = clip( clipHandle( uuid ) );
+        if ( c == nullptr )
+            return {};
+        if ( seen.contains( uuid ) == false )
+        {
+            seen.insert( uuid );
+            res << c;
+        }
+        for ( const auto& linked : c->linkedClips )
+        {
+            auto lc = clip( clipHandle( linked ) );
+            if ( lc == nullptr || seen.contains( linked ) == true )
+                continue;
+            seen.insert( linked );
+            res << lc;
+        }
+    }
+    return res;
+}
+
+bool
+SequenceWorkflow::planGroupMove( const QVector<QUuid>& uuids, qint32 trackOffset, qint64 posOffset,
+                                 QVector<ClipEdit>& edits ) const
+{
+    auto clips = withLinkedClips( uuids );
+    if ( clips.isEmpty() == true )
+        return false;
+    for ( const auto& c : clips )
+    {
+        auto e = placement( c->uuid );
+        auto trackId = static_cast<qint64>( e.trackId ) + trackOffset;
+        if ( trackId < 0 )
+            return false;
+        e.trackId = static_cast<quint32>( trackId );
+        e.pos += posOffset;
+        if ( isValid( e ) == false )
+            return false;
+        edits << e;
+    }
+    return true;
+}
+
+bool
+SequenceWorkflow::planRippleInsert( qint64 pos, qint64 length, QVector<ClipEdit>& edits ) const
+{
+    if ( pos < 0 || length <= 0 )
+        return false;
+    for ( auto it = m_clips.begin(); it != m_clips.end(); ++it )
+    {
+        const auto& c = *it;
+        if ( c->pos < pos )
+            continue;
+        auto e = placement( c->uuid );
+        e.pos += length;
+        edits << e;
+    }
+    return true;
+}
+
+bool
+SequenceWorkflow::planRippleDelete( qint64 begin, qint64 end, QVector<ClipEdit>& edits,
+                                    QVector<QUuid>& removed ) const
+{
+    if ( begin < 0 || begin > end )
+        return false;
+    auto length = end - begin + 1;
+    for ( auto it = m_clips.begin(); it != m_clips.end(); ++it )
+    {
+        const auto& c = *it;
+        auto clipEnd = c->pos + c->clip->length() - 1;
+        if ( clipEnd < begin )
+            continue;
+        if ( c->pos > end )
+        {
+            auto e = placement( c->uuid );
+            e.pos -= length;
+            edits << e;
+        }
+        else if ( c->pos >= begin && clipEnd <= end )
+            removed << c->uuid;
+        else
+            return false;
+    }
+    return true;
+}
+
+bool
+SequenceWorkflow::planRoll( const QUuid& left, const QUuid& right, qint64 offset,
+                            QVector<ClipEdit>& edits ) const
+{
+    auto l = clip( clipHandle( left ) );
+    auto r = clip( clipHandle( right ) );
+    if ( l == nullptr || r == nullptr || l->trackId != r->trackId || l->isAudio != r->isAudio ||
+         l->pos + l->clip->length() != r->pos )
+        return false;
+    for ( const auto& c : withLinkedClips( { left } ) )
+    {
+        auto e = placement( c->uuid );
+        e.end += offset;
+        if ( isValid( e ) == false )
+            return false;
+        edits << e;
+    }
+    for ( const auto& c : withLinkedClips( { right } ) )
+    {
+        auto e = placement( c->uuid );
+        e.begin += offset;
+        e.pos += offset;
+        if ( isValid( e ) == false )
+            return false;
+        edits << e;
+    }
+    return true;
+}
+
+bool
+SequenceWorkflow::planSlip( const QUuid& uuid, qint64 offset, QVector<ClipEdit>& edits ) const
+{
+    auto clips = withLinkedClips( { uuid } );
+    if ( clips.isEmpty() == true )
+        return false;
+    for ( const auto& c : clips )
+    {
+        auto e = placement( c->uuid );
+        e.begin += offset;
+        e.end += offset;
+        if ( isValid( e ) == false )
+            return false;
+        edits << e;
+    }
+    return true;
+}
+
 QUuid
 SequenceWorkflow::addTransition( const QString& identifier, qint64 begin, qint64 end,
                                  quint32 trackId, Workflow::TrackType type )
@@ -224,8 +613,11 @@ SequenceWorkflow::addTransition( const QString& identifier, qint64 begin, qint64
     auto t = track( trackId, type == Workflow::AudioTrack );
     auto transition = QSharedPointer<Transition>::create( identifier, begin, end, type );
     t->addTransition( transition );
-    m_transitions.insert( transition->uuid(), QSharedPointer<TransitionInstance>::create( transition, trackId, 0, true ) );
-    emit transitionAdded( transition->uuid().toString() );
+    auto transitionInstance = QSharedPointer<TransitionInstance>::create( transition, trackId, 0, true );
+    transitionInstance->handle = m_transitions.insert( transitionInstance );
+    m_transitionHandles.insert( transition->uuid(), transitionInstance->handle );
+    updateState( transitionInstance );
+    emit transitionAdded( transitionInstance->handle );
     return transition->uuid();
 }
 
@@ -235,9 +627,12 @@ SequenceWorkflow::addTransitionBetweenTracks( const QString& identifier, qint64
                                               Workflow::TrackType type )
 {
     auto transition = QSharedPointer<Transition>::create( identifier, begin, end, type );
-    m_transitions.insert( transition->uuid(), QSharedPointer<TransitionInstance>::create( transition, trackAId, trackBId, false ) );
+    auto transitionInstance = QSharedPointer<TransitionInstance>::create( transition, trackAId, trackBId, false );
+    transitionInstance->handle = m_transitions.insert( transitionInstance );
+    m_transitionHandles.insert( transition->uuid(), transitionInstance->handle );
+    updateState( transitionInstance );
     transition->apply( *m_multitrack, trackAId, trackBId );
-    emit transitionAdded( transition->uuid().toString() );
+    emit transitionAdded( transitionInstance->handle );
     return transition->uuid();
 }
 
@@ -245,32 +640,48 @@ bool
 SequenceWorkflow::addTransition( QSharedPointer<TransitionInstance> transitionInstance )
 {
     auto transition = transitionInstance->transition;
+    transitionInstance->handle = m_transitions.insert( transitionInstance );
+    m_transitionHandles.insert( transition->uuid(), transitionInstance->handle );
+    updateState( transitionInstance );
+    if ( transitionInstance->isInTrack == false )
+    {
+        transition->apply( *m_multitrack, transitionInstance->trackAId, transitionInstance->trackBId );
+        emit transitionAdded( transitionInstance->handle );
+        return true;
+    }
     auto t = track( transitionInstance->trackAId, transition->type() == Workflow::AudioTrack );
-    m_transitions.insert( transition->uuid(), transitionInstance );
-    emit transitionAdded( transition->uuid().toString() );
+    emit transitionAdded( transitionInstance->handle );
     return t->addTransition( transition );
 }
 
 bool
 SequenceWorkflow::moveTransition( const QUuid& uuid, qint64 begin, qint64 end )
 {
-    auto it = m_transitions.find( uuid );
-    if ( it == m_transitions.end() )
+    return moveTransition( transitionHandle( uuid ), begin, end );
+}
+
+bool
+SequenceWorkflow::moveTransition( SlotHandle handle, qint64 begin, qint64 end )
+{
+    auto transitionInstance = transition( handle );
+    if ( transitionInstance == nullptr )
         return false;
-    auto transitionInstance = it.value();
     auto transition = transitionInstance->transition;
     if ( transition->begin() == begin && transition->end() == end )
         return true;
     if ( transitionInstance->isInTrack == true )
     {
         auto t = track( transitionInstance->trackAId, transition->type() == Workflow::AudioTrack );
-        emit transitionMoved( uuid.toString() );
-        return t->moveTransition( uuid, begin, end );
+        auto ret = t->moveTransition( transition->uuid(), begin, end );
+        updateState( transitionInstance );
+        emit transitionMoved( handle );
+        return ret;
     }
     else
     {
         transition->setBoundaries( begin, end );
-        emit transitionMoved( uuid.toString() );
+        updateState( transitionInstance );
+        emit transitionMoved( handle );
         return true;
     }
 }
@@ -278,10 +689,15 @@ SequenceWorkflow::moveTransition( const QUuid& uuid, qint64 begin, qint64 end )
 bool
 SequenceWorkflow::moveTransitionBetweenTracks( const QUuid& uuid, quint32 trackAId, quint32 trackBId )
 {
-    auto it = m_transitions.find( uuid );
-    if ( it == m_transitions.end() )
+    return moveTransitionBetweenTracks( transitionHandle( uuid ), trackAId, trackBId );
+}
+
+bool
+SequenceWorkflow::moveTransitionBetweenTracks( SlotHandle handle, quint32 trackAId, quint32 trackBId )
+{
+    auto transitionInstance = transition( handle );
+    if ( transitionInstance == nullptr )
         return false;
-    auto transitionInstance = it.value();
     if ( transitionInstance->isInTrack == true )
         return false; // Not allowed
     auto transition = transitionInstance->transition;
@@ -290,25 +706,36 @@ SequenceWorkflow::moveTransitionBetweenTracks( const QUuid& uuid, quint32 trackA
     transition->setTracks( trackAId, trackBId );
     transitionInstance->trackAId = trackAId;
     transitionInstance->trackBId = trackBId;
-    emit transitionMoved( uuid.toString() );
+    updateState( transitionInstance );
+    emit transitionMoved( handle );
     return true;
 }
 
 QSharedPointer<SequenceWorkflow::TransitionInstance>
 SequenceWorkflow::removeTransition( const QUuid& uuid )
 {
-    auto it = m_transitions.find( uuid );
-    if ( it == m_transitions.end() )
+    return removeTransition( transitionHandle( uuid ) );
+}
+
+QSharedPointer<SequenceWorkflow::TransitionInstance>
+SequenceWorkflow::removeTransition( SlotHandle handle )
+{
+    auto transitionInstance = transition( handle );
+    if ( transitionInstance == nullptr )
         return {};
-    auto transitionInstance = it.value();
+    const auto uuid = transitionInstance->transition->uuid();
     if ( transitionInstance->isInTrack == true )
     {
         auto transition = transitionInstance->transition;
         auto t = track( transitionInstance->trackAId, transition->type() == Workflow::AudioTrack );
         t->removeTransition( uuid );
     }
-    m_transitions.erase( it );
-    emit transitionRemoved( uuid.toString() );
+    m_transitionIndex.remove( transitionInstance->handle );
+    m_transitions.remove( transitionInstance->handle );
+    m_transitionHandles.remove( uuid );
+    transitionInstance->handle = SlotHandle();
+    removeFromState( uuid );
+    emit transitionRemoved( handle );
     return transitionInstance;
 }
 
@@ -320,9 +747,8 @@ SequenceWorkflow::toVariant() const
         transitions << t->toVariant();
 
     QVariantList l;
-    for ( auto it = m_clips.begin(); it != m_clips.end(); ++it )
+    for ( const auto& c : m_clips )
     {
-        auto c = it.value();
         QVariantHash h = {
             { "uuid", c->uuid.toString() },
             { "clipUuid", c->clip->uuid().toString() },
@@ -346,16 +772,7 @@ void
 SequenceWorkflow::loadFromVariant( const QVariant& variant )
 {
     for ( auto& var : variant.toMap()["transitions"].toList() )
-    {
-        auto m = var.toMap();
-        bool inTrack = m["isInTrack"].toBool();
-        if ( inTrack == true )
-            addTransition( m["identifier"].toString(), m["begin"].toLongLong(), m["end"].toLongLong(),
-                    m["trackId"].toUInt(), m["audio"].toBool() ? Workflow::AudioTrack : Workflow::VideoTrack );
-        else
-            addTransitionBetweenTracks( m["identifier"].toString(), m["begin"].toLongLong(), m["end"].toLongLong(),
-                    m["trackAId"].toUInt(), m["trackBId"].toUInt(), m["audio"].toBool() ? Workflow::AudioTrack : Workflow::VideoTrack );
-    }
+        addTransitionFromVariant( var.toMap() );
 
     for ( auto& var : variant.toMap()["clips"].toList() )
     {
@@ -374,64 +791,468 @@ SequenceWorkflow::loadFromVariant( const QVariant& variant )
         auto isAudio = m["isAudio"].toBool();
         //FIXME: Add missing clip type handling. We don't know if we're adding an audio clip or not
         addClip( clip, m["trackId"].toUInt(), m["position"].toLongLong(), uuid, isAudio );
-        auto c = m_clips[uuid];
+        auto c = this->clip( uuid );
+        if ( c == nullptr )
+            continue;
 
         auto linkedClipsList = m["linkedClips"].toList();
         for ( const auto& uuidVar : linkedClipsList )
         {
             auto linkedClipUuid = uuidVar.toUuid();
             c->linkedClips.append( linkedClipUuid );
-            auto it = m_clips.find( linkedClipUuid );
-            if ( it != m_clips.end() )
-                emit clipLinked( uuid.toString(), linkedClipUuid.toString() );
+            if ( m_clipHandles.contains( linkedClipUuid ) == true )
+                emit clipLinked( c->handle, clipHandle( linkedClipUuid ) );
         }
 
         EffectHelper::loadFromVariant( m["filters"], clip->input() );
     }
     EffectHelper::loadFromVariant( variant.toMap()["filters"], m_multitrack.get() );
+    updateFilters();
+}
+
+SequenceSnapshot
+SequenceWorkflow::snapshot( bool optimizedMedia, const std::function<double( const ::Media& )>& gain ) const
+{
+    SequenceSnapshot res;
+    try
+    {
+        res = SequenceSnapshot( m_multitrack->serialize(), m_multitrack->playableLength() );
+    }
+    catch ( Backend::InvalidServiceException& )
+    {
+        vlmcWarning() << "Couldn't describe the sequence";
+        return res;
+    }
+    QSet<const ::Media*> media;
+    for ( const auto& c : m_clips )
+    {
+        auto m = c->clip->media().data();
+        if ( media.contains( m ) == true )
+            continue;
+        media.insert( m );
+        // The preview may play the optimized copy rather than the original
+        auto optimized = m->optimizedFile();
+        if ( optimized.isEmpty() == false )
+        {
+            if ( optimizedMedia == true )
+                res.setResource( m->mrl(), optimized );
+            else
+                res.setResource( optimized, m->mrl() );
+        }
+        if ( gain == nullptr || m->input()->hasAudio() == false )
+            continue;
+        auto level = gain( *m );
+        if ( level == .0 )
+            continue;
+        res.setAudioGain( m->mrl(), level );
+        if ( optimized.isEmpty() == false )
+            res.setAudioGain( optimized, level );
+    }
+    return res;
+}
+
+SequenceState
+SequenceWorkflow::state() const
+{
+    return m_state;
+}
+
+void
+SequenceWorkflow::updateFilters( const QUuid& uuid )
+{
+    auto c = clip( uuid );
+    if ( c == nullptr )
+        return;
+    // The instances of a library clip share its filters
+    updateFilters( c->clip->input() );
+}
+
+void
+SequenceWorkflow::updateFilters( Backend::IInput* input )
+{
+    if ( input == nullptr )
+        return;
+    // Filters hand out new wrappers of their input, which are matched by their backend service
+    auto isInput = [input]( Backend::IInput& i ) {
+        return &i == input || i.sameClip( *input ) == true;
+    };
+    if ( isInput( *m_multitrack ) == true )
+    {
+        auto filters = EffectHelper::toVariant( m_multitrack.get() );
+        if ( filters != m_state.m_filters )
+        {
+            m_state.m_filters = filters;
+            ++m_state.m_revision;
+        }
+        return;
+    }
+    for ( int i = 0; i < m_multiTracks.size(); ++i )
+    {
+        if ( isInput( *m_multiTracks[i] ) == false )
+            continue;
+        auto filters = EffectHelper::toVariant( m_multiTracks[i].get() );
+        if ( filters != m_state.m_trackFilters[i] )
+        {
+            m_state.m_trackFilters[i] = filters;
+            ++m_state.m_revision;
+        }
+        return;
+    }
+    auto it = m_clipInputs.find( input );
+    if ( it != m_clipInputs.end() )
+    {
+        for ( const auto& c : instances( m_clipUsage.value( it.value() ) ) )
+            updateState( c );
+        return;
+    }
+    // A wrapper of a clip input matches every clip of the same media, they're all updated
+    for ( auto it = m_clipInputs.begin(); it != m_clipInputs.end(); ++it )
+    {
+        if ( it.key()->sameClip( *input ) == false )
+            continue;
+        for ( const auto& c : instances( m_clipUsage.value( it.value() ) ) )
+            updateState( c );
+    }
+}
+
+void
+SequenceWorkflow::updateFilters()
+{
+    // updateState() keeps the records which didn't change
+    for ( const auto& c : m_clips )
+        updateState( c );
+    for ( int i = 0; i < m_multiTracks.size(); ++i )
+    {
+        auto filters = EffectHelper::toVariant( m_multiTracks[i].get() );
+        if ( filters != m_state.m_trackFilters[i] )
+        {
+            m_state.m_trackFilters[i] = filters;
+            ++m_state.m_revision;
+        }
+    }
+    auto filters = EffectHelper::toVariant( m_multitrack.get() );
+    if ( filters != m_state.m_filters )
+    {
+        m_state.m_filters = filters;
+        ++m_state.m_revision;
+    }
+}
+
+QByteArray
+SequenceWorkflow::fingerprint( qint64 begin, qint64 end ) const
+{
+    QStringList elements;
+    for ( const auto& c : m_clips )
+    {
+        if ( c->pos >= end || c->pos + c->clip->length() <= begin )
+            continue;
+        auto mrl = c->clip->media()->mrl();
+        QFileInfo fInfo( QUrl::fromUserInput( mrl ).toLocalFile() );
+        QVariantHash h = {
+            { "mrl", mrl },
+            { "size", fInfo.size() },
+            { "lastModified", fInfo.lastModified().toMSecsSinceEpoch() },
+            { "begin", c->clip->begin() },
+            { "end", c->clip->end() },
+            { "position", c->pos - begin },
+            { "trackId", c->trackId },
+            { "isAudio", c->isAudio },
+            { "filters", EffectHelper::toVariant( c->clip->input() ) },
+        };
+        elements << QString::fromUtf8( QJsonDocument::fromVariant( h ).toJson( QJsonDocument::Compact ) );
+    }
+    for ( const auto& t : m_transitions )
+    {
+        auto transition = t->transition;
+        if ( transition->begin() >= end || transition->end() < begin )
+            continue;
+        auto h = t->toVariant().toHash();
+        h.remove( "uuid" );
+        h["begin"] = transition->begin() - begin;
+        h["end"] = transition->end() - begin;
+        elements << QString::fromUtf8( QJsonDocument::fromVariant( h ).toJson( QJsonDocument::Compact ) );
+    }
+    // Track filters apply to the whole range, whatever it contains
+    for ( auto i = 0; i < m_multiTracks.size(); ++i )
+    {
+        if ( m_multiTracks[i]->filterCount() == 0 )
+            continue;
+        QVariantHash h = {
+            { "trackId", i },
+            { "filters", EffectHelper::toVariant( m_multiTracks[i].get() ) },
+        };
+        elements << QString::fromUtf8( QJsonDocument::fromVariant( h ).toJson( QJsonDocument::Compact ) );
+    }
+    // Clip & transition maps are sorted by uuid, which depends on the edit history
+    elements.sort();
+    elements << QString::fromUtf8( QJsonDocument::fromVariant( EffectHelper::toVariant( m_multitrack.get() ) )
+                                        .toJson( QJsonDocument::Compact ) );
+
+    QCryptographicHash hash( QCryptographicHash::Sha1 );
+    hash.addData( QByteArray::number( end - begin ) );
+    for ( const auto& e : elements )
+        hash.addData( e.toUtf8() );
+    return hash.result();
 }
 
 void
 SequenceWorkflow::clear()
 {
-    while ( !m_clips.empty() )
-        removeClip( m_clips.begin().key() );
+    // Removing instances one by one would edit the playlists and notify for each of them.
+    // Instead, swap the whole backend graph for an empty one, and let the previous one, along
+    // with the producers and filters it holds, be destroyed by the background releaser.
+    // The clips & transitions are released here: the graph still references their producers,
+    // so this only drops references, and their signals are emitted from this thread.
+    Graph   graph;
+    for ( auto it = m_clips.begin(); it != m_clips.end(); ++it )
+    {
+        const auto& c = *it;
+        c->handle = SlotHandle();
+        c->clip->disconnect( this );
+        c->clip->setOnTimeline( false );
+    }
+    for ( auto it = m_transitions.begin(); it != m_transitions.end(); ++it )
+    {
+        ( *it )->handle = SlotHandle();
+        ( *it )->transition->disconnect( this );
+    }
+    for ( int i = 0; i < Workflow::NbTrackType; ++i )
+    {
+        for ( const auto& t : m_tracks[i] )
+            graph.trackTractors.push_back( t->releaseBackend( graph.playlists ) );
+        m_tracks[i].clear();
+    }
+    graph.multiTracks.swap( m_multiTracks );
+    graph.multitrack = std::move( m_multitrack );
+
+    m_clips.clear();
+    m_clipHandles.clear();
+    m_transitions.clear();
+    m_transitionHandles.clear();
+    m_clipUsage.clear();
+    m_mediaUsage.clear();
+    m_clipInputs.clear();
+    m_clipIndex.clear();
+    m_transitionIndex.clear();
+
+    auto revision = m_state.m_revision;
+    m_state = SequenceState();
+    m_state.m_revision = revision + 1;
+    m_state.m_trackFilters.fill( QVariantList(), static_cast<int>( m_trackCount ) );
+
+    createTracks();
+    Core::instance()->releaser()->release( std::move( graph ) );
+    emit cleared();
+}
+
+// Replaces the filters of an input with serialized ones, unless they are the same already
+static void
+resetFilters( const QVariant& filters, Backend::IInput* input )
+{
+    if ( EffectHelper::toVariant( input ) == filters )
+        return;
+    while ( input->filterCount() > 0 )
+        input->detach( 0 );
+    EffectHelper::loadFromVariant( filters, input );
+}
+
+bool
+SequenceWorkflow::restore( const SequenceState& target )
+{
+    bool ret = true;
+    auto changed = target.changedClips( m_state );
+
+    // Instances now using another library clip are recreated, hence the two passes:
+    // applyEdits() can't remove and add the same UUID at once.
+    QVector<ClipEdit>                       edits;
+    QVector<QUuid>                          removed;
+    QVector<QSharedPointer<ClipInstance>>   added;
+    for ( const auto& uuid : changed )
+    {
+        auto record = target.clip( uuid );
+        auto c = clip( clipHandle( uuid ) );
+        if ( c != nullptr && ( record == nullptr || c->clip->uuid() != record->clipUuid ) )
+        {
+            removed << uuid;
+            c = nullptr;
+        }
+        if ( record == nullptr )
+            continue;
+        if ( c != nullptr )
+        {
+            edits << ClipEdit{ uuid, record->trackId, record->pos, record->begin, record->end };
+            continue;
+        }
+        auto libraryClip = Core::instance()->library()->clip( record->clipUuid );
+        if ( libraryClip == nullptr )
+        {
+            vlmcCritical() << "Can't restore clip instance" << uuid << ": library clip"
+                           << record->clipUuid << "is gone";
+            ret = false;
+            continue;
+        }
+        auto instance = QSharedPointer<ClipInstance>::create( libraryClip, uuid, record->trackId,
+                                                              record->pos, record->isAudio );
+        if ( libraryClip->begin() != record->begin || libraryClip->end() != record->end )
+            instance->duplicateClipForResize( record->begin, record->end );
+        added << instance;
+    }
+    if ( applyEdits( edits, removed ) == false || applyEdits( {}, {}, added ) == false )
+    {
+        vlmcWarning() << "Failed to restore the sequence to revision" << target.revision();
+        ret = false;
+    }
+
+    for ( const auto& uuid : changed )
+    {
+        auto record = target.clip( uuid );
+        auto c = clip( clipHandle( uuid ) );
+        if ( record == nullptr || c == nullptr )
+            continue;
+        resetFilters( record->filters, c->clip->input() );
+        if ( c->linkedClips == record->linkedClips )
+            continue;
+        // Each link is shared by two changed instances, notify it only once
+        for ( const auto& other : record->linkedClips )
+        {
+            if ( c->linkedClips.contains( other ) == false && uuid < other )
+                emit clipLinked( c->handle, clipHandle( other ) );
+        }
+        for ( const auto& other : c->linkedClips )
+        {
+            if ( record->linkedClips.contains( other ) == false && uuid < other )
+                emit clipUnlinked( c->handle, clipHandle( other ) );
+        }
+        c->linkedClips = record->linkedClips;
+    }
+
+    for ( const auto& uuid : target.changedTransitions( m_state ) )
+    {
+        auto record = target.transition( uuid );
+        auto t = transition( uuid );
+        if ( t != nullptr && record != nullptr && t->isInTrack == record->isInTrack &&
+             t->transition->identifier() == record->identifier &&
+             ( record->isInTrack == false || t->trackAId == record->trackAId ) )
+        {
+            moveTransition( uuid, record->begin, record->end );
+            if ( record->isInTrack == false )
+                moveTransitionBetweenTracks( uuid, record->trackAId, record->trackBId );
+            continue;
+        }
+        if ( t != nullptr )
+            removeTransition( uuid );
+        if ( record == nullptr )
+            continue;
+        auto transition = QSharedPointer<Transition>::create( record->identifier, record->begin, record->end,
+                            record->isAudio == true ? Workflow::AudioTrack : Workflow::VideoTrack );
+        transition->setUuid( uuid );
+        addTransition( QSharedPointer<TransitionInstance>::create( transition, record->trackAId,
+                                                                   record->trackBId, record->isInTrack ) );
+    }
+
+    for ( int i = 0; i < m_multiTracks.size(); ++i )
+        resetFilters( target.trackFilters( static_cast<quint32>( i ) ), m_multiTracks[i].get() );
+    resetFilters( target.filters(), m_multitrack.get() );
+    updateFilters();
+    return ret;
 }
 
 QSharedPointer<SequenceWorkflow::ClipInstance>
 SequenceWorkflow::clip( const QUuid& uuid )
 {
-    auto it = m_clips.find( uuid );
-    if ( it == m_clips.end() )
-        return {};
-    return it.value();
+    return clip( clipHandle( uuid ) );
 }
 
 QSharedPointer<SequenceWorkflow::TransitionInstance>
 SequenceWorkflow::transition( const QUuid& uuid )
 {
-    auto it = m_transitions.find( uuid );
-    if ( it == m_transitions.end() )
-        return {};
-    return it.value();
+    return transition( transitionHandle( uuid ) );
+}
+
+SlotHandle
+SequenceWorkflow::clipHandle( const QUuid& uuid ) const
+{
+    return m_clipHandles.value( uuid );
+}
+
+QSharedPointer<SequenceWorkflow::ClipInstance>
+SequenceWorkflow::clip( SlotHandle handle ) const
+{
+    return m_clips.value( handle );
+}
+
+SlotHandle
+SequenceWorkflow::transitionHandle( const QUuid& uuid ) const
+{
+    return m_transitionHandles.value( uuid );
+}
+
+QSharedPointer<SequenceWorkflow::TransitionInstance>
+SequenceWorkflow::transition( SlotHandle handle ) const
+{
+    return m_transitions.value( handle );
 }
 
 quint32
 SequenceWorkflow::trackId( const QUuid& uuid )
 {
-    auto it = m_clips.find( uuid );
-    if ( it == m_clips.end() )
+    auto c = clip( uuid );
+    if ( c == nullptr )
         return 0;
-    return it.value()->trackId;
+    return c->trackId;
 }
 
 qint64
 SequenceWorkflow::position( const QUuid& uuid )
 {
-    auto it = m_clips.find( uuid );
-    if ( it == m_clips.end() )
+    auto c = clip( uuid );
+    if ( c == nullptr )
         return 0;
-    return it.value()->pos;
+    return c->pos;
+}
+
+QList<QSharedPointer<SequenceWorkflow::ClipInstance>>
+SequenceWorkflow::clipInstances( const QUuid& clipUuid ) const
+{
+    return instances( m_clipUsage.value( clipUuid ) );
+}
+
+QList<QSharedPointer<SequenceWorkflow::ClipInstance>>
+SequenceWorkflow::mediaInstances( qint64 mediaId ) const
+{
+    return instances( m_mediaUsage.value( mediaId ) );
+}
+
+QList<QSharedPointer<SequenceWorkflow::ClipInstance>>
+SequenceWorkflow::clipsInRange( qint64 begin, qint64 end, const QVector<quint32>& trackIds,
+                                Workflow::TrackType type ) const
+{
+    QList<QSharedPointer<ClipInstance>> res;
+    for ( const auto& h : m_clipIndex.query( begin, end, trackIds, type ) )
+        res << m_clips.value( h );
+    return res;
+}
+
+QList<QSharedPointer<SequenceWorkflow::TransitionInstance>>
+SequenceWorkflow::transitionsInRange( qint64 begin, qint64 end, const QVector<quint32>& trackIds,
+                                      Workflow::TrackType type ) const
+{
+    QList<QSharedPointer<TransitionInstance>> res;
+    for ( const auto& h : m_transitionIndex.query( begin, end, trackIds, type ) )
+        res << m_transitions.value( h );
+    return res;
+}
+
+int
+SequenceWorkflow::clipUsageCount( const QUuid& clipUuid ) const
+{
+    return m_clipUsage.value( clipUuid ).size();
+}
+
+int
+SequenceWorkflow::mediaUsageCount( qint64 mediaId ) const
+{
+    return m_mediaUsage.value( mediaId ).size();
 }
 
 Backend::IInput*
@@ -457,6 +1278,118 @@ SequenceWorkflow::track( quint32 trackId, bool isAudio )
     return m_tracks[Workflow::VideoTrack][static_cast<int>( trackId )];
 }
 
+void
+SequenceWorkflow::updateState( const QSharedPointer<ClipInstance>& c )
+{
+    m_clipIndex.insert( c->handle, c->isAudio == true ? Workflow::AudioTrack : Workflow::VideoTrack,
+                        { c->trackId }, c->pos, c->pos + c->clip->length() - 1 );
+
+    auto record = QSharedPointer<SequenceState::Clip>::create();
+    record->uuid = c->uuid;
+    record->clipUuid = c->clip->uuid();
+    record->mrl = c->clip->media()->mrl();
+    record->begin = c->clip->begin();
+    record->end = c->clip->end();
+    record->trackId = c->trackId;
+    record->pos = c->pos;
+    record->isAudio = c->isAudio;
+    record->linkedClips = c->linkedClips;
+    record->filters = EffectHelper::toVariant( c->clip->input() );
+
+    // Keep sharing the previous record if nothing changed, so that diffs stay accurate
+    auto previous = m_state.m_clips.value( c->uuid );
+    if ( previous != nullptr && previous->clipUuid == record->clipUuid &&
+         previous->begin == record->begin && previous->end == record->end &&
+         previous->trackId == record->trackId && previous->pos == record->pos &&
+         previous->linkedClips == record->linkedClips && previous->filters == record->filters )
+        return;
+    m_state.m_clips.insert( c->uuid, record );
+    ++m_state.m_revision;
+}
+
+void
+SequenceWorkflow::updateState( const QSharedPointer<TransitionInstance>& t )
+{
+    if ( t->isInTrack == true )
+        m_transitionIndex.insert( t->handle, t->transition->type(), { t->trackAId },
+                                  t->transition->begin(), t->transition->end() );
+    else
+        m_transitionIndex.insert( t->handle, t->transition->type(), { t->trackAId, t->trackBId },
+                                  t->transition->begin(), t->transition->end() );
+
+    auto record = QSharedPointer<SequenceState::Transition>::create();
+    record->uuid = t->transition->uuid();
+    record->identifier = t->transition->identifier();
+    record->begin = t->transition->begin();
+    record->end = t->transition->end();
+    record->trackAId = t->trackAId;
+    record->trackBId = t->trackBId;
+    record->isInTrack = t->isInTrack;
+    record->isAudio = t->transition->type() == Workflow::AudioTrack;
+    m_state.m_transitions.insert( record->uuid, record );
+    ++m_state.m_revision;
+}
+
+void
+SequenceWorkflow::removeFromState( const QUuid& uuid )
+{
+    if ( m_state.m_clips.remove( uuid ) + m_state.m_transitions.remove( uuid ) > 0 )
+        ++m_state.m_revision;
+}
+
+void
+SequenceWorkflow::addUsage( ::Clip& clip, SlotHandle handle )
+{
+    m_clipUsage[clip.uuid()].insert( handle );
+    m_mediaUsage[clip.media()->id()].insert( handle );
+    m_clipInputs.insert( clip.input(), clip.uuid() );
+    clip.setOnTimeline( true );
+}
+
+void
+SequenceWorkflow::removeUsage( ::Clip& clip, SlotHandle handle )
+{
+    auto it = m_clipUsage.find( clip.uuid() );
+    if ( it != m_clipUsage.end() )
+    {
+        it->remove( handle );
+        if ( it->isEmpty() == true )
+        {
+            m_clipUsage.erase( it );
+            m_clipInputs.remove( clip.input() );
+        }
+    }
+    auto mediaIt = m_mediaUsage.find( clip.media()->id() );
+    if ( mediaIt != m_mediaUsage.end() )
+    {
+        mediaIt->remove( handle );
+        if ( mediaIt->isEmpty() == true )
+            m_mediaUsage.erase( mediaIt );
+    }
+    clip.setOnTimeline( m_clipUsage.contains( clip.uuid() ) );
+}
+
+QList<QSharedPointer<SequenceWorkflow::ClipInstance>>
+SequenceWorkflow::instances( const QSet<SlotHandle>& handles ) const
+{
+    QList<QSharedPointer<ClipInstance>> res;
+    for ( const auto& h : handles )
+        res << m_clips.value( h );
+    return res;
+}
+
+void
+SequenceWorkflow::addTransitionFromVariant( const QVariantMap& m )
+{
+    bool inTrack = m["isInTrack"].toBool();
+    if ( inTrack == true )
+        addTransition( m["identifier"].toString(), m["begin"].toLongLong(), m["end"].toLongLong(),
+                m["trackId"].toUInt(), m["audio"].toBool() ? Workflow::AudioTrack : Workflow::VideoTrack );
+    else
+        addTransitionBetweenTracks( m["identifier"].toString(), m["begin"].toLongLong(), m["end"].toLongLong(),
+                m["trackAId"].toUInt(), m["trackBId"].toUInt(), m["audio"].toBool() ? Workflow::AudioTrack : Workflow::VideoTrack );
+}
+
 SequenceWorkflow::ClipInstance::ClipInstance(QSharedPointer<::Clip> c, const QUuid& uuid, quint32 tId, qint64 p, bool isAudio )
     : clip( c )
     , uuid( uuid )
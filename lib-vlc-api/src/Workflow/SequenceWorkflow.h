@@ -23,13 +23,20 @@
 #ifndef SEQUENCEWORKFLOW_H
 #define SEQUENCEWORKFLOW_H
 
+#include <functional>
 #include <memory>
 #include <tuple>
+#include <vector>
 
 #include <QUuid>
-#include <QMap>
+#include <QHash>
+#include <QSet>
 
 #include "Media/Clip.h"
+#include "SequenceSnapshot.h"
+#include "SequenceState.h"
+#include "TimelineIndex.h"
+#include "Tools/SlotMap.hpp"
 #include "Types.h"
 
 class Track;
@@ -65,6 +72,8 @@ class SequenceWorkflow : public QObject
             ClipInstance( QSharedPointer<::Clip> c, const QUuid& uuid, quint32 tId, qint64 p, bool isAudio );
             QSharedPointer<::Clip>  clip;
             QUuid                   uuid;
+            // This instance's slot in the sequence, valid while it is on the timeline
+            SlotHandle              handle;
             quint32                 trackId;
             qint64                  pos;
             QVector<QUuid>          linkedClips;
@@ -88,6 +97,7 @@ class SequenceWorkflow : public QObject
             TransitionInstance() = default;
             TransitionInstance( QSharedPointer<Transition>  transition, quint32 trackAId, quint32 trackBId, bool isInTrack );
             QSharedPointer<Transition>  transition;
+            SlotHandle              handle;
             quint32                 trackAId;
             quint32                 trackBId;
             bool                    isInTrack; // If it's in a track, the transition is between clips.
@@ -109,11 +119,76 @@ class SequenceWorkflow : public QObject
         QUuid                   addClip( QSharedPointer<::Clip> clip, quint32 trackId, qint64 pos,
                                          const QUuid& uuid, bool isAudioClip );
         bool                    moveClip( const QUuid& uuid, quint32 trackId, qint64 pos );
+        bool                    moveClip( SlotHandle handle, quint32 trackId, qint64 pos );
         bool                    resizeClip( const QUuid& uuid, qint64 newBegin,
                                             qint64 newEnd, qint64 newPos );
+        bool                    resizeClip( SlotHandle handle, qint64 newBegin,
+                                            qint64 newEnd, qint64 newPos );
         QSharedPointer<ClipInstance>    removeClip( const QUuid& uuid );
+        QSharedPointer<ClipInstance>    removeClip( SlotHandle handle );
         bool                    linkClips( const QUuid& uuidA, const QUuid& uuidB );
+        bool                    linkClips( SlotHandle handleA, SlotHandle handleB );
         bool                    unlinkClips( const QUuid& uuidA, const QUuid& uuidB );
+        bool                    unlinkClips( SlotHandle handleA, SlotHandle handleB );
+
+        /**
+         * @brief The placement of a clip instance, as handled by group edits
+         */
+        struct ClipEdit
+        {
+            QUuid                   uuid;
+            quint32                 trackId;
+            qint64                  pos;
+            qint64                  begin;
+            qint64                  end;
+        };
+
+        ClipEdit                placement( const QUuid& uuid ) const;
+        /**
+         * @brief applyEdits    Applies many clip changes at once
+         *
+         * Every change is validated first, and nothing is modified if one of them is invalid.
+         * Each affected playlist is then rebuilt once, in a single ordered pass, instead of
+         * being reshuffled for each clip. If a playlist rejects its new layout, every clip
+         * gets its previous placement back and false is returned, without any signal.
+         * @param edits     The new placement of existing instances
+         * @param removed   Instances to remove from the sequence
+         * @param added     Previously removed instances to put back, at their recorded place
+         */
+        bool                    applyEdits( const QVector<ClipEdit>& edits,
+                                            const QVector<QUuid>& removed = {},
+                                            const QVector<QSharedPointer<ClipInstance>>& added = {} );
+
+        /*
+         * Group edits planning: those compute every new placement up front, to be given to
+         * applyEdits(). They return false if the operation isn't possible, and never modify
+         * the sequence. Linked clips follow the clips they're linked to.
+         */
+        /**
+         * @brief planGroupMove Moves clips by the same offset
+         */
+        bool                    planGroupMove( const QVector<QUuid>& uuids, qint32 trackOffset,
+                                               qint64 posOffset, QVector<ClipEdit>& edits ) const;
+        /**
+         * @brief planRippleInsert  Opens a gap of length frames at pos, on every track
+         */
+        bool                    planRippleInsert( qint64 pos, qint64 length, QVector<ClipEdit>& edits ) const;
+        /**
+         * @brief planRippleDelete  Removes everything within [begin, end] and closes the gap, on every track
+         *
+         * This fails if a clip straddles begin or end.
+         */
+        bool                    planRippleDelete( qint64 begin, qint64 end, QVector<ClipEdit>& edits,
+                                                  QVector<QUuid>& removed ) const;
+        /**
+         * @brief planRoll      Moves the cut between two adjacent clips, keeping the sequence length
+         */
+        bool                    planRoll( const QUuid& left, const QUuid& right, qint64 offset,
+                                          QVector<ClipEdit>& edits ) const;
+        /**
+         * @brief planSlip      Shifts the part of the media a clip shows, without moving it
+         */
+        bool                    planSlip( const QUuid& uuid, qint64 offset, QVector<ClipEdit>& edits ) const;
 
         QUuid                   addTransition( const QString& identifier, qint64 begin, qint64 end,
                                                quint32 trackId, Workflow::TrackType type );
@@ -121,44 +196,186 @@ class SequenceWorkflow : public QObject
                                                quint32 trackAId, quint32 trackBId, Workflow::TrackType type );
         bool                    addTransition( QSharedPointer<TransitionInstance> transition );
         bool                    moveTransition( const QUuid& uuid, qint64 begin, qint64 end );
+        bool                    moveTransition( SlotHandle handle, qint64 begin, qint64 end );
         bool                    moveTransitionBetweenTracks( const QUuid& uuid, quint32 trackAId, quint32 trackBId );
+        bool                    moveTransitionBetweenTracks( SlotHandle handle, quint32 trackAId, quint32 trackBId );
         QSharedPointer<TransitionInstance>     removeTransition( const QUuid& uuid );
+        QSharedPointer<TransitionInstance>     removeTransition( SlotHandle handle );
 
         QVariant                toVariant() const;
         void                    loadFromVariant( const QVariant& variant );
+        /**
+         * @brief clear     Drops every clip, transition and filter of the sequence at once
+         *
+         * The backend tracks are replaced by empty ones, so input() changes and must be
+         * queried again. Only cleared() is emitted, not a removal signal per instance.
+         */
         void                    clear();
+        /**
+         * @brief restore   Brings the sequence back to a previously captured state
+         *
+         * Only the elements which differ from the current state are touched: instances
+         * are moved and resized in a single applyEdits() pass, and the removed ones are
+         * recreated from their library clip. This is what undo checkpoints rely on, so
+         * the commands they replaced don't need to be kept around.
+         * @return  false if an element couldn't be restored, ie. its library clip is gone
+         */
+        bool                    restore( const SequenceState& target );
+
+        /**
+         * @brief snapshot  Describes the sequence as it is, to render it apart
+         *
+         * This only serializes the backend graph, the copy is opened from the snapshot,
+         * on the thread which renders it. Tracks, clips, filters and transitions are copied.
+         * @param optimizedMedia    Reads from the optimized copies of the media, when they exist
+         * @param gain  Returns the gain to apply to the audio of a media, in dB, ie. to
+         *              normalize an export. Nothing is added for a null gain.
+         */
+        SequenceSnapshot        snapshot( bool optimizedMedia = false,
+                                          const std::function<double( const ::Media& )>& gain = nullptr ) const;
+
+        /**
+         * @brief state     Returns the current state of the sequence, in O(1)
+         *
+         * Filters are captured when updateFilters() is called, which happens
+         * whenever an effect is added, edited, or an effect command ran.
+         */
+        SequenceState           state() const;
+        /**
+         * @brief updateFilters Records the current filters of a clip instance in the state
+         */
+        void                    updateFilters( const QUuid& uuid );
+        /**
+         * @brief updateFilters Records the current filters of the element an input belongs to
+         *
+         * The input is either the sequence, one of its tracks, or a library clip, in which
+         * case every instance of that clip is updated.
+         */
+        void                    updateFilters( Backend::IInput* input );
+        /**
+         * @brief updateFilters Records the current filters of every clip, track and of the sequence
+         */
+        void                    updateFilters();
+
+        /**
+         * @brief fingerprint   Computes a hash of everything contributing to [begin, end)
+         *
+         * Clip identities, in/out points, filters and transitions are taken into account,
+         * relatively to begin. Two ranges with the same fingerprint render the same frames.
+         */
+        QByteArray              fingerprint( qint64 begin, qint64 end ) const;
 
         QSharedPointer<ClipInstance>    clip( const QUuid& uuid );
         QSharedPointer<TransitionInstance>      transition( const QUuid& uuid );
+
+        /**
+         * UUIDs are only meant for persistence, undo commands & QML. Resolving them once
+         * to a handle makes the following accesses a plain vector lookup.
+         */
+        SlotHandle              clipHandle( const QUuid& uuid ) const;
+        QSharedPointer<ClipInstance>    clip( SlotHandle handle ) const;
+        SlotHandle              transitionHandle( const QUuid& uuid ) const;
+        QSharedPointer<TransitionInstance>      transition( SlotHandle handle ) const;
         quint32                 trackId( const QUuid& uuid );
         qint64                  position( const QUuid& uuid );
 
+        /**
+         * @brief clipInstances Lists the timeline instances using a library clip
+         */
+        QList<QSharedPointer<ClipInstance>>     clipInstances( const QUuid& clipUuid ) const;
+        /**
+         * @brief mediaInstances Lists the timeline instances using any clip of a media
+         */
+        QList<QSharedPointer<ClipInstance>>     mediaInstances( qint64 mediaId ) const;
+        int                     clipUsageCount( const QUuid& clipUuid ) const;
+        int                     mediaUsageCount( qint64 mediaId ) const;
+
+        /**
+         * @brief clipsInRange  Lists the instances overlapping [begin, end], without scanning the sequence
+         * @param trackIds      The tracks to look at, every track if empty
+         * @param type          The type of tracks to look at, both if NbTrackType
+         * @return              The instances, ordered by position, then by track
+         */
+        QList<QSharedPointer<ClipInstance>>         clipsInRange( qint64 begin, qint64 end,
+                                                                  const QVector<quint32>& trackIds = {},
+                                                                  Workflow::TrackType type = Workflow::NbTrackType ) const;
+        /**
+         * @brief transitionsInRange    Lists the transitions overlapping [begin, end]
+         *
+         * A transition between two tracks is listed if either of them is requested.
+         */
+        QList<QSharedPointer<TransitionInstance>>   transitionsInRange( qint64 begin, qint64 end,
+                                                                        const QVector<quint32>& trackIds = {},
+                                                                        Workflow::TrackType type = Workflow::NbTrackType ) const;
+
         Backend::IInput*        input();
         Backend::IInput*        trackInput( quint32 trackId );
 
     private:
+        // What clear() hands over to the background releaser. Only backend objects go
+        // there: QObjects, such as clips and transitions, must die on their own thread.
+        // The members are destroyed in reverse order, each tractor before what it references.
+        struct Graph
+        {
+            QList<QSharedPointer<Backend::ITrack>>              playlists;
+            std::vector<std::unique_ptr<Backend::IMultiTrack>>  trackTractors;
+            QList<std::shared_ptr<Backend::IMultiTrack>>        multiTracks;
+            std::unique_ptr<Backend::IMultiTrack>               multitrack;
+        };
 
         inline QSharedPointer<Track>   track( quint32 trackId, bool audio );
+        void                    createTracks();
+        void                    addTransitionFromVariant( const QVariantMap& variant );
+        void                    updateState( const QSharedPointer<ClipInstance>& clip );
+        void                    updateState( const QSharedPointer<TransitionInstance>& transition );
+        void                    removeFromState( const QUuid& uuid );
+        void                    addUsage( ::Clip& clip, SlotHandle handle );
+        void                    removeUsage( ::Clip& clip, SlotHandle handle );
+        QList<QSharedPointer<ClipInstance>>     instances( const QSet<SlotHandle>& handles ) const;
+        // The given clips, along with the clips linked to them
+        QVector<QSharedPointer<ClipInstance>>   withLinkedClips( const QVector<QUuid>& uuids ) const;
+        bool                    isValid( const ClipEdit& edit ) const;
 
-        QMap<QUuid, QSharedPointer<ClipInstance>>       m_clips;
-        QMap<QUuid, QSharedPointer<TransitionInstance>>         m_transitions;
+        SlotMap<QSharedPointer<ClipInstance>>           m_clips;
+        QHash<QUuid, SlotHandle>                        m_clipHandles;
+        SlotMap<QSharedPointer<TransitionInstance>>     m_transitions;
+        QHash<QUuid, SlotHandle>                        m_transitionHandles;
+        // Reverse index, from library clips & media to the instances using them
+        QHash<QUuid, QSet<SlotHandle>>                  m_clipUsage;
+        QHash<qint64, QSet<SlotHandle>>                 m_mediaUsage;
+        // The library clips used on the timeline, by input, see updateFilters()
+        QHash<Backend::IInput*, QUuid>                  m_clipInputs;
+        // Timeline extent of the instances & transitions, for range queries
+        TimelineIndex                                   m_clipIndex;
+        TimelineIndex                                   m_transitionIndex;
 
         QList<QSharedPointer<Track>>    m_tracks[Workflow::NbTrackType];
         QList<std::shared_ptr<Backend::IMultiTrack>>    m_multiTracks;
         std::unique_ptr<Backend::IMultiTrack>           m_multitrack;
         const size_t                    m_trackCount;
+        SequenceState                   m_state;
 
     signals:
-        void                    clipAdded( QString );
-        void                    clipRemoved( QString );
-        void                    clipLinked( QString, QString );
-        void                    clipUnlinked( QString, QString );
-        void                    clipMoved( QString );
-        void                    clipResized( QString );
-
-        void                    transitionAdded( const QString& uuid );
-        void                    transitionMoved( const QString& uuid );
-        void                    transitionRemoved( const QString& uuid );
+        /*
+         * Elements are notified by handle. When clipRemoved or transitionRemoved is emitted,
+         * the handle doesn't resolve anymore, and clipUnlinked can be given the null handle
+         * of an instance which was removed along.
+         */
+        void                    clipAdded( SlotHandle handle );
+        void                    clipRemoved( SlotHandle handle );
+        void                    clipLinked( SlotHandle handleA, SlotHandle handleB );
+        void                    clipUnlinked( SlotHandle handleA, SlotHandle handleB );
+        void                    clipMoved( SlotHandle handle );
+        void                    clipResized( SlotHandle handle );
+
+        void                    transitionAdded( SlotHandle handle );
+        void                    transitionMoved( SlotHandle handle );
+        void                    transitionRemoved( SlotHandle handle );
+
+        /**
+         * @brief cleared   Emitted once the whole sequence was dropped by clear()
+         */
+        void                    cleared();
 };
 
 #endif // SEQUENCEWORKFLOW_H
@@ -0,0 +1,162 @@
+/*****************************************************************************
+ * TimelineIndex.cpp: Finds the timeline elements overlapping a frame range
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "TimelineIndex.h"
+
+#include <QSet>
+
+#include <algorithm>
+#include <tuple>
+
+int
+TimelineIndex::lengthClass( qint64 begin, qint64 end )
+{
+    int k = 0;
+    for ( auto length = end - begin + 1; length > 1; length >>= 1 )
+        ++k;
+    return k;
+}
+
+void
+TimelineIndex::insert( SlotHandle handle, Workflow::TrackType type, const QVector<quint32>& trackIds,
+                       qint64 begin, qint64 end )
+{
+    auto it = m_entries.constFind( handle );
+    if ( it != m_entries.constEnd() )
+    {
+        if ( it->type == type && it->trackIds == trackIds && it->begin == begin && it->end == end )
+            return;
+        remove( handle );
+    }
+    for ( auto trackId : trackIds )
+    {
+        auto& lane = m_lanes[LaneKey( type, trackId )];
+        lane[lengthClass( begin, end )].emplace( begin, handle );
+    }
+    m_entries.insert( handle, Entry{ type, trackIds, begin, end } );
+}
+
+void
+TimelineIndex::remove( SlotHandle handle )
+{
+    auto it = m_entries.find( handle );
+    if ( it == m_entries.end() )
+        return;
+    for ( auto trackId : it->trackIds )
+    {
+        auto laneIt = m_lanes.find( LaneKey( it->type, trackId ) );
+        if ( laneIt == m_lanes.end() )
+            continue;
+        auto& lane = laneIt->second;
+        auto bucketIt = lane.find( lengthClass( it->begin, it->end ) );
+        if ( bucketIt == lane.end() )
+            continue;
+        auto& bucket = bucketIt->second;
+        auto range = bucket.equal_range( it->begin );
+        for ( auto e = range.first; e != range.second; ++e )
+        {
+            if ( e->second == handle )
+            {
+                bucket.erase( e );
+                break;
+            }
+        }
+        if ( bucket.empty() == true )
+            lane.erase( bucketIt );
+        if ( lane.empty() == true )
+            m_lanes.erase( laneIt );
+    }
+    m_entries.erase( it );
+}
+
+void
+TimelineIndex::clear()
+{
+    m_entries.clear();
+    m_lanes.clear();
+}
+
+QVector<SlotHandle>
+TimelineIndex::query( qint64 begin, qint64 end, const QVector<quint32>& trackIds,
+                      Workflow::TrackType type ) const
+{
+    // First frame, lane, element
+    QVector<std::tuple<qint64, LaneKey, SlotHandle>>    found;
+    // An element between two tracks is found on both
+    QSet<SlotHandle>                                    seen;
+
+    auto visit = [&]( const LaneKey& key, const Lane& lane )
+    {
+        for ( const auto& b : lane )
+        {
+            // Nothing of this bucket starting before that can still be running at begin
+            auto longest = ( qint64( 2 ) << b.first ) - 1;
+            auto first = b.second.lower_bound( begin - longest + 1 );
+            auto last = b.second.upper_bound( end );
+            for ( auto it = first; it != last; ++it )
+            {
+                const auto& entry = m_entries[it->second];
+                if ( entry.end < begin || seen.contains( it->second ) == true )
+                    continue;
+                seen.insert( it->second );
+                found.append( std::make_tuple( it->first, key, it->second ) );
+            }
+        }
+    };
+    for ( int t = 0; t < Workflow::NbTrackType; ++t )
+    {
+        if ( type != Workflow::NbTrackType && type != t )
+            continue;
+        if ( trackIds.isEmpty() == true )
+        {
+            for ( auto it = m_lanes.lower_bound( LaneKey( t, 0 ) );
+                  it != m_lanes.end() && it->first.first == t; ++it )
+                visit( it->first, it->second );
+            continue;
+        }
+        for ( auto trackId : trackIds )
+        {
+            auto it = m_lanes.find( LaneKey( t, trackId ) );
+            if ( it != m_lanes.end() )
+                visit( it->first, it->second );
+        }
+    }
+    // By first frame, then by track, then by type
+    std::sort( found.begin(), found.end(), []( const std::tuple<qint64, LaneKey, SlotHandle>& a,
+                                               const std::tuple<qint64, LaneKey, SlotHandle>& b )
+    {
+        const auto& ka = std::get<1>( a );
+        const auto& kb = std::get<1>( b );
+        return std::make_tuple( std::get<0>( a ), ka.second, ka.first ) <
+                std::make_tuple( std::get<0>( b ), kb.second, kb.first );
+    } );
+
+    QVector<SlotHandle> res;
+    res.reserve( found.size() );
+    for ( const auto& f : found )
+        res.append( std::get<2>( f ) );
+    return res;
+}
@@ -0,0 +1,93 @@
+/*****************************************************************************
+ * TimelineIndex.h: Finds the timeline elements overlapping a frame range
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef TIMELINEINDEX_H
+#define TIMELINEINDEX_H
+
+#include <QHash>
+#include <QVector>
+
+#include <map>
+#include <utility>
+
+#include "Tools/SlotMap.hpp"
+#include "Types.h"
+
+/**
+ *  \brief  Indexes timeline elements by track type, track and first frame.
+ *
+ *  Each audio or video track is a lane. A lane sorts its elements by first frame in
+ *  buckets of similar lengths, bucket k holding the lengths in [2^k, 2^(k+1)). A range
+ *  query visits the elements of bucket k starting in [begin - 2^(k+1) + 2, end]. The
+ *  elements of a track hardly overlap, so only a couple of them per bucket end before
+ *  begin, and a query costs O(b log n + m) per lane, b being the number of buckets in
+ *  use and m the number of elements found. A very long element doesn't widen the
+ *  search for the short ones.
+ */
+class   TimelineIndex
+{
+    public:
+        /**
+         * @brief insert    Indexes an element, replacing its previous entry if any
+         * @param type      The type of the tracks the element lies on
+         * @param trackIds  The tracks the element lies on, ie. both tracks of a transition between tracks
+         * @param begin     The first frame the element covers
+         * @param end       The last frame the element covers, inclusive
+         */
+        void                insert( SlotHandle handle, Workflow::TrackType type,
+                                    const QVector<quint32>& trackIds, qint64 begin, qint64 end );
+        void                remove( SlotHandle handle );
+        void                clear();
+
+        /**
+         * @brief query     Lists the elements overlapping [begin, end]
+         * @param trackIds  The tracks to look at, every track if empty
+         * @param type      The type of tracks to look at, both if NbTrackType
+         * @return          The elements, ordered by first frame, then by track
+         */
+        QVector<SlotHandle> query( qint64 begin, qint64 end, const QVector<quint32>& trackIds = {},
+                                   Workflow::TrackType type = Workflow::NbTrackType ) const;
+
+    private:
+        // Track type & track id
+        typedef std::pair<int, quint32>     LaneKey;
+
+        struct  Entry
+        {
+            Workflow::TrackType type;
+            QVector<quint32>    trackIds;
+            qint64              begin;
+            qint64              end;
+        };
+
+        // The elements of a lane whose length is in [2^k, 2^(k+1)), by first frame
+        typedef std::multimap<qint64, SlotHandle>   Bucket;
+        // By k
+        typedef std::map<int, Bucket>               Lane;
+
+        static int          lengthClass( qint64 begin, qint64 end );
+
+        QHash<SlotHandle, Entry>    m_entries;
+        std::map<LaneKey, Lane>     m_lanes;
+};
+
+#endif // TIMELINEINDEX_H
@@ -5,6 +5,14 @@
 #include "Transition/Transition.h"
 #include "Tools/VlmcDebug.h"
 
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+// Layer of an attached clip which wasn't laid out yet
+static const quint32 NoLayer = std::numeric_limits<quint32>::max();
+
 Track::Track( Workflow::TrackType type )
     : m_type( type )
     , m_multitrack( new Backend::MLT::MLTMultiTrack )
@@ -104,6 +112,81 @@ Track::removeClip( const QUuid& uuid )
     return true;
 }
 
+void
+Track::attachClip( QSharedPointer<SequenceWorkflow::ClipInstance> clipInstance )
+{
+    m_clips[clipInstance->uuid] = QSharedPointer<ClipInstance>::create( clipInstance, NoLayer );
+}
+
+void
+Track::detachClip( const QUuid& uuid )
+{
+    auto it = m_clips.find( uuid );
+    if ( it == m_clips.end() )
+        return;
+    if ( it.value()->internalTrackId != NoLayer )
+        m_dirtyLayers.insert( it.value()->internalTrackId );
+    m_clips.erase( it );
+}
+
+bool
+Track::relayout( const QSet<QUuid>& changed )
+{
+    QList<QSharedPointer<ClipInstance>>  placed;
+    QList<QSharedPointer<ClipInstance>>  toPlace;
+    for ( const auto& c : m_clips )
+    {
+        if ( changed.contains( c->clip->uuid ) == true || c->internalTrackId == NoLayer )
+        {
+            if ( c->internalTrackId != NoLayer )
+                m_dirtyLayers.insert( c->internalTrackId );
+            toPlace << c;
+        }
+        else
+            placed << c;
+    }
+    std::sort( toPlace.begin(), toPlace.end(),
+               []( const QSharedPointer<ClipInstance>& a, const QSharedPointer<ClipInstance>& b )
+    {
+        return a->clip->pos < b->clip->pos;
+    } );
+    // Same rule as insertableTrackIndex: above anything the clip would overlap
+    for ( const auto& c : toPlace )
+    {
+        quint32 index = 0;
+        auto pos = c->clip->pos;
+        auto end = pos + c->clip->clip->length() - 1;
+        for ( const auto& p : placed )
+        {
+            if ( p->clip->pos <= end && pos <= p->clip->pos + p->clip->clip->length() - 1 )
+                index = qMax( index, p->internalTrackId + 1 );
+        }
+        c->internalTrackId = index;
+        m_dirtyLayers.insert( index );
+        placed << c;
+    }
+
+    bool ret = true;
+    for ( auto layer : m_dirtyLayers )
+    {
+        std::vector<std::pair<Backend::IInput*, int64_t>>   clips;
+        for ( const auto& c : m_clips )
+        {
+            if ( c->internalTrackId == layer )
+                clips.emplace_back( c->clip->clip->input(), c->clip->pos );
+        }
+        std::sort( clips.begin(), clips.end(),
+                   []( const std::pair<Backend::IInput*, int64_t>& a, const std::pair<Backend::IInput*, int64_t>& b )
+        {
+            return a.second < b.second;
+        } );
+        if ( track( layer )->setClips( clips ) == false )
+            ret = false;
+    }
+    m_dirtyLayers.clear();
+    return ret;
+}
+
 bool
 Track::addTransition( QSharedPointer<Transition> transition )
 {
@@ -142,6 +225,14 @@ Track::input()
     return *m_multitrack.get();
 }
 
+std::unique_ptr<Backend::IMultiTrack>
+Track::releaseBackend( QList<QSharedPointer<Backend::ITrack>>& tracks )
+{
+    tracks << m_tracks;
+    m_tracks.clear();
+    return std::move( m_multitrack );
+}
+
 quint32
 Track::internalTrackId( const QUuid& uuid )
 {
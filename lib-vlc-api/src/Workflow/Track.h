@@ -1,6 +1,8 @@
 #ifndef TRACK_H
 #define TRACK_H
 
+#include <QHash>
+#include <QSet>
 #include <QUuid>
 #include <QSharedPointer>
 
@@ -21,6 +23,18 @@ public:
     bool                    resizeClip( const QUuid& uuid, qint64 newBegin, qint64 newEnd, qint64 newPos );
     bool                    removeClip( const QUuid& uuid );
 
+    /**
+     * Group edits register & unregister clips without touching the playlists.
+     * relayout() then rebuilds every playlist they affected, once.
+     */
+    void                    attachClip( QSharedPointer<SequenceWorkflow::ClipInstance> clipInstance );
+    void                    detachClip( const QUuid& uuid );
+    /**
+     * @brief relayout  Assigns a layer to the given clips, and rebuilds the layers which changed
+     * @param changed   The clips which were attached, moved or resized. Other clips keep their layer.
+     */
+    bool                    relayout( const QSet<QUuid>& changed );
+
 
     bool                    addTransition( QSharedPointer<Transition> transition );
     bool                    moveTransition( const QUuid& uuid, qint64 begin, qint64 end );
@@ -28,6 +42,16 @@ public:
 
     Backend::IInput&        input();
 
+    /**
+     * @brief releaseBackend    Gives away the playlists & the tractor of this track
+     *
+     * This lets them be destroyed apart, while the clips and transitions this track still
+     * refers to are released along with it. The track must not be used afterward.
+     * @param tracks    Receives the playlists
+     * @return          The tractor, which must be destroyed before the playlists
+     */
+    std::unique_ptr<Backend::IMultiTrack>   releaseBackend( QList<QSharedPointer<Backend::ITrack>>& tracks );
+
 private:
     struct ClipInstance {
         ClipInstance() = default;
@@ -47,11 +71,13 @@ private:
 
     Workflow::TrackType                                                 m_type;
 
-    QMap<QUuid, QSharedPointer<ClipInstance>>                           m_clips;
-    QMap<QUuid, QSharedPointer<Transition>>                             m_transitions;
+    QHash<QUuid, QSharedPointer<ClipInstance>>                          m_clips;
+    QHash<QUuid, QSharedPointer<Transition>>                            m_transitions;
 
     QList<QSharedPointer<Backend::ITrack>>                              m_tracks;
     std::unique_ptr<Backend::IMultiTrack>                               m_multitrack;
+    // Layers to rebuild on the next relayout()
+    QSet<quint32>                                                       m_dirtyLayers;
 };
 
 #endif // TRACK_H